@@ -72,32 +72,161 @@ namespace BluetoothAudioSinkClient {
     class AudioSink : protected RPC::SmartInterfaceType<Exchange::IBluetoothAudio::ISink> {
     private:
         static constexpr uint32_t WriteTimeout = 50;
+        static constexpr uint32_t RingFrames = 8;
+        static constexpr uint32_t RingMagic = 0x474E4952; // "RING"
+        static constexpr uint32_t RingVersion = 1;
 
     private:
+        // The shared segment holds a single-producer/single-consumer ring of
+        // several frames, so the writer does not have to hand over (and wait
+        // for) every frame individually:
+        //
+        //   | Ring (magic, version, accepted, head, tail, capacity) | capacity bytes of audio data |
+        //
+        // Head and tail are free-running byte counters, owned by the producer
+        // and the consumer respectively; (head - tail) is the fill level. The
+        // capacity is a power of two, so (counter & (capacity - 1)) is the
+        // offset in the data, also across the wrap of the counters. The
+        // semaphores of the SharedBuffer are only used for wakeups: Produced()
+        // when the ring turns non-empty, Consumed() when it is no longer full.
+        // Either side publishes its counter first and then rechecks the other
+        // one before it signals or sleeps, so a transition is never missed; a
+        // superfluous wakeup is harmless as both sides recheck the counters.
+        //
+        // The producer fills in magic and version, a consumer that reads the
+        // ring answers with the version it reads in accepted before it returns
+        // from Acquire(). A consumer that leaves accepted at 0 predates the
+        // ring and gets a single frame per handover at the start of the
+        // segment, as before; any other version is refused.
+        struct Ring {
+            uint32_t Magic;
+            uint32_t Version;
+            std::atomic<uint32_t> Accepted;
+            std::atomic<uint32_t> Head;
+            std::atomic<uint32_t> Tail;
+            uint32_t Capacity;
+        };
+
         class SendBuffer : public Core::SharedBuffer {
         public:
             SendBuffer() = delete;
             SendBuffer(const SendBuffer&) = delete;
             SendBuffer& operator=(const SendBuffer&) = delete;
 
-            SendBuffer(const char *connector, const uint32_t bufferSize)
-                : Core::SharedBuffer(connector, 0777, bufferSize, 0)
-                , _bufferSize(bufferSize)
+            SendBuffer(const char *connector, const uint32_t frameSize, const uint32_t frames)
+                : Core::SharedBuffer(connector, 0777, (sizeof(Ring) + Capacity(frameSize * frames)), 0)
+                , _ring(nullptr)
+                , _data(nullptr)
+                , _capacity(Capacity(frameSize * frames))
+                , _frameSize(frameSize)
+                , _single(false)
             {
+                if (IsValid() == true) {
+                    _ring = new (Buffer()) Ring;
+                    _ring->Magic = RingMagic;
+                    _ring->Version = RingVersion;
+                    _ring->Accepted.store(0);
+                    _ring->Head.store(0);
+                    _ring->Tail.store(0);
+                    _ring->Capacity = _capacity;
+                    _data = (Buffer() + sizeof(Ring));
+
+                    Size(sizeof(Ring) + _capacity);
+                }
             }
 
             ~SendBuffer() = default;
 
         public:
-            uint16_t Write(uint32_t length, const uint8_t data[])
+            // To be called once the consumer returned from Acquire(), tells
+            // if it can read what is written here.
+            uint32_t Negotiate()
+            {
+                ASSERT(_ring != nullptr);
+
+                uint32_t result = Core::ERROR_NONE;
+                const uint32_t accepted = _ring->Accepted.load();
+
+                if (accepted == 0) {
+                    TRACE_L1("The consumer does not read the ring, one frame per handover");
+                    _single = true;
+                }
+                else if (accepted != RingVersion) {
+                    TRACE_L1("The consumer reads ring version %u, not %u", accepted, RingVersion);
+                    result = Core::ERROR_NOT_SUPPORTED;
+                }
+
+                return (result);
+            }
+
+            uint16_t Write(const uint16_t length, const uint8_t data[])
             {
                 ASSERT(IsValid() == true);
+                ASSERT(_ring != nullptr);
                 ASSERT(data != nullptr);
 
+                return (_single == true ? WriteFrame(length, data) : WriteRing(length, data));
+            }
+
+        private:
+            // Copies as much of the data as fits in the ring and returns the
+            // number of bytes taken. Only blocks (for at most WriteTimeout ms)
+            // if the ring is completely full.
+            uint16_t WriteRing(const uint16_t length, const uint8_t data[])
+            {
+                uint32_t head = _ring->Head.load(std::memory_order_relaxed);
+                uint32_t space = (_capacity - (head - _ring->Tail.load(std::memory_order_acquire)));
+
+                if ((space == 0) && (length != 0)) {
+                    // Full, wait for the consumer to make room. A stale wakeup
+                    // may return early, in which case we report 0 bytes taken.
+                    RequestProduce(WriteTimeout);
+                    space = (_capacity - (head - _ring->Tail.load(std::memory_order_acquire)));
+                }
+
+                const uint32_t result = std::min(static_cast<uint32_t>(length), space);
+
+                if (result != 0) {
+                    const uint32_t offset = (head & (_capacity - 1));
+                    const uint32_t first = std::min(result, (_capacity - offset));
+
+                    ::memcpy(_data + offset, data, first);
+
+                    if (first < result) {
+                        ::memcpy(_data, data + first, (result - first));
+                    }
+
+                    _ring->Head.store(head + result);
+
+                    // If the consumer had drained everything up to here, it is
+                    // (about to be) asleep and needs a wakeup.
+                    if (_ring->Tail.load() == head) {
+                        Produced();
+                    }
+                }
+
+                return (static_cast<uint16_t>(result));
+            }
+
+            static uint32_t Capacity(const uint32_t size)
+            {
+                uint32_t result = 1;
+
+                while (result < size) {
+                    result <<= 1;
+                }
+
+                return (result);
+            }
+
+            // The exchange of a consumer without the ring, the header is
+            // overwritten by the frame.
+            uint16_t WriteFrame(const uint16_t length, const uint8_t data[])
+            {
                 uint16_t result = 0;
 
                 if (RequestProduce(WriteTimeout) == Core::ERROR_NONE) {
-                    result = std::min(length, _bufferSize);
+                    result = std::min(static_cast<uint32_t>(length), _frameSize);
                     Size(result);
                     ::memcpy(Buffer(), data, result);
                     Produced();
@@ -107,7 +236,11 @@ namespace BluetoothAudioSinkClient {
             }
 
         private:
-            uint32_t _bufferSize;
+            Ring* _ring;
+            uint8_t* _data;
+            uint32_t _capacity;
+            uint32_t _frameSize;
+            bool _single;
         }; // class SendBuffer
 
     private:
@@ -458,7 +591,7 @@ namespace BluetoothAudioSinkClient {
 
                 TRACE_L1("Acquiring sink with connector '%s'", CONNECTOR);
 
-                _buffer.reset(new SendBuffer(CONNECTOR, _frameSize));
+                _buffer.reset(new SendBuffer(CONNECTOR, _frameSize, RingFrames));
                 ASSERT(_buffer.get() != nullptr);
 
                 if (_buffer->IsValid() == true) {
@@ -468,6 +601,14 @@ namespace BluetoothAudioSinkClient {
                         TRACE_L1("IStream::Acquire() failed! [%i]", result);
                         _buffer.reset();
                     }
+                    else {
+                        result = _buffer->Negotiate();
+
+                        if (result != Core::ERROR_NONE) {
+                            _sinkControl->Relinquish();
+                            _buffer.reset();
+                        }
+                    }
                 }
                 else {
                     TRACE_L1("Failed to open buffer!");
@@ -95,6 +95,8 @@ static void* playback_task(void *user_data)
                 const uint16_t bufferSize = ((100UL * context->format.channels * context->format.resolution * (context->format.sample_rate / context->format.frame_rate)) / 8);
                 uint8_t *data = alloca(bufferSize);
                 uint16_t to_play = 0;
+                uint16_t offset = 0;
+                uint16_t chunk = 0;
 
                 TRACE("Opened file '%s' (read buffer size: %i bytes)", context->file, bufferSize);
 
@@ -109,16 +111,17 @@ static void* playback_task(void *user_data)
                         uint16_t played = 0;
 
                         if (to_play == 0) {
-                            to_play = fread(data, 1, bufferSize, f);
+                            to_play = chunk = fread(data, 1, bufferSize, f);
+                            offset = 0;
                         }
 
-                        if (bluetoothaudiosink_frame(to_play, data, &played) != 0) {
+                        if (bluetoothaudiosink_frame(to_play, (data + offset), &played) != 0) {
                             TRACE("Failed to send audio frame!");
                             context->exit = true;
                             break;
                         }
 
-                        if (to_play != bufferSize) {
+                        if ((chunk != bufferSize) && (played == to_play)) {
                             TRACE("EOF reached");
                             context->exit = true;
                             break;
@@ -136,6 +139,7 @@ static void* playback_task(void *user_data)
                         }
 
                         to_play -= played;
+                        offset += played;
                     }
 
                     TRACE("Paused...");
@@ -67,6 +67,8 @@ EXTERNAL uint32_t bluetoothaudiosink_relinquish(void);
 EXTERNAL uint32_t bluetoothaudiosink_speed(const int8_t speed);
 EXTERNAL uint32_t bluetoothaudiosink_time(uint32_t *out_time_ms);
 EXTERNAL uint32_t bluetoothaudiosink_delay(uint32_t *out_delay_samples);
+/* Queues up to length bytes of audio data; the number of bytes actually taken is returned in consumed
+   and may be less than length (or 0) when the sink's buffer is (nearly) full, the caller resubmits the rest. */
 EXTERNAL uint32_t bluetoothaudiosink_frame(const uint16_t length, const uint8_t data[], uint16_t *consumed);
 
 EXTERNAL uint32_t bluetoothaudiosink_init(void);
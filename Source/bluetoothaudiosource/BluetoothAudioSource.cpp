@@ -31,6 +31,36 @@ namespace BluetoothAudioSourceClient {
     private:
         static constexpr uint32_t WriteTimeout = 50;
 
+        // A multi-frame producer lays out the shared segment as the same kind of
+        // single-producer/single-consumer ring the sink library uses, with a magic
+        // and a version in front, so it can be told apart from a single-frame
+        // producer (which writes its frame at the start of the buffer):
+        //
+        //   | Ring (magic, version, accepted, head, tail, capacity) | capacity bytes of audio data |
+        //
+        // Head and tail are free-running byte counters, owned by the producer and
+        // by us respectively. The capacity is a power of two, so the offset in the
+        // data is (counter & (capacity - 1)), also across the wrap of the counters.
+        // Produced() wakes us when the ring turns non-empty, Consumed() wakes the
+        // producer when the ring is no longer full. Both sides publish their own
+        // counter before they check the other one. We answer a ring we read with
+        // its version in accepted, a ring of another version is refused.
+        struct Ring {
+            uint32_t Magic;
+            uint32_t Version;
+            std::atomic<uint32_t> Accepted;
+            std::atomic<uint32_t> Head;
+            std::atomic<uint32_t> Tail;
+            uint32_t Capacity;
+        };
+
+        static constexpr uint32_t RingMagic = 0x474E4952; // "RING"
+        static constexpr uint32_t RingVersion = 1;
+        static constexpr uint32_t ReceiveTimeout = 100;
+
+        // frame_cb takes 16 bit lengths; a multiple of all common sample sizes.
+        static constexpr uint32_t MaxChunk = 65520;
+
         class Receiver : public Core::Thread {
         private:
             class ReceiveBuffer : public Core::SharedBuffer {
@@ -42,29 +72,81 @@ namespace BluetoothAudioSourceClient {
 
                 ReceiveBuffer(const string& name)
                     : Core::SharedBuffer(name.c_str())
+                    , _ring(nullptr)
+                    , _data(nullptr)
+                    , _capacity(0)
+                    , _supported(true)
                 {
+                    if ((IsValid() == true) && (Size() > sizeof(Ring))) {
+                        Ring* ring = reinterpret_cast<Ring*>(Buffer());
+
+                        if (ring->Magic == RingMagic) {
+                            const uint32_t capacity = ring->Capacity;
+
+                            if ((ring->Version == RingVersion) && (capacity != 0) && ((capacity & (capacity - 1)) == 0) && (capacity <= (Size() - sizeof(Ring)))) {
+                                _ring = ring;
+                                _data = (Buffer() + sizeof(Ring));
+                                _capacity = capacity;
+
+                                _ring->Accepted.store(RingVersion);
+                            }
+                            else {
+                                TRACE_L1("Ring version %u of %u bytes is not supported", ring->Version, capacity);
+                                _supported = false;
+                            }
+                        }
+                    }
                 }
 
             public:
-                uint32_t Get(const uint32_t length, uint8_t buffer[])
+                bool IsRing() const
+                {
+                    return (_ring != nullptr);
+                }
+                bool IsSupported() const
+                {
+                    return (_supported);
+                }
+                uint32_t Capacity() const
+                {
+                    return (_capacity);
+                }
+                uint32_t Available() const
+                {
+                    ASSERT(_ring != nullptr);
+                    return (_ring->Head.load() - _ring->Tail.load(std::memory_order_relaxed));
+                }
+                // Lends the oldest data in the ring, without copying it. The length is
+                // clipped to what is contiguous, the rest follows from the start.
+                const uint8_t* Peek(uint32_t& length) const
                 {
-                    uint32_t result = 0;
+                    ASSERT(_ring != nullptr);
+
+                    const uint32_t offset = (_ring->Tail.load(std::memory_order_relaxed) & (_capacity - 1));
+                    length = std::min(length, (_capacity - offset));
 
-                    ASSERT(IsValid() == true);
-                    ASSERT(Buffer() != nullptr);
+                    return (_data + offset);
+                }
+                void Release(const uint32_t length)
+                {
+                    ASSERT(_ring != nullptr);
 
-                    if (RequestConsume(100) == Core::ERROR_NONE) {
-                        ASSERT(BytesWritten() <= length);
+                    const uint32_t tail = _ring->Tail.load(std::memory_order_relaxed);
 
-                        const uint32_t size = std::min(BytesWritten(), length);
-                        ::memcpy(buffer, Buffer(), size);
-                        result = size;
+                    _ring->Tail.store(tail + length);
 
+                    // If the ring was full since we last looked, the producer may be
+                    // waiting for room.
+                    if ((_ring->Head.load() - tail) == _capacity) {
                         Consumed();
                     }
-
-                    return (result);
                 }
+
+            private:
+                Ring* _ring;
+                uint8_t* _data;
+                uint32_t _capacity;
+                bool _supported;
             }; // class ReceiveBuffer
 
         public:
@@ -72,20 +154,17 @@ namespace BluetoothAudioSourceClient {
             Receiver(const Receiver&) = delete;
             Receiver& operator=(const Receiver&) = delete;
 
-            Receiver(AudioSource& parent, const string& connector)
+            Receiver(AudioSource& parent, const string& connector, const uint32_t bytesPerSecond, const uint16_t batchDuration)
                 : _parent(parent)
                 , _receiveBuffer(connector)
-                , _maxFrameSize(0)
-                , _buffer()
-                , _bufferSize(0)
+                , _bytesPerSecond(bytesPerSecond)
+                , _minimum(0)
+                , _waited(false)
+                , _running(false)
             {
-                TRACE_L1("Receive buffer at '%s'", connector.c_str());
+                TRACE_L1("Receive buffer at '%s' (%s)", connector.c_str(), (_receiveBuffer.IsRing() == true ? "multi-frame" : "single frame"));
 
-                _maxFrameSize = _receiveBuffer.Size();
-                _bufferSize = _maxFrameSize;
-
-                _buffer.reset(new (std::nothrow) uint8_t[_bufferSize]);
-                ASSERT(_buffer.get() != nullptr);
+                BatchDuration(batchDuration);
 
                 Block();
                 Stop();
@@ -107,22 +186,58 @@ namespace BluetoothAudioSourceClient {
                 _running = false;
                 Thread::Wait(BLOCKED, Core::infinite);
             }
+            void BatchDuration(const uint16_t durationMs)
+            {
+                if ((_receiveBuffer.IsRing() == true) && (_bytesPerSecond != 0)) {
+                    // Never wait for more than half the ring, or the producer stalls.
+                    const uint64_t minimum = ((static_cast<uint64_t>(durationMs) * _bytesPerSecond) / 1000);
+                    _minimum = static_cast<uint32_t>(std::min(minimum, static_cast<uint64_t>(_receiveBuffer.Capacity() / 2)));
+                }
+            }
 
         public:
             bool IsValid() const {
                 return (_receiveBuffer.IsValid());
             }
+            bool IsSupported() const {
+                return (_receiveBuffer.IsSupported());
+            }
 
         private:
             uint32_t Worker()
             {
                 uint32_t delay = 0;
 
-                const uint16_t bytesRead = _receiveBuffer.Get(_maxFrameSize, _buffer.get());
-                ASSERT(bytesRead < _maxFrameSize);
+                if (_receiveBuffer.IsRing() == false) {
+                    // One frame per handover; still lend it straight from the buffer.
+                    if (_receiveBuffer.RequestConsume(ReceiveTimeout) == Core::ERROR_NONE) {
+                        const uint32_t length = std::min(std::min(_receiveBuffer.BytesWritten(), static_cast<uint32_t>(_receiveBuffer.Size())), static_cast<uint32_t>(MaxChunk));
+
+                        if (length != 0) {
+                            _parent.OnFrameReceived(_receiveBuffer.Buffer(), static_cast<uint16_t>(length));
+                        }
+
+                        _receiveBuffer.Consumed();
+                    }
+                }
+                else {
+                    const uint32_t available = _receiveBuffer.Available();
+                    const uint32_t minimum = _minimum;
 
-                if (bytesRead != 0) {
-                    _parent.OnFrameReceived(_buffer.get(), bytesRead);
+                    if (available == 0) {
+                        _receiveBuffer.RequestConsume(ReceiveTimeout);
+                    }
+                    else if ((available < minimum) && (_waited == false)) {
+                        // Sleep for as long as the rest of the batch takes to come in. If
+                        // it still is not there by then, deliver what we have, so a
+                        // slow or paused producer does not add more than a batch of latency.
+                        delay = std::max(static_cast<uint32_t>(((static_cast<uint64_t>(minimum - available)) * 1000) / _bytesPerSecond), 1u);
+                        _waited = true;
+                    }
+                    else {
+                        Drain(available);
+                        _waited = false;
+                    }
                 }
 
                 if (_running == false) {
@@ -132,14 +247,26 @@ namespace BluetoothAudioSourceClient {
 
                 return (delay);
             }
+            void Drain(uint32_t available)
+            {
+                while (available != 0) {
+                    uint32_t length = std::min(available, static_cast<uint32_t>(MaxChunk));
+                    const uint8_t* data = _receiveBuffer.Peek(length);
+
+                    _parent.OnFrameReceived(data, static_cast<uint16_t>(length));
+
+                    _receiveBuffer.Release(length);
+                    available -= length;
+                }
+            }
 
         private:
             AudioSource& _parent;
             ReceiveBuffer _receiveBuffer;
-            uint16_t _maxFrameSize;
-            std::unique_ptr<uint8_t[]> _buffer;
-            uint32_t _bufferSize;
-            bool _running;
+            uint32_t _bytesPerSecond;
+            std::atomic<uint32_t> _minimum;
+            bool _waited;
+            std::atomic<bool> _running;
         }; // class Receiver
 
     private:
@@ -161,6 +288,8 @@ namespace BluetoothAudioSourceClient {
             , _sinkStateCallbacks()
             , _sinkCallbacks(nullptr)
             , _sinkCallbacksUserData(nullptr)
+            , _bytesPerSecond(0)
+            , _batchDuration(0)
             , _receiver()
         {
             TRACE_L1("Constructing Bluetooth Audio Source client library...");
@@ -349,6 +478,8 @@ namespace BluetoothAudioSourceClient {
                     result = Core::ERROR_GENERAL;
                 }
                 else {
+                    _bytesPerSecond = (format.SampleRate * format.Channels * ((format.Resolution + 7) / 8));
+
                     result = Core::ERROR_NONE;
                     TRACE_L1("Sink configured (%d Hz, %d bits, %d channels, %d.%02d fps)",
                         cFormat.sample_rate, cFormat.resolution, cFormat.channels, (cFormat.frame_rate / 100), (cFormat.frame_rate % 100));
@@ -386,7 +517,7 @@ namespace BluetoothAudioSourceClient {
                         result = Core::ERROR_GENERAL;
                     }
                     else {
-                        _receiver.reset(new Receiver(*this, connector));
+                        _receiver.reset(new Receiver(*this, connector, _bytesPerSecond, _batchDuration));
                         ASSERT(_receiver.get() != nullptr);
 
                         if (_receiver->IsValid() != true) {
@@ -399,6 +530,16 @@ namespace BluetoothAudioSourceClient {
                             TRACE_L1("Failed to open the shared buffer!");
                             result = Core::ERROR_OPENING_FAILED;
                         }
+                        else if (_receiver->IsSupported() != true) {
+                            _receiver.reset();
+
+                            ASSERT(_sinkCallbacks->relinquish_cb != nullptr);
+
+                            _sinkCallbacks->relinquish_cb(_sinkCallbacksUserData);
+
+                            TRACE_L1("The layout of the shared buffer is not supported!");
+                            result = Core::ERROR_NOT_SUPPORTED;
+                        }
                         else {
                             TRACE_L1("Sink acquired");
                             result = Core::ERROR_NONE;
@@ -792,6 +933,20 @@ namespace BluetoothAudioSourceClient {
 
             return (result);
         }
+        uint32_t BatchDuration(const uint16_t durationMs)
+        {
+            _sinkLock.Lock();
+
+            _batchDuration = durationMs;
+
+            if (_receiver != nullptr) {
+                _receiver->BatchDuration(durationMs);
+            }
+
+            _sinkLock.Unlock();
+
+            return (Core::ERROR_NONE);
+        }
         uint32_t Relinquish()
         {
             uint32_t result = Core::ERROR_ILLEGAL_STATE;
@@ -943,6 +1098,8 @@ namespace BluetoothAudioSourceClient {
         SourceStateChangedCallbacks _sinkStateCallbacks;
         const bluetoothaudiosource_sink_t* _sinkCallbacks;
         void* _sinkCallbacksUserData;
+        uint32_t _bytesPerSecond;
+        uint16_t _batchDuration;
         std::unique_ptr<Receiver> _receiver;
     };
 
@@ -1002,6 +1159,11 @@ uint32_t bluetoothaudiosource_set_sink(const bluetoothaudiosource_sink_t *sink,
     return (BluetoothAudioSourceClient::AudioSource::Instance().SetSink(sink, user_data));
 }
 
+uint32_t bluetoothaudiosource_set_batch_duration(const uint16_t duration_ms)
+{
+    return (BluetoothAudioSourceClient::AudioSource::Instance().BatchDuration(duration_ms));
+}
+
 uint32_t bluetoothaudiosource_get_state(bluetoothaudiosource_state_t* out_state)
 {
     if (out_state == nullptr) {
@@ -19,6 +19,7 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <assert.h>
@@ -45,6 +46,8 @@ typedef struct {
     bluetoothaudiosource_format_t format;
     bool recording;
     uint32_t recorded_bytes;
+    uint32_t callbacks;
+    uint16_t batch_ms;
     sem_t connect_sync;
     sem_t record_sync;
 } context_t;
@@ -242,6 +245,7 @@ static void on_frame_received(const uint16_t length, const uint8_t frame[], void
         if (context->file && context->recording) {
             fwrite(frame, length, 1, context->file);
             context->recorded_bytes += length;
+            context->callbacks++;
         }
     }
 }
@@ -297,6 +301,9 @@ static void operational_state_update(const uint8_t running, void *user_data)
         else if (bluetoothaudiosource_set_sink(&callbacks, user_data) != 0) {
             ERROR("Failed to set sink callbacks!");
         }
+        else if (bluetoothaudiosource_set_batch_duration(((context_t *) user_data)->batch_ms) != 0) {
+            ERROR("Failed to set the batch duration!");
+        }
     }
     else {
         TRACE("Bluetooth Audio Source service is now unavailable");
@@ -316,14 +323,15 @@ int main(const int argc, const char* argv[])
 
     TRACE("Records incoming Bluetooth audio stream to  a .wav file");
 
-    if (argc != 2) {
-        TRACE("arguments:\n\t%s <file>", argv[0]);
+    if ((argc != 2) && (argc != 3)) {
+        TRACE("arguments:\n\t%s <file> [minimum batch duration in ms]", argv[0]);
     }
     else {
         context_t context;
         memset(&context, 0, sizeof(context));
 
         context.file_name = argv[1];
+        context.batch_ms = (argc == 3 ? atoi(argv[2]) : 0);
 
         sem_init(&context.connect_sync, 0, 0);
         sem_init(&context.record_sync, 0, 0);
@@ -367,7 +375,8 @@ int main(const int argc, const char* argv[])
 
                             usleep(50 * 1000);
 
-                            printf("Captured %i kilobytes\r", (context.recorded_bytes / 1024));
+                            printf("Captured %i kilobytes in %i callbacks (%i bytes per callback)\r", (context.recorded_bytes / 1024),
+                                context.callbacks, (context.callbacks != 0 ? (context.recorded_bytes / context.callbacks) : 0));
 
                             if ((user_break != false) && (context.recording == true)) {
                                 // Ctrl+C!
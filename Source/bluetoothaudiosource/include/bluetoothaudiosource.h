@@ -78,6 +78,16 @@ EXTERNAL uint32_t bluetoothaudiosource_unregister_state_changed_callback(const b
 
 EXTERNAL uint32_t bluetoothaudiosource_set_sink(const bluetoothaudiosource_sink_t *sink, void *user_data);
 
+/*
+ * Minimum amount of audio, in milliseconds, to collect before frame_cb is called
+ * (default 0: deliver as soon as data arrives). A higher value means fewer, larger
+ * callbacks at the cost of latency. Only effective with a multi-frame source, which
+ * then calls frame_cb with all audio collected so far, possibly split in two when
+ * it wraps around the shared buffer. The frame passed to frame_cb points into the
+ * shared buffer and is only valid for the duration of the callback.
+ */
+EXTERNAL uint32_t bluetoothaudiosource_set_batch_duration(const uint16_t duration_ms);
+
 EXTERNAL uint32_t bluetoothaudiosource_get_state(bluetoothaudiosource_state_t *out_state);
 EXTERNAL uint32_t bluetoothaudiosource_get_device(uint8_t out_address[6]);
 EXTERNAL uint32_t bluetoothaudiosource_get_time(uint32_t *out_time_ms);
@@ -0,0 +1,117 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Include the core and com headers (and declare the module) before this one.
+
+namespace Thunder {
+namespace Client {
+
+    // One COM-RPC channel to an endpoint a plugin serves itself (not the Thunder
+    // communicator), opened on first use and kept open for the calls that follow.
+    // If the other side closed it in the mean time, the next Interface() call
+    // opens a fresh one.
+    template <typename INTERFACE>
+    class EndPointLink {
+    public:
+        EndPointLink() = delete;
+        EndPointLink(const EndPointLink&) = delete;
+        EndPointLink& operator=(const EndPointLink&) = delete;
+
+        EndPointLink(const string& endPoint, const string& className)
+            : _adminLock()
+            , _endPoint(endPoint)
+            , _className(className)
+            , _engine(Core::ProxyType<RPC::InvokeServerType<1, 0, 4>>::Create())
+            , _client()
+            , _remote(nullptr)
+        {
+        }
+        ~EndPointLink()
+        {
+            Close();
+        }
+
+    public:
+        // Returns the (AddRef'ed) remote interface, or nullptr if the endpoint
+        // can not be reached.
+        INTERFACE* Interface()
+        {
+            INTERFACE* result = nullptr;
+
+            _adminLock.Lock();
+
+            if ((_client.IsValid() == true) && (_client->IsOpen() == false)) {
+                Drop();
+            }
+
+            if (_client.IsValid() == false) {
+                _client = Core::ProxyType<RPC::CommunicatorClient>::Create(Core::NodeId(_endPoint.c_str()), Core::ProxyType<Core::IIPCServer>(_engine));
+                ASSERT(_client.IsValid() == true);
+
+                _remote = _client->template Open<INTERFACE>(_className);
+
+                if (_remote == nullptr) {
+                    TRACE_L1(_T("Could not open link to the %s @ %s"), _className.c_str(), _endPoint.c_str());
+                    _client.Release();
+                }
+            }
+
+            if (_remote != nullptr) {
+                _remote->AddRef();
+                result = _remote;
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+        void Close()
+        {
+            _adminLock.Lock();
+            Drop();
+            _adminLock.Unlock();
+        }
+
+    private:
+        void Drop()
+        {
+            if (_remote != nullptr) {
+                _remote->Release();
+                _remote = nullptr;
+            }
+
+            if (_client.IsValid() == true) {
+                _client.Release();
+            }
+        }
+
+    private:
+        Core::CriticalSection _adminLock;
+        const string _endPoint;
+        const string _className;
+        Core::ProxyType<RPC::InvokeServerType<1, 0, 4>> _engine;
+        Core::ProxyType<RPC::CommunicatorClient> _client;
+        INTERFACE* _remote;
+    };
+
+}
+}
@@ -28,6 +28,9 @@ const char* descriptors[] = {
     _T("/tmp/buffer2.txt"),
 };
 
+// Number of slots in the swapchain, each slot gets its own set of files.
+constexpr uint8_t depth = 2;
+
 const char bridgeConnector[] = _T("/tmp/connector");
 
 class CompositorBuffer : public Compositor::CompositorBuffer {
@@ -39,17 +42,19 @@ protected:
         const uint32_t width, const uint32_t height,
         const uint32_t format, const uint64_t modifier,
         const Exchange::ICompositionBuffer::DataType type)
-        : BaseClass(width, height, format, modifier, type)
+        : BaseClass(width, height, format, modifier, type, depth)
         , _dirty(false)
     {
 
-        printf("Constructing server buffer.\n");
+        printf("Constructing server buffer with %d slots.\n", depth);
 
-        for (uint8_t index = 0; index < (sizeof(descriptors) / sizeof(const char*)); index++) {
-            Core::File file(string(descriptors[index]));
-            if (file.Create(Core::File::USER_READ | Core::File::USER_WRITE) == true) {
-                BaseClass::Add(static_cast<Core::File::Handle>(file), 0xAAAA + index, 0x5555 + index);
-                printf("Opening: [%d] -> name: %s\n", static_cast<Core::File::Handle>(file), descriptors[index]);
+        for (uint8_t slot = 0; slot < depth; slot++) {
+            for (uint8_t index = 0; index < (sizeof(descriptors) / sizeof(const char*)); index++) {
+                Core::File file(string(descriptors[index]) + '.' + Core::NumberType<uint8_t>(slot).Text());
+                if (file.Create(Core::File::USER_READ | Core::File::USER_WRITE) == true) {
+                    BaseClass::Add(slot, static_cast<Core::File::Handle>(file), 0xAAAA + index, 0x5555 + index);
+                    printf("Opening: [%d] -> name: %s\n", static_cast<Core::File::Handle>(file), file.Name().c_str());
+                }
             }
         }
         // Let's start monitoring the CompositorBuffer to detect changes
@@ -91,18 +96,18 @@ public:
         }
         return (result);
     }
-    void Request() override
+    void Request(const uint8_t slot) override
     {
-        printf("We need to do our magic here :-)\n");
+        printf("We need to do our magic here on slot %d :-)\n", slot);
         _dirty = true;
 
         std::this_thread::sleep_for(std::chrono::milliseconds(4));
 
-        if (Rendered() == true) {
+        if (Rendered(slot) == true) {
             printf("Request rendered.\n");
             std::this_thread::sleep_for(std::chrono::milliseconds(12));
 
-            if (Published() == true){
+            if (Published(slot) == true){
                 printf("Request published.\n");
             } else {
                 printf("Request failed to publish.\n");
@@ -294,6 +299,10 @@ int main(int argc, const char* argv[])
                     printf("Height: %d\n", buffer->Height());
                     printf("Format: %d\n", buffer->Format());
                     printf("Type: %d\n", buffer->Type());
+                    Core::ProxyType<Compositor::SharedBuffer> shared = Core::ProxyType<Compositor::SharedBuffer>(buffer);
+                    if (shared != nullptr) {
+                        printf("Slots:  %d\n", shared->Depth());
+                    }
                     Core::ProxyType<Test::CompositorBuffer> info = Core::ProxyType<Test::CompositorBuffer>(buffer);
                     if (info != nullptr) {
                         printf("Dirty:  %s\n", info->IsDirty() ? _T("true") : _T("false"));
@@ -304,9 +313,15 @@ int main(int argc, const char* argv[])
                 if (buffer == nullptr) {
                     printf("There are no buffers\n");
                 } else {
-                    Exchange::ICompositionBuffer::IIterator* planes = buffer->Acquire(10);
+                    Core::ProxyType<Compositor::ClientBuffer> client = Core::ProxyType<Compositor::ClientBuffer>(buffer);
+
+                    // The client renders into the next free slot of the swapchain, the
+                    // server accesses the slot it was last requested to render.
+                    Exchange::ICompositionBuffer::IIterator* planes = (client != nullptr ? client->AcquireNext(10) : buffer->Acquire(10));
 
-                    if (planes != nullptr) {
+                    if (planes == nullptr) {
+                        printf("No free slot to write to.\n");
+                    } else {
                         printf("Iterating ove the planes to write:\n");
                         while (planes->Next() == true) {
                             int fd = planes->Descriptor();
@@ -314,22 +329,22 @@ int main(int argc, const char* argv[])
                             ::write(fd, "Hello World !!!\n", 16);
                             ::fsync(fd);
                         }
-                    }
 
-                    buffer->Relinquish();
+                        buffer->Relinquish();
+                    }
 
                     if (server == false) {
-                        Core::ProxyType<Compositor::ClientBuffer> info = Core::ProxyType<Compositor::ClientBuffer>(buffer);
-                        if (info != nullptr) {
-                            printf("Request to render.\n");
-                            info->RequestRender();
+                        if ((client != nullptr) && (planes != nullptr)) {
+                            printf("Request to render slot %d.\n", client->Slot());
+                            client->RequestRender();
                         }
                     } else {
                         Core::ProxyType<Compositor::CompositorBuffer> info = Core::ProxyType<Compositor::CompositorBuffer>(buffer);
                         if (info != nullptr) {
                             printf("Render request handled.\n");
-                            info->Rendered();
-                            info->Published();
+                            const uint8_t slot = info->Slot();
+                            info->Rendered(slot);
+                            info->Published(slot);
                         }
                     }
                 }
@@ -27,8 +27,10 @@
 
 #include <interfaces/ICompositionBuffer.h>
 
+#include <linux/futex.h>
 #include <sys/eventfd.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 
 namespace Thunder {
 
@@ -205,9 +207,14 @@ namespace Compositor {
     class EXTERNAL SharedBuffer : public Exchange::ICompositionBuffer, public Core::IResource {
     public:
         static constexpr uint8_t MaxPlanes = 4;
+        static constexpr uint8_t MaxSlots = 4;
+        static constexpr uint8_t InvalidSlot = 0xFF;
 
     private:
         // We need some shared space for data to exchange, and to create a lock..
+        // The buffer is a swapchain of 1 to MaxSlots slots. Each slot has its own
+        // planes, lock and state, so the client can render into one slot while
+        // the compositor is still using another one.
         class EXTERNAL SharedStorage {
         private:
             struct PlaneStorage {
@@ -221,8 +228,278 @@ namespace Compositor {
                 PUBLISHED,
                 DESTROYED
             };
+            enum owner : uint8_t {
+                FREE,
+                CLIENT,
+                COMPOSITOR
+            };
+
+            class SlotStorage {
+            public:
+                // Just like the SharedStorage, this lives in the mmapped area, the
+                // members are set up by Initialize() on the side that creates it.
+                SlotStorage() {};
+                SlotStorage(SlotStorage&&) = delete;
+                SlotStorage(const SlotStorage&) = delete;
+                SlotStorage& operator=(SlotStorage&&) = delete;
+                SlotStorage& operator=(const SlotStorage&) = delete;
+
+            public:
+                void Initialize()
+                {
+                    _command.store(mode::IDLE);
+                    _owner.store(owner::FREE);
+                    _sequence = 0;
+                    _count = 0;
+
+                    // The lock is taken from both processes, and a client that crashes while
+                    // rendering should not lock out the compositor, so process shared and robust.
+                    pthread_mutexattr_t attributes;
+
+                    if ((::pthread_mutexattr_init(&attributes) != 0) || (::pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED) != 0) || (::pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST) != 0) || (::pthread_mutex_init(&_mutex, &attributes) != 0)) {
+                        // That will be the day, if this fails...
+                        ASSERT(false);
+                    }
+
+                    ::pthread_mutexattr_destroy(&attributes);
+                }
+                void Deinitialize()
+                {
+#ifdef __WINDOWS__
+                    ::CloseHandle(&(_mutex));
+#else
+                    ::pthread_mutex_destroy(&(_mutex));
+#endif
+                }
+
+            public:
+                uint8_t Planes() const
+                {
+                    return (_count);
+                }
+                uint32_t Stride(const uint8_t index) const
+                { // Bytes per row for a plane [(bit-per-pixel/8) * width]
+                    ASSERT(index < _count);
+                    return (_planes[index]._stride);
+                }
+                uint32_t Offset(const uint8_t index) const
+                { // Offset of the plane from where the pixel data starts in the buffer.
+                    ASSERT(index < _count);
+                    return (_planes[index]._offset);
+                }
+                void Add(const uint32_t stride, const uint32_t offset)
+                {
+                    ASSERT(_count < (sizeof(_planes) / sizeof(PlaneStorage)));
+                    _planes[_count]._stride = stride;
+                    _planes[_count]._offset = offset;
+                    _count++;
+                }
+                bool Claim()
+                {
+                    owner set = owner::FREE;
+                    return (_owner.compare_exchange_strong(set, owner::CLIENT));
+                }
+                void Abandon()
+                {
+                    owner set = owner::CLIENT;
+                    _owner.compare_exchange_strong(set, owner::FREE);
+                }
+                void Submit(const uint32_t sequence)
+                {
+                    _sequence = sequence;
+                    _owner.store(owner::COMPOSITOR);
+                }
+                bool Release()
+                {
+                    owner set = owner::COMPOSITOR;
+                    return (_owner.compare_exchange_strong(set, owner::FREE));
+                }
+                bool IsSubmitted() const
+                {
+                    return (_owner == owner::COMPOSITOR);
+                }
+                uint32_t Sequence() const
+                {
+                    return (_sequence);
+                }
+                bool Request()
+                {
+                    bool result;
+                    mode set = mode::IDLE;
+                    if ((result = _command.compare_exchange_strong(set, mode::REQUEST)) == false) {
+                        set = mode::REQUEST;
+                        result = _command.compare_exchange_strong(set, mode::REQUEST);
+                    }
+                    return (result);
+                }
+                bool Rendered()
+                {
+                    bool result;
+                    mode set = mode::IDLE;
+                    if ((result = _command.compare_exchange_strong(set, mode::RENDERED)) == false) {
+                        set = mode::RENDERED;
+                        if ((result = _command.compare_exchange_strong(set, mode::RENDERED)) == false) {
+                            set = mode::PUBLISHED;
+                            result = _command.compare_exchange_strong(set, mode::RENDERED);
+                        }
+                    }
+                    return (result);
+                }
+                bool Published()
+                {
+                    bool result;
+                    mode set = mode::IDLE;
+                    if ((result = _command.compare_exchange_strong(set, mode::PUBLISHED)) == false) {
+                        set = mode::RENDERED;
+                        if ((result = _command.compare_exchange_strong(set, mode::PUBLISHED)) == false) {
+                            set = mode::PUBLISHED;
+                            result = _command.compare_exchange_strong(set, mode::PUBLISHED);
+                        }
+                    }
+                    return (result);
+                }
+                void Destroyed()
+                {
+                    _command.store(mode::DESTROYED);
+                }
+                bool IsDestroyed() const
+                {
+                    return (_command == mode::DESTROYED);
+                }
+                bool IsRequested() const
+                {
+                    mode set = mode::REQUEST;
+                    return (_command.compare_exchange_strong(set, mode::IDLE));
+                }
+                bool IsRendered() const
+                {
+                    mode set = mode::RENDERED;
+                    return (_command.compare_exchange_strong(set, mode::IDLE));
+                }
+                bool IsPublished() const
+                {
+                    mode set = mode::PUBLISHED;
+                    return (_command.compare_exchange_strong(set, mode::IDLE));
+                }
+                uint32_t Lock(uint32_t timeout)
+                {
+                    timespec structTime;
+
+#ifdef __WINDOWS__
+                    return (::WaitForSingleObjectEx(&_mutex, timeout, FALSE) == WAIT_OBJECT_0 ? Core::ERROR_NONE : Core::ERROR_TIMEDOUT);
+#else
+                    // pthread_mutex_timedlock takes an absolute CLOCK_REALTIME time.
+                    clock_gettime(CLOCK_REALTIME, &structTime);
+                    structTime.tv_nsec += ((timeout % 1000) * 1000 * 1000); /* remainder, milliseconds to nanoseconds */
+                    structTime.tv_sec += (timeout / 1000) + (structTime.tv_nsec / 1000000000); /* milliseconds to seconds */
+                    structTime.tv_nsec = structTime.tv_nsec % 1000000000;
+                    int result = pthread_mutex_timedlock(&_mutex, &structTime);
+
+                    if (result == EOWNERDEAD) {
+                        // The other side died holding the lock, the kernel handed it to us. Whatever
+                        // was half rendered gets overwritten by the next frame, so take it over.
+                        result = ::pthread_mutex_consistent(&_mutex);
+                    }
+
+                    return (result == 0 ? Core::ERROR_NONE : Core::ERROR_TIMEDOUT);
+#endif
+                }
+                uint32_t Unlock()
+                {
+#ifdef __WINDOWS__
+                    ::LeaveCriticalSection(&_mutex);
+#else
+                    pthread_mutex_unlock(&_mutex);
+#endif
+                    return (Core::ERROR_NONE);
+                }
+
+            private:
+                mutable std::atomic<mode> _command;
+                std::atomic<owner> _owner;
+                uint32_t _sequence;
+#ifdef __WINDOWS__
+                CRITICAL_SECTION _mutex;
+#else
+                pthread_mutex_t _mutex;
+#endif
+                uint8_t _count;
+                PlaneStorage _planes[MaxPlanes];
+            };
 
         public:
+            // One direction of the frame handshake. The sender sets the bit of the slot in
+            // the futex word and only enters the kernel to wake the other side if it is parked
+            // in Wait(). The eventfd of this direction is only written for a receiver that
+            // (still) polls it through the ResourceMonitor.
+            class Handshake {
+            public:
+                // Lives in the mmapped area, set up by Initialize() on the side that creates it.
+                Handshake() {};
+                Handshake(Handshake&&) = delete;
+                Handshake(const Handshake&) = delete;
+                Handshake& operator=(Handshake&&) = delete;
+                Handshake& operator=(const Handshake&) = delete;
+
+            public:
+                void Initialize()
+                {
+                    _state.store(0);
+                    _polled.store(true);
+                }
+                // Returns true if the receiver still needs the eventfd.
+                bool Signal(const uint8_t slot)
+                {
+                    if ((_state.fetch_or(1 << slot) & Parked) != 0) {
+                        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_state), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+                    }
+                    return (_polled.load());
+                }
+                // The slots signalled since the previous call.
+                uint32_t Take()
+                {
+                    return (_state.exchange(0) & ~Parked);
+                }
+                uint32_t Wait(const uint32_t waitTimeInMs)
+                {
+                    const uint64_t deadline = (waitTimeInMs == Core::infinite ? 0 : Core::Time::Now().Add(waitTimeInMs).Ticks());
+                    uint32_t result;
+
+                    // From now on the receiver does not look at the eventfd anymore.
+                    _polled.store(false);
+
+                    while (((result = Take()) == 0) && (waitTimeInMs != 0)) {
+                        uint32_t expected = 0;
+                        timespec remaining;
+
+                        if (waitTimeInMs != Core::infinite) {
+                            const uint64_t now = Core::Time::Now().Ticks();
+
+                            if (now >= deadline) {
+                                break;
+                            }
+
+                            remaining.tv_sec = static_cast<time_t>((deadline - now) / Core::Time::MicroSecondsPerSecond);
+                            remaining.tv_nsec = static_cast<long>(((deadline - now) % Core::Time::MicroSecondsPerSecond) * 1000);
+                        }
+
+                        // Only park if nothing came in meanwhile, the kernel checks the word again.
+                        if (_state.compare_exchange_strong(expected, Parked) == true) {
+                            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_state), FUTEX_WAIT, Parked, (waitTimeInMs == Core::infinite ? nullptr : &remaining), nullptr, 0);
+                        }
+                    }
+
+                    return (result);
+                }
+
+            private:
+                static constexpr uint32_t Parked = 0x80000000;
+                static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "The futex word must be a plain 32 bits value");
+
+                std::atomic<uint32_t> _state;
+                std::atomic<bool> _polled;
+            };
+
             // Do not initialize members for now, this constructor is called after a mmap in the
             // placement new operator above. Initializing them now will reset the original values
             // of the buffer metadata.
@@ -245,33 +522,35 @@ namespace Compositor {
             SharedStorage& operator=(SharedStorage&&) = delete;
             SharedStorage& operator=(const SharedStorage&) = delete;
 
-            SharedStorage(const uint32_t width, const uint32_t height, const uint32_t format, const uint64_t modifier, const Exchange::ICompositionBuffer::DataType type)
+            SharedStorage(const uint32_t width, const uint32_t height, const uint32_t format, const uint64_t modifier, const Exchange::ICompositionBuffer::DataType type, const uint8_t depth)
                 : _width(width)
                 , _height(height)
                 , _format(format)
                 , _modifier(modifier)
                 , _type(type)
-                , _command(mode::IDLE)
-                , _count(0)
+                , _depth(depth == 0 ? 1 : (depth > MaxSlots ? static_cast<uint8_t>(MaxSlots) : depth))
+                , _sequence(0)
             {
-                if (::pthread_mutex_init(&_mutex, nullptr) != 0) {
-                    // That will be the day, if this fails...
-                    ASSERT(false);
+                ASSERT((depth >= 1) && (depth <= MaxSlots));
+
+                _produced.Initialize();
+                _consumed.Initialize();
+
+                for (uint8_t index = 0; index < MaxSlots; index++) {
+                    _slots[index].Initialize();
                 }
             }
             ~SharedStorage()
             {
-#ifdef __WINDOWS__
-                ::CloseHandle(&(_mutex));
-#else
-                ::pthread_mutex_destroy(&(_mutex));
-#endif
+                for (uint8_t index = 0; index < MaxSlots; index++) {
+                    _slots[index].Deinitialize();
+                }
             }
 
         public:
-            uint8_t Planes() const
+            uint8_t Depth() const
             {
-                return (_count);
+                return (_depth);
             }
             uint32_t Width() const
             {
@@ -289,109 +568,82 @@ namespace Compositor {
             {
                 return (_modifier);
             }
-            uint32_t Stride(const uint8_t index) const
-            { // Bytes per row for a plane [(bit-per-pixel/8) * width]
-                ASSERT(index < _count);
-                return (_planes[index]._stride);
+            Exchange::ICompositionBuffer::DataType Type() const
+            {
+                return _type;
             }
-            uint32_t Offset(const uint8_t index) const
-            { // Offset of the plane from where the pixel data starts in the buffer.
-                ASSERT(index < _count);
-                return (_planes[index]._offset);
+            SlotStorage& Slot(const uint8_t index)
+            {
+                ASSERT(index < _depth);
+                return (_slots[index]);
+            }
+            const SlotStorage& Slot(const uint8_t index) const
+            {
+                ASSERT(index < _depth);
+                return (_slots[index]);
+            }
+            // Client to compositor, the counterpart of the produced eventfd.
+            Handshake& Produced()
+            {
+                return (_produced);
             }
-            void Add(const uint32_t stride, const uint32_t offset)
+            // Compositor to client, the counterpart of the consumed eventfd.
+            Handshake& Consumed()
             {
-                ASSERT(_count < (sizeof(_planes) / sizeof(PlaneStorage)));
-                _planes[_count]._stride = stride;
-                _planes[_count]._offset = offset;
-                _count++;
+                return (_consumed);
             }
-            bool Request()
+            uint8_t Claim()
             {
-                bool result;
-                mode set = mode::IDLE;
-                if ((result = _command.compare_exchange_strong(set, mode::REQUEST)) == false) {
-                    set = mode::REQUEST;
-                    result = _command.compare_exchange_strong(set, mode::REQUEST);
+                uint8_t result = 0;
+
+                while ((result < _depth) && (_slots[result].Claim() == false)) {
+                    result++;
+                }
+
+                if (result == _depth) {
+                    result = InvalidSlot;
                 }
+
                 return (result);
             }
-            bool Rendered()
+            void Submit(const uint8_t index)
             {
-                bool result;
-                mode set = mode::IDLE;
-                if ((result = _command.compare_exchange_strong(set, mode::RENDERED)) == false) {
-                    set = mode::RENDERED;
-                    if ((result = _command.compare_exchange_strong(set, mode::RENDERED)) == false) {
-                        set = mode::PUBLISHED;
-                        result = _command.compare_exchange_strong(set, mode::RENDERED);
+                _slots[index].Submit(_sequence.fetch_add(1) + 1);
+            }
+            // The compositor is done with everything that was submitted before this slot.
+            void Composited(const uint8_t index)
+            {
+                const uint32_t sequence = _slots[index].Sequence();
+
+                for (uint8_t slot = 0; slot < _depth; slot++) {
+                    // With a single slot there is nothing to swap with, it is free for the next frame right away.
+                    if ((_depth == 1) || ((slot != index) && (_slots[slot].IsSubmitted() == true) && (static_cast<int32_t>(_slots[slot].Sequence() - sequence) < 0))) {
+                        _slots[slot].Release();
                     }
                 }
-                return (result);
             }
-            bool Published()
+            // Of the slots waiting for the compositor, the one submitted last.
+            uint8_t Latest() const
             {
-                bool result;
-                mode set = mode::IDLE;
-                if ((result = _command.compare_exchange_strong(set, mode::PUBLISHED)) == false) {
-                    set = mode::RENDERED;
-                    if ((result = _command.compare_exchange_strong(set, mode::PUBLISHED)) == false) {
-                        set = mode::PUBLISHED;
-                        result = _command.compare_exchange_strong(set, mode::PUBLISHED);
+                uint8_t result = InvalidSlot;
+
+                for (uint8_t slot = 0; slot < _depth; slot++) {
+                    if ((_slots[slot].IsSubmitted() == true) && ((result == InvalidSlot) || (static_cast<int32_t>(_slots[slot].Sequence() - _slots[result].Sequence()) > 0))) {
+                        result = slot;
                     }
                 }
+
                 return (result);
             }
             void Destroyed()
             {
-                _command.store(mode::DESTROYED);
+                for (uint8_t index = 0; index < _depth; index++) {
+                    _slots[index].Destroyed();
+                }
             }
             bool IsDestroyed() const
             {
-                return (_command == mode::DESTROYED);
-            }
-            bool IsRequested() const
-            {
-                mode set = mode::REQUEST;
-                return (_command.compare_exchange_strong(set, mode::IDLE));
-            }
-            bool IsRendered() const
-            {
-                mode set = mode::RENDERED;
-                return (_command.compare_exchange_strong(set, mode::IDLE));
-            }
-            bool IsPublished() const
-            {
-                mode set = mode::PUBLISHED;
-                return (_command.compare_exchange_strong(set, mode::IDLE));
-            }
-            Exchange::ICompositionBuffer::DataType Type() const
-            {
-                return _type;
-            }
-            uint32_t Lock(uint32_t timeout)
-            {
-                timespec structTime;
-
-#ifdef __WINDOWS__
-                return (::WaitForSingleObjectEx(&_mutex, timeout, FALSE) == WAIT_OBJECT_0 ? Core::ERROR_NONE : Core::ERROR_TIMEDOUT);
-#else
-                clock_gettime(CLOCK_MONOTONIC, &structTime);
-                structTime.tv_nsec += ((timeout % 1000) * 1000 * 1000); /* remainder, milliseconds to nanoseconds */
-                structTime.tv_sec += (timeout / 1000) + (structTime.tv_nsec / 1000000000); /* milliseconds to seconds */
-                structTime.tv_nsec = structTime.tv_nsec % 1000000000;
-                int result = pthread_mutex_timedlock(&_mutex, &structTime);
-                return (result == 0 ? Core::ERROR_NONE : Core::ERROR_TIMEDOUT);
-#endif
-            }
-            uint32_t Unlock()
-            {
-#ifdef __WINDOWS__
-                ::LeaveCriticalSection(&_mutex);
-#else
-                pthread_mutex_unlock(&_mutex);
-#endif
-                return (Core::ERROR_NONE);
+                return (_slots[0].IsDestroyed());
             }
 
         private:
@@ -400,17 +652,14 @@ namespace Compositor {
             uint32_t _format;
             uint64_t _modifier;
             Exchange::ICompositionBuffer::DataType _type;
-            mutable std::atomic<mode> _command;
-#ifdef __WINDOWS__
-            CRITICAL_SECTION _mutex;
-#else
-            pthread_mutex_t _mutex;
-#endif
+            uint8_t _depth;
+            std::atomic<uint32_t> _sequence;
+            Handshake _produced;
+            Handshake _consumed;
             // This might fluctuate between the different implementations
             // although the shared storage space might be shared so
             // always keep this at the end of the data set..
-            uint8_t _count;
-            PlaneStorage _planes[MaxPlanes];
+            SlotStorage _slots[MaxSlots];
         };
 
         class EXTERNAL Iterator : public Exchange::ICompositionBuffer::IIterator {
@@ -472,12 +721,18 @@ namespace Compositor {
             , _producedFd(-1)
             , _consumedFd(-1)
             , _storage(nullptr)
+            , _buffer()
+            , _slot(0)
+            , _locked(0)
         {
+            Invalidate();
         }
 
     public:
         /***
-         * We need a 64bit according: https://github.com/torvalds/linux/blob/v6.1/fs/eventfd.c#L275
+         * The eventfd's only ring the bell, which slots were signalled is kept in the futex
+         * word of the handshake in the shared storage, one bit per slot.
+         * The eventfd needs a 64bit according: https://github.com/torvalds/linux/blob/v6.1/fs/eventfd.c#L275
          */
         using EventFrame = uint64_t;
 
@@ -486,14 +741,18 @@ namespace Compositor {
         SharedBuffer& operator=(SharedBuffer&&) = delete;
         SharedBuffer& operator=(const SharedBuffer&) = delete;
 
-        SharedBuffer(const uint32_t width, const uint32_t height, const uint32_t format, const uint64_t modifier, const Exchange::ICompositionBuffer::DataType type)
+        SharedBuffer(const uint32_t width, const uint32_t height, const uint32_t format, const uint64_t modifier, const Exchange::ICompositionBuffer::DataType type, const uint8_t depth = 1)
             : _iterator(*this)
             , _virtualFd(-1)
             , _producedFd(-1)
             , _consumedFd(-1)
             , _storage(nullptr)
             , _buffer()
+            , _slot(0)
+            , _locked(0)
         {
+            Invalidate();
+
             _virtualFd = ::memfd_create(_T("CompositorBuffer"), MFD_ALLOW_SEALING | MFD_CLOEXEC);
             if (_virtualFd != -1) {
                 int length = sizeof(struct SharedStorage);
@@ -501,13 +760,13 @@ namespace Compositor {
                 /* Size the file as specified by our struct. */
                 if (::ftruncate(_virtualFd, length) != -1) {
                     /* map that file to a memory area we can directly access as a memory mapped file */
-                    _storage = new (_virtualFd) SharedStorage(width, height, format, modifier, type);
+                    _storage = new (_virtualFd) SharedStorage(width, height, format, modifier, type, depth);
                     if (_storage == nullptr) {
                         ::close(_virtualFd);
                         _virtualFd = -1;
                     } else {
-                        _producedFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
-                        _consumedFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+                        _producedFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                        _consumedFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
                     }
                 }
             }
@@ -519,7 +778,10 @@ namespace Compositor {
             , _consumedFd(-1)
             , _storage(nullptr)
             , _buffer()
+            , _slot(0)
+            , _locked(0)
         {
+            Invalidate();
             Load(descriptors);
         }
         SharedBuffer(const Core::ProxyType<Exchange::ICompositionBuffer>& buffer)
@@ -529,7 +791,10 @@ namespace Compositor {
             , _consumedFd(-1)
             , _storage(nullptr)
             , _buffer()
+            , _slot(0)
+            , _locked(0)
         {
+            Invalidate();
             Load(buffer);
         }
         ~SharedBuffer() override
@@ -546,9 +811,14 @@ namespace Compositor {
 
                 ASSERT(_storage != nullptr);
             }
-            // Close all the FileDescriptors handed over to us for the planes.
-            for (uint8_t index = 0; index < _storage->Planes(); index++) {
-                ::close(_descriptors[index]);
+            // Close all the FileDescriptors handed over to us for the planes, fewer
+            // than announced may have arrived.
+            for (uint8_t slot = 0; slot < MaxSlots; slot++) {
+                for (uint8_t index = 0; index < MaxPlanes; index++) {
+                    if (_descriptors[slot][index] != -1) {
+                        ::close(_descriptors[slot][index]);
+                    }
+                }
             }
             if (_storage != nullptr) {
                 delete _storage;
@@ -565,6 +835,7 @@ namespace Compositor {
         {
             return (_storage != nullptr);
         }
+        // The virtual memory and the two eventfd's, followed by the planes of all slots, in slot order.
         uint8_t Descriptors(const uint8_t maxSize, int container[]) const
         {
             ASSERT(IsValid() == true);
@@ -575,11 +846,13 @@ namespace Compositor {
                 container[0] = _virtualFd;
                 container[1] = _producedFd;
                 container[2] = _consumedFd;
-                uint8_t count = std::min(_storage->Planes(), static_cast<uint8_t>(maxSize - 3));
-                for (uint8_t index = 0; index < count; index++) {
-                    container[index + 3] = _descriptors[index];
+                result = 3;
+
+                for (uint8_t slot = 0; slot < _storage->Depth(); slot++) {
+                    for (uint8_t index = 0; (index < _storage->Slot(slot).Planes()) && (result < maxSize); index++) {
+                        container[result++] = _descriptors[slot][index];
+                    }
                 }
-                result = 3 + count;
             }
             return (result);
         }
@@ -590,9 +863,12 @@ namespace Compositor {
         // Wait time in milliseconds.
         IIterator* Acquire(const uint32_t waitTimeInMs) override
         {
-            // Access to the buffer planes.
+            // Access to the buffer planes of the selected slot.
             IIterator* result = nullptr;
-            if (_storage->Lock(waitTimeInMs) == Core::ERROR_NONE) {
+            const uint8_t slot = _slot;
+
+            if (_storage->Slot(slot).Lock(waitTimeInMs) == Core::ERROR_NONE) {
+                _locked = slot;
                 _iterator.Reset();
                 result = &_iterator;
             }
@@ -600,7 +876,7 @@ namespace Compositor {
         }
         void Relinquish() override
         {
-            _storage->Unlock();
+            _storage->Slot(_locked).Unlock();
         }
         uint32_t Width() const override
         { // Width of the allocated buffer in pixels
@@ -629,7 +905,18 @@ namespace Compositor {
         }
         uint8_t Planes() const
         {
-            return (_storage->Planes());
+            return (_storage->Slot(_locked).Planes());
+        }
+        // Number of slots in the swapchain.
+        uint8_t Depth() const
+        {
+            ASSERT(_storage != nullptr);
+            return (_storage->Depth());
+        }
+        // The slot Acquire() gives access to.
+        uint8_t Slot() const
+        {
+            return (_slot);
         }
 
     protected:
@@ -645,14 +932,14 @@ namespace Compositor {
                 /* Size the file as specified by our struct. */
                 if (::ftruncate(_virtualFd, length) != -1) {
                     /* map that file to a memory area we can directly access as a memory mapped file */
-                    _storage = new (_virtualFd) SharedStorage(buffer->Width(), buffer->Height(), buffer->Format(), buffer->Modifier(), buffer->Type());
+                    _storage = new (_virtualFd) SharedStorage(buffer->Width(), buffer->Height(), buffer->Format(), buffer->Modifier(), buffer->Type(), 1);
                     if (_storage == nullptr) {
                         ::close(_virtualFd);
                         _virtualFd = -1;
                     } else {
 
-                        _producedFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
-                        _consumedFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+                        _producedFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                        _consumedFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
 
                         // Iterate over the planes and create them
                         Exchange::ICompositionBuffer::IIterator* index(buffer->Acquire(Core::infinite));
@@ -681,6 +968,7 @@ namespace Compositor {
                 _storage = new (_virtualFd) SharedStorage();
                 if (_storage == nullptr) {
                     ::close(_virtualFd);
+                    _virtualFd = -1;
                 } else {
                     _producedFd = index->Move();
                     index++;
@@ -690,23 +978,29 @@ namespace Compositor {
                     ASSERT(_producedFd != -1);
                     ASSERT(_consumedFd != -1);
 
-                    uint8_t position = 0;
+                    for (uint8_t slot = 0; slot < _storage->Depth(); slot++) {
+                        uint8_t position = 0;
 
-                    while ((index != descriptors.end()) && (position < _storage->Planes())) {
-                        _descriptors[position] = index->Move();
-                        index++;
-                        position++;
+                        while ((index != descriptors.end()) && (position < _storage->Slot(slot).Planes())) {
+                            _descriptors[slot][position] = index->Move();
+                            index++;
+                            position++;
+                        }
                     }
                 }
             }
         }
         void Add(int fd, const uint32_t stride, const uint32_t offset)
         {
-            uint8_t index = _storage->Planes();
+            Add(0, fd, stride, offset);
+        }
+        void Add(const uint8_t slot, int fd, const uint32_t stride, const uint32_t offset)
+        {
+            uint8_t index = _storage->Slot(slot).Planes();
             ASSERT(fd > 0);
-            ASSERT(index < (sizeof(_descriptors) / sizeof(int)));
-            _descriptors[index] = ::dup(fd);
-            _storage->Add(stride, offset);
+            ASSERT(index < MaxPlanes);
+            _descriptors[slot][index] = ::dup(fd);
+            _storage->Slot(slot).Add(stride, offset);
         }
         int Producer() const
         {
@@ -716,53 +1010,121 @@ namespace Compositor {
         {
             return (_consumedFd);
         }
+        void Select(const uint8_t slot)
+        {
+            ASSERT(slot < _storage->Depth());
+            _slot = slot;
+        }
+        uint8_t Claim()
+        {
+            return (_storage->Claim());
+        }
+        void Abandon(const uint8_t slot)
+        {
+            _storage->Slot(slot).Abandon();
+        }
+        void Submit(const uint8_t slot)
+        {
+            _storage->Submit(slot);
+        }
+        void Composited(const uint8_t slot)
+        {
+            _storage->Composited(slot);
+        }
+        uint8_t Latest() const
+        {
+            return (_storage->Latest());
+        }
+        bool Signal(const int fd, const uint8_t slot)
+        {
+            bool result = true;
+
+            if (Channel(fd).Signal(slot) == true) {
+                EventFrame value = 1;
+                result = (::write(fd, &value, sizeof(value)) == sizeof(value));
+            }
+
+            return (result);
+        }
+        EventFrame Signalled(const int fd)
+        {
+            EventFrame value;
+
+            // Clear the bell, the slots are in the handshake, even if it was not rung.
+            const ssize_t length VARIABLE_IS_NOT_USED = ::read(fd, &value, sizeof(value));
+
+            return (Channel(fd).Take());
+        }
+        // Blocking alternative to polling the eventfd, for a dedicated thread. Once used, the
+        // other side stops writing the eventfd, so do not mix it with a ResourceMonitor.
+        EventFrame Signalled(const int fd, const uint32_t waitTimeInMs)
+        {
+            return (Channel(fd).Wait(waitTimeInMs));
+        }
+        static bool IsSignalled(const EventFrame frame, const uint8_t slot)
+        {
+            return (((frame >> slot) & 1) != 0);
+        }
         void Destroyed()
         {
             _storage->Destroyed();
         }
-        bool Request()
+        bool Request(const uint8_t slot)
         {
-            return (_storage->Request());
+            return (_storage->Slot(slot).Request());
         }
-        bool Rendered()
+        bool Rendered(const uint8_t slot)
         {
-            return (_storage->Rendered());
+            return (_storage->Slot(slot).Rendered());
         }
-        bool Published()
+        bool Published(const uint8_t slot)
         {
-            return (_storage->Published());
+            return (_storage->Slot(slot).Published());
         }
         bool IsDestroyed() const
         {
             return (_storage->IsDestroyed());
         }
-        bool IsRequested() const
+        bool IsRequested(const uint8_t slot) const
         {
-            return (_storage->IsRequested());
+            return (_storage->Slot(slot).IsRequested());
         }
-        bool IsRendered() const
+        bool IsRendered(const uint8_t slot) const
         {
-            return (_storage->IsRendered());
+            return (_storage->Slot(slot).IsRendered());
         }
-        bool IsPublished() const
+        bool IsPublished(const uint8_t slot) const
         {
-            return (_storage->IsPublished());
+            return (_storage->Slot(slot).IsPublished());
         }
 
     private:
+        SharedStorage::Handshake& Channel(const int fd)
+        {
+            ASSERT((fd == _producedFd) || (fd == _consumedFd));
+            return (fd == _producedFd ? _storage->Produced() : _storage->Consumed());
+        }
         uint32_t Stride(const uint8_t index) const
         { // Bytes per row for a plane [(bit-per-pixel/8) * width]
             ASSERT(_storage != nullptr);
-            return (_storage->Stride(index));
+            return (_storage->Slot(_locked).Stride(index));
         }
         uint32_t Offset(const uint8_t index) const
         { // Offset of the plane from where the pixel data starts in the buffer.
             ASSERT(_storage != nullptr);
-            return (_storage->Offset(index));
+            return (_storage->Slot(_locked).Offset(index));
         }
         int Descriptor(const uint8_t index) const
         {
-            return (_descriptors[index]);
+            return (_descriptors[_locked][index]);
+        }
+        void Invalidate()
+        {
+            for (uint8_t slot = 0; slot < MaxSlots; slot++) {
+                for (uint8_t index = 0; index < MaxPlanes; index++) {
+                    _descriptors[slot][index] = -1;
+                }
+            }
         }
 
     private:
@@ -783,7 +1145,11 @@ namespace Compositor {
         // have the same lifetime as we have..
         Core::ProxyType<Exchange::ICompositionBuffer> _buffer;
 
-        int _descriptors[MaxPlanes];
+        // The slot Acquire() will lock and the one that is currently locked.
+        std::atomic<uint8_t> _slot;
+        uint8_t _locked;
+
+        int _descriptors[MaxSlots][MaxPlanes];
     };
 
     class EXTERNAL ClientBuffer : public SharedBuffer {
@@ -795,6 +1161,7 @@ namespace Compositor {
 
         ClientBuffer()
             : SharedBuffer()
+            , _released(false, true)
         {
         }
         ~ClientBuffer() override = default;
@@ -804,18 +1171,59 @@ namespace Compositor {
         {
             SharedBuffer::Load(descriptors);
         }
+        // Claim a slot the compositor is done with and lock it for rendering, waits
+        // for the compositor to release one if all slots are in use. RequestRender()
+        // hands the claimed slot over to the compositor.
+        IIterator* AcquireNext(const uint32_t waitTimeInMs)
+        {
+            IIterator* result = nullptr;
+            uint8_t slot = SharedBuffer::Claim();
+
+            if ((slot == InvalidSlot) && (waitTimeInMs != 0)) {
+                const uint64_t deadline = (waitTimeInMs == Core::infinite ? 0 : Core::Time::Now().Add(waitTimeInMs).Ticks());
+                uint32_t remaining = waitTimeInMs;
+                bool waiting = true;
+
+                // Not every signal of the compositor releases a slot, so keep on trying till
+                // one is released or the time is up.
+                while (waiting == true) {
+                    _released.ResetEvent();
+
+                    // The compositor might have released one in between.
+                    if (((slot = SharedBuffer::Claim()) != InvalidSlot) || (remaining == 0) || (_released.Lock(remaining) != Core::ERROR_NONE)) {
+                        waiting = false;
+                    } else if (remaining != Core::infinite) {
+                        const uint64_t now = Core::Time::Now().Ticks();
+                        remaining = (now < deadline ? static_cast<uint32_t>((deadline - now) / 1000) : 0);
+                    }
+                }
+            }
+
+            if (slot != InvalidSlot) {
+                SharedBuffer::Select(slot);
+
+                if ((result = SharedBuffer::Acquire(waitTimeInMs)) == nullptr) {
+                    SharedBuffer::Abandon(slot);
+                }
+            }
+
+            return (result);
+        }
         bool RequestRender()
         {
+            const uint8_t slot = SharedBuffer::Slot();
             bool requested = true;
 
-            if (SharedBuffer::Request() == false) {
+            SharedBuffer::Submit(slot);
+
+            if (SharedBuffer::Request(slot) == false) {
                 // Might be that we just got a RENDERED event from the other side
-                if (SharedBuffer::IsRendered() == true) {
+                if (SharedBuffer::IsRendered(slot) == true) {
                     // If so handle it..
                     Rendered();
                 }
                 // If it was not the Rendered event it must  have been the Published event
-                else if (SharedBuffer::IsPublished() == true) {
+                else if (SharedBuffer::IsPublished(slot) == true) {
                     Published();
                 }
 
@@ -824,24 +1232,23 @@ namespace Compositor {
                 // state, than if the IsPublished() state was not yet handled
                 // it might ocurr now before we do a second attempt to set the
                 // request.. So potentially it might still fail once!
-                if (SharedBuffer::Request() == false) {
+                if (SharedBuffer::Request(slot) == false) {
 
                     // This ocurres if the IsRendered() was picked up by the Handle
                     // method in this class, the Publication occurred after we checked
                     // the IsPublished before we reached the second attempt to Request()
-                    if (SharedBuffer::IsPublished() == true) {
+                    if (SharedBuffer::IsPublished(slot) == true) {
                         Published();
                     }
 
                     // Now the request *MUST* succeed!
-                    requested = SharedBuffer::Request();
+                    requested = SharedBuffer::Request(slot);
 
                     ASSERT((requested == true) || (SharedBuffer::IsDestroyed() == true));
                 }
             }
             if (requested == true) {
-                typename SharedBuffer::EventFrame value = 1;
-                requested = (::write(SharedBuffer::Producer(), &value, sizeof(value)) == sizeof(value));
+                requested = SharedBuffer::Signal(SharedBuffer::Producer(), slot);
             }
 
             return (requested);
@@ -860,22 +1267,50 @@ namespace Compositor {
         }
         void Handle(const uint16_t events) override
         {
-            typename SharedBuffer::EventFrame value;
-
-            if (((events & POLLIN) != 0) && (::read(SharedBuffer::Consumer(), &value, sizeof(value)) == sizeof(value))) {
-                if (SharedBuffer::IsRendered() == true) {
-                    Rendered();
-                } else if (SharedBuffer::IsPublished() == true) {
-                    Published();
-                }
+            if ((events & POLLIN) != 0) {
+                Dispatch(SharedBuffer::Signalled(SharedBuffer::Consumer()));
             }
         }
 
+        // Instead of registering with the ResourceMonitor, a render thread can wait for the
+        // compositor itself. Rendered() and Published() are then called from here. As the
+        // slots are released from here as well, use AcquireNext(0) in between.
+        uint32_t Wait(const uint32_t waitTimeInMs)
+        {
+            const typename SharedBuffer::EventFrame value = SharedBuffer::Signalled(SharedBuffer::Consumer(), waitTimeInMs);
+
+            Dispatch(value);
+
+            return (value != 0 ? Core::ERROR_NONE : Core::ERROR_TIMEDOUT);
+        }
+
         //
         // Methods to retrieve the status of the buffer on Compositor side
         // ----------------------------------------------------------------
         virtual void Rendered() = 0;
         virtual void Published() = 0;
+
+    private:
+        void Dispatch(const typename SharedBuffer::EventFrame value)
+        {
+            if (value != 0) {
+                for (uint8_t slot = 0; slot < SharedBuffer::Depth(); slot++) {
+                    if (SharedBuffer::IsSignalled(value, slot) == true) {
+                        if (SharedBuffer::IsRendered(slot) == true) {
+                            Rendered();
+                        } else if (SharedBuffer::IsPublished(slot) == true) {
+                            Published();
+                        }
+                    }
+                }
+
+                // The compositor releases slots as it moves on to newer ones.
+                _released.SetEvent();
+            }
+        }
+
+    private:
+        Core::Event _released;
     };
 
     class EXTERNAL CompositorBuffer : public SharedBuffer {
@@ -886,8 +1321,8 @@ namespace Compositor {
         CompositorBuffer& operator=(CompositorBuffer&&) = delete;
         CompositorBuffer& operator=(const CompositorBuffer&) = delete;
 
-        CompositorBuffer(const uint32_t width, const uint32_t height, const uint32_t format, const uint64_t modifier, const Exchange::ICompositionBuffer::DataType type)
-            : SharedBuffer(width, height, format, modifier, type)
+        CompositorBuffer(const uint32_t width, const uint32_t height, const uint32_t format, const uint64_t modifier, const Exchange::ICompositionBuffer::DataType type, const uint8_t depth = 1)
+            : SharedBuffer(width, height, format, modifier, type, depth)
         {
         }
         CompositorBuffer(const Core::ProxyType<Exchange::ICompositionBuffer>& buffer)
@@ -906,51 +1341,59 @@ namespace Compositor {
         {
             SharedBuffer::Load(buffer);
         }
-        bool Rendered()
+        // Rendered and Published take the slot handed out by Request(slot). The selected
+        // slot moves on as soon as the client submits a newer frame, so it can not be used
+        // to find out which frame the compositor was working on.
+        bool Rendered(const uint8_t slot)
         {
             bool requested = true;
 
-            if (SharedBuffer::Rendered() == false) {
+            ASSERT(slot < SharedBuffer::Depth());
+
+            // Everything the client submitted before this slot is of no use anymore.
+            SharedBuffer::Composited(slot);
+
+            if (SharedBuffer::Rendered(slot) == false) {
 
                 // Might be that we just got a REQUEST event from the other side
-                if (SharedBuffer::IsRequested() == true) {
+                if (SharedBuffer::IsRequested(slot) == true) {
                     // If so handle it..
-                    Request();
+                    Request(slot);
                 }
 
                 // Now the request *MUST* succeed!
-                requested = SharedBuffer::Rendered();
+                requested = SharedBuffer::Rendered(slot);
 
                 ASSERT(requested == true);
             }
 
             if (requested == true) {
-                typename SharedBuffer::EventFrame value = 1;
-                requested = (::write(SharedBuffer::Consumer(), &value, sizeof(value)) == sizeof(value));
+                requested = SharedBuffer::Signal(SharedBuffer::Consumer(), slot);
             }
 
             return (requested);
         }
-        bool Published()
+        bool Published(const uint8_t slot)
         {
             bool requested = true;
 
-            if (SharedBuffer::Published() == false) {
+            ASSERT(slot < SharedBuffer::Depth());
+
+            if (SharedBuffer::Published(slot) == false) {
                 // Might be that we just got a REQUEST event from the other side
-                if (SharedBuffer::IsRequested() == true) {
+                if (SharedBuffer::IsRequested(slot) == true) {
                     // If so handle it..
-                    Request();
+                    Request(slot);
                 }
 
                 // Now the request *MUST* succeed!
-                requested = SharedBuffer::Published();
+                requested = SharedBuffer::Published(slot);
 
                 ASSERT(requested == true);
             }
 
             if (requested == true) {
-                typename SharedBuffer::EventFrame value = 1;
-                requested = (::write(SharedBuffer::Consumer(), &value, sizeof(value)) == sizeof(value));
+                requested = SharedBuffer::Signal(SharedBuffer::Consumer(), slot);
             }
 
             return (requested);
@@ -969,19 +1412,48 @@ namespace Compositor {
         }
         void Handle(const uint16_t events) override
         {
-            typename SharedBuffer::EventFrame value;
-
-            if (((events & POLLIN) != 0) && (::read(SharedBuffer::Producer(), &value, sizeof(value)) == sizeof(value))) {
-                if (SharedBuffer::IsRequested() == true) {
-                    Request();
-                }
+            if ((events & POLLIN) != 0) {
+                Dispatch(SharedBuffer::Signalled(SharedBuffer::Producer()));
             }
         }
 
+        // Instead of registering with the ResourceMonitor, a compositor thread can wait for
+        // the client itself. Request(slot) is then called from here.
+        uint32_t Wait(const uint32_t waitTimeInMs)
+        {
+            const typename SharedBuffer::EventFrame value = SharedBuffer::Signalled(SharedBuffer::Producer(), waitTimeInMs);
+
+            Dispatch(value);
+
+            return (value != 0 ? Core::ERROR_NONE : Core::ERROR_TIMEDOUT);
+        }
+
         //
         // Method to retrieve the status of the buffer on Client side
         // ----------------------------------------------------------------
-        virtual void Request() = 0;
+        virtual void Request(const uint8_t slot) = 0;
+
+    private:
+        void Dispatch(const typename SharedBuffer::EventFrame value)
+        {
+            bool requested = false;
+
+            for (uint8_t slot = 0; slot < SharedBuffer::Depth(); slot++) {
+                if ((SharedBuffer::IsSignalled(value, slot) == true) && (SharedBuffer::IsRequested(slot) == true)) {
+                    requested = true;
+                }
+            }
+
+            // If the client got ahead of us, only its last frame is of interest.
+            if (requested == true) {
+                const uint8_t slot = SharedBuffer::Latest();
+
+                if (slot != InvalidSlot) {
+                    SharedBuffer::Select(slot);
+                    Request(slot);
+                }
+            }
+        }
     };
 
 }
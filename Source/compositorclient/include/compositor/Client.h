@@ -114,6 +114,22 @@ namespace Compositor {
             virtual void Direct(const uint8_t index, const ITouchPanel::state state, const uint16_t x, const uint16_t y) = 0;
         };
 
+        // The compositor is done with a buffer handed over with ISurface::Present, it may be
+        // written again. Called on the event thread of the display. Once BufferCallback(nullptr)
+        // returned, it is no longer called, nor still running.
+        struct IBufferCallback {
+            virtual ~IBufferCallback() {}
+
+            virtual void Released(const uint32_t id) = 0;
+        };
+
+        // One plane of a dma-buf frame, the descriptor stays owned by the caller.
+        struct Plane {
+            int fd;
+            uint32_t offset;
+            uint32_t stride;
+        };
+
         struct ISurface {
             virtual ~ISurface(){};
 
@@ -136,6 +152,16 @@ namespace Compositor {
             virtual void Opacity(const uint32_t) { }
             virtual void Visibility(const bool) { }
             virtual void Resize(const int, const int, const int, const int) { }
+
+            // Zero copy path for frames that already live in dma-bufs (decoders, GBM bos), for the
+            // backends that support it. Import returns the id of the buffer, the same id for a
+            // dma-buf imported before, or ~0 if the compositor can not take the format/modifier.
+            virtual uint32_t Import(const uint32_t /* width */, const uint32_t /* height */, const uint32_t /* format */, const uint64_t /* modifier */, const uint8_t /* count */, const Plane /* planes */[]) { return (~0); }
+            // False if the buffer is unknown or still held by the compositor.
+            virtual bool Present(const uint32_t /* id */) { return (false); }
+            // Drops the buffer from the pool, once the compositor released it.
+            virtual void Forget(const uint32_t /* id */) { }
+            virtual void BufferCallback(IBufferCallback*) { }
         };
 
         static IDisplay* Instance(const std::string&);
@@ -184,6 +210,10 @@ namespace Compositor {
             return (result);
         }
 
+        // Flag for Process(data), honoured by backends that wait for the compositor to
+        // publish the surfaces (Mesa): only wait for the surfaces to be handed over.
+        enum : uint32_t { PROCESS_NONBLOCKING = 0x80000000 };
+
         virtual ~IDisplay() {}
 
         // Lifetime management
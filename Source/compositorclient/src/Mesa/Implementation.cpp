@@ -47,8 +47,13 @@ extern "C" {
 #include "RenderAPI.h"
 
 #include <condition_variable>
+#include <list>
 #include <mutex>
 
+#include <linux/dma-buf.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+
 namespace Thunder {
 namespace Linux {
     namespace {
@@ -90,6 +95,7 @@ namespace Linux {
 
     private:
         static constexpr uint32_t DisplayId = 0;
+        static constexpr uint8_t SubmitThreads = 2;
 
         Display(const std::string& displayName);
 
@@ -119,20 +125,21 @@ namespace Linux {
                     , _textureId(0)
                     , _frameBuffer(0)
                     , _eglImage(EGL_NO_IMAGE)
-                    , _eglSync()
+                    , _nativeFence(false)
+                    , _fence(-1)
+                    , _sync(nullptr)
                 {
                 }
                 ~EGLBuffer()
                 {
+                    Discard();
+
                     if (_frameBuffer != 0) {
                         glDeleteFramebuffers(1, &_frameBuffer);
                     }
                     if (_textureId != 0) {
                         glDeleteTextures(1, &_textureId);
                     }
-                    if (_eglSync != nullptr) {
-                        _egl.eglDestroySync(_display, _eglSync);
-                    }
                     if (_eglImage != EGL_NO_IMAGE) {
                         _egl.eglDestroyImage(_display, _eglImage);
                     }
@@ -161,7 +168,8 @@ namespace Linux {
 
                         ASSERT(_display != EGL_NO_DISPLAY);
 
-                        _eglSync = _egl.eglCreateSync(_display, EGL_SYNC_FENCE, NULL);
+                        _nativeFence = (_egl.eglDupNativeFenceFDANDROID != nullptr)
+                            && (Compositor::API::HasExtension(eglQueryString(_display, EGL_EXTENSIONS), "EGL_ANDROID_native_fence_sync") == true);
 
                         planes->Next();
                         ASSERT(planes->IsValid() == true);
@@ -225,10 +233,12 @@ namespace Linux {
 
                     return eglImage;
                 }
-                bool Render()
+                /*
+                 * @brief   Binds the buffer and fences the GPU work queued so far. Uses
+                 *          the current EGL context, so it runs on the rendering thread.
+                 */
+                void Prepare()
                 {
-                    bool succeeded = false;
-
                     // Make sure this done at the right time, after eglInitialize and only needed once.
                     if (_eglImage == EGL_NO_IMAGE) {
                         _eglImage = CreateImage();
@@ -236,66 +246,181 @@ namespace Linux {
 
                     ASSERT(_eglImage != EGL_NO_IMAGE);
 
+                    // The texture and framebuffer are backed by the buffer itself, they
+                    // live as long as the buffer does.
+                    if (_frameBuffer == 0) {
+                        CreateFrameBuffer();
+                    }
+
+                    if (_frameBuffer != 0) {
+                        glBindFramebuffer(GL_FRAMEBUFFER, _frameBuffer);
+                    }
+
+                    Fence();
+                }
+                /*
+                 * @brief   Hands the buffer, and the fence of Prepare(), over to the
+                 *          compositor. Does not touch the EGL context, so it can run on
+                 *          any thread.
+                 *
+                 * @return  false if the buffer could not be submitted.
+                 */
+                bool Submit()
+                {
+                    bool requested = false;
+
                     // Lock the buffer
-                    if (Acquire(100) != nullptr) {
-                        constexpr const GLuint target = GL_TEXTURE_2D;
-                        constexpr const GLuint filter = GL_LINEAR;
-                        constexpr const GLuint wrap = GL_CLAMP_TO_EDGE;
+                    ICompositionBuffer::IIterator* planes = Acquire(100);
 
-                        // Just an arbitrary selected unit
-                        glActiveTexture(GL_TEXTURE0);
+                    if (planes != nullptr) {
+                        planes->Next();
+                        ASSERT(planes->IsValid() == true);
 
-                        if (_textureId != 0) {
-                            glDeleteTextures(1, &_textureId);
+                        // Let the compositor wait for the rendering to complete, not us.
+                        if (Handover(planes->Descriptor()) == false) {
+                            Wait();
                         }
 
-                        // GLES (extension: GL_OES_EGL_image_external): Create GL texture from EGL image
-                        glGenTextures(1, &_textureId);
-                        glBindTexture(target, _textureId);
-                        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, filter);
-                        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, filter);
-                        glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
-                        glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+                        Relinquish();
 
-                        _gl.glEGLImageTargetTexture2DOES(target, _eglImage);
+                        // Signal the other side we have a completed buffer, ready to show...
+                        _parent.Requested();
 
-                        if (_frameBuffer != 0) {
-                            glDeleteFramebuffers(1, &_frameBuffer);
+                        requested = RequestRender();
+
+                        if (requested == false) {
+                            _parent.Published();
                         }
+                    }
 
-                        glGenFramebuffers(1, &_frameBuffer);
-                        glBindFramebuffer(GL_FRAMEBUFFER, _frameBuffer);
+                    Discard();
 
-                        // Bind the created texture as one of the buffers of the frame buffer object
-                        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, _textureId, 0 /* level */);
+                    return (requested);
+                }
+                void Rendered() override
+                {
+                    _parent.Rendered();
+                }
+                void Published() override
+                {
+                    _parent.Published();
+                }
 
-                        succeeded = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+            private:
+                void CreateFrameBuffer()
+                {
+                    constexpr const GLuint target = GL_TEXTURE_2D;
+                    constexpr const GLuint filter = GL_LINEAR;
+                    constexpr const GLuint wrap = GL_CLAMP_TO_EDGE;
+
+                    // Just an arbitrary selected unit
+                    glActiveTexture(GL_TEXTURE0);
+
+                    // GLES (extension: GL_OES_EGL_image_external): Create GL texture from EGL image
+                    glGenTextures(1, &_textureId);
+                    glBindTexture(target, _textureId);
+                    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, filter);
+                    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, filter);
+                    glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+                    glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+
+                    _gl.glEGLImageTargetTexture2DOES(target, _eglImage);
+
+                    glGenFramebuffers(1, &_frameBuffer);
+                    glBindFramebuffer(GL_FRAMEBUFFER, _frameBuffer);
+
+                    // Bind the created texture as one of the buffers of the frame buffer object
+                    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, _textureId, 0 /* level */);
+
+                    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                        TRACE(Trace::Error, (_T("Framebuffer for the buffer is incomplete")));
+
+                        glDeleteFramebuffers(1, &_frameBuffer);
+                        glDeleteTextures(1, &_textureId);
+
+                        _frameBuffer = 0;
+                        _textureId = 0;
+                    } else {
+                        TRACE(Trace::Information, (_T("Created texture %d and framebuffer %d for the buffer"), _textureId, _frameBuffer));
+                    }
+                }
+                /*
+                 * @brief   Creates a fence for the GPU work queued so far; preferably a
+                 *          native one, that can be attached to the dma-buf.
+                 */
+                void Fence()
+                {
+                    ASSERT((_fence == -1) && (_sync == nullptr));
+
+#ifdef DMA_BUF_IOCTL_IMPORT_SYNC_FILE
+                    if (_nativeFence == true) {
+                        EGLSync sync = _egl.eglCreateSync(_display, EGL_SYNC_NATIVE_FENCE_ANDROID, nullptr);
 
-                        if (succeeded != true) {
-                            glDeleteFramebuffers(1, &_frameBuffer);
-                            glDeleteTextures(1, &_textureId);
+                        if (sync != nullptr) {
+                            // The native fence only exists after the commands are flushed.
+                            glFlush();
 
-                            _frameBuffer = 0;
-                            _textureId = 0;
+                            _fence = _egl.eglDupNativeFenceFDANDROID(_display, sync);
+
+                            _egl.eglDestroySync(_display, sync);
                         }
+                    }
+#endif
 
-                        // Wait for all EGL actions to be completed
-                        _egl.eglClientWaitSync(_display, _eglSync, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, EGL_FOREVER_KHR);
+                    if (_fence < 0) {
+                        _sync = _egl.eglCreateSync(_display, EGL_SYNC_FENCE, nullptr);
 
-                        Relinquish();
+                        // Flushed here, the submitter waits without a current context.
+                        glFlush();
+                    }
+                }
+                /*
+                 * @brief   Attaches the native fence to the dma-buf, so whoever accesses
+                 *          the buffer next implicitly waits for it.
+                 *
+                 * @return  false if the fence could not be handed over.
+                 */
+                bool Handover(const int dmabuf VARIABLE_IS_NOT_USED)
+                {
+                    bool result = false;
 
-                        // Signal the other side we have a completed buffer, ready to show...
-                        RequestRender();
+#ifdef DMA_BUF_IOCTL_IMPORT_SYNC_FILE
+                    if (_fence >= 0) {
+                        struct dma_buf_import_sync_file import = { DMA_BUF_SYNC_WRITE, _fence };
+
+                        result = (::ioctl(dmabuf, DMA_BUF_IOCTL_IMPORT_SYNC_FILE, &import) == 0);
+
+                        if (result == false) {
+                            TRACE(Trace::Warning, (_T("Could not hand over the render fence, falling back to waiting for the GPU")));
+                            _nativeFence = false;
+                        }
                     }
-                    return (succeeded);
+#endif
+
+                    return (result);
                 }
-                void Rendered() override
+                void Wait()
                 {
-                    _parent.Rendered();
+                    if (_fence >= 0) {
+                        // A native fence is a sync_file, it polls readable once signalled.
+                        struct pollfd descriptor = { _fence, POLLIN, 0 };
+
+                        ::poll(&descriptor, 1, -1);
+                    } else if (_sync != nullptr) {
+                        _egl.eglClientWaitSync(_display, _sync, 0, EGL_FOREVER_KHR);
+                    }
                 }
-                void Published() override
+                void Discard()
                 {
-                    _parent.Published();
+                    if (_fence >= 0) {
+                        ::close(_fence);
+                        _fence = -1;
+                    }
+
+                    if (_sync != nullptr) {
+                        _egl.eglDestroySync(_display, _sync);
+                        _sync = nullptr;
+                    }
                 }
 
             private:
@@ -304,7 +429,10 @@ namespace Linux {
                 GLuint _textureId;
                 GLuint _frameBuffer;
                 EGLImage _eglImage;
-                EGLSync _eglSync;
+                std::atomic<bool> _nativeFence;
+                // Handed from Prepare() to Submit(), which never overlap.
+                int _fence;
+                EGLSync _sync;
                 Compositor::API::EGL _egl;
                 Compositor::API::GL _gl;
             };
@@ -328,6 +456,7 @@ namespace Linux {
                 , _touchpanel(nullptr)
                 , _surface(nullptr)
                 , _buffer(*this)
+                , _pending(false)
             {
                 TRACE(Trace::Information, (_T("Construct surface[%d] %s  %dx%d (hxb)"), _id, name.c_str(), height, width));
 
@@ -471,6 +600,10 @@ namespace Linux {
                 }
             }
 
+            void Requested()
+            {
+                _display.Requested(this);
+            }
             void Rendered()
             {
                 _display.Rendered(this);
@@ -480,9 +613,23 @@ namespace Linux {
                 _display.Published(this);
             }
 
-            uint32_t Process()
+            void Prepare()
+            {
+                _buffer.Prepare();
+            }
+            bool Submit()
+            {
+                return (_buffer.Submit());
+            }
+
+            // Only accessed under the rendering lock of the display.
+            bool IsPending() const
             {
-                return (_buffer.Render() == true) ? Core::ERROR_NONE : Core::ERROR_BAD_REQUEST;
+                return (_pending);
+            }
+            void Pending(const bool pending)
+            {
+                _pending = pending;
             }
 
         private:
@@ -497,6 +644,7 @@ namespace Linux {
             ITouchPanel* _touchpanel;
             struct gbm_surface* _surface;
             Core::SinkType<EGLBuffer> _buffer;
+            bool _pending;
 
             static uint32_t _surfaceIndex;
         };
@@ -568,22 +716,50 @@ namespace Linux {
 
         ISurface* Create(const std::string& name, const uint32_t width, const uint32_t height) override;
 
-        int Process(const uint32_t data VARIABLE_IS_NOT_USED) override
+        // The GL work of all surfaces is done on the calling thread, as it owns the
+        // context. Handing them over, which waits for the buffer and possibly the GPU,
+        // is shared with the submitters, so one slow surface does not hold up the rest.
+        int Process(const uint32_t data) override
         {
+            Surfaces surfaces;
+
+            _adminLock.Lock();
+
+            for (SurfaceImplementation* surface : _surfaces) {
+                surface->AddRef();
+                surfaces.push_back(surface);
+            }
+
+            _adminLock.Unlock();
+
+            for (SurfaceImplementation* surface : surfaces) {
+                surface->Prepare();
+            }
+
             std::unique_lock<std::mutex> lock(_rendering);
 
-            for (auto begin = _surfaces.begin(), it = begin, end = _surfaces.end(); it != end; it++) {
-                SurfaceImplementation* surface = *it;
+            _submitting += static_cast<uint32_t>(surfaces.size());
+            _queue.insert(_queue.end(), surfaces.begin(), surfaces.end());
 
-                if (surface->Process() == Core::ERROR_NONE) {
-                    _pendingSurfaces |= (1 << surface->Id());
+            if (surfaces.size() > 1) {
+                for (Submitter& submitter : _submitters) {
+                    submitter.Run();
                 }
             }
 
-            while (_pendingSurfaces != 0) {
+            while (_queue.empty() == false) {
+                SurfaceImplementation* surface = _queue.front();
+                _queue.pop_front();
+
+                lock.unlock();
+                Submit(surface);
+                lock.lock();
+            }
+
+            while ((_submitting != 0) || (((data & PROCESS_NONBLOCKING) == 0) && (_pendingSurfaces != 0))) {
                 _published.wait(lock);
             }
-            
+
             return Core::ERROR_NONE;
         }
 
@@ -622,17 +798,94 @@ namespace Linux {
             return _remoteDisplay;
         }
 
+        void Requested(SurfaceImplementation* surface)
+        {
+            std::lock_guard<std::mutex> lock(_rendering);
+
+            if (surface->IsPending() == false) {
+                surface->Pending(true);
+                _pendingSurfaces++;
+            }
+        }
+
         void Rendered(SurfaceImplementation* /*surface*/)
         {
         }
 
         void Published(SurfaceImplementation* surface)
         {
-            _pendingSurfaces &= ~(1 << surface->Id());
-            _published.notify_all();
+            std::lock_guard<std::mutex> lock(_rendering);
+
+            if (surface->IsPending() == true) {
+                surface->Pending(false);
+                _pendingSurfaces--;
+                _published.notify_all();
+            }
         }
 
     private:
+        class Submitter : public Core::Thread {
+        public:
+            Submitter() = delete;
+            Submitter(Submitter&&) = delete;
+            Submitter(const Submitter&) = delete;
+            Submitter& operator=(Submitter&&) = delete;
+            Submitter& operator=(const Submitter&) = delete;
+
+            explicit Submitter(Display& parent)
+                : Core::Thread()
+                , _parent(parent)
+            {
+            }
+            ~Submitter() override
+            {
+                Thread::Stop();
+                Thread::Wait(Thread::BLOCKED | Thread::STOPPED, Core::infinite);
+            }
+
+        private:
+            uint32_t Worker() override
+            {
+                return (_parent.Submit(*this));
+            }
+
+        private:
+            Display& _parent;
+        };
+
+        // Called by the submitters: takes one surface from the queue, or parks the
+        // submitter until Process() queues more.
+        uint32_t Submit(Submitter& submitter)
+        {
+            uint32_t delay = 0;
+            std::unique_lock<std::mutex> lock(_rendering);
+
+            if (_queue.empty() == true) {
+                // Blocked under the lock, so a Run() of Process() can not slip in between.
+                submitter.Block();
+                delay = Core::infinite;
+            } else {
+                SurfaceImplementation* surface = _queue.front();
+                _queue.pop_front();
+
+                lock.unlock();
+                Submit(surface);
+            }
+
+            return (delay);
+        }
+
+        void Submit(SurfaceImplementation* surface)
+        {
+            surface->Submit();
+            surface->Release();
+
+            std::lock_guard<std::mutex> lock(_rendering);
+
+            _submitting--;
+            _published.notify_all();
+        }
+
         void Initialize()
         {
             TRACE(Trace::Information, (_T("PID: %d: Compositor connector: %s"), getpid(), DisplayConnector().c_str()));
@@ -742,6 +995,9 @@ namespace Linux {
             }
 
             _adminLock.Unlock();
+
+            // Do not wait for a publication that will not come anymore.
+            Published(surface);
         }
 
         Thunder::Exchange::IComposition::IClient* CreateRemoteSurface(const std::string& name, const uint32_t width, const uint32_t height)
@@ -763,9 +1019,12 @@ namespace Linux {
         Exchange::IComposition::IDisplay* _remoteDisplay;
         int _gpuId;
         gbm_device* _gbmDevice;
-        uint32_t _pendingSurfaces;
         std::mutex _rendering;
         std::condition_variable _published;
+        std::list<SurfaceImplementation*> _queue;
+        uint32_t _submitting;
+        uint32_t _pendingSurfaces;
+        std::list<Submitter> _submitters;
     }; // class Display
 
     uint32_t Display::SurfaceImplementation::_surfaceIndex = 0;
@@ -783,10 +1042,17 @@ namespace Linux {
         , _remoteDisplay(nullptr)
         , _gpuId(-1)
         , _gbmDevice(nullptr)
-        , _pendingSurfaces(0)
         , _rendering()
         , _published()
+        , _queue()
+        , _submitting(0)
+        , _pendingSurfaces(0)
+        , _submitters()
     {
+        for (uint8_t index = 0; index < SubmitThreads; index++) {
+            _submitters.emplace_back(*this);
+        }
+
         Core::PrivilegedRequest::Container descriptors;
         Core::PrivilegedRequest request;
 
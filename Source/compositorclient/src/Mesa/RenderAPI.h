@@ -306,6 +306,7 @@ namespace Compositor {
                 , eglClientWaitSync(nullptr)
                 , eglExportDmaBufImageQueryMesa(nullptr)
                 , eglExportDmaBufImageMesa(nullptr)
+                , eglDupNativeFenceFDANDROID(nullptr)
             {
                 eglGetPlatformDisplayEXT = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
                 eglQueryDmaBufFormatsEXT = reinterpret_cast<PFNEGLQUERYDMABUFFORMATSEXTPROC>(eglGetProcAddress("eglQueryDmaBufFormatsEXT"));
@@ -326,6 +327,8 @@ namespace Compositor {
 
                 eglExportDmaBufImageQueryMesa = reinterpret_cast<PFNEGLEXPORTDMABUFIMAGEQUERYMESAPROC>(eglGetProcAddress("eglExportDMABUFImageQueryMESA"));
                 eglExportDmaBufImageMesa = reinterpret_cast<PFNEGLEXPORTDMABUFIMAGEMESAPROC>(eglGetProcAddress("eglExportDMABUFImageMESA"));
+
+                eglDupNativeFenceFDANDROID = reinterpret_cast<PFNEGLDUPNATIVEFENCEFDANDROIDPROC>(eglGetProcAddress("eglDupNativeFenceFDANDROID"));
             }
 
         public:
@@ -349,6 +352,8 @@ namespace Compositor {
 
             PFNEGLEXPORTDMABUFIMAGEQUERYMESAPROC eglExportDmaBufImageQueryMesa;
             PFNEGLEXPORTDMABUFIMAGEMESAPROC eglExportDmaBufImageMesa;
+
+            PFNEGLDUPNATIVEFENCEFDANDROIDPROC eglDupNativeFenceFDANDROID;
         }; // class EGL
 
     } // namespace API
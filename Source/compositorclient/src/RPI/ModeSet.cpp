@@ -20,10 +20,12 @@
 #include "Module.h"
 #include "ModeSet.h"
 
+#include <algorithm>
 #include <vector>
 #include <list>
 #include <string>
 #include <cassert>
+#include <cstring>
 #include <limits>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -145,9 +147,21 @@ static bool FindProperDisplay(int fd, uint32_t& crtc, uint32_t& encoder, uint32_
     // Only connected connectors are considered
     uint32_t connectorMask = GetConnectors(fd, DRM_MODE_CONNECTOR_HDMIA);
 
+    if (connectorMask == 0)
+    {
+        // No HDMI, a virtual output (e.g. vkms) will do as well
+        connectorMask = GetConnectors(fd, DRM_MODE_CONNECTOR_VIRTUAL);
+    }
+
     // All CRTCs are considered for the given mode (valid / not valid)
     uint32_t crtcs = GetCRTCS(fd, true);
 
+    if (crtcs == 0)
+    {
+        // Nothing set up yet, e.g. no console on it, we set the mode ourselves anyway
+        crtcs = GetCRTCS(fd, false);
+    }
+
     drmModeResPtr resources = drmModeGetResources(fd);
 
     if(nullptr != resources)
@@ -309,10 +323,20 @@ ModeSet::ModeSet()
     : _crtc(0)
     , _encoder(0)
     , _connector(0)
+    , _fb(0)
     , _mode(0)
     , _device(nullptr)
     , _buffer(nullptr)
     , _fd(-1)
+    , _lock()
+    , _callback(nullptr)
+    , _locked()
+    , _flipping()
+    , _scanout()
+    , _pending(false)
+    , _atomic(false)
+    , _primary()
+    , _planes()
 {
     if (drmAvailable() > 0) {
 
@@ -349,6 +373,11 @@ ModeSet::ModeSet()
                     }
                     if (success == true) {
                         TRACE_L1(_T("Opened Card: %s"), index->c_str());
+
+                        // Implies universal planes, otherwise only the primary plane is used, legacy style
+                        _atomic = ((drmSetClientCap(_fd, DRM_CLIENT_CAP_ATOMIC, 1) == 0) && (Planes() == true));
+
+                        TRACE_L1(_T("Atomic modesetting: %s, %d additional planes"), (_atomic == true ? _T("yes") : _T("no")), static_cast<int>(_planes.size()));
                     }
                     else {
                         Destruct();
@@ -368,6 +397,16 @@ ModeSet::~ModeSet()
 
 void ModeSet::Destruct()
 {
+    // The surfaces, and with them the buffers, are gone by now
+    _locked = Frame();
+    _flipping = Frame();
+    _scanout = Frame();
+    _pending = false;
+
+    _atomic = false;
+    _primary = Plane();
+    _planes.clear();
+
     // Destroy the initial buffer if one exists
     if (nullptr != _buffer)
     {
@@ -434,16 +473,45 @@ void ModeSet::DestroyRenderTarget(struct gbm_surface* surface)
 {
     if (nullptr != surface)
     {
+        std::lock_guard<std::mutex> guard(_lock);
+
+        // Its buffers go with it, nothing to give back anymore
+        Frame* frames[] = { &_locked, &_flipping, &_scanout };
+
+        for (Frame* frame : frames) {
+            if (frame->surface == surface) {
+                *frame = Frame();
+            }
+        }
+
         gbm_surface_destroy(surface);
     }
 }
 
-static void PageFlip (int, unsigned int, unsigned int, unsigned int, void* data) {
+// Lives as user data with the bo, so the framebuffer is removed when gbm destroys the bo
+struct FrameBuffer {
+    int fd;
+    uint32_t id;
+};
+
+static void DestroyFrameBuffer (struct gbm_bo*, void* data) {
 
     assert (data != nullptr);
 
-    reinterpret_cast<std::mutex*> (data)->unlock();
-};
+    FrameBuffer* buffer = static_cast<FrameBuffer*>(data);
+
+    drmModeRmFB(buffer->fd, buffer->id);
+
+    delete buffer;
+}
+
+void ModeSet::Release(Frame& frame) {
+    if (frame.bo != nullptr) {
+        gbm_surface_release_buffer (frame.surface, frame.bo);
+    }
+
+    frame = Frame();
+}
 
 uint32_t ModeSet::AddSurfaceToOutput(struct gbm_surface* surface) {
     uint32_t id = ~0;
@@ -453,70 +521,373 @@ uint32_t ModeSet::AddSurfaceToOutput(struct gbm_surface* surface) {
     gbm_bo* bo = gbm_surface_lock_front_buffer (surface);
 
     if (bo != nullptr) {
-        uint32_t _format = gbm_bo_get_format (bo);
-        uint32_t _bpp = gbm_bo_get_bpp (bo);
-        uint32_t _stride = gbm_bo_get_stride (bo);
-        uint32_t _handle = gbm_bo_get_handle (bo).u32;
+        FrameBuffer* buffer = static_cast<FrameBuffer*>(gbm_bo_get_user_data (bo));
 
-        if (drmModeAddFB (_fd, gbm_bo_get_width (bo), gbm_bo_get_height (bo), _format != DRM_FORMAT_ARGB8888 ? _bpp - BPP () + ColorDepth () : _bpp, _bpp, _stride, _handle, &id) != 0) {
-            id = ~0;
+        if (buffer != nullptr) {
+            id = buffer->id;
         }
+        else {
+            uint32_t _format = gbm_bo_get_format (bo);
+            uint32_t _bpp = gbm_bo_get_bpp (bo);
+            uint32_t _stride = gbm_bo_get_stride (bo);
+            uint32_t _handle = gbm_bo_get_handle (bo).u32;
+
+            // First time this bo comes by, the surface recycles the same few
+            if (drmModeAddFB (_fd, gbm_bo_get_width (bo), gbm_bo_get_height (bo), _format != DRM_FORMAT_ARGB8888 ? _bpp - BPP () + ColorDepth () : _bpp, _bpp, _stride, _handle, &id) != 0) {
+                id = ~0;
+            }
+            else {
+                gbm_bo_set_user_data (bo, new FrameBuffer { _fd, id }, DestroyFrameBuffer);
+            }
+        }
+
+        if (id == static_cast<uint32_t>(~0)) {
+            gbm_surface_release_buffer (surface, bo);
+        }
+        else {
+            std::lock_guard<std::mutex> guard(_lock);
 
-        // These two should be kept in sync for multiple buffers
-        gbm_surface_release_buffer (surface, bo);
+            // A frame that never made it to the screen, superseded by this one
+            Release(_locked);
+
+            _locked.surface = surface;
+            _locked.bo = bo;
+            _locked.id = id;
+        }
     }
 
     return (id);
 }
 
-void ModeSet::DropSurfaceFromOutput(const uint32_t id) {
-    drmModeRmFB(_fd, id);
+uint32_t ModeSet::AddBufferToOutput(struct gbm_bo* bo) {
+    uint32_t id = ~0;
+
+    assert (_fd > 0);
+    assert (bo != nullptr);
+
+    FrameBuffer* buffer = static_cast<FrameBuffer*>(gbm_bo_get_user_data (bo));
+
+    if (buffer != nullptr) {
+        id = buffer->id;
+    }
+    else {
+        uint32_t handles[4] = { 0, 0, 0, 0 };
+        uint32_t pitches[4] = { 0, 0, 0, 0 };
+        uint32_t offsets[4] = { 0, 0, 0, 0 };
+        uint64_t modifiers[4] = { 0, 0, 0, 0 };
+        const uint64_t modifier = gbm_bo_get_modifier (bo);
+        const int planes = gbm_bo_get_plane_count (bo);
+
+        // NV12 and P010 come with a separate chroma plane
+        for (int index = 0; (index < planes) && (index < 4); index++) {
+            handles[index] = gbm_bo_get_handle_for_plane (bo, index).u32;
+            pitches[index] = gbm_bo_get_stride_for_plane (bo, index);
+            offsets[index] = gbm_bo_get_offset (bo, index);
+            modifiers[index] = modifier;
+        }
+
+        const bool explicitModifier = (modifier != DRM_FORMAT_MOD_INVALID);
+
+        if (drmModeAddFB2WithModifiers (_fd, gbm_bo_get_width (bo), gbm_bo_get_height (bo), gbm_bo_get_format (bo), handles, pitches, offsets, (explicitModifier == true ? modifiers : nullptr), &id, (explicitModifier == true ? DRM_MODE_FB_MODIFIERS : 0)) != 0) {
+            id = ~0;
+        }
+        else {
+            gbm_bo_set_user_data (bo, new FrameBuffer { _fd, id }, DestroyFrameBuffer);
+        }
+    }
+
+    return (id);
 }
 
-void ModeSet::ScanOutRenderTarget(struct gbm_surface*, const uint32_t id) {
+void ModeSet::DropSurfaceFromOutput(const uint32_t) {
+    // The framebuffers stay with their bo for the next time around, they are removed
+    // when gbm destroys the bo, see DestroyFrameBuffer
+}
+
+bool ModeSet::Planes() {
+    // In the order of the property enum
+    static const char* const names[] = { "FB_ID", "CRTC_ID", "SRC_X", "SRC_Y", "SRC_W", "SRC_H", "CRTC_X", "CRTC_Y", "CRTC_W", "CRTC_H" };
+
+    static_assert((sizeof(names) / sizeof(names[0])) == PROPERTIES, "A name for every plane property");
+
+    uint32_t crtcMask = 0;
+
+    drmModeResPtr resources = drmModeGetResources(_fd);
+
+    if (nullptr != resources)
+    {
+        for (int i = 0; i < resources->count_crtcs; i++)
+        {
+            if (resources->crtcs[i] == _crtc)
+            {
+                crtcMask = (1 << i);
+            }
+        }
+
+        drmModeFreeResources(resources);
+    }
+
+    drmModePlaneResPtr planes = drmModeGetPlaneResources(_fd);
+
+    if (nullptr != planes)
+    {
+        for (uint32_t i = 0; i < planes->count_planes; i++)
+        {
+            drmModePlanePtr info = drmModeGetPlane(_fd, planes->planes[i]);
 
-    std::mutex signal; 
-    signal.lock();
+            if (nullptr != info)
+            {
+                drmModeObjectPropertiesPtr properties = ((info->possible_crtcs & crtcMask) != 0 ? drmModeObjectGetProperties(_fd, info->plane_id, DRM_MODE_OBJECT_PLANE) : nullptr);
 
-    int err = drmModePageFlip (_fd, _crtc, id, DRM_MODE_PAGE_FLIP_EVENT, &signal);
+                if (nullptr != properties)
+                {
+                    Plane plane;
+                    uint8_t found = 0;
 
-    // Many causes, but the most obvious is a busy resource or a missing drmModeSetCrtc
-    // Probably a missing drmModeSetCrtc or an invalid _crtc
-    // See ModeSet::Create, not recovering here
-    assert (err != EINVAL);
+                    plane.id = info->plane_id;
+                    plane.type = DRM_PLANE_TYPE_OVERLAY;
+                    plane.formats.assign(info->formats, info->formats + info->count_formats);
+                    plane.active = false;
 
-    if (err == 0) {
-        // No error
-        // Strictly speaking c++ linkage and not C linkage
-        // Asynchronous, but never called more than once, waiting in scope
-        // Use the magic constant here because the struct is versioned!
-        drmEventContext context = { .version = 2, .vblank_handler = nullptr, .page_flip_handler = PageFlip, .page_flip_handler2 = nullptr, .sequence_handler = nullptr };
-        struct timespec timeout = { .tv_sec = 1, .tv_nsec = 0 };
-        fd_set fds;
+                    for (uint32_t j = 0; j < properties->count_props; j++)
+                    {
+                        drmModePropertyPtr property = drmModeGetProperty(_fd, properties->props[j]);
 
-        while (signal.try_lock() == false) {
-            FD_ZERO(&fds);
-            FD_SET(_fd, &fds);
+                        if (nullptr != property)
+                        {
+                            if (strcmp(property->name, "type") == 0)
+                            {
+                                plane.type = properties->prop_values[j];
+                            }
+                            else
+                            {
+                                for (uint8_t k = 0; k < PROPERTIES; k++)
+                                {
+                                    if (strcmp(property->name, names[k]) == 0)
+                                    {
+                                        plane.properties[k] = property->prop_id;
+                                        found++;
+                                    }
+                                }
+                            }
+
+                            drmModeFreeProperty(property);
+                        }
+                    }
+
+                    drmModeFreeObjectProperties(properties);
 
-            // Race free
-            if ((err = pselect(_fd + 1, &fds, nullptr, nullptr, &timeout, nullptr)) < 0) {
-                // Error; break the loop
-                break;
+                    if (found == PROPERTIES)
+                    {
+                        if (plane.type != DRM_PLANE_TYPE_PRIMARY)
+                        {
+                            _planes.push_back(plane);
+                        }
+                        // The primary of another CRTC can not be used for ours at the same time
+                        else if ((_primary.id == 0) || (info->crtc_id == _crtc))
+                        {
+                            _primary = plane;
+                        }
+                    }
+                }
+
+                drmModeFreePlane(info);
             }
-            else if (err == 0) {
-                // Timeout; retry
-                // TODO: add an additional condition to break the loop to limit the 
-                // number of retries, but then deal with the asynchronous nature of 
-                // the callback
+        }
+
+        drmModeFreePlaneResources(planes);
+    }
+
+    return (_primary.id != 0);
+}
+
+void ModeSet::Place(struct _drmModeAtomicReq* request, const Plane& plane, const uint32_t id, const uint32_t width, const uint32_t height, const int32_t x, const int32_t y, const uint32_t displayWidth, const uint32_t displayHeight) const {
+    drmModeAtomicAddProperty(request, plane.id, plane.properties[FB_ID], id);
+    drmModeAtomicAddProperty(request, plane.id, plane.properties[CRTC_ID], (id != 0 ? _crtc : 0));
+
+    if (id != 0) {
+        // The source is in 16.16 fixed point
+        drmModeAtomicAddProperty(request, plane.id, plane.properties[SRC_X], 0);
+        drmModeAtomicAddProperty(request, plane.id, plane.properties[SRC_Y], 0);
+        drmModeAtomicAddProperty(request, plane.id, plane.properties[SRC_W], static_cast<uint64_t>(width) << 16);
+        drmModeAtomicAddProperty(request, plane.id, plane.properties[SRC_H], static_cast<uint64_t>(height) << 16);
+        drmModeAtomicAddProperty(request, plane.id, plane.properties[CRTC_X], static_cast<uint64_t>(static_cast<int64_t>(x)));
+        drmModeAtomicAddProperty(request, plane.id, plane.properties[CRTC_Y], static_cast<uint64_t>(static_cast<int64_t>(y)));
+        drmModeAtomicAddProperty(request, plane.id, plane.properties[CRTC_W], displayWidth);
+        drmModeAtomicAddProperty(request, plane.id, plane.properties[CRTC_H], displayHeight);
+    }
+}
+
+uint8_t ModeSet::Assign(Layer layers[], const uint8_t count) {
+    uint8_t result = 0;
+
+    for (uint8_t index = 0; index < count; index++) {
+        layers[index].plane = 0;
+    }
+
+    std::lock_guard<std::mutex> guard(_lock);
+
+    drmModeAtomicReqPtr request = ((_atomic == true) && (count > 0) ? drmModeAtomicAlloc() : nullptr);
+
+    if (request != nullptr) {
+        // The render target as it is on the screen now, the layers have to fit on top of it
+        Place(request, _primary, (_scanout.id != 0 ? _scanout.id : _fb), Width(), Height(), 0, 0, Width(), Height());
+
+        int plane = static_cast<int>(_planes.size()) - 1;
+        int layer = count - 1;
+        bool placing = true;
+
+        // Top down, a layer that does not make it goes into the render target, and with it
+        // everything below, so they stay below it
+        while ((layer >= 0) && (placing == true)) {
+            Layer& entry = layers[layer];
+
+            placing = false;
+
+            while ((plane >= 0) && (placing == false)) {
+                const Plane& candidate = _planes[plane];
+
+                if (std::find(candidate.formats.begin(), candidate.formats.end(), entry.format) != candidate.formats.end()) {
+                    const int cursor = drmModeAtomicGetCursor(request);
+
+                    Place(request, candidate, entry.id, entry.width, entry.height, entry.x, entry.y, entry.displayWidth, entry.displayHeight);
+
+                    if (drmModeAtomicCommit(_fd, request, DRM_MODE_ATOMIC_TEST_ONLY, nullptr) == 0) {
+                        entry.plane = candidate.id;
+                        placing = true;
+                        result++;
+                    }
+                    else {
+                        drmModeAtomicSetCursor(request, cursor);
+                    }
+                }
+
+                plane--;
             }
-            else if (FD_ISSET (_fd, &fds) != 0) {
-                // Node is readable
-                if (drmHandleEvent (_fd, &context) != 0) {
-                    // Error; break the loop
-                    break;
+
+            layer--;
+        }
+
+        drmModeAtomicFree(request);
+    }
+
+    return (result);
+}
+
+bool ModeSet::ScanOutRenderTarget(struct gbm_surface* surface, const uint32_t id, const Layer layers[], const uint8_t count) {
+    std::lock_guard<std::mutex> guard(_lock);
+
+    bool result = false;
+
+    // One flip at a time, the next one after Dispatch() handled the completion
+    if (_pending == false) {
+        int err;
+
+        if (_atomic == false) {
+            err = drmModePageFlip (_fd, _crtc, id, DRM_MODE_PAGE_FLIP_EVENT, this);
+        }
+        else {
+            drmModeAtomicReqPtr request = drmModeAtomicAlloc();
+            std::vector<bool> active(_planes.size(), false);
+
+            err = -ENOMEM;
+
+            if (request != nullptr) {
+                Place(request, _primary, id, Width(), Height(), 0, 0, Width(), Height());
+
+                for (uint32_t index = 0; index < _planes.size(); index++) {
+                    const Layer* layer = nullptr;
+
+                    for (uint8_t entry = 0; (entry < count) && (layer == nullptr); entry++) {
+                        if ((layers[entry].plane != 0) && (layers[entry].plane == _planes[index].id)) {
+                            layer = &layers[entry];
+                        }
+                    }
+
+                    if (layer != nullptr) {
+                        Place(request, _planes[index], layer->id, layer->width, layer->height, layer->x, layer->y, layer->displayWidth, layer->displayHeight);
+                        active[index] = true;
+                    }
+                    else if (_planes[index].active == true) {
+                        // Shown last time, not anymore
+                        Place(request, _planes[index], 0, 0, 0, 0, 0, 0, 0);
+                    }
                 }
-                // Flip probably occured already otherwise it loops again
+
+                err = drmModeAtomicCommit (_fd, request, DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, this);
+
+                drmModeAtomicFree(request);
+
+                if (err == 0) {
+                    for (uint32_t index = 0; index < _planes.size(); index++) {
+                        _planes[index].active = active[index];
+                    }
+                }
+            }
+        }
+
+        // Many causes, but the most obvious is a busy resource or a missing drmModeSetCrtc
+        // Probably a missing drmModeSetCrtc or an invalid _crtc
+        // See ModeSet::Create, not recovering here
+        assert (err != -EINVAL);
+
+        if (err == 0) {
+            _pending = true;
+
+            if ((_locked.surface == surface) && (_locked.id == id)) {
+                _flipping = _locked;
+                _locked = Frame();
             }
+
+            result = true;
         }
     }
+
+    return (result);
+}
+
+/* static */ void ModeSet::PageFlipped (int, unsigned int frame, unsigned int sec, unsigned int usec, void* data) {
+
+    assert (data != nullptr);
+
+    ModeSet& parent = *reinterpret_cast<ModeSet*> (data);
+    ICallback* callback;
+
+    parent._lock.lock();
+
+    // The previous one is off the screen now, its surface can render into it again
+    parent.Release(parent._scanout);
+
+    parent._scanout = parent._flipping;
+    parent._flipping = Frame();
+    parent._pending = false;
+
+    callback = parent._callback;
+
+    parent._lock.unlock();
+
+    if (callback != nullptr) {
+        callback->PageFlip(frame, sec, usec);
+    }
+}
+
+void ModeSet::Dispatch() {
+    // Strictly speaking c++ linkage and not C linkage
+    // Use the magic constant here because the struct is versioned!
+    drmEventContext context = { .version = 2, .vblank_handler = nullptr, .page_flip_handler = PageFlipped, .page_flip_handler2 = nullptr, .sequence_handler = nullptr };
+
+    // Only reads what is there if Descriptor() is readable, otherwise it blocks till the next event
+    drmHandleEvent (_fd, &context);
+}
+
+bool ModeSet::IsFlipPending() const {
+    std::lock_guard<std::mutex> guard(_lock);
+
+    return (_pending);
+}
+
+void ModeSet::Callback(ICallback* callback) {
+    std::lock_guard<std::mutex> guard(_lock);
+
+    _callback = callback;
 }
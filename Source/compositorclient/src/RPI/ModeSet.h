@@ -22,7 +22,11 @@
 #include <cstdint>
 #include <limits>
 #include <ctime>
+#include <mutex>
+#include <vector>
 #include <drm/drm_fourcc.h>
+
+struct _drmModeAtomicReq;
  
 class ModeSet
 {
@@ -32,6 +36,20 @@ class ModeSet
             virtual void PageFlip(unsigned int frame, unsigned int sec, unsigned int usec) = 0;
             virtual void VBlank(unsigned int frame, unsigned int sec, unsigned int usec) = 0;
         };
+
+        // A buffer to show on top of the render target, on a plane of its own if the hardware
+        // allows, see Assign().
+        struct Layer {
+            uint32_t id; // See AddBufferToOutput()
+            uint32_t format;
+            uint32_t width;
+            uint32_t height;
+            int32_t x;
+            int32_t y;
+            uint32_t displayWidth;
+            uint32_t displayHeight;
+            uint32_t plane; // Set by Assign(), 0 if it has to be composed with GL
+        };
  
     public:
         ModeSet(const ModeSet&) = delete;
@@ -67,15 +85,73 @@ class ModeSet
         int Descriptor () const {
             return (_fd);
         }
+        // Atomic modesetting, without it there is only the primary plane.
+        bool IsAtomic() const {
+            return (_atomic);
+        }
         uint32_t Width() const;
         uint32_t Height() const;
         struct gbm_surface* CreateRenderTarget(const uint32_t width, const uint32_t height);
+        // Locks the front buffer of the surface until it is replaced on the screen. The framebuffer
+        // id is kept with the buffer object, so a surface cycling through its buffers only adds
+        // each of them once.
         uint32_t AddSurfaceToOutput(struct gbm_surface* surface);
+        // Same for a buffer that is not rendered through a surface, e.g. a video frame, any
+        // format and modifier the planes support. The id is kept as user data of the bo.
+        uint32_t AddBufferToOutput(struct gbm_bo* bo);
         void DropSurfaceFromOutput(const uint32_t id);
         void DestroyRenderTarget(struct gbm_surface* surface);
-        void ScanOutRenderTarget (struct gbm_surface* surface, const uint32_t id);
+        // Does not wait for the flip, it completes once Dispatch() picked up the event, which is
+        // reported through the ICallback. Returns false if the previous flip is still pending.
+        bool ScanOutRenderTarget (struct gbm_surface* surface, const uint32_t id)
+        {
+            return (ScanOutRenderTarget(surface, id, nullptr, 0));
+        }
+        // Layers, bottom to top, go on top of the render target. Finds a plane for as many of
+        // them as the hardware accepts, starting at the top, with test only commits. The ones
+        // left, and everything below them, have to be composed into the render target.
+        uint8_t Assign(Layer layers[], const uint8_t count);
+        // The layers Assign() placed on a plane are shown with the render target. Keep their
+        // buffers until the next flip completed.
+        bool ScanOutRenderTarget (struct gbm_surface* surface, const uint32_t id, const Layer layers[], const uint8_t count);
+        // Call if Descriptor() is readable, from the render thread or an event loop of choice.
+        void Dispatch();
+        bool IsFlipPending() const;
+        void Callback(ICallback* callback);
 
     private:
+        struct Frame {
+            struct gbm_surface* surface;
+            struct gbm_bo* bo;
+            uint32_t id;
+        };
+
+        enum property : uint8_t {
+            FB_ID,
+            CRTC_ID,
+            SRC_X,
+            SRC_Y,
+            SRC_W,
+            SRC_H,
+            CRTC_X,
+            CRTC_Y,
+            CRTC_W,
+            CRTC_H,
+            PROPERTIES
+        };
+
+        struct Plane {
+            uint32_t id;
+            uint64_t type;
+            std::vector<uint32_t> formats;
+            uint32_t properties[PROPERTIES];
+            bool active;
+        };
+
+        static void PageFlipped(int, unsigned int frame, unsigned int sec, unsigned int usec, void* data);
+        void Release(Frame& frame);
+        bool Planes();
+        void Place(struct _drmModeAtomicReq* request, const Plane& plane, const uint32_t id, const uint32_t width, const uint32_t height, const int32_t x, const int32_t y, const uint32_t displayWidth, const uint32_t displayHeight) const;
         void Destruct();
 
     private:
@@ -89,4 +165,17 @@ class ModeSet
         struct gbm_device* _device;
         struct gbm_bo* _buffer;
         int _fd;
+
+        mutable std::mutex _lock;
+        ICallback* _callback;
+        // Handed out by AddSurfaceToOutput, flipped to and on the screen.
+        Frame _locked;
+        Frame _flipping;
+        Frame _scanout;
+        bool _pending;
+
+        // The primary plane of our CRTC and the overlay and cursor planes it can use, lowest first.
+        bool _atomic;
+        Plane _primary;
+        std::vector<Plane> _planes;
 };
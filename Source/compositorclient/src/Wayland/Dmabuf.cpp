@@ -0,0 +1,242 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+
+#include <wayland-egl.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <compositor/Client.h>
+#include "Implementation.h"
+
+#include <wayland-client.h>
+
+#include <sys/stat.h>
+
+#include "linux-dmabuf-unstable-v1-client-protocol.h"
+
+// The dma-buf path, shared by the Weston and Westeros flavours: the buffers are imported on the
+// thread presenting them, the releases arrive on the event thread.
+
+namespace Thunder {
+
+namespace Wayland {
+
+    namespace {
+
+        // DRM_FORMAT_MOD_INVALID, the layout is implied by the buffer.
+        constexpr uint64_t ImplicitModifier = 0x00FFFFFFFFFFFFFFULL;
+        constexpr uint8_t MaxPlanes = 4;
+
+        const struct zwp_linux_dmabuf_v1_listener dmabufListener = {
+            // format, only the compositors without modifiers count, the others follow up with them.
+            [](void* data, struct zwp_linux_dmabuf_v1* dmabuf, uint32_t format) {
+                if (zwp_linux_dmabuf_v1_get_version(dmabuf) < ZWP_LINUX_DMABUF_V1_MODIFIER_SINCE_VERSION) {
+                    static_cast<Display*>(data)->Format(format, ImplicitModifier);
+                }
+            },
+            // modifier
+            [](void* data, struct zwp_linux_dmabuf_v1*, uint32_t format, uint32_t high, uint32_t low) {
+                static_cast<Display*>(data)->Format(format, (static_cast<uint64_t>(high) << 32) | low);
+            }
+        };
+    }
+
+    void Display::Dmabuf(struct wl_registry* registry, const uint32_t name, const uint32_t version)
+    {
+        // Without create_immed every import would be a roundtrip, from version 4 on the modifiers
+        // come with the feedback objects only, so take it at 3 at most.
+        if (version >= ZWP_LINUX_BUFFER_PARAMS_V1_CREATE_IMMED_SINCE_VERSION) {
+            _dmabuf = static_cast<struct zwp_linux_dmabuf_v1*>(wl_registry_bind(registry, name, &zwp_linux_dmabuf_v1_interface, std::min(version, static_cast<uint32_t>(3))));
+            zwp_linux_dmabuf_v1_add_listener(_dmabuf, &dmabufListener, this);
+        }
+    }
+
+    uint32_t Display::BufferPool::Import(struct zwp_linux_dmabuf_v1* dmabuf, const uint32_t width, const uint32_t height, const uint32_t format, const uint64_t modifier, const uint8_t count, const Compositor::IDisplay::Plane planes[])
+    {
+        static const struct wl_buffer_listener bufferListener = {
+            Released
+        };
+
+        uint32_t result = ~0;
+        struct stat properties;
+
+        if (::fstat(planes[0].fd, &properties) == 0) {
+            std::lock_guard<std::mutex> lock(_lock);
+
+            Entries::iterator index(_entries.begin());
+
+            while ((index != _entries.end()) && ((index->forgotten == true) || (index->inode != properties.st_ino) || (index->width != width) || (index->height != height) || (index->format != format) || (index->modifier != modifier))) {
+                index++;
+            }
+
+            if (index != _entries.end()) {
+                result = index->id;
+            } else {
+                struct zwp_linux_buffer_params_v1* params = zwp_linux_dmabuf_v1_create_params(dmabuf);
+
+                for (uint8_t plane = 0; plane < count; plane++) {
+                    zwp_linux_buffer_params_v1_add(params, planes[plane].fd, plane, planes[plane].offset, planes[plane].stride, static_cast<uint32_t>(modifier >> 32), static_cast<uint32_t>(modifier & 0xFFFFFFFF));
+                }
+
+                // No roundtrip, a buffer the compositor can not import ends the connection. That is
+                // why only the advertised format/modifier pairs get here.
+                struct wl_buffer* buffer = zwp_linux_buffer_params_v1_create_immed(params, width, height, format, 0);
+
+                zwp_linux_buffer_params_v1_destroy(params);
+
+                if (buffer != nullptr) {
+                    _entries.push_back({ _nextId++, properties.st_ino, width, height, format, modifier, buffer, false, false });
+                    wl_buffer_add_listener(buffer, &bufferListener, this);
+
+                    result = _entries.back().id;
+                }
+            }
+        }
+
+        return (result);
+    }
+
+    struct wl_buffer* Display::BufferPool::Acquire(const uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        struct wl_buffer* result = nullptr;
+        Entries::iterator index(_entries.begin());
+
+        while ((index != _entries.end()) && (index->id != id)) {
+            index++;
+        }
+
+        if ((index != _entries.end()) && (index->busy == false) && (index->forgotten == false)) {
+            index->busy = true;
+            result = index->buffer;
+        }
+
+        return (result);
+    }
+
+    void Display::BufferPool::Forget(const uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        Entries::iterator index(_entries.begin());
+
+        while ((index != _entries.end()) && (index->id != id)) {
+            index++;
+        }
+
+        if (index != _entries.end()) {
+            if (index->busy == true) {
+                // Still on screen, goes with the release.
+                index->forgotten = true;
+            } else {
+                wl_buffer_destroy(index->buffer);
+                _entries.erase(index);
+            }
+        }
+    }
+
+    void Display::BufferPool::Clear()
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        for (Entry& entry : _entries) {
+            wl_buffer_destroy(entry.buffer);
+        }
+
+        _entries.clear();
+    }
+
+    /* static */ void Display::BufferPool::Released(void* data, struct wl_buffer* buffer)
+    {
+        BufferPool& pool = *static_cast<BufferPool*>(data);
+        Compositor::IDisplay::IBufferCallback* callback = nullptr;
+        uint32_t id = ~0;
+
+        pool._lock.lock();
+
+        Entries::iterator index(pool._entries.begin());
+
+        while ((index != pool._entries.end()) && (index->buffer != buffer)) {
+            index++;
+        }
+
+        if (index != pool._entries.end()) {
+            if (index->forgotten == true) {
+                wl_buffer_destroy(buffer);
+                pool._entries.erase(index);
+            } else {
+                index->busy = false;
+                id = index->id;
+                callback = pool._callback;
+
+                if (callback != nullptr) {
+                    pool._calling++;
+                }
+            }
+        }
+
+        pool._lock.unlock();
+
+        // Without the lock, the callback may present the next buffer right away.
+        if (callback != nullptr) {
+            callback->Released(id);
+
+            std::lock_guard<std::mutex> lock(pool._lock);
+
+            if (--pool._calling == 0) {
+                pool._idle.notify_all();
+            }
+        }
+    }
+
+    uint32_t Display::SurfaceImplementation::Import(const uint32_t width, const uint32_t height, const uint32_t format, const uint64_t modifier, const uint8_t count, const Compositor::IDisplay::Plane planes[])
+    {
+        uint32_t result = ~0;
+
+        if ((_display != nullptr) && (_surface != nullptr) && (_display->_dmabuf != nullptr) && (count > 0) && (count <= MaxPlanes) && (_display->IsSupported(format, modifier) == true)) {
+            result = _buffers.Import(_display->_dmabuf, width, height, format, modifier, count, planes);
+        }
+
+        return (result);
+    }
+
+    bool Display::SurfaceImplementation::Present(const uint32_t id)
+    {
+        struct wl_buffer* buffer = (_display != nullptr ? _buffers.Acquire(id) : nullptr);
+
+        if (buffer != nullptr) {
+            if (_queue != nullptr) {
+                wl_display_dispatch_queue_pending(_display->_display, _queue);
+            }
+
+            // The compositor releases the buffer presented before once it has this one.
+            wl_surface_attach(_surface, buffer, 0, 0);
+            wl_surface_damage(_surface, 0, 0, _width, _height);
+            wl_surface_commit(_surface);
+            wl_display_flush(_display->_display);
+        }
+
+        return (buffer != nullptr);
+    }
+
+} // Wayland
+} // Thunder
@@ -19,10 +19,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <list>
 #include <map>
-#include <semaphore.h>
+#include <mutex>
+#include <pthread.h>
 #include <signal.h>
 #include <string>
 #include <sys/types.h>
@@ -35,6 +38,7 @@
 // with the idea behind the abstraction from C -> C++
 //
 struct wl_display;
+struct wl_event_queue;
 struct wl_registry;
 struct wl_compositor;
 struct wl_display;
@@ -56,6 +60,9 @@ struct wl_shell_surface;
 struct xdg_surface;
 struct xdg_toplevel;
 
+struct wl_buffer;
+struct zwp_linux_dmabuf_v1;
+
 namespace Thunder {
 namespace Wayland {
 
@@ -72,39 +79,82 @@ namespace Wayland {
         Display(const Display&) = delete;
         Display& operator=(const Display&) = delete;
 
-        class CriticalSection {
+        // The wl_buffers imported from dma-bufs for one surface. A buffer stays imported until it is
+        // forgotten or the surface goes, so a producer cycling through a few bos imports each once.
+        class BufferPool {
         private:
-            CriticalSection(const CriticalSection&);
-            CriticalSection& operator=(const CriticalSection&);
+            struct Entry {
+                uint32_t id;
+                // Identifies the dma-buf, whatever descriptor it is handed over with.
+                ino_t inode;
+                uint32_t width;
+                uint32_t height;
+                uint32_t format;
+                uint64_t modifier;
+                struct wl_buffer* buffer;
+                bool busy;
+                bool forgotten;
+            };
+
+            typedef std::list<Entry> Entries;
 
         public:
-            CriticalSection()
-            {
-
-                pthread_mutexattr_t structAttributes;
+            BufferPool(const BufferPool&) = delete;
+            BufferPool& operator=(const BufferPool&) = delete;
 
-                // Create a recursive mutex for this process (no named version, use semaphore)
-                if ((pthread_mutexattr_init(&structAttributes) != 0) || (pthread_mutexattr_settype(&structAttributes, PTHREAD_MUTEX_RECURSIVE) != 0) || (pthread_mutex_init(&_lock, &structAttributes) != 0)) {
-                    // That will be the day, if this fails...
-                    assert(false);
-                }
+            BufferPool()
+                : _lock()
+                , _entries()
+                , _nextId(1)
+                , _callback(nullptr)
+                , _calling(0)
+                , _idle()
+            {
             }
-            ~CriticalSection()
+            ~BufferPool()
             {
+                std::unique_lock<std::mutex> lock(_lock);
+
+                _callback = nullptr;
+                _idle.wait(lock, [this]() { return (_calling == 0); });
+
+                lock.unlock();
+
+                Clear();
             }
 
         public:
-            void Lock()
-            {
-                pthread_mutex_lock(&_lock);
-            }
-            void Unlock()
-            {
-                pthread_mutex_unlock(&_lock);
+            uint32_t Import(struct zwp_linux_dmabuf_v1* dmabuf, const uint32_t width, const uint32_t height, const uint32_t format, const uint64_t modifier, const uint8_t count, const Compositor::IDisplay::Plane planes[]);
+            // Marks the buffer busy until the compositor releases it.
+            struct wl_buffer* Acquire(const uint32_t id);
+            void Forget(const uint32_t id);
+            // Once cleared, returns only after a release that is being reported
+            // has returned, so the callback can go right after. Not to be cleared
+            // from within the callback itself.
+            void Callback(Compositor::IDisplay::IBufferCallback* callback)
+            {
+                std::unique_lock<std::mutex> lock(_lock);
+
+                assert((_callback == nullptr) ^ (callback == nullptr));
+                _callback = callback;
+
+                if (callback == nullptr) {
+                    _idle.wait(lock, [this]() { return (_calling == 0); });
+                }
             }
+            void Clear();
 
         private:
-            pthread_mutex_t _lock;
+            static void Released(void* data, struct wl_buffer* buffer);
+
+        private:
+            std::mutex _lock;
+            Entries _entries;
+            uint32_t _nextId;
+            Compositor::IDisplay::IBufferCallback* _callback;
+            // Releases reported without the lock held.
+            uint32_t _calling;
+            std::condition_variable _idle;
         };
 
         class SurfaceImplementation : public Compositor::IDisplay::ISurface {
@@ -122,12 +172,12 @@ namespace Wayland {
         public:
             uint32_t AddRef() const override
             {
-                _refcount++;
+                Core::InterlockedIncrement(_refcount);
                 return Core::ERROR_NONE;
             }
             uint32_t Release() const override
             {
-                if (--_refcount == 0) {
+                if (Core::InterlockedDecrement(_refcount) == 0) {
                     delete const_cast<SurfaceImplementation*>(this);
                     return Core::ERROR_DESTRUCTION_SUCCEEDED;
                 }
@@ -151,12 +201,21 @@ namespace Wayland {
             }
             void Keyboard(IKeyboard* keyboard) override
             {
+                std::string mapping;
+
+                _adminLock.lock();
+
                 assert((_keyboard == nullptr) ^ (keyboard == nullptr));
                 _keyboard = keyboard;
 
-                if (_keyboard != nullptr && _display != nullptr) {
-                    const std::string& mapping = _display->KeyMapConfiguration();
-                    _keyboard->KeyMap(mapping.c_str(), mapping.length());
+                if (_display != nullptr) {
+                    mapping = _display->KeyMapConfiguration();
+                }
+
+                _adminLock.unlock();
+
+                if ((keyboard != nullptr) && (mapping.empty() == false)) {
+                    keyboard->KeyMap(mapping.c_str(), mapping.length());
                 }
             }
             inline uint32_t Id() const override
@@ -183,14 +242,20 @@ namespace Wayland {
             }
             void Pointer(IPointer* pointer) override
             {
+                std::lock_guard<std::mutex> lock(_adminLock);
+
                 assert((_pointer == nullptr) ^ (pointer == nullptr));
                 _pointer = pointer;
             }
-            void KeyMapConfiguration(const char information[], const uint16_t size)
+            uint32_t Import(const uint32_t width, const uint32_t height, const uint32_t format, const uint64_t modifier, const uint8_t count, const Compositor::IDisplay::Plane planes[]) override;
+            bool Present(const uint32_t id) override;
+            void Forget(const uint32_t id) override
             {
-                if (_keyboard != nullptr) {
-                    _keyboard->KeyMap(information, size);
-                }
+                _buffers.Forget(id);
+            }
+            void BufferCallback(Compositor::IDisplay::IBufferCallback* callback) override
+            {
+                _buffers.Callback(callback);
             }
             bool Connect(const EGLSurface& surface);
             uint32_t ZOrder(const uint16_t order) override;
@@ -209,6 +274,8 @@ namespace Wayland {
             // Called by C interface methods. A bit to much overkill to actually make the private and all kind
             // of friend definitions.
             struct wl_surface* _surface;
+            // The events of this surface, dispatched by the thread rendering it, not the event thread.
+            struct wl_event_queue* _queue;
 
             struct xdg_surface *_xdg_surface;
             struct xdg_toplevel *_xdg_toplevel;
@@ -233,6 +300,7 @@ namespace Wayland {
             EGLSurface _eglSurfaceWindow;
             IKeyboard* _keyboard;
             IPointer* _pointer;
+            BufferPool _buffers;
         };
 
         class ImageImplementation {
@@ -275,6 +343,7 @@ namespace Wayland {
 
         typedef std::map<const void*, SurfaceImplementation*> SurfaceMap;
         typedef std::map<struct wl_surface*, SurfaceImplementation*> WaylandSurfaceMap;
+        typedef std::multimap<uint32_t, uint64_t> FormatMap;
 
         Display(const std::string& displayName)
             : _display(nullptr)
@@ -290,9 +359,12 @@ namespace Wayland {
             , _pointer(nullptr)
             , _touch(nullptr)
             , _shell(nullptr)
-            , _trigger()
-            , _redraw()
+            , _dmabuf(nullptr)
             , _tid(0)
+            , _epoll(-1)
+            , _wakeup(-1)
+            , _notify(-1)
+            , _running(false)
             , _displayName(displayName)
             , _displayId()
             , _keyboardReceiver(nullptr)
@@ -301,6 +373,7 @@ namespace Wayland {
             , _eglDisplay(EGL_NO_DISPLAY)
             , _eglConfig(0)
             , _eglContext(EGL_NO_CONTEXT)
+            , _formats()
             , _collect(false)
             , _surfaces()
             , _physical()
@@ -550,20 +623,16 @@ namespace Wayland {
         ISurface* SurfaceByName(const std::string& name) override
         {
             //iterate through waylandsurface map return wl_surface with matching name
-            _adminLock.Lock();
+            std::lock_guard<std::mutex> lock(_adminLock);
 
             WaylandSurfaceMap::iterator entry(_waylandSurfaces.begin());
 
-            while (entry != _waylandSurfaces.end()) {
-                if (entry->second->Name().compare(name) == 0) {
-                    _adminLock.Unlock();
-                    //return iSurface to upper layers
-                    return entry->second;
-                }
+            while ((entry != _waylandSurfaces.end()) && (entry->second->Name().compare(name) != 0)) {
                 entry++;
             }
-            _adminLock.Unlock();
-            return nullptr;
+
+            //return iSurface to upper layers
+            return (entry != _waylandSurfaces.end() ? entry->second : nullptr);
         }
 
         inline bool IsOperational() const
@@ -576,10 +645,10 @@ namespace Wayland {
         }
         inline void Callback(ICallback* callback) const
         {
-            _adminLock.Lock();
+            std::lock_guard<std::mutex> lock(_adminLock);
+
             assert((callback != nullptr) ^ (_clientHandler != nullptr));
             _clientHandler = callback;
-            _adminLock.Unlock();
         }
         inline const std::string& RuntimeDirectory() const
         {
@@ -595,7 +664,7 @@ namespace Wayland {
         }
         void Get(const void* id, Surface& surface)
         {
-            _adminLock.Lock();
+            std::lock_guard<std::mutex> lock(_adminLock);
 
             SurfaceMap::iterator index(_surfaces.find(id));
 
@@ -604,7 +673,6 @@ namespace Wayland {
             } else {
                 surface.Release();
             }
-            _adminLock.Unlock();
         }
         void LoadSurfaces();
         Image Create(const uint32_t texture, const uint32_t width, const uint32_t height);
@@ -615,20 +683,18 @@ namespace Wayland {
             return _eglDisplay;
         }
 
-        inline void Trigger()
-        {
-            sem_post(&_trigger);
-        }
-
-        inline void Redraw()
-        {
-            sem_post(&_redraw);
-        }
-
     private:
         void Initialize();
         void Deinitialize();
         void EGLInitialize();
+        void Dispatch();
+        void Notify();
+
+        static void* Processor(void* data)
+        {
+            static_cast<Display*>(data)->Dispatch();
+            return nullptr;
+        }
 
     public:
         // Called by C interface methods. A bit to much overkill to actually make the private and all kind
@@ -645,9 +711,29 @@ namespace Wayland {
         void Dimensions(
             const uint32_t id, const uint32_t visible, const int32_t x, const int32_t y, const int32_t width,
             const int32_t height, const uint32_t opacity, const uint32_t zorder);
+        void Dmabuf(struct wl_registry* registry, const uint32_t name, const uint32_t version);
+        void Format(const uint32_t format, const uint64_t modifier)
+        {
+            std::lock_guard<std::mutex> lock(_adminLock);
+
+            _formats.emplace(format, modifier);
+        }
+        bool IsSupported(const uint32_t format, const uint64_t modifier) const
+        {
+            std::lock_guard<std::mutex> lock(_adminLock);
+
+            std::pair<FormatMap::const_iterator, FormatMap::const_iterator> range(_formats.equal_range(format));
+
+            while ((range.first != range.second) && (range.first->second != modifier)) {
+                range.first++;
+            }
+
+            return (range.first != range.second);
+        }
         void FocusKeyboard(struct wl_surface* surface, const bool state)
         {
-            _adminLock.Lock();
+            std::lock_guard<std::mutex> lock(_adminLock);
+
             WaylandSurfaceMap::const_iterator index = _waylandSurfaces.find(surface);
 
             if (index != _waylandSurfaces.end()) {
@@ -659,11 +745,11 @@ namespace Wayland {
                     _keyboardReceiver = index->second;
                 }
             }
-            _adminLock.Unlock();
         }
         void FocusPointer(struct wl_surface* surface, const bool state)
         {
-            _adminLock.Lock();
+            std::lock_guard<std::mutex> lock(_adminLock);
+
             WaylandSurfaceMap::const_iterator index = _waylandSurfaces.find(surface);
 
             if (index != _waylandSurfaces.end()) {
@@ -675,78 +761,78 @@ namespace Wayland {
                     _pointerReceiver = index->second;
                 }
             }
-
-            _adminLock.Unlock();
         }
 
+        // Input is dispatched on the event thread. The receiver is looked up under the lock, the
+        // keyboard or pointer itself is called without it.
         void KeyMapConfiguration(const char information[], const uint16_t size)
         {
-            _adminLock.Lock();
+            std::list<IKeyboard*> keyboards;
 
-            WaylandSurfaceMap::iterator index(_waylandSurfaces.begin());
+            _adminLock.lock();
 
-            while (index != _waylandSurfaces.end()) {
-                index->second->KeyMapConfiguration(information, size);
-                index++;
+            for (const std::pair<struct wl_surface* const, SurfaceImplementation*>& entry : _waylandSurfaces) {
+                if (entry.second->_keyboard != nullptr) {
+                    entry.second->_keyboard->AddRef();
+                    keyboards.push_back(entry.second->_keyboard);
+                }
             }
 
             _keyMapConfiguration = std::string(information, size);
 
-            _adminLock.Unlock();
+            _adminLock.unlock();
+
+            for (IKeyboard* keyboard : keyboards) {
+                keyboard->KeyMap(information, size);
+                keyboard->Release();
+            }
         }
         void Key(const uint32_t key, const IKeyboard::state action, const uint32_t)
         {
-            _adminLock.Lock();
+            IKeyboard* keyboard = Keyboard();
 
-            if ((_keyboardReceiver != nullptr) && (_keyboardReceiver->_keyboard != nullptr)) {
-                _keyboardReceiver->_keyboard->Direct(key, action);
+            if (keyboard != nullptr) {
+                keyboard->Direct(key, action);
+                keyboard->Release();
             }
-
-            _adminLock.Unlock();
         }
         void Modifiers(uint32_t depressedMods, uint32_t latchedMods, uint32_t lockedMods, uint32_t group)
         {
-            _adminLock.Lock();
+            IKeyboard* keyboard = Keyboard();
 
-            if ((_keyboardReceiver != nullptr) && (_keyboardReceiver->_keyboard != nullptr)) {
-                _keyboardReceiver->_keyboard->Modifiers(depressedMods, latchedMods, lockedMods, group);
+            if (keyboard != nullptr) {
+                keyboard->Modifiers(depressedMods, latchedMods, lockedMods, group);
+                keyboard->Release();
             }
-
-            _adminLock.Unlock();
         }
         void Repeat(int32_t rate, int32_t delay)
         {
-            _adminLock.Lock();
+            IKeyboard* keyboard = Keyboard();
 
-            if ((_keyboardReceiver != nullptr) && (_keyboardReceiver->_keyboard != nullptr)) {
-                _keyboardReceiver->_keyboard->Repeat(rate, delay);
+            if (keyboard != nullptr) {
+                keyboard->Repeat(rate, delay);
+                keyboard->Release();
             }
-
-            _adminLock.Unlock();
         }
 
         void SendPointerPosition(const uint16_t x, const uint16_t y)
         {
-            _adminLock.Lock();
+            IPointer* pointer = Pointer();
 
-            if ((_pointerReceiver != nullptr) && (_pointerReceiver->_pointer != nullptr)) {
-              _pointerReceiver->_pointer->Direct(x, y);
+            if (pointer != nullptr) {
+                pointer->Direct(x, y);
+                pointer->Release();
             }
-
-            _adminLock.Unlock();
-
         }
 
         void SendPointerButton(const uint8_t button, const IPointer::state action)
         {
-            _adminLock.Lock();
+            IPointer* pointer = Pointer();
 
-            if ((_pointerReceiver != nullptr) && (_pointerReceiver->_pointer != nullptr)) {
-              _pointerReceiver->_pointer->Direct(button, action);
+            if (pointer != nullptr) {
+                pointer->Direct(button, action);
+                pointer->Release();
             }
-
-            _adminLock.Unlock();
-
         }
 
         // Wayland related info
@@ -765,20 +851,49 @@ namespace Wayland {
         struct wl_touch* _touch;
         struct wl_shell* _shell;
         struct xdg_wm_base* _wm_base;
+        struct zwp_linux_dmabuf_v1* _dmabuf;
 
         // KeyBoardInfo
         uint32_t _keyRate;
         uint32_t _keyDelay;
         uint32_t _keyModifiers;
 
-        sem_t _trigger;
-        sem_t _redraw;
-
     private:
         friend class Surface;
         friend class Image;
 
+        IKeyboard* Keyboard() const
+        {
+            std::lock_guard<std::mutex> lock(_adminLock);
+
+            IKeyboard* result = (_keyboardReceiver != nullptr ? _keyboardReceiver->_keyboard : nullptr);
+
+            if (result != nullptr) {
+                result->AddRef();
+            }
+
+            return (result);
+        }
+        IPointer* Pointer() const
+        {
+            std::lock_guard<std::mutex> lock(_adminLock);
+
+            IPointer* result = (_pointerReceiver != nullptr ? _pointerReceiver->_pointer : nullptr);
+
+            if (result != nullptr) {
+                result->AddRef();
+            }
+
+            return (result);
+        }
+
+        // Event thread, the only one dispatching the default queue: registry, seat, output and shell.
         pthread_t _tid;
+        int _epoll;
+        int _wakeup;
+        // Signalled after the event thread dispatched, see FileDescriptor().
+        int _notify;
+        std::atomic<bool> _running;
 
         std::string _displayName;
         std::string _displayId;
@@ -792,6 +907,9 @@ namespace Wayland {
         EGLConfig _eglConfig;
         EGLContext _eglContext;
 
+        // The format/modifier pairs the compositor imports dma-bufs with.
+        FormatMap _formats;
+
         // Abstraction representations
         int _threadId;
         bool _collect;
@@ -805,7 +923,7 @@ namespace Wayland {
         int _thread;
 
         // Process wide singleton
-        static CriticalSection _adminLock;
+        static std::mutex _adminLock;
         static std::string _runtimeDir;
         static DisplayMap _displays;
         static WaylandSurfaceMap _waylandSurfaces;
@@ -43,10 +43,14 @@
 #include <pthread.h>
 #include <signal.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/mman.h>
 #include <sys/signalfd.h>
 #include <unistd.h>
 
+#include "linux-dmabuf-unstable-v1-client-protocol.h"
+
 // logical xor
 #define XOR(a, b) ((!a && b) || (a && !b))
 
@@ -368,6 +372,8 @@ static const struct wl_registry_listener globalRegistryListener = {
             struct wl_output* result = static_cast<struct wl_output*>(wl_registry_bind(registry, name, &wl_output_interface, 2));
             wl_output_add_listener(result, &outputListener, data);
             context._output = result;
+        } else if (::strcmp(interface, "zwp_linux_dmabuf_v1") == 0) {
+            context.Dmabuf(registry, name, version);
         }
     },
     // global_remove
@@ -379,7 +385,7 @@ static const struct wl_registry_listener globalRegistryListener = {
 namespace Thunder {
 
 namespace Wayland {
-    /*static*/ Display::CriticalSection Display::_adminLock;
+    /*static*/ std::mutex Display::_adminLock;
     /*static*/ std::string Display::_runtimeDir;
     /*static*/ Display::DisplayMap Display::_displays;
     /*static*/ Display::WaylandSurfaceMap Display::_waylandSurfaces;
@@ -435,6 +441,7 @@ namespace Wayland {
 
     Display::SurfaceImplementation::SurfaceImplementation(Display& display, const std::string& name, const uint32_t width, const uint32_t height)
         : _surface(nullptr)
+        , _queue(nullptr)
         , _refcount(1)
         , _level(0)
         , _name(name)
@@ -451,6 +458,7 @@ namespace Wayland {
         , _eglSurfaceWindow(EGL_NO_SURFACE)
         , _keyboard(nullptr)
         , _pointer(nullptr)
+        , _buffers()
     {
         assert(display.IsOperational());
 
@@ -459,6 +467,10 @@ namespace Wayland {
         _surface = wl_compositor_create_surface(display._compositor);
 
         if (_surface != nullptr) {
+            _queue = wl_display_create_queue(display._display);
+
+            // The shell surface stays with the event thread, it answers the pings
+            wl_proxy_set_queue(reinterpret_cast<struct wl_proxy*>(_surface), _queue);
 
             struct wl_region* region;
             region = wl_compositor_create_region(display._compositor);
@@ -491,6 +503,7 @@ namespace Wayland {
 
     Display::SurfaceImplementation::SurfaceImplementation(Display& display, const uint32_t id, struct wl_surface* surface)
         : _surface(surface)
+        , _queue(nullptr)
         , _refcount(1)
         , _level(2)
         , _name()
@@ -506,11 +519,13 @@ namespace Wayland {
         , _eglSurfaceWindow(EGL_NO_SURFACE)
         , _keyboard(nullptr)
         , _pointer(nullptr)
+        , _buffers()
     {
     }
 
     Display::SurfaceImplementation::SurfaceImplementation(Display& display, const uint32_t id, const char* name)
         : _surface(nullptr)
+        , _queue(nullptr)
         , _refcount(1)
         , _level(2)
         , _name(name)
@@ -526,6 +541,7 @@ namespace Wayland {
         , _eglSurfaceWindow(EGL_NO_SURFACE)
         , _keyboard(nullptr)
         , _pointer(nullptr)
+        , _buffers()
     {
     }
 
@@ -607,10 +623,12 @@ namespace Wayland {
     }
     void Display::SurfaceImplementation::Redraw()
     {
-        _display->Trigger();
+        // Only the events of this surface, the event thread takes care of the rest
+        if (_queue != nullptr) {
+            wl_display_dispatch_queue_pending(_display->_display, _queue);
+        }
+        wl_display_flush(_display->_display);
 
-        // wait for wayland to flush events
-        sem_wait(&(_display->_redraw));
         if (_native != nullptr) {
             eglSwapBuffers(_display->_eglDisplay, _eglSurfaceWindow);
         }
@@ -620,6 +638,8 @@ namespace Wayland {
     {
         if (_display != nullptr) {
 
+            _buffers.Clear();
+
             if (_eglSurfaceWindow != EGL_NO_SURFACE) {
 
                 eglDestroySurface(_display->_eglDisplay, _eglSurfaceWindow);
@@ -641,6 +661,11 @@ namespace Wayland {
                 _surface = nullptr;
             }
 
+            if (_queue != nullptr) {
+                wl_event_queue_destroy(_queue);
+                _queue = nullptr;
+            }
+
             _display = nullptr;
         }
     }
@@ -737,18 +762,85 @@ namespace Wayland {
         }
     }
 
-    static void* Processor(void* data)
+    // Reads the connection for all queues, the surface queues included, and dispatches the
+    // default one. Whoever else reads (EGL, a surface roundtrip) joins in through
+    // wl_display_prepare_read_queue, so nobody has to take a lock for it.
+    void Display::Dispatch()
     {
-        Wayland::Display& context = *(static_cast<Wayland::Display*>(data));
+        const int fd = wl_display_get_fd(_display);
+        uint32_t interest = EPOLLIN;
+        bool running = true;
+        struct epoll_event event;
+
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event);
+        event.data.fd = _wakeup;
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeup, &event);
+
+        while (running == true) {
+            int dispatched = 0;
+            int result = 0;
+
+            while ((result >= 0) && (wl_display_prepare_read(_display) != 0)) {
+                result = wl_display_dispatch_pending(_display);
+                dispatched += (result > 0 ? result : 0);
+            }
+
+            if (result < 0) {
+                running = false;
+            } else {
+                // A full socket is flushed as soon as it drained
+                const uint32_t wanted = (((wl_display_flush(_display) < 0) && (errno == EAGAIN)) ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+
+                if (wanted != interest) {
+                    interest = wanted;
+                    event.events = interest;
+                    event.data.fd = fd;
+                    epoll_ctl(_epoll, EPOLL_CTL_MOD, fd, &event);
+                }
 
-        while ((sem_wait(&context._trigger) == 0) && (context._display != nullptr)) {
-            Trace("Flush Events\n");
-            wl_display_flush(context._display);
+                struct epoll_event events[2];
+                const int count = epoll_wait(_epoll, events, 2, -1);
+                bool readable = false;
+
+                for (int index = 0; index < count; index++) {
+                    if (events[index].data.fd == _wakeup) {
+                        uint64_t value;
+                        const ssize_t length VARIABLE_IS_NOT_USED = ::read(_wakeup, &value, sizeof(value));
+
+                        running = _running;
+                    } else if ((events[index].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0) {
+                        readable = true;
+                    }
+                }
 
-            context.Redraw();
+                if (readable == false) {
+                    wl_display_cancel_read(_display);
+                } else if ((wl_display_read_events(_display) < 0) || ((result = wl_display_dispatch_pending(_display)) < 0)) {
+                    Trace("[Wayland] Lost the connection to the compositor\n");
+                    running = false;
+                } else {
+                    dispatched += result;
+                }
+            }
+
+            if (dispatched > 0) {
+                Notify();
+            }
         }
-        return nullptr;
+
+        // Whoever waits in the process loop, has to know we stopped
+        _running = false;
+        Notify();
     }
+
+    void Display::Notify()
+    {
+        const uint64_t value = 1;
+        const ssize_t length VARIABLE_IS_NOT_USED = ::write(_notify, &value, sizeof(value));
+    }
+
     Display::~Display()
     {
         ASSERT(_refCount == 0);
@@ -793,12 +885,20 @@ namespace Wayland {
                 wl_registry_add_listener(_registry, &globalRegistryListener, this);
                 wl_display_roundtrip(_display);
 
-                sem_init(&_trigger, 0, 0);
-                sem_init(&_redraw, 0, 0);
+                if (_dmabuf != nullptr) {
+                    // The formats and modifiers are sent once the dmabuf global is bound.
+                    wl_display_roundtrip(_display);
+                }
+
+                _epoll = epoll_create1(EPOLL_CLOEXEC);
+                _wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                _notify = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                _running = true;
 
                 Trace("creating communication thread\n");
                 if (pthread_create(&_tid, nullptr, Processor, this) != 0) {
                     Trace("[Wayland] Error creating communication thread\n");
+                    _tid = 0;
                 }
             }
         }
@@ -895,9 +995,21 @@ namespace Wayland {
 
     void Display::Deinitialize()
     {
-        _adminLock.Lock();
+        if (_tid != 0) {
+            const uint64_t value = 1;
+
+            _running = false;
+
+            const ssize_t length VARIABLE_IS_NOT_USED = ::write(_wakeup, &value, sizeof(value));
+
+            pthread_join(_tid, nullptr);
+            _tid = 0;
+        }
+
+        _adminLock.lock();
 
         _keyboardReceiver = nullptr;
+        _pointerReceiver = nullptr;
 
         // First notify our client of our destruction...
         SurfaceMap::iterator index(_surfaces.begin());
@@ -937,6 +1049,13 @@ namespace Wayland {
             _output = nullptr;
         }
 
+        if (_dmabuf != nullptr) {
+            zwp_linux_dmabuf_v1_destroy(_dmabuf);
+            _dmabuf = nullptr;
+        }
+
+        _formats.clear();
+
         if (_simpleShell != nullptr) {
             wl_simple_shell_destroy(_simpleShell);
             _simpleShell = nullptr;
@@ -970,11 +1089,20 @@ namespace Wayland {
             wl_display_disconnect(_display);
             _display = nullptr;
         }
-        _adminLock.Unlock();
-
-        Trigger();
+        _adminLock.unlock();
 
-        pthread_join(_tid, nullptr);
+        if (_epoll != -1) {
+            ::close(_epoll);
+            _epoll = -1;
+        }
+        if (_wakeup != -1) {
+            ::close(_wakeup);
+            _wakeup = -1;
+        }
+        if (_notify != -1) {
+            ::close(_notify);
+            _notify = -1;
+        }
     }
 
     void Display::LoadSurfaces()
@@ -991,7 +1119,7 @@ namespace Wayland {
     {
         IDisplay::ISurface* result = nullptr;
 
-        _adminLock.Lock();
+        std::lock_guard<std::mutex> lock(_adminLock);
 
         SurfaceImplementation* surface = new SurfaceImplementation(*this, name, width, height);
 
@@ -1001,8 +1129,6 @@ namespace Wayland {
 
         result = surface;
 
-        _adminLock.Unlock();
-
         return (result);
     }
 
@@ -1013,7 +1139,7 @@ namespace Wayland {
 
     void Display::Constructed(const void* id, wl_surface* surface)
     {
-        _adminLock.Lock();
+        _adminLock.lock();
 
         WaylandSurfaceMap::iterator index = _waylandSurfaces.find(surface);
 
@@ -1031,16 +1157,18 @@ namespace Wayland {
             _waylandSurfaces.insert(std::pair<wl_surface*, Display::SurfaceImplementation*>(surface, entry));
         }
 
-        if (_clientHandler != nullptr) {
-            _clientHandler->Attached(reinterpret_cast<uint32_t>(id));
-        }
+        ICallback* handler = _clientHandler;
+
+        _adminLock.unlock();
 
-        _adminLock.Unlock();
+        if (handler != nullptr) {
+            handler->Attached(reinterpret_cast<uint32_t>(id));
+        }
     }
 
     void Display::Constructed(const void* id, const char* name)
     {
-        _adminLock.Lock();
+        _adminLock.lock();
 
         SurfaceMap::iterator index = _surfaces.find(id);
 
@@ -1058,10 +1186,13 @@ namespace Wayland {
             _surfaces.insert(std::pair<const void*, Display::SurfaceImplementation*>(id, entry));
         }
 
-        if (_clientHandler != nullptr) {
-            _clientHandler->Attached(reinterpret_cast<uint32_t>(id));
+        ICallback* handler = _clientHandler;
+
+        _adminLock.unlock();
+
+        if (handler != nullptr) {
+            handler->Attached(reinterpret_cast<uint32_t>(id));
         }
-        _adminLock.Unlock();
     }
 
     void Display::Dimensions(
@@ -1072,7 +1203,7 @@ namespace Wayland {
         const uint32_t zorder)
     {
         Trace("Updated Dimensions surfaceId=%d width=%d  height=%d x=%d, y=%d visible=%d opacity=%d zorder=%d\n", id, width, height, x, y, visible, opacity, zorder);
-        _adminLock.Lock();
+        std::lock_guard<std::mutex> lock(_adminLock);
 
         SurfaceMap::iterator index = _surfaces.find(reinterpret_cast<void*>(id));
 
@@ -1083,13 +1214,11 @@ namespace Wayland {
             // TODO: Seems this is a surface, we did not create. maybe we need to collect it in future.
             // Trace("Unidentified surface: id=%d.\n");
         }
-
-        _adminLock.Unlock();
     }
 
     void Display::Destructed(const void* id)
     {
-        _adminLock.Lock();
+        _adminLock.lock();
 
         if (_collect != true) {
             SurfaceMap::iterator index = _surfaces.find(id);
@@ -1108,16 +1237,23 @@ namespace Wayland {
                 if (_keyboardReceiver == index->second) {
                     _keyboardReceiver = nullptr;
                 }
+                if (_pointerReceiver == index->second) {
+                    _pointerReceiver = nullptr;
+                }
 
                 index->second->Unlink();
                 index->second->Release();
                 _surfaces.erase(index);
             }
         }
-        if (_clientHandler != nullptr) {
-            _clientHandler->Detached(reinterpret_cast<uint32_t>(id));
+
+        ICallback* handler = _clientHandler;
+
+        _adminLock.unlock();
+
+        if (handler != nullptr) {
+            handler->Detached(reinterpret_cast<uint32_t>(id));
         }
-        _adminLock.Unlock();
     }
 
     /* static */ Display& Display::Instance(const std::string& displayName)
@@ -1136,7 +1272,7 @@ namespace Wayland {
 
         Display* result(nullptr);
 
-        _adminLock.Lock();
+        _adminLock.lock();
 
         DisplayMap::iterator index(_displays.find(displayName));
 
@@ -1147,7 +1283,7 @@ namespace Wayland {
             result = index->second;
         }
         result->AddRef();
-        _adminLock.Unlock();
+        _adminLock.unlock();
 
         assert(result != nullptr);
 
@@ -1172,42 +1308,30 @@ namespace Wayland {
 
         Trace("Setup dispatch loop using thread %p signal: %d \n", &_thread, _signal);
         if (_display != nullptr) {
-            while ((wl_display_dispatch(_display) != -1) && (processloop->Dispatch() == true)) {
+            struct pollfd descriptor = { _notify, POLLIN, 0 };
+
+            // The events are dispatched by the event thread already, Signal() interrupts the poll.
+            while ((::poll(&descriptor, 1, -1) > 0) && (Process(descriptor.revents) == 0) && (processloop->Dispatch() == true)) {
                 /* intentionally left empty */
             }
         }
     }
 
-    int Display::Process(const uint32_t data)
+    int Display::Process(const uint32_t)
     {
+        signed int result(-1);
 
-        signed int result(0);
-        _adminLock.Lock();
-        if (_display) {
+        if (_display != nullptr) {
+            uint64_t value;
 
-            while (wl_display_prepare_read(_display) != 0) {
-                if (wl_display_dispatch_pending(_display) < 0) {
-                    result = -1;
-                    break;
-                }
-            }
+            // Only the notification is taken, the event thread did the dispatching.
+            const ssize_t length VARIABLE_IS_NOT_USED = ::read(_notify, &value, sizeof(value));
 
             wl_display_flush(_display);
 
-            if (data != 0) {
-                if (wl_display_read_events(_display) < 0) {
-                    result = -2;
-                } else {
-                    if (wl_display_dispatch_pending(_display) < 0) {
-                        result = 1;
-                    }
-                }
-            } else {
-                wl_display_cancel_read(_display);
-                result = -3;
-            }
+            result = ((_running == true) && (wl_display_get_error(_display) == 0) ? 0 : -1);
         }
-        _adminLock.Unlock();
+
         return result;
     }
 
@@ -1232,7 +1356,7 @@ namespace Wayland {
 
     int Display::FileDescriptor() const
     {
-        return (wl_display_get_fd(_display));
+        return (_notify);
     }
 
     void Display::Signal()
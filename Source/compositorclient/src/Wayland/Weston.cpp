@@ -38,10 +38,13 @@
 #include <pthread.h>
 #include <signal.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/mman.h>
 #include <sys/signalfd.h>
 #include <unistd.h>
 
+#include "linux-dmabuf-unstable-v1-client-protocol.h"
 #include "xdg-shell-client-protocol.h"
 // logical xor
 #define XOR(a, b) ((!a && b) || (a && !b))
@@ -309,6 +312,8 @@ static const struct wl_registry_listener globalRegistryListener = {
 
             xdg_wm_base_add_listener(result, &wm_base_listener, data);
             context._wm_base = result;
+        } else if (::strcmp(interface, "zwp_linux_dmabuf_v1") == 0) {
+            context.Dmabuf(registry, name, version);
         }
     },
     // global_remove
@@ -348,7 +353,7 @@ static const struct xdg_toplevel_listener xdg_toplevel_listener = {
 namespace Thunder {
 
 namespace Wayland {
-    /*static*/ Display::CriticalSection Display::_adminLock;
+    /*static*/ std::mutex Display::_adminLock;
     /*static*/ std::string Display::_runtimeDir;
     /*static*/ Display::DisplayMap Display::_displays;
     /*static*/ Display::WaylandSurfaceMap Display::_waylandSurfaces;
@@ -404,6 +409,9 @@ namespace Wayland {
 
     Display::SurfaceImplementation::SurfaceImplementation(Display& display, const std::string& name, const uint32_t width, const uint32_t height)
         : _surface(nullptr)
+        , _queue(nullptr)
+        , _xdg_surface(nullptr)
+        , _xdg_toplevel(nullptr)
         , _refcount(1)
         , _level(0)
         , _name(name)
@@ -421,6 +429,7 @@ namespace Wayland {
         , _eglSurfaceWindow(EGL_NO_SURFACE)
         , _keyboard(nullptr)
         , _pointer(nullptr)
+        , _buffers()
     {
         assert(display.IsOperational());
 
@@ -429,6 +438,9 @@ namespace Wayland {
         _surface = wl_compositor_create_surface(display._compositor);
 
         if (_surface != nullptr) {
+            _queue = wl_display_create_queue(display._display);
+
+            wl_proxy_set_queue(reinterpret_cast<struct wl_proxy*>(_surface), _queue);
 
             Trace("### Creating a surface of size: %d x %d _surface=%p\n", width, height, _surface);
 
@@ -444,6 +456,9 @@ namespace Wayland {
 
     Display::SurfaceImplementation::SurfaceImplementation(Display& display, const uint32_t id, struct wl_surface* surface)
         : _surface(surface)
+        , _queue(nullptr)
+        , _xdg_surface(nullptr)
+        , _xdg_toplevel(nullptr)
         , _refcount(1)
         , _level(2)
         , _name()
@@ -459,11 +474,15 @@ namespace Wayland {
         , _eglSurfaceWindow(EGL_NO_SURFACE)
         , _keyboard(nullptr)
         , _pointer(nullptr)
+        , _buffers()
     {
     }
 
     Display::SurfaceImplementation::SurfaceImplementation(Display& display, const uint32_t id, const char* name)
         : _surface(nullptr)
+        , _queue(nullptr)
+        , _xdg_surface(nullptr)
+        , _xdg_toplevel(nullptr)
         , _refcount(1)
         , _level(2)
         , _name(name)
@@ -479,24 +498,18 @@ namespace Wayland {
         , _eglSurfaceWindow(EGL_NO_SURFACE)
         , _keyboard(nullptr)
         , _pointer(nullptr)
+        , _buffers()
     {
     }
 
     Display::SurfaceImplementation::~SurfaceImplementation()
     {
-        if (_xdg_toplevel != nullptr) {
-            xdg_toplevel_destroy(_xdg_toplevel);
-            _xdg_toplevel = nullptr;
+        if ((_xdg_surface != nullptr) && (_display != nullptr)) {
+            // Unlink the surface and remove it from the maps
+            _display->Destructed(reinterpret_cast<Display*>(_xdg_surface));
         }
 
-        if (_xdg_surface != nullptr) {
-            if (_display != nullptr) {
-                // Unlink the surface and remove from th
-                _display->Destructed(reinterpret_cast<Display*>(_xdg_surface));
-            }
-            xdg_surface_destroy(_xdg_surface);
-            _xdg_surface = nullptr;
-        }
+        Unlink();
     }
 
     void Display::SurfaceImplementation::Resize(const int x, const int y, const int w, const int h)
@@ -528,10 +541,12 @@ namespace Wayland {
 
     void Display::SurfaceImplementation::Redraw()
     {
-        _display->Trigger();
+        // Only the events of this surface, the event thread takes care of the rest
+        if (_queue != nullptr) {
+            wl_display_dispatch_queue_pending(_display->_display, _queue);
+        }
+        wl_display_flush(_display->_display);
 
-        // wait for wayland to flush events
-        sem_wait(&(_display->_redraw));
         if (_native != nullptr) {
             eglSwapBuffers(_display->_eglDisplay, _eglSurfaceWindow);
         }
@@ -541,6 +556,8 @@ namespace Wayland {
     {
         if (_display != nullptr) {
 
+            _buffers.Clear();
+
             if (_eglSurfaceWindow != EGL_NO_SURFACE) {
 
                 eglDestroySurface(_display->_eglDisplay, _eglSurfaceWindow);
@@ -557,11 +574,27 @@ namespace Wayland {
                 _shellSurface = nullptr;
             }
 
+            // The role objects go before the surface they are the role of
+            if (_xdg_toplevel != nullptr) {
+                xdg_toplevel_destroy(_xdg_toplevel);
+                _xdg_toplevel = nullptr;
+            }
+
+            if (_xdg_surface != nullptr) {
+                xdg_surface_destroy(_xdg_surface);
+                _xdg_surface = nullptr;
+            }
+
             if (_surface != nullptr) {
                 wl_surface_destroy(_surface);
                 _surface = nullptr;
             }
 
+            if (_queue != nullptr) {
+                wl_event_queue_destroy(_queue);
+                _queue = nullptr;
+            }
+
             _display = nullptr;
         }
     }
@@ -658,18 +691,85 @@ namespace Wayland {
         }
     }
 
-    static void* Processor(void* data)
+    // Reads the connection for all queues, the surface queues included, and dispatches the
+    // default one. Whoever else reads (EGL, a surface roundtrip) joins in through
+    // wl_display_prepare_read_queue, so nobody has to take a lock for it.
+    void Display::Dispatch()
     {
-        Wayland::Display& context = *(static_cast<Wayland::Display*>(data));
+        const int fd = wl_display_get_fd(_display);
+        uint32_t interest = EPOLLIN;
+        bool running = true;
+        struct epoll_event event;
+
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event);
+        event.data.fd = _wakeup;
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeup, &event);
+
+        while (running == true) {
+            int dispatched = 0;
+            int result = 0;
+
+            while ((result >= 0) && (wl_display_prepare_read(_display) != 0)) {
+                result = wl_display_dispatch_pending(_display);
+                dispatched += (result > 0 ? result : 0);
+            }
+
+            if (result < 0) {
+                running = false;
+            } else {
+                // A full socket is flushed as soon as it drained
+                const uint32_t wanted = (((wl_display_flush(_display) < 0) && (errno == EAGAIN)) ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+
+                if (wanted != interest) {
+                    interest = wanted;
+                    event.events = interest;
+                    event.data.fd = fd;
+                    epoll_ctl(_epoll, EPOLL_CTL_MOD, fd, &event);
+                }
 
-        while ((sem_wait(&context._trigger) == 0) && (context._display != nullptr)) {
-            Trace("Flush Events\n");
-            wl_display_flush(context._display);
+                struct epoll_event events[2];
+                const int count = epoll_wait(_epoll, events, 2, -1);
+                bool readable = false;
 
-            context.Redraw();
+                for (int index = 0; index < count; index++) {
+                    if (events[index].data.fd == _wakeup) {
+                        uint64_t value;
+                        const ssize_t length VARIABLE_IS_NOT_USED = ::read(_wakeup, &value, sizeof(value));
+
+                        running = _running;
+                    } else if ((events[index].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0) {
+                        readable = true;
+                    }
+                }
+
+                if (readable == false) {
+                    wl_display_cancel_read(_display);
+                } else if ((wl_display_read_events(_display) < 0) || ((result = wl_display_dispatch_pending(_display)) < 0)) {
+                    Trace("[Wayland] Lost the connection to the compositor\n");
+                    running = false;
+                } else {
+                    dispatched += result;
+                }
+            }
+
+            if (dispatched > 0) {
+                Notify();
+            }
         }
-        return nullptr;
+
+        // Whoever waits in the process loop, has to know we stopped
+        _running = false;
+        Notify();
+    }
+
+    void Display::Notify()
+    {
+        const uint64_t value = 1;
+        const ssize_t length VARIABLE_IS_NOT_USED = ::write(_notify, &value, sizeof(value));
     }
+
     Display::~Display()
     {
         ASSERT(_refCount == 0);
@@ -706,7 +806,6 @@ namespace Wayland {
         assert(_display != nullptr);
 
         if (_display != nullptr) {
-            sem_init(&_trigger, 0, 0);
             _registry = wl_display_get_registry(_display);
 
             assert(_registry != nullptr);
@@ -716,10 +815,20 @@ namespace Wayland {
                 wl_registry_add_listener(_registry, &globalRegistryListener, this);
                 wl_display_roundtrip(_display);
 
-                sem_init(&_redraw, 0, 0);
+                if (_dmabuf != nullptr) {
+                    // The formats and modifiers are sent once the dmabuf global is bound.
+                    wl_display_roundtrip(_display);
+                }
+
+                _epoll = epoll_create1(EPOLL_CLOEXEC);
+                _wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                _notify = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                _running = true;
+
                 Trace("creating communication thread\n");
                 if (pthread_create(&_tid, nullptr, Processor, this) != 0) {
                     Trace("[Wayland] Error creating communication thread\n");
+                    _tid = 0;
                 }
             }
         }
@@ -817,9 +926,21 @@ namespace Wayland {
     {
         Trace("Display::Deinitialize\n");
 
-        _adminLock.Lock();
+        if (_tid != 0) {
+            const uint64_t value = 1;
+
+            _running = false;
+
+            const ssize_t length VARIABLE_IS_NOT_USED = ::write(_wakeup, &value, sizeof(value));
+
+            pthread_join(_tid, nullptr);
+            _tid = 0;
+        }
+
+        _adminLock.lock();
 
         _keyboardReceiver = nullptr;
+        _pointerReceiver = nullptr;
 
         // First notify our client of our destruction...
         SurfaceMap::iterator index(_surfaces.begin());
@@ -851,6 +972,13 @@ namespace Wayland {
             _output = nullptr;
         }
 
+        if (_dmabuf != nullptr) {
+            zwp_linux_dmabuf_v1_destroy(_dmabuf);
+            _dmabuf = nullptr;
+        }
+
+        _formats.clear();
+
         if (_wm_base != nullptr) {
             xdg_wm_base_destroy(_wm_base);
             _wm_base = nullptr;
@@ -887,12 +1015,19 @@ namespace Wayland {
             _display = nullptr;
         }
 
-        _adminLock.Unlock();
+        _adminLock.unlock();
 
-        Trigger();
-
-        if (_tid) {
-            pthread_join(_tid, nullptr);
+        if (_epoll != -1) {
+            ::close(_epoll);
+            _epoll = -1;
+        }
+        if (_wakeup != -1) {
+            ::close(_wakeup);
+            _wakeup = -1;
+        }
+        if (_notify != -1) {
+            ::close(_notify);
+            _notify = -1;
         }
     }
 
@@ -906,13 +1041,15 @@ namespace Wayland {
         IDisplay::ISurface* result = nullptr;
 
         Trace("Display::Create: name = %s\n", name.c_str());
-        _adminLock.Lock();
+        _adminLock.lock();
 
         SurfaceImplementation* surface = new SurfaceImplementation(*this, name, width, height);
 
         if (_wm_base != nullptr) {
             surface->_xdg_surface = xdg_wm_base_get_xdg_surface(_wm_base, surface->_surface);
             assert(surface->_xdg_surface != NULL);
+            // The first configure has to be acked before EGL attaches a buffer, have it on the surface queue
+            wl_proxy_set_queue(reinterpret_cast<struct wl_proxy*>(surface->_xdg_surface), surface->_queue);
             xdg_surface_add_listener(surface->_xdg_surface, &xdg_surface_listener, this);
 
             surface->_xdg_toplevel = xdg_surface_get_toplevel(surface->_xdg_surface);
@@ -926,10 +1063,18 @@ namespace Wayland {
             result = surface;
         }
 
-        _adminLock.Unlock();
+        _adminLock.unlock();
 
-        // Wait till we are fully registered.
-        wl_display_roundtrip(_display);
+        if (result != nullptr) {
+            // Wait till we are fully registered, only for this surface, the event thread keeps going.
+            wl_display_roundtrip_queue(_display, surface->_queue);
+
+            // Later configures are acked by the event thread, this surface might not render for a while
+            wl_proxy_set_queue(reinterpret_cast<struct wl_proxy*>(surface->_xdg_surface), nullptr);
+            wl_proxy_set_queue(reinterpret_cast<struct wl_proxy*>(surface->_xdg_toplevel), nullptr);
+        } else {
+            surface->Release();
+        }
 
         return (result);
     }
@@ -960,13 +1105,15 @@ namespace Wayland {
     {
         Trace("Display::Destructed\n");
 
-        _adminLock.Lock();
+        std::lock_guard<std::mutex> lock(_adminLock);
 
         SurfaceMap::iterator index = _surfaces.find(id);
 
         if (index != _surfaces.end()) {
+            SurfaceImplementation* surface = index->second;
+
             // See if it is in the surfaces map, we need to take it out here as well..
-            WaylandSurfaceMap::iterator entry(_waylandSurfaces.find(index->second->_surface));
+            WaylandSurfaceMap::iterator entry(_waylandSurfaces.find(surface->_surface));
 
             assert(entry != _waylandSurfaces.end());
 
@@ -974,14 +1121,16 @@ namespace Wayland {
                 _waylandSurfaces.erase(entry);
             }
 
-            if (_keyboardReceiver == index->second) {
+            if (_keyboardReceiver == surface) {
                 _keyboardReceiver = nullptr;
             }
+            if (_pointerReceiver == surface) {
+                _pointerReceiver = nullptr;
+            }
 
             _surfaces.erase(index);
-            index->second->Unlink();
+            surface->Unlink();
         }
-        _adminLock.Unlock();
     }
 
     /* static */ Display& Display::Instance(const std::string& displayName)
@@ -1000,7 +1149,7 @@ namespace Wayland {
 
         Display* result(nullptr);
 
-        _adminLock.Lock();
+        _adminLock.lock();
 
         DisplayMap::iterator index(_displays.find(displayName));
 
@@ -1011,7 +1160,7 @@ namespace Wayland {
             result = index->second;
         }
         result->AddRef();
-        _adminLock.Unlock();
+        _adminLock.unlock();
 
         assert(result != nullptr);
 
@@ -1036,42 +1185,30 @@ namespace Wayland {
 
         Trace("Setup dispatch loop using thread %p signal: %d \n", &_thread, _signal);
         if (_display != nullptr) {
-            while ((wl_display_dispatch(_display) != -1) && (processloop->Dispatch() == true)) {
+            struct pollfd descriptor = { _notify, POLLIN, 0 };
+
+            // The events are dispatched by the event thread already, Signal() interrupts the poll.
+            while ((::poll(&descriptor, 1, -1) > 0) && (Process(descriptor.revents) == 0) && (processloop->Dispatch() == true)) {
                 /* intentionally left empty */
             }
         }
     }
 
-    int Display::Process(const uint32_t data)
+    int Display::Process(const uint32_t)
     {
+        signed int result(-1);
 
-        signed int result(0);
-        _adminLock.Lock();
-        if (_display) {
+        if (_display != nullptr) {
+            uint64_t value;
 
-            while (wl_display_prepare_read(_display) != 0) {
-                if (wl_display_dispatch_pending(_display) < 0) {
-                    result = -1;
-                    break;
-                }
-            }
+            // Only the notification is taken, the event thread did the dispatching.
+            const ssize_t length VARIABLE_IS_NOT_USED = ::read(_notify, &value, sizeof(value));
 
             wl_display_flush(_display);
 
-            if (data != 0) {
-                if (wl_display_read_events(_display) < 0) {
-                    result = -2;
-                } else {
-                    if (wl_display_dispatch_pending(_display) < 0) {
-                        result = 1;
-                    }
-                }
-            } else {
-                wl_display_cancel_read(_display);
-                result = -3;
-            }
+            result = ((_running == true) && (wl_display_get_error(_display) == 0) ? 0 : -1);
         }
-        _adminLock.Unlock();
+
         return result;
     }
 
@@ -1096,7 +1233,7 @@ namespace Wayland {
 
     int Display::FileDescriptor() const
     {
-        return (wl_display_get_fd(_display));
+        return (_notify);
     }
 
     void Display::Signal()
@@ -0,0 +1,178 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace Implementation {
+
+// Slab of vault elements, addressed by handles that encode the slot index and
+// the generation of that slot:
+//
+//    31  30            16 15             0
+//   | 1 |  generation    |     index      |
+//
+// A slot gets a new generation when its element is removed, so a stale handle
+// never resolves to the element that reused the slot. Freed slots are reused
+// oldest first, and a slot that used up its generations is retired rather than
+// wrapped. Handles below 0x80000000 are reserved for elements with a
+// well-known id (see Add(handle, element)), their slots are never handed out
+// to other elements.
+// Lookups are O(1). The table does not lock, the owner guards it, but as the
+// elements are shared the owner only needs to hold its lock for the lookup
+// itself and not for the work done with the element.
+template <typename ELEMENT>
+class HandleTable {
+public:
+    using Element = std::shared_ptr<const ELEMENT>;
+
+private:
+    static constexpr uint32_t Dynamic = 0x80000000;
+    static constexpr uint8_t IndexBits = 16;
+    static constexpr uint32_t IndexMask = ((1 << IndexBits) - 1);
+    static constexpr uint32_t GenerationMask = ((~Dynamic) >> IndexBits);
+
+    struct Slot {
+        Slot()
+            : Handle(0)
+            , Generation(0)
+            , Item()
+        {
+        }
+
+        uint32_t Handle;
+        uint16_t Generation;
+        Element Item;
+    };
+
+public:
+    HandleTable(const HandleTable&) = delete;
+    HandleTable& operator=(const HandleTable&) = delete;
+
+    HandleTable()
+        : _slots()
+        , _free()
+    {
+    }
+    ~HandleTable() = default;
+
+public:
+    // Returns the new handle, or 0 if the table is full.
+    uint32_t Add(const Element& element)
+    {
+        uint32_t result = 0;
+
+        if ((_free.empty() == false) || (_slots.size() <= IndexMask)) {
+            uint32_t index;
+
+            if (_free.empty() == false) {
+                index = _free.front();
+                _free.pop_front();
+            } else {
+                index = static_cast<uint32_t>(_slots.size());
+                _slots.emplace_back();
+            }
+
+            Slot& slot(_slots[index]);
+
+            result = (Dynamic | ((slot.Generation & GenerationMask) << IndexBits) | index);
+            slot.Handle = result;
+            slot.Item = element;
+        }
+
+        return (result);
+    }
+
+    // Adds an element with a well-known (reserved) handle.
+    bool Add(const uint32_t handle, const Element& element)
+    {
+        bool result = false;
+
+        if ((handle != 0) && (handle <= IndexMask)) {
+
+            // The slots up to the reserved one stay out of the free list, they are
+            // kept for the other well-known ids.
+            if (_slots.size() <= handle) {
+                _slots.resize(handle + 1);
+            }
+
+            Slot& slot(_slots[handle]);
+
+            if (slot.Handle == 0) {
+                // The slot may have been used and freed by a dynamic element before.
+                typename std::deque<uint32_t>::iterator index(std::find(_free.begin(), _free.end(), handle));
+
+                if (index != _free.end()) {
+                    _free.erase(index);
+                }
+
+                slot.Handle = handle;
+                slot.Item = element;
+                result = true;
+            }
+        }
+
+        return (result);
+    }
+
+    Element Find(const uint32_t handle) const
+    {
+        const uint32_t index = (handle & IndexMask);
+
+        return (((handle != 0) && (index < _slots.size()) && (_slots[index].Handle == handle)) ? _slots[index].Item : Element());
+    }
+
+    bool Remove(const uint32_t handle)
+    {
+        bool result = false;
+        const uint32_t index = (handle & IndexMask);
+
+        if ((handle != 0) && (index < _slots.size()) && (_slots[index].Handle == handle)) {
+            Slot& slot(_slots[index]);
+
+            slot.Handle = 0;
+            slot.Item.reset();
+
+            // Reserved slots wait for their well-known id, a slot that would wrap its
+            // generation is retired so none of its old handles can ever match again.
+            if ((handle & Dynamic) != 0) {
+                if (slot.Generation < GenerationMask) {
+                    slot.Generation++;
+                    _free.push_back(index);
+                }
+            }
+
+            result = true;
+        }
+
+        return (result);
+    }
+
+private:
+    std::vector<Slot> _slots;
+    std::deque<uint32_t> _free;
+};
+
+} // namespace Implementation
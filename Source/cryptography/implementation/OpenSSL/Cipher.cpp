@@ -66,9 +66,10 @@ public:
     Cipher() = delete;
 
     Cipher(const Implementation::Vault* vault, const EVP_CIPHER* cipher, const uint32_t keyId, const uint8_t keyLength, const uint8_t ivLength)
-        : _context(nullptr)
+        : _encryptContext(nullptr)
+        , _decryptContext(nullptr)
         , _vault(vault)
-        , _cipher(cipher)
+        , _key(vault->Find(keyId))
         , _keyId(keyId)
         , _keyLength(keyLength)
         , _ivLength(ivLength)
@@ -79,38 +80,75 @@ public:
         ASSERT(keyLength != 0);
         ASSERT(ivLength != 0);
 
-        _context = EVP_CIPHER_CTX_new();
-        ASSERT(_context != nullptr);
+        _encryptContext = EVP_CIPHER_CTX_new();
+        ASSERT(_encryptContext != nullptr);
+
+        _decryptContext = EVP_CIPHER_CTX_new();
+        ASSERT(_decryptContext != nullptr);
+
+        // Expand the key schedule once, the operations only (re)set the IV.
+        uint8_t* keyBuf = reinterpret_cast<uint8_t*>(ALLOCA(_keyLength));
+        ASSERT(keyBuf != nullptr);
+
+        uint16_t length = _vault->Export(_keyId, _keyLength, keyBuf, true);
+        ASSERT(length != 0);
+
+        if (length != _keyLength) {
+            TRACE_L1("Failed to retrieve a valid encryption key from id 0x%08x", _keyId);
+            Clear();
+        } else {
+            ERR_clear_error();
+
+            if ((EVP_CipherInit_ex(_encryptContext, cipher, nullptr, keyBuf, nullptr, 1) == 0)
+                || (EVP_CipherInit_ex(_decryptContext, cipher, nullptr, keyBuf, nullptr, 0) == 0)) {
+                TRACE_L1("EVP_CipherInit_ex() failed: %s", GetSSLError().c_str());
+                Clear();
+            }
+        }
+
+        ::memset(keyBuf, 0x00, _keyLength);
     }
 
     ~Cipher() override
     {
-        if (_context != nullptr) {
-            EVP_CIPHER_CTX_free(_context);
-        }
+        Clear();
     }
 
     int32_t Encrypt(const uint8_t ivLength, const uint8_t iv[],
         const uint32_t inputLength, const uint8_t input[],
         const uint32_t maxOutputLength, uint8_t output[]) const override
     {
-        return (Operation(true, ivLength, iv, inputLength, input, maxOutputLength, output));
+        return (Operation(_encryptContext, ivLength, iv, inputLength, input, maxOutputLength, output));
     }
 
     int32_t Decrypt(const uint8_t ivLength, const uint8_t iv[],
         const uint32_t inputLength, const uint8_t input[],
         const uint32_t maxOutputLength, uint8_t output[]) const override
     {
-        return (Operation(false, ivLength, iv, inputLength, input, maxOutputLength, output));
+        return (Operation(_decryptContext, ivLength, iv, inputLength, input, maxOutputLength, output));
     }
 
 private:
-    int32_t Operation(bool encrypt,
+    void Clear()
+    {
+        // EVP_CIPHER_CTX_free() also cleanses the expanded key.
+        if (_encryptContext != nullptr) {
+            EVP_CIPHER_CTX_free(_encryptContext);
+            _encryptContext = nullptr;
+        }
+        if (_decryptContext != nullptr) {
+            EVP_CIPHER_CTX_free(_decryptContext);
+            _decryptContext = nullptr;
+        }
+    }
+
+    int32_t Operation(EVP_CIPHER_CTX* context,
         const uint8_t ivLength, const uint8_t iv[],
         const uint32_t inputLength, const uint8_t input[],
         const uint32_t maxOutputLength, uint8_t output[]) const
     {
         int32_t result = 0;
+        const HandleTable<Vault::Element>::Element key(_key.lock());
 
         ASSERT(iv != nullptr);
         ASSERT(ivLength != 0);
@@ -123,38 +161,31 @@ private:
             // Note: Pitfall, AES CBC/ECB will use padding
             TRACE_L1("Too small output buffer, expected: %i bytes", inputLength);
             result = (-static_cast<int32_t>(inputLength + (16 - (inputLength % 16))));
+        } else if (context == nullptr) {
+            TRACE_L1("No valid encryption key for id 0x%08x", _keyId);
+        } else if ((key == nullptr) || (_vault->Find(_keyId) != key)) {
+            TRACE_L1("Encryption key 0x%08x has been deleted from the vault", _keyId);
         } else {
-            uint8_t* keyBuf = reinterpret_cast<uint8_t*>(ALLOCA(_keyLength));
-            ASSERT(keyBuf != nullptr);
+            ERR_clear_error();
+            int len = 0;
 
-            uint16_t length = _vault->Export(_keyId, _keyLength, keyBuf, true);
-            ASSERT(length != 0);
-
-            if (length != _keyLength) {
-                TRACE_L1("Failed to retrieve a valid encryption key from id 0x%08x", _keyId);
+            // Keep the cipher and the expanded key, only reset the IV (and the operation state).
+            if (EVP_CipherInit_ex(context, nullptr, nullptr, nullptr, iv, -1) == 0) {
+                TRACE_L1("EVP_CipherInit_ex() failed: %s", GetSSLError().c_str());
             } else {
-                ERR_clear_error();
-                int len = 0;
-                int initResult = EVP_CipherInit_ex(_context, _cipher, nullptr, keyBuf, iv, encrypt);
-                ::memset(keyBuf, 0x00, length);
-
-                if (initResult == 0) {
-                    TRACE_L1("EVP_CipherInit_ex() failed: %s", GetSSLError().c_str());
+                if (EVP_CipherUpdate(context, output, &len, input, inputLength) == 0) {
+                    TRACE_L1("EVP_CipherUpdate() failed: %s", GetSSLError().c_str());
                 } else {
-                    if (EVP_CipherUpdate(_context, output, &len, input, inputLength) == 0) {
-                        TRACE_L1("EVP_CipherUpdate() failed: %s", GetSSLError().c_str());
+                    result = len;
+                    len = 0;
+                    // Note: EVP_CipherFinal_ex() can still write to the output buffer!
+                    if (EVP_CipherFinal_ex(context, (output + result), &len) == 0) {
+                        TRACE_L1("EVP_CipherFinal_ex() failed: %s", GetSSLError().c_str());
+                        result = 0;
                     } else {
-                        result = len;
-                        len = 0;
-                        // Note: EVP_CipherFinal_ex() can still write to the output buffer!
-                        if (EVP_CipherFinal_ex(_context, (output + result), &len) == 0) {
-                            TRACE_L1("EVP_CipherFinal_ex() failed: %s", GetSSLError().c_str());
-                            result = 0;
-                        } else {
-                            result += len;
-                            TRACE_L2("Completed %scryption, input size: %i, output size: %i",
-                                (encrypt ? "en" : "de"), inputLength, result);
-                        }
+                        result += len;
+                        TRACE_L2("Completed %scryption, input size: %i, output size: %i",
+                            (context == _encryptContext ? "en" : "de"), inputLength, result);
                     }
                 }
             }
@@ -164,9 +195,10 @@ private:
     }
 
 private:
-    EVP_CIPHER_CTX* _context;
+    EVP_CIPHER_CTX* _encryptContext;
+    EVP_CIPHER_CTX* _decryptContext;
     const Implementation::Vault* _vault;
-    const EVP_CIPHER* _cipher;
+    std::weak_ptr<const Implementation::Vault::Element> _key;
     uint32_t _keyId;
     uint8_t _keyLength;
     uint8_t _ivLength;
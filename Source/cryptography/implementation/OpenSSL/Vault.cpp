@@ -113,21 +113,20 @@ POP_WARNING()
 
                         NetflixData* data = reinterpret_cast<NetflixData*>(netflix_data);
 
-                        VARIABLE_IS_NOT_USED uint32_t kpeId = vault.Import(sizeof(NetflixData::kpe), data->kpe, false);
+                        VARIABLE_IS_NOT_USED uint32_t kpeId = vault.Import(sizeof(NetflixData::kpe), data->kpe, false, Netflix::KPE_ID);
                         ASSERT(kpeId == Netflix::KPE_ID);
 
-                        VARIABLE_IS_NOT_USED uint32_t kphId = vault.Import(sizeof(NetflixData::kph), data->kph, false);
+                        VARIABLE_IS_NOT_USED uint32_t kphId = vault.Import(sizeof(NetflixData::kph), data->kph, false, Netflix::KPH_ID);
                         ASSERT(kphId == Netflix::KPH_ID);
 
                         uint8_t kpw[32];
                         // kpe and kph are already concatenated in the correct order
                         Netflix::DeriveWrappingKey(data->kpe, (sizeof(data->kpe) + sizeof(data->kph)), sizeof(kpw), kpw);
-                        VARIABLE_IS_NOT_USED uint32_t kdwId = vault.Import(16, kpw, false); // take the first 16 bytes only!
+                        VARIABLE_IS_NOT_USED uint32_t kdwId = vault.Import(16, kpw, false, Netflix::KPW_ID); // take the first 16 bytes only!
                         ASSERT(kdwId == Netflix::KPW_ID);
 
                         // Let's (ab)use the vault to hold the ESN as well
-                        vault._lastHandle = (Netflix::ESN_ID - 1);
-                        VARIABLE_IS_NOT_USED uint32_t esnId = vault.Import((netflix_data_size - sizeof(NetflixData)), data->esn, true);
+                        VARIABLE_IS_NOT_USED uint32_t esnId = vault.Import((netflix_data_size - sizeof(NetflixData)), data->esn, true, Netflix::ESN_ID);
                         ASSERT(esnId == Netflix::ESN_ID);
 
                         TRACE_L1("Imported pre-shared keys and ESN () into the Netflix vault");
@@ -173,21 +172,20 @@ POP_WARNING()
                 if (blobSize >= sizeof(NetflixData)) {
                     NetflixData* data = reinterpret_cast<NetflixData*>(decryptedBlob);
 
-                    VARIABLE_IS_NOT_USED uint32_t kpeId = vault.Import(sizeof(NetflixData::kpe), data->kpe, false);
+                    VARIABLE_IS_NOT_USED uint32_t kpeId = vault.Import(sizeof(NetflixData::kpe), data->kpe, false, Netflix::KPE_ID);
                     ASSERT(kpeId == Netflix::KPE_ID);
 
-                    VARIABLE_IS_NOT_USED uint32_t kphId = vault.Import(sizeof(NetflixData::kph), data->kph, false);
+                    VARIABLE_IS_NOT_USED uint32_t kphId = vault.Import(sizeof(NetflixData::kph), data->kph, false, Netflix::KPH_ID);
                     ASSERT(kphId == Netflix::KPH_ID);
 
                     uint8_t kpw[32];
                     // kpe and kph are already concatenated in the correct order
                     Netflix::DeriveWrappingKey(data->kpe, (sizeof(data->kpe) + sizeof(data->kph)), sizeof(kpw), kpw);
-                    VARIABLE_IS_NOT_USED uint32_t kdwId = vault.Import(16, kpw, false); // take the first 16 bytes only!
+                    VARIABLE_IS_NOT_USED uint32_t kdwId = vault.Import(16, kpw, false, Netflix::KPW_ID); // take the first 16 bytes only!
                     ASSERT(kdwId == Netflix::KPW_ID);
 
                     // Let's (ab)use the vault to hold the ESN as well
-                    vault._lastHandle = (Netflix::ESN_ID - 1);
-                    VARIABLE_IS_NOT_USED uint32_t esnId = vault.Import((blobSize - sizeof(NetflixData)), data->esn, true);
+                    VARIABLE_IS_NOT_USED uint32_t esnId = vault.Import((blobSize - sizeof(NetflixData)), data->esn, true, Netflix::ESN_ID);
                     ASSERT(esnId == Netflix::ESN_ID);
 
                     TRACE_L1("Imported pre-shared keys and ESN into the Netflix vault");
@@ -222,15 +220,12 @@ POP_WARNING()
 Vault::Vault(const string key, const Callback& ctor, const Callback& dtor)
     : _lock()
     , _items()
-    , _lastHandle(0)
     , _vaultKey(key)
     , _dtor(dtor)
 {
     if (ctor != nullptr) {
         ctor(*this);
     }
-
-    _lastHandle = 0x80000000;
 }
 
 Vault::~Vault()
@@ -298,17 +293,26 @@ uint16_t Vault::Cipher(bool encrypt, const uint16_t inSize, const uint8_t input[
     return (result);
 }
 
+HandleTable<Vault::Element>::Element Vault::Find(const uint32_t id) const
+{
+    // Only the lookup needs the lock, the element itself is immutable.
+    _lock.Lock();
+    HandleTable<Element>::Element element(_items.Find(id));
+    _lock.Unlock();
+
+    return (element);
+}
+
 uint16_t Vault::Size(const uint32_t id, bool allowSealed) const
 {
     uint16_t size = 0;
 
-    _lock.Lock();
-    auto it = _items.find(id);
-    if (it != _items.end()) {
-        if ((allowSealed == true) || (*it).second.IsExportable() == true) {
-            size = ((*it).second.Size() - IV_SIZE);
+    HandleTable<Element>::Element element(Find(id));
+    if (element != nullptr) {
+        if ((allowSealed == true) || element->IsExportable() == true) {
+            size = (element->Size() - IV_SIZE);
             TRACE_L2("%sBlob id 0x%08x size: %i",
-                (((allowSealed == true) || ((*it).second.IsExportable() == false)) ? "Internal: " : ""), id, size);
+                (((allowSealed == true) || (element->IsExportable() == false)) ? "Internal: " : ""), id, size);
         } else {
             TRACE_L2("Blob id 0x%08x is sealed, won't tell its size", id);
             size = USHRT_MAX;
@@ -316,35 +320,39 @@ uint16_t Vault::Size(const uint32_t id, bool allowSealed) const
     } else {
         TRACE_L1("Failed to look up blob id 0x%08x", id);
     }
-    _lock.Unlock();
 
     return (size);
 }
 
 uint32_t Vault::Import(const uint16_t size, const uint8_t blob[], bool exportable)
 {
-    uint32_t id = 0;
-
-    if (size > 0) {
-        _lock.Lock();
-        id = (_lastHandle + 1);
+    return (Import(size, blob, exportable, 0));
+}
 
-        if (id != 0) {
-            uint8_t* buf = reinterpret_cast<uint8_t*>(ALLOCA(USHRT_MAX));
-            uint16_t len = Cipher(true, size, blob, USHRT_MAX, buf);
+uint32_t Vault::Import(const uint16_t size, const uint8_t blob[], bool exportable, const uint32_t id)
+{
+    uint32_t result = 0;
 
-            _items.emplace(std::piecewise_construct,
-                std::forward_as_tuple(id),
-                std::forward_as_tuple(exportable, len, buf));
+    if (size > 0) {
+        uint8_t* buf = reinterpret_cast<uint8_t*>(ALLOCA(USHRT_MAX));
+        uint16_t len = Cipher(true, size, blob, USHRT_MAX, buf);
 
-            _lastHandle = id;
+        HandleTable<Element>::Element element(std::make_shared<const Element>(exportable, len, buf));
 
-            TRACE_L2("Added a %s data blob of size %i as id 0x%08x", (exportable ? "clear" : "sealed"), (len - IV_SIZE), id);
+        _lock.Lock();
+        if (id == 0) {
+            result = _items.Add(element);
+        } else if (_items.Add(id, element) == true) {
+            result = id;
         }
         _lock.Unlock();
+
+        if (result != 0) {
+            TRACE_L2("Added a %s data blob of size %i as id 0x%08x", (exportable ? "clear" : "sealed"), (len - IV_SIZE), result);
+        }
     }
 
-    return (id);
+    return (result);
 }
 
 uint16_t Vault::Export(const uint32_t id, const uint16_t size, uint8_t blob[], bool allowSealed) const
@@ -352,21 +360,19 @@ uint16_t Vault::Export(const uint32_t id, const uint16_t size, uint8_t blob[], b
     uint16_t outSize = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        auto it = _items.find(id);
-        if (it != _items.end()) {
-            if ((allowSealed == true) || ((*it).second.IsExportable() == true)) {
-                outSize = Cipher(false, (*it).second.Size(), (*it).second.Buffer(), size, blob);
+        HandleTable<Element>::Element element(Find(id));
+        if (element != nullptr) {
+            if ((allowSealed == true) || (element->IsExportable() == true)) {
+                outSize = Cipher(false, element->Size(), element->Buffer(), size, blob);
 
                 TRACE_L2("%sExported %i bytes from blob id 0x%08x",
-                    (((allowSealed == true) || ((*it).second.IsExportable() == false)) ? "Internal: " : ""), outSize, id);
+                    (((allowSealed == true) || (element->IsExportable() == false)) ? "Internal: " : ""), outSize, id);
             } else {
                 TRACE_L1("Blob id 0x%08x is sealed, can't export", id);
             }
         } else {
             TRACE_L1("Failed to look up blob id 0x%08x", id);
         }
-        _lock.Unlock();
     }
 
     return (outSize);
@@ -377,18 +383,15 @@ uint32_t Vault::Put(const uint16_t size, const uint8_t blob[])
     uint32_t id = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        id = (_lastHandle + 1);
-        if (id != 0) {
-            _items.emplace(std::piecewise_construct,
-                std::forward_as_tuple(id),
-                std::forward_as_tuple(false, size, blob));
+        HandleTable<Element>::Element element(std::make_shared<const Element>(false, size, blob));
 
-            _lastHandle = id;
+        _lock.Lock();
+        id = _items.Add(element);
+        _lock.Unlock();
 
+        if (id != 0) {
             TRACE_L2("Inserted a sealed data blob of size %i as id 0x%08x", size, id);
         }
-        _lock.Unlock();
     }
 
     return (id);
@@ -399,14 +402,12 @@ uint16_t Vault::Get(const uint32_t id, const uint16_t size, uint8_t blob[]) cons
     uint16_t result = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        auto it = _items.find(id);
-        if (it != _items.end()) {
-            result = std::min(size, static_cast<uint16_t>((*it).second.Size()));
-            ::memcpy(blob, (*it).second.Buffer(), result);
+        HandleTable<Element>::Element element(Find(id));
+        if (element != nullptr) {
+            result = std::min(size, static_cast<uint16_t>(element->Size()));
+            ::memcpy(blob, element->Buffer(), result);
             TRACE_L2("Retrieved a sealed data blob id 0x%08x of size %i bytes", id, result);
         }
-        _lock.Unlock();
     }
 
     return (result);
@@ -436,14 +437,8 @@ uint32_t Vault::Generate(const uint16_t size)
 
 bool Vault::Delete(const uint32_t id)
 {
-    bool result = false;
-
     _lock.Lock();
-    auto it = _items.find(id);
-    if (it != _items.end()) {
-        _items.erase(it);
-        result = true;
-    }
+    bool result = _items.Remove(id);
     _lock.Unlock();
 
     return (result);
@@ -18,7 +18,7 @@
  */
 
 #include "../../Module.h"
-#include <map>
+#include <HandleTable.h>
 #include <climits>
 
 
@@ -72,14 +72,16 @@ public:
     uint16_t Get(const uint32_t id, const uint16_t size, uint8_t blob[]) const;
     uint32_t Generate(const uint16_t length);
     bool Delete(const uint32_t id);
+    // The element itself identifies the blob, a well-known id can be deleted and taken again.
+    HandleTable<Element>::Element Find(const uint32_t id) const;
 
 private:
+    uint32_t Import(const uint16_t size, const uint8_t blob[], bool exportable, const uint32_t id);
     uint16_t Cipher(bool encrypt, const uint16_t inSize, const uint8_t input[], const uint16_t maxOutSize, uint8_t output[]) const;
 
 private:
     mutable Thunder::Core::CriticalSection _lock;
-    std::map<uint32_t, Element> _items;
-    uint32_t _lastHandle;
+    HandleTable<Element> _items;
     string _vaultKey;
     Callback _dtor;
 };
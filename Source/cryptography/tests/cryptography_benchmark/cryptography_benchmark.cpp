@@ -0,0 +1,526 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME CryptographyBenchmark
+#endif
+
+#include <benchmark/benchmark.h>
+
+#include <com/com.h>
+#include <core/core.h>
+
+#include <cryptography.h>
+
+#include <cstring>
+#include <vector>
+
+// Set by the build, from where the Thunder it is built against is installed.
+#ifndef PROXYSTUB_PATH
+#error "PROXYSTUB_PATH should point to the installed Thunder proxy stubs"
+#endif
+
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+// Throughput and latency of the cryptography library. Every benchmark runs
+// against the library in-process (LOCAL) and through COM-RPC (REMOTE), the
+// latter against an in-process server that hands out the local implementation,
+// so the difference between the two is the cost of the RPC layer.
+//
+// Results are written as JSON to stdout, unless another --benchmark_format is
+// given. Usage: cgbenchmark [benchmark options] [proxystub path]
+namespace {
+
+    constexpr TCHAR Connector[] = _T("/tmp/cryptographybenchmark");
+    constexpr TCHAR ProxyStubPath[] = _T(PROXYSTUB_PATH);
+
+    // Payloads over COM-RPC are copied in a single frame, keep these modest.
+    constexpr uint32_t MaxLocalPayload = (4 * 1024 * 1024);
+    constexpr uint32_t MaxRemotePayload = (64 * 1024);
+
+    const uint8_t Key[] = {
+        0x7C, 0xF3, 0xA6, 0x2F, 0xB3, 0xC6, 0xB6, 0x43,
+        0x68, 0xFE, 0xD5, 0xD8, 0x1C, 0x0A, 0xEC, 0x26
+    };
+
+    const uint8_t IV[] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+    };
+
+    const uint8_t HMACKey[] = {
+        0x7C, 0xF3, 0xA6, 0x2F, 0xB3, 0xC6, 0xB6, 0x43,
+        0xA4, 0x2B, 0x18, 0x9B, 0x97, 0xBC, 0x59, 0x5D,
+        0x51, 0x77, 0x51, 0xEC, 0x7C, 0x8B, 0x4B, 0xFE,
+        0x68, 0xFE, 0xD5, 0xD8, 0x1C, 0x0A, 0xEC, 0x26
+    };
+
+    // RFC 2409, 1024-bit MODP group (Oakley group 2), generator 2.
+    constexpr uint8_t DHGenerator = 2;
+    const uint8_t DHModulus[] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xC9, 0x0F, 0xDA, 0xA2, 0x21, 0x68, 0xC2, 0x34,
+        0xC4, 0xC6, 0x62, 0x8B, 0x80, 0xDC, 0x1C, 0xD1, 0x29, 0x02, 0x4E, 0x08, 0x8A, 0x67, 0xCC, 0x74,
+        0x02, 0x0B, 0xBE, 0xA6, 0x3B, 0x13, 0x9B, 0x22, 0x51, 0x4A, 0x08, 0x79, 0x8E, 0x34, 0x04, 0xDD,
+        0xEF, 0x95, 0x19, 0xB3, 0xCD, 0x3A, 0x43, 0x1B, 0x30, 0x2B, 0x0A, 0x6D, 0xF2, 0x5F, 0x14, 0x37,
+        0x4F, 0xE1, 0x35, 0x6D, 0x6D, 0x51, 0xC2, 0x45, 0xE4, 0x85, 0xB5, 0x76, 0x62, 0x5E, 0x7E, 0xC6,
+        0xF4, 0x4C, 0x42, 0xE9, 0xA6, 0x37, 0xED, 0x6B, 0x0B, 0xFF, 0x5C, 0xB6, 0xF4, 0x06, 0xB7, 0xED,
+        0xEE, 0x38, 0x6B, 0xFB, 0x5A, 0x89, 0x9F, 0xA5, 0xAE, 0x9F, 0x24, 0x11, 0x7C, 0x4B, 0x1F, 0xE6,
+        0x49, 0x28, 0x66, 0x51, 0xEC, 0xE6, 0x53, 0x81, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+    };
+
+    const Exchange::aesmode AESModes[] = {
+        Exchange::aesmode::ECB,
+        Exchange::aesmode::CBC,
+        Exchange::aesmode::OFB,
+        Exchange::aesmode::CFB1,
+        Exchange::aesmode::CFB8,
+        Exchange::aesmode::CFB128,
+        Exchange::aesmode::CTR
+    };
+
+    const Exchange::hashtype HashTypes[] = {
+        Exchange::hashtype::SHA1,
+        Exchange::hashtype::SHA224,
+        Exchange::hashtype::SHA256,
+        Exchange::hashtype::SHA384,
+        Exchange::hashtype::SHA512
+    };
+
+    enum path : uint8_t {
+        LOCAL = 0,
+        REMOTE = 1
+    };
+
+    class StubServer : public RPC::Communicator {
+    public:
+        StubServer() = delete;
+        StubServer(const StubServer&) = delete;
+        StubServer& operator=(const StubServer&) = delete;
+
+        StubServer(const Core::NodeId& node, const string& proxyStubPath, Exchange::ICryptography* cryptography)
+            : RPC::Communicator(node, proxyStubPath, Core::ProxyType<Core::IIPCServer>(Core::ProxyType<RPC::InvokeServerType<4, 0, 8>>::Create()))
+            , _cryptography(cryptography)
+        {
+            Open(Core::infinite);
+        }
+        ~StubServer() override
+        {
+            Close(Core::infinite);
+        }
+
+    private:
+        void* Acquire(const string&, const uint32_t interfaceId, const uint32_t) override
+        {
+            void* result = nullptr;
+
+            if (interfaceId == Exchange::ICryptography::ID) {
+                _cryptography->AddRef();
+                result = _cryptography;
+            }
+
+            return (result);
+        }
+
+    private:
+        Exchange::ICryptography* _cryptography;
+    };
+
+    // The interfaces the benchmarks run against, one set per path.
+    struct Endpoint {
+        Exchange::ICryptography* Cryptography;
+        Exchange::IVault* Vault;
+    };
+
+    Endpoint Endpoints[2] = { { nullptr, nullptr }, { nullptr, nullptr } };
+
+    template <path PATH>
+    Exchange::IVault* Vault(benchmark::State& state)
+    {
+        Exchange::IVault* vault = Endpoints[PATH].Vault;
+
+        if (vault == nullptr) {
+            state.SkipWithError((PATH == LOCAL) ? "local vault not available" : "remote vault not available");
+        }
+
+        return (vault);
+    }
+
+    void PayloadSizes(benchmark::internal::Benchmark* benchmark, const uint32_t maxSize)
+    {
+        for (uint8_t index = 0; index < (sizeof(AESModes) / sizeof(AESModes[0])); index++) {
+            for (uint32_t size = 16; size <= maxSize; size *= 4) {
+                benchmark->Args({ index, size });
+            }
+        }
+    }
+
+    void LocalAESArguments(benchmark::internal::Benchmark* benchmark)
+    {
+        PayloadSizes(benchmark, MaxLocalPayload);
+    }
+
+    void RemoteAESArguments(benchmark::internal::Benchmark* benchmark)
+    {
+        PayloadSizes(benchmark, MaxRemotePayload);
+    }
+
+    void HashArguments(benchmark::internal::Benchmark* benchmark, const uint32_t maxSize)
+    {
+        for (uint8_t index = 0; index < (sizeof(HashTypes) / sizeof(HashTypes[0])); index++) {
+            for (uint32_t size = 16; size <= maxSize; size *= 16) {
+                benchmark->Args({ index, size });
+            }
+        }
+    }
+
+    void LocalHashArguments(benchmark::internal::Benchmark* benchmark)
+    {
+        HashArguments(benchmark, MaxLocalPayload);
+    }
+
+    void RemoteHashArguments(benchmark::internal::Benchmark* benchmark)
+    {
+        HashArguments(benchmark, MaxRemotePayload);
+    }
+
+}
+
+// AES throughput, per mode and payload size, on a cipher created once.
+template <path PATH>
+static void AES(benchmark::State& state)
+{
+    Exchange::IVault* vault = Vault<PATH>(state);
+
+    if (vault != nullptr) {
+        const Exchange::aesmode mode = AESModes[state.range(0)];
+        const uint32_t size = static_cast<uint32_t>(state.range(1));
+        const uint32_t keyId = vault->Import(sizeof(Key), Key);
+        Exchange::ICipher* aes = (keyId != 0 ? vault->AES(mode, keyId) : nullptr);
+
+        if (aes == nullptr) {
+            state.SkipWithError("failed to create the cipher");
+        } else {
+            std::vector<uint8_t> input(size, 0xA5);
+            std::vector<uint8_t> output(size + sizeof(IV));
+
+            for (auto _ : state) {
+                int32_t length = aes->Encrypt(sizeof(IV), IV, size, input.data(), static_cast<uint32_t>(output.size()), output.data());
+                benchmark::DoNotOptimize(length);
+            }
+
+            state.SetBytesProcessed(state.iterations() * size);
+
+            aes->Release();
+        }
+
+        if (keyId != 0) {
+            vault->Delete(keyId);
+        }
+    }
+}
+
+// Latency of a one-shot AES operation, including the creation of the cipher
+// from a vault held key.
+template <path PATH>
+static void AESOneShot(benchmark::State& state)
+{
+    Exchange::IVault* vault = Vault<PATH>(state);
+
+    if (vault != nullptr) {
+        const uint32_t keyId = vault->Import(sizeof(Key), Key);
+        uint8_t input[16] = {};
+        uint8_t output[32];
+
+        for (auto _ : state) {
+            Exchange::ICipher* aes = vault->AES(Exchange::aesmode::CBC, keyId);
+
+            if (aes == nullptr) {
+                state.SkipWithError("failed to create the cipher");
+                break;
+            }
+
+            int32_t length = aes->Encrypt(sizeof(IV), IV, sizeof(input), input, sizeof(output), output);
+            benchmark::DoNotOptimize(length);
+
+            aes->Release();
+        }
+
+        vault->Delete(keyId);
+    }
+}
+
+// Digest of a payload, including the creation of the hash.
+template <path PATH>
+static void Hash(benchmark::State& state)
+{
+    Exchange::ICryptography* cryptography = Endpoints[PATH].Cryptography;
+
+    if (cryptography == nullptr) {
+        state.SkipWithError("cryptography not available");
+    } else {
+        const Exchange::hashtype type = HashTypes[state.range(0)];
+        const uint32_t size = static_cast<uint32_t>(state.range(1));
+        std::vector<uint8_t> input(size, 0xA5);
+        uint8_t digest[64];
+
+        for (auto _ : state) {
+            Exchange::IHash* hash = cryptography->Hash(type);
+
+            if (hash == nullptr) {
+                state.SkipWithError("failed to create the hash");
+                break;
+            }
+
+            hash->Ingest(size, input.data());
+            uint8_t length = hash->Calculate(sizeof(digest), digest);
+            benchmark::DoNotOptimize(length);
+
+            hash->Release();
+        }
+
+        state.SetBytesProcessed(state.iterations() * size);
+    }
+}
+
+// HMAC of a payload with a vault held key, including the creation of the hash.
+template <path PATH>
+static void HMAC(benchmark::State& state)
+{
+    Exchange::IVault* vault = Vault<PATH>(state);
+
+    if (vault != nullptr) {
+        const Exchange::hashtype type = HashTypes[state.range(0)];
+        const uint32_t size = static_cast<uint32_t>(state.range(1));
+        const uint32_t keyId = vault->Import(sizeof(HMACKey), HMACKey);
+        std::vector<uint8_t> input(size, 0xA5);
+        uint8_t digest[64];
+
+        for (auto _ : state) {
+            Exchange::IHash* hash = vault->HMAC(type, keyId);
+
+            if (hash == nullptr) {
+                state.SkipWithError("failed to create the HMAC");
+                break;
+            }
+
+            hash->Ingest(size, input.data());
+            uint8_t length = hash->Calculate(sizeof(digest), digest);
+            benchmark::DoNotOptimize(length);
+
+            hash->Release();
+        }
+
+        state.SetBytesProcessed(state.iterations() * size);
+
+        vault->Delete(keyId);
+    }
+}
+
+// Vault administration: import, export and delete a key.
+template <path PATH>
+static void VaultChurn(benchmark::State& state)
+{
+    Exchange::IVault* vault = Vault<PATH>(state);
+
+    if (vault != nullptr) {
+        uint8_t output[sizeof(Key)];
+
+        for (auto _ : state) {
+            const uint32_t keyId = vault->Import(sizeof(Key), Key);
+
+            if (keyId == 0) {
+                state.SkipWithError("failed to import the key");
+                break;
+            }
+
+            uint16_t length = vault->Export(keyId, sizeof(output), output);
+            benchmark::DoNotOptimize(length);
+
+            vault->Delete(keyId);
+        }
+    }
+}
+
+template <path PATH>
+static void DHGenerate(benchmark::State& state)
+{
+    Exchange::IVault* vault = Vault<PATH>(state);
+    Exchange::IDiffieHellman* dh = (vault != nullptr ? vault->DiffieHellman() : nullptr);
+
+    if (dh == nullptr) {
+        state.SkipWithError("Diffie-Hellman not available");
+    } else {
+        for (auto _ : state) {
+            uint32_t privateKeyId = 0;
+            uint32_t publicKeyId = 0;
+
+            if (dh->Generate(DHGenerator, sizeof(DHModulus), DHModulus, privateKeyId, publicKeyId) != 0) {
+                state.SkipWithError("failed to generate a key pair");
+                break;
+            }
+
+            state.PauseTiming();
+            vault->Delete(privateKeyId);
+            vault->Delete(publicKeyId);
+            state.ResumeTiming();
+        }
+
+        dh->Release();
+    }
+}
+
+template <path PATH>
+static void DHDerive(benchmark::State& state)
+{
+    Exchange::IVault* vault = Vault<PATH>(state);
+    Exchange::IDiffieHellman* dh = (vault != nullptr ? vault->DiffieHellman() : nullptr);
+
+    if (dh == nullptr) {
+        state.SkipWithError("Diffie-Hellman not available");
+    } else {
+        uint32_t privateKeyId = 0;
+        uint32_t publicKeyId = 0;
+        uint32_t peerPrivateKeyId = 0;
+        uint32_t peerPublicKeyId = 0;
+
+        if ((dh->Generate(DHGenerator, sizeof(DHModulus), DHModulus, privateKeyId, publicKeyId) != 0)
+            || (dh->Generate(DHGenerator, sizeof(DHModulus), DHModulus, peerPrivateKeyId, peerPublicKeyId) != 0)) {
+            state.SkipWithError("failed to generate the key pairs");
+        } else {
+            for (auto _ : state) {
+                uint32_t secretId = 0;
+
+                if (dh->Derive(privateKeyId, peerPublicKeyId, secretId) != 0) {
+                    state.SkipWithError("failed to derive the secret");
+                    break;
+                }
+
+                state.PauseTiming();
+                vault->Delete(secretId);
+                state.ResumeTiming();
+            }
+        }
+
+        vault->Delete(privateKeyId);
+        vault->Delete(publicKeyId);
+        vault->Delete(peerPrivateKeyId);
+        vault->Delete(peerPublicKeyId);
+
+        dh->Release();
+    }
+}
+
+// Cost of getting hold of the library (and for REMOTE, the connection to it).
+template <path PATH>
+static void Instance(benchmark::State& state)
+{
+    const string connectionPoint = (PATH == LOCAL ? string() : string(Connector));
+
+    if (Endpoints[PATH].Cryptography == nullptr) {
+        state.SkipWithError("cryptography not available");
+    } else {
+        for (auto _ : state) {
+            Exchange::ICryptography* cryptography = Exchange::ICryptography::Instance(connectionPoint);
+
+            if (cryptography == nullptr) {
+                state.SkipWithError("failed to get the cryptography instance");
+                break;
+            }
+
+            cryptography->Release();
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(AES, LOCAL)->Apply(LocalAESArguments);
+BENCHMARK_TEMPLATE(AES, REMOTE)->Apply(RemoteAESArguments);
+BENCHMARK_TEMPLATE(AESOneShot, LOCAL);
+BENCHMARK_TEMPLATE(AESOneShot, REMOTE);
+BENCHMARK_TEMPLATE(Hash, LOCAL)->Apply(LocalHashArguments);
+BENCHMARK_TEMPLATE(Hash, REMOTE)->Apply(RemoteHashArguments);
+BENCHMARK_TEMPLATE(HMAC, LOCAL)->Apply(LocalHashArguments);
+BENCHMARK_TEMPLATE(HMAC, REMOTE)->Apply(RemoteHashArguments);
+BENCHMARK_TEMPLATE(VaultChurn, LOCAL);
+BENCHMARK_TEMPLATE(VaultChurn, REMOTE);
+BENCHMARK_TEMPLATE(DHGenerate, LOCAL)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(DHGenerate, REMOTE)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(DHDerive, LOCAL)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(DHDerive, REMOTE)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(Instance, LOCAL);
+BENCHMARK_TEMPLATE(Instance, REMOTE)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv)
+{
+    std::vector<char*> arguments(argv, argv + argc);
+    char json[] = "--benchmark_format=json";
+    bool formatted = false;
+
+    for (int index = 1; index < argc; index++) {
+        formatted = formatted || (::strncmp(argv[index], "--benchmark_format", 18) == 0);
+    }
+    if (formatted == false) {
+        arguments.push_back(json);
+    }
+
+    int count = static_cast<int>(arguments.size());
+    arguments.push_back(nullptr);
+
+    benchmark::Initialize(&count, arguments.data());
+
+    const string proxyStubPath = (count > 1 ? arguments[1] : ProxyStubPath);
+
+    Exchange::ICryptography* local = Exchange::ICryptography::Instance(_T(""));
+
+    if (local != nullptr) {
+        {
+            StubServer server(Core::NodeId(Connector), proxyStubPath, local);
+
+            Endpoints[LOCAL].Cryptography = local;
+            Endpoints[LOCAL].Vault = local->Vault(Exchange::CRYPTOGRAPHY_VAULT_DEFAULT);
+
+            Endpoints[REMOTE].Cryptography = Exchange::ICryptography::Instance(Connector);
+            if (Endpoints[REMOTE].Cryptography != nullptr) {
+                Endpoints[REMOTE].Vault = Endpoints[REMOTE].Cryptography->Vault(Exchange::CRYPTOGRAPHY_VAULT_DEFAULT);
+            }
+
+            benchmark::RunSpecifiedBenchmarks();
+
+            for (Endpoint& endpoint : Endpoints) {
+                if (endpoint.Vault != nullptr) {
+                    endpoint.Vault->Release();
+                    endpoint.Vault = nullptr;
+                }
+            }
+            if (Endpoints[REMOTE].Cryptography != nullptr) {
+                Endpoints[REMOTE].Cryptography->Release();
+                Endpoints[REMOTE].Cryptography = nullptr;
+            }
+            Endpoints[LOCAL].Cryptography = nullptr;
+        }
+
+        // The server is gone, nobody can reach the local instance anymore.
+        local->Release();
+    }
+
+    Core::Singleton::Dispose();
+
+    return (0);
+}
@@ -126,6 +126,33 @@ TEST(Vault, ImportExport)
 }
 
 
+TEST(Vault, StaleHandle)
+{
+    /* A slot is freed and taken again over and over, more often than its generation can count */
+    uint32_t stale = vault_import(vault, sizeof(testVector1), testVector1);
+    EXPECT_NE(stale, 0);
+    EXPECT_NE(vault_delete(vault, stale), false);
+
+    uint32_t hits = 0;
+    uint32_t failures = 0;
+
+    for (uint32_t cycle = 0; cycle < 0x10000; cycle++) {
+        uint32_t id = vault_import(vault, sizeof(testVector2), testVector2);
+
+        if (id == 0) {
+            failures++;
+        } else {
+            if ((id == stale) || (vault_size(vault, stale) != 0)) {
+                hits++;
+            }
+            vault_delete(vault, id);
+        }
+    }
+
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(hits, 0);
+}
+
 static uint32_t TestVaultSet(const uint8_t vector[], const uint16_t vectorSize, bool clear)
 {
     uint8_t* sealed = static_cast<uint8_t*>(malloc(USHRT_MAX));
@@ -706,6 +733,43 @@ TEST(Cipher, AES_Unpadded)
   ===================================
 */
 
+TEST(Cipher, AES_DeletedKey)
+{
+    const uint8_t data[] = "0123456789abcdef";
+    const uint16_t dataSize = sizeof(data) - 1;
+    const uint8_t iv[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+    const uint8_t key1[] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x11 };
+    const uint8_t key2[] = { 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x11, 0x22 };
+    uint8_t output[32];
+
+    uint32_t key1Id = vault_import(vault, sizeof(key1), key1);
+    EXPECT_NE(key1Id, 0);
+    if (key1Id != 0) {
+        struct CipherImplementation* cipher = cipher_create_aes(vault, AES_MODE_CTR, key1Id);
+
+        if (cipher != NULL) {
+            EXPECT_EQ(cipher_encrypt(cipher, sizeof(iv), iv, dataSize, data, sizeof(output), output), dataSize);
+
+            // A key of the same length in the slot of the deleted one must not be picked up.
+            EXPECT_NE(vault_delete(vault, key1Id), false);
+            uint32_t key2Id = vault_import(vault, sizeof(key2), key2);
+            EXPECT_NE(key2Id, 0);
+
+            EXPECT_EQ(cipher_encrypt(cipher, sizeof(iv), iv, dataSize, data, sizeof(output), output), 0);
+            EXPECT_EQ(cipher_decrypt(cipher, sizeof(iv), iv, dataSize, data, sizeof(output), output), 0);
+
+            cipher_destroy(cipher);
+
+            if (key2Id != 0) {
+                EXPECT_NE(vault_delete(vault, key2Id), false);
+            }
+        } else {
+            printf("  FATAL: Failed to create cryptor implementations, deleted key test will be skipped\n");
+            EXPECT_NE(vault_delete(vault, key1Id), false);
+        }
+    }
+}
+
 int main(void)
 {
     CALL(Signing, Hash);
@@ -714,6 +778,7 @@ int main(void)
     if (vault != NULL) {
         CALL(Vault, Common);
         CALL(Vault, ImportExport);
+        CALL(Vault, StaleHandle);
         CALL(Vault, SetGet); // Will not work on Sage
 
         CALL(Signing, Hash);
@@ -724,6 +789,7 @@ int main(void)
 
         CALL(Cipher, AES_Padded);
         CALL(Cipher, AES_Unpadded);
+        CALL(Cipher, AES_DeletedKey);
     }
 
     printf("TOTAL: %i tests; %i PASSED, %i FAILED\n", TotalTests, TotalTestsPassed, (TotalTests - TotalTestsPassed));
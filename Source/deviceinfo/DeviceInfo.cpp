@@ -18,6 +18,9 @@
 */ 
 
 #include "Module.h"
+#include <atomic>
+#include <list>
+#include <memory>
 #include <vector>
 
 #include "deviceinfo.h"
@@ -221,23 +224,66 @@ static string Callsign()
 class DeviceInfoLink : public Thunder::RPC::SmartInterfaceType<Thunder::Exchange::IDeviceInfo> {
 private:
     using BaseClass = Thunder::RPC::SmartInterfaceType<Thunder::Exchange::IDeviceInfo>;
+
+    template <typename TYPE>
+    struct Field {
+        Field()
+            : Status(deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE)
+            , Value()
+        {
+        }
+
+        uint32_t Status;
+        TYPE Value;
+    };
+
     struct AudioOutputCapability {
         deviceinfo_audio_output_t type;
-        std::vector<deviceinfo_audio_capability_t> audioCapabilities;
-        std::vector<deviceinfo_audio_ms12_capability_t> ms12Capabilities;
-        std::vector<deviceinfo_audio_ms12_profile_t> ms12AuioProfiles;
+        Field<std::vector<deviceinfo_audio_capability_t>> audioCapabilities;
+        Field<std::vector<deviceinfo_audio_ms12_capability_t>> ms12Capabilities;
+        Field<std::vector<deviceinfo_audio_ms12_profile_t>> ms12AudioProfiles;
     };
 
     struct VideoOutputCapability {
         deviceinfo_video_output_t type;
-        Core::OptionalType<deviceinfo_hdcp_t> hdcp;
-        std::vector<deviceinfo_output_resolution_t> resolutions;
-        Core::OptionalType<deviceinfo_output_resolution_t> defaultResolution;
-        Core::OptionalType<deviceinfo_output_resolution_t> maxScreenResolution;
+        Field<deviceinfo_hdcp_t> hdcp;
+        Field<std::vector<deviceinfo_output_resolution_t>> resolutions;
+        Field<deviceinfo_output_resolution_t> defaultResolution;
+        Field<deviceinfo_output_resolution_t> maxScreenResolution;
     };
     using AudioOutputMap = std::map<Exchange::IDeviceAudioCapabilities::AudioOutput, AudioOutputCapability>;
     using VideoOutputMap = std::map<Exchange::IDeviceVideoCapabilities::VideoOutput, VideoOutputCapability>;
 
+    // Everything the DeviceInfo plugin reports, fetched in one pass. Once
+    // published, a snapshot is never modified, so readers only need to load
+    // the pointer to the current one. A reconnect retires the current snapshot
+    // (it stays alive, a reader may still be using it) and the next reader
+    // fetches a fresh one.
+    struct Snapshot {
+        Field<std::string> architecture;
+        Field<std::string> chipsetName;
+        Field<std::string> firmwareVersion;
+        Field<std::vector<uint8_t>> id;
+        Field<std::string> idStr;
+        Field<std::string> serialNumber;
+        Field<std::string> sku;
+        Field<std::string> make;
+        Field<std::string> deviceType;
+        Field<std::string> modelName;
+        Field<std::string> modelYear;
+        Field<std::string> systemIntegraterName;
+        Field<std::string> friendlyName;
+        Field<std::string> platformName;
+        Field<std::string> hostEdid;
+        Field<bool> hdr;
+        Field<bool> atmos;
+        Field<bool> cec;
+        Field<std::vector<deviceinfo_audio_output_t>> audioOutputs;
+        Field<std::vector<deviceinfo_video_output_t>> videoOutputs;
+        AudioOutputMap audioOutputMap;
+        VideoOutputMap videoOutputMap;
+    };
+
     DeviceInfoLink()
         : BaseClass()
         , _lock()
@@ -246,24 +292,8 @@ private:
         , _deviceAudioCapabilitiesInterface(nullptr)
         , _deviceVideoCapabilitiesInterface(nullptr)
         , _deviceInfoInterface(nullptr)
-        , _architecture()
-        , _chipsetName()
-        , _serialNumber()
-        , _sku()
-        , _make()
-        , _deviceType()
-        , _modelName()
-        , _modelYear()
-        , _systemIntegraterName()
-        , _friendlyName()
-        , _platformName()
-        , _firmwareVersion()
-        , _idStr()
-        , _hostEdid()
-        , _videoOutputMap()
-        , _audioOutputMap()
-        , _id()
-        , _hdr_atmos_cec(0)
+        , _current(nullptr)
+        , _snapshots()
     {
         ASSERT(_singleton==nullptr);
         
@@ -302,6 +332,9 @@ public:
             _identifierInterface = nullptr;
         }
 
+        _current.store(nullptr);
+        _snapshots.clear();
+
         _lock.Unlock();
 
         _singleton = nullptr;
@@ -338,6 +371,9 @@ private:
                     _deviceVideoCapabilitiesInterface = _deviceInfoInterface->QueryInterface<Exchange::IDeviceVideoCapabilities>();
                 }
             }
+
+            // (Re)connected, whatever we have might be stale or incomplete.
+            _current.store(nullptr, std::memory_order_release);
             
         } else {
             if (_deviceAudioCapabilitiesInterface != nullptr) {
@@ -357,126 +393,180 @@ private:
         _lock.Unlock();
     }
 
-    /*
-    * hdr_atmos_cec variable stores value in this format
-    * ZX1X2X3 ZY1Y2Y3
-    * Z - Unused
-    * X1 - hdr value
-    * X2 - atmos value
-    * X3 - cec value
-    * Y1 - hdr cached
-    * Y2 - atmos cached
-    * Y3 - cec cached
-    */
-    void setHdrSupport(const bool hdr)
+    const Snapshot& Current()
     {
-        _hdr_atmos_cec |= hdr << 6;
-        _hdr_atmos_cec |= 0x04;
-    }
+        const Snapshot* result = _current.load(std::memory_order_acquire);
 
-    void setAtmosSupport(const bool atmos)
-    {
-        _hdr_atmos_cec |= atmos << 5;
-        _hdr_atmos_cec |= 0x02;
-    }
+        if (result == nullptr) {
+            _lock.Lock();
 
-    void setCecSupport(const bool cec)
-    {
-        _hdr_atmos_cec |= cec << 4;
-        _hdr_atmos_cec |= 0x01;
-    }
+            result = _current.load(std::memory_order_relaxed);
 
-    bool getCecSupport() const
-    {
-        return _hdr_atmos_cec & 0x10;
-    }
+            if (result == nullptr) {
+                Snapshot* snapshot = new Snapshot();
 
-    bool getAtmosSupport() const
-    {
-        return _hdr_atmos_cec & 0x20;
-    }
+                Fetch(*snapshot);
 
-    bool getHDRSupport() const
-    {
-        return _hdr_atmos_cec & 0x40;
-    }
+                _snapshots.emplace_back(snapshot);
+                _current.store(snapshot, std::memory_order_release);
 
-    bool isCecSupportCached() const
-    {
-        return _hdr_atmos_cec & 0x01;
-    }
+                result = snapshot;
+            }
 
-    bool isAtmosSupportCached() const
-    {
-        return _hdr_atmos_cec & 0x02;
+            _lock.Unlock();
+        }
+
+        return (*result);
     }
 
-    bool isHDRSupportCached() const
+    template <typename ELEMENT, typename ITERATOR, typename TYPE>
+    static void Drain(ITERATOR* iterator, Field<std::vector<TYPE>>& field)
     {
-        return _hdr_atmos_cec & 0x04;
+        if (iterator != nullptr) {
+            ELEMENT element;
+
+            while (iterator->Next(element) == true) {
+                field.Value.push_back(Convert(element));
+            }
+
+            iterator->Release();
+            field.Value.shrink_to_fit();
+            field.Status = deviceinfo_status::DEVICEINFO_OK;
+        }
     }
 
-    public:
-    uint32_t Deviceinfo_serial_number(char buffer[], uint8_t* length)
+    // Called with the _lock taken.
+    void Fetch(Snapshot& snapshot) const
     {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        string serialNumber;
-        _lock.Lock();
-        if (_modelName.IsSet() == true) {
-            serialNumber = _serialNumber.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
+        if (_identifierInterface != nullptr) {
+            snapshot.architecture.Value = Core::ToString(_identifierInterface->Architecture());
+            snapshot.architecture.Status = deviceinfo_status::DEVICEINFO_OK;
+            snapshot.chipsetName.Value = Core::ToString(_identifierInterface->Chipset());
+            snapshot.chipsetName.Status = deviceinfo_status::DEVICEINFO_OK;
+            snapshot.firmwareVersion.Value = Core::ToString(_identifierInterface->FirmwareVersion());
+            snapshot.firmwareVersion.Status = deviceinfo_status::DEVICEINFO_OK;
+
+            // First byte holds the length, as Core::SystemInfo::Id expects it.
+            uint8_t buffer[255] = {};
+            buffer[0] = _identifierInterface->Identifier(sizeof(buffer) - 1, &(buffer[1]));
+            snapshot.id.Value.assign(&(buffer[1]), &(buffer[1]) + buffer[0]);
+            snapshot.id.Status = deviceinfo_status::DEVICEINFO_OK;
+            snapshot.idStr.Value = Core::SystemInfo::Instance().Id(buffer, ~0);
+            snapshot.idStr.Status = deviceinfo_status::DEVICEINFO_OK;
+        }
+
+        if (_deviceInfoInterface != nullptr) {
+            uint16_t modelYear = 0;
+
+            snapshot.serialNumber.Status = DeviceInfoStatus(_deviceInfoInterface->SerialNumber(snapshot.serialNumber.Value));
+            snapshot.sku.Status = DeviceInfoStatus(_deviceInfoInterface->Sku(snapshot.sku.Value));
+            snapshot.make.Status = DeviceInfoStatus(_deviceInfoInterface->Make(snapshot.make.Value));
+            snapshot.deviceType.Status = DeviceInfoStatus(_deviceInfoInterface->DeviceType(snapshot.deviceType.Value));
+            snapshot.modelName.Status = DeviceInfoStatus(_deviceInfoInterface->ModelName(snapshot.modelName.Value));
+            snapshot.modelYear.Status = DeviceInfoStatus(_deviceInfoInterface->ModelYear(modelYear));
+            snapshot.modelYear.Value = Core::ToString(modelYear);
+            snapshot.systemIntegraterName.Status = DeviceInfoStatus(_deviceInfoInterface->DistributorId(snapshot.systemIntegraterName.Value));
+            snapshot.friendlyName.Status = DeviceInfoStatus(_deviceInfoInterface->FriendlyName(snapshot.friendlyName.Value));
+            snapshot.platformName.Status = DeviceInfoStatus(_deviceInfoInterface->PlatformName(snapshot.platformName.Value));
+        }
+
+        if (_deviceAudioCapabilitiesInterface != nullptr) {
+            Exchange::IDeviceAudioCapabilities::IAudioOutputIterator* index = nullptr;
+
+            _deviceAudioCapabilitiesInterface->AudioOutputs(index);
+            if (index != nullptr) {
+                Exchange::IDeviceAudioCapabilities::AudioOutput field;
+                while (index->Next(field) == true) {
+                    snapshot.audioOutputMap[field].type = Convert(field);
+                }
+                index->Release();
+                snapshot.audioOutputs.Status = deviceinfo_status::DEVICEINFO_OK;
+            }
+
+            for (AudioOutputMap::iterator output = snapshot.audioOutputMap.begin(); output != snapshot.audioOutputMap.end(); ++output) {
+                Exchange::IDeviceAudioCapabilities::IAudioCapabilityIterator* capabilities = nullptr;
+                Exchange::IDeviceAudioCapabilities::IMS12CapabilityIterator* ms12Capabilities = nullptr;
+                Exchange::IDeviceAudioCapabilities::IMS12ProfileIterator* profiles = nullptr;
+
+                snapshot.audioOutputs.Value.push_back(output->second.type);
+
+                _deviceAudioCapabilitiesInterface->AudioCapabilities(output->first, capabilities);
+                Drain<Exchange::IDeviceAudioCapabilities::AudioCapability>(capabilities, output->second.audioCapabilities);
+
+                _deviceAudioCapabilitiesInterface->MS12Capabilities(output->first, ms12Capabilities);
+                Drain<Exchange::IDeviceAudioCapabilities::MS12Capability>(ms12Capabilities, output->second.ms12Capabilities);
+
+                _deviceAudioCapabilitiesInterface->MS12AudioProfiles(output->first, profiles);
+                Drain<Exchange::IDeviceAudioCapabilities::MS12Profile>(profiles, output->second.ms12AudioProfiles);
+            }
         }
-        else {
-            if (_deviceInfoInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceInfoInterface->SerialNumber(serialNumber));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    _serialNumber = serialNumber;
+
+        if (_deviceVideoCapabilitiesInterface != nullptr) {
+            Exchange::IDeviceVideoCapabilities::IVideoOutputIterator* index = nullptr;
+
+            _deviceVideoCapabilitiesInterface->VideoOutputs(index);
+            if (index != nullptr) {
+                Exchange::IDeviceVideoCapabilities::VideoOutput field;
+                while (index->Next(field) == true) {
+                    snapshot.videoOutputMap[field].type = Convert(field);
                 }
+                index->Release();
+                snapshot.videoOutputs.Status = deviceinfo_status::DEVICEINFO_OK;
             }
-        }
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK ) {
-            auto size = serialNumber.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH;
-            } else {
-                strncpy(buffer, serialNumber.c_str(), *length);
+
+            for (VideoOutputMap::iterator output = snapshot.videoOutputMap.begin(); output != snapshot.videoOutputMap.end(); ++output) {
+                Exchange::IDeviceVideoCapabilities::IScreenResolutionIterator* resolutions = nullptr;
+                Exchange::IDeviceVideoCapabilities::ScreenResolution resolution = Exchange::IDeviceVideoCapabilities::ScreenResolution_Unknown;
+                Exchange::IDeviceVideoCapabilities::CopyProtection cp = Exchange::IDeviceVideoCapabilities::CopyProtection::HDCP_UNAVAILABLE;
+                VideoOutputCapability& capability(output->second);
+
+                snapshot.videoOutputs.Value.push_back(capability.type);
+
+                _deviceVideoCapabilitiesInterface->Resolutions(output->first, resolutions);
+                Drain<Exchange::IDeviceVideoCapabilities::ScreenResolution>(resolutions, capability.resolutions);
+
+                if (capability.resolutions.Status == deviceinfo_status::DEVICEINFO_OK) {
+                    if (capability.resolutions.Value.empty() == true) {
+                        capability.maxScreenResolution.Status = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH;
+                    } else {
+                        capability.maxScreenResolution.Value = DEVICEINFO_RESOLUTION_480I;
+                        for (const deviceinfo_output_resolution_t entry : capability.resolutions.Value) {
+                            if (entry > capability.maxScreenResolution.Value) {
+                                capability.maxScreenResolution.Value = entry;
+                            }
+                        }
+                        capability.maxScreenResolution.Status = deviceinfo_status::DEVICEINFO_OK;
+                    }
+                }
+
+                _deviceVideoCapabilitiesInterface->DefaultResolution(output->first, resolution);
+                capability.defaultResolution.Value = Convert(resolution);
+                capability.defaultResolution.Status = deviceinfo_status::DEVICEINFO_OK;
+
+                if (_deviceVideoCapabilitiesInterface->Hdcp(output->first, cp) == Core::ERROR_NONE) {
+                    capability.hdcp.Value = Convert(cp);
+                    capability.hdcp.Status = deviceinfo_status::DEVICEINFO_OK;
+                }
             }
-            *length = static_cast<uint8_t>(size + 1);
-        } else {
-            *length = 0;
+
+            snapshot.hostEdid.Status = DeviceInfoStatus(_deviceVideoCapabilitiesInterface->HostEDID(snapshot.hostEdid.Value));
+            snapshot.hdr.Status = DeviceInfoStatus(_deviceVideoCapabilitiesInterface->HDR(snapshot.hdr.Value));
+            snapshot.atmos.Status = DeviceInfoStatus(_deviceVideoCapabilitiesInterface->Atmos(snapshot.atmos.Value));
+            snapshot.cec.Status = DeviceInfoStatus(_deviceVideoCapabilitiesInterface->CEC(snapshot.cec.Value));
         }
-        return result;
     }
 
-    uint32_t Deviceinfo_sku(char buffer[], uint8_t* length)
+    static uint32_t Copy(const Field<std::string>& field, char buffer[], uint8_t* length)
     {
         ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        string sku;
-
-        _lock.Lock();
-        if (_sku.IsSet() == true) {
-            sku = _sku.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceInfoInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceInfoInterface->Sku(sku));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    _sku = sku;
-                }
-            }
-        }
-        _lock.Unlock();
+        uint32_t result = field.Status;
 
         if (result == deviceinfo_status::DEVICEINFO_OK) {
-            auto size = sku.size();
+            auto size = field.Value.size();
             if (*length <= size) {
                 result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH;
             } else {
-                strncpy(buffer, sku.c_str(), *length);
+                strncpy(buffer, field.Value.c_str(), *length);
             }
             *length = static_cast<uint8_t>(size + 1);
         } else {
@@ -486,34 +576,31 @@ private:
         return result;
     }
 
-    uint32_t Deviceinfo_make(char buffer[], uint8_t* length)
+    template <typename TYPE>
+    static uint32_t Copy(const Field<std::vector<TYPE>>& field, TYPE value[], uint8_t* length)
     {
         ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        string make;
-        _lock.Lock();
-        if (_make.IsSet() == true) {
-            make = _make.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceInfoInterface != nullptr ) {
-                result = DeviceInfoStatus(_deviceInfoInterface->Make(make));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    _make = make;
+        uint32_t result = field.Status;
+
+        if (result == deviceinfo_status::DEVICEINFO_OK) {
+
+            uint8_t inserted = 0;
+            typename std::vector<TYPE>::const_iterator iter = field.Value.begin();
+
+            while ((inserted < *length) && iter != field.Value.end()) {
+                uint8_t loop = 0;
+
+                while ((loop < inserted) && (value[loop] != *iter)) {
+                    loop++;
                 }
-            }
-        }
 
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK ) {
-            auto size = make.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH ;
-            } else {
-                strncpy(buffer, make.c_str(), *length);
+                if (loop == inserted) {
+                    value[inserted] = *iter;
+                    inserted++;
+                }
+                iter++;
             }
-            *length = static_cast<uint8_t>(size + 1);
+            *length = inserted;
         } else {
             *length = 0;
         }
@@ -521,909 +608,231 @@ private:
         return result;
     }
 
+    template <typename TYPE>
+    static uint32_t Copy(const Field<TYPE>& field, TYPE* value)
+    {
+        ASSERT(value != nullptr);
+
+        if (field.Status == deviceinfo_status::DEVICEINFO_OK) {
+            *value = field.Value;
+        }
+
+        return field.Status;
+    }
+
+    public:
+    uint32_t Deviceinfo_serial_number(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().serialNumber, buffer, length);
+    }
+
+    uint32_t Deviceinfo_sku(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().sku, buffer, length);
+    }
+
+    uint32_t Deviceinfo_make(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().make, buffer, length);
+    }
+
     uint32_t Deviceinfo_device_type(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().deviceType, buffer, length);
+    }
+
+    uint32_t Deviceinfo_model_name(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().modelName, buffer, length);
+    }
+
+    uint32_t Deviceinfo_model_year(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().modelYear, buffer, length);
+    }
+
+    uint32_t Deviceinfo_system_integrator_name(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().systemIntegraterName, buffer, length);
+    }
+
+    uint32_t Deviceinfo_friendly_name(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().friendlyName, buffer, length);
+    }
+
+    uint32_t Deviceinfo_platform_name(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().platformName, buffer, length);
+    }
+
+    uint32_t Deviceinfo_architecture(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().architecture, buffer, length);
+    }
+
+    uint32_t Deviceinfo_chipset(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().chipsetName, buffer, length);
+    }
+
+    uint32_t Deviceinfo_firmware_version(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().firmwareVersion, buffer, length);
+    }
+
+    uint32_t Deviceinfo_id(uint8_t buffer[], uint8_t* length)
     {
         ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        string deviceType;
-        _lock.Lock();
-        if (_deviceType.IsSet() == true) {
-            deviceType = _deviceType.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceInfoInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceInfoInterface->DeviceType(deviceType));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    _deviceType = deviceType;
-                }
-            }
-        }
-        _lock.Unlock();
+        const Field<std::vector<uint8_t>>& id(Current().id);
 
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            auto size = deviceType.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH;
-            } else {
-                strncpy(buffer, deviceType.c_str(), *length);
-            }
-            *length = static_cast<uint8_t>(size + 1);
+        if (id.Status == deviceinfo_status::DEVICEINFO_OK) {
+            uint8_t size = static_cast<uint8_t>(id.Value.size());
+            *length = ((size > (*length) - 1) ? (*length) - 1 : size);
+            std::copy_n(id.Value.begin(), *length, buffer);
         } else {
             *length = 0;
         }
 
-        return result;
+        return id.Status;
     }
 
-    uint32_t Deviceinfo_model_name(char buffer[], uint8_t* length)
+    uint32_t Deviceinfo_id_str(char buffer[], uint8_t* length)
+    {
+        return Copy(Current().idStr, buffer, length);
+    }
+
+    uint32_t Deviceinfo_audio_outputs(deviceinfo_audio_output_t value[], uint8_t* length)
+    {
+        return Copy(Current().audioOutputs, value, length);
+    }
+
+    uint32_t Deviceinfo_audio_capabilities(const deviceinfo_audio_output_t audioOutput, deviceinfo_audio_capability_t value[], uint8_t* length)
     {
         ASSERT(length != nullptr);
         uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        string modelName;
-        _lock.Lock();
-        if (_modelName.IsSet() == true) {
-            modelName = _modelName.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceInfoInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceInfoInterface->ModelName(modelName));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    _modelName = modelName;
-                }
-            }
-        }
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            auto size = modelName.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH ;
-            } else {
-                strncpy(buffer, modelName.c_str(), *length);
-            }
-            *length = static_cast<uint8_t>(size + 1);
+        const Snapshot& snapshot(Current());
+
+        AudioOutputMap::const_iterator index = snapshot.audioOutputMap.find(Convert(audioOutput));
+        if (index != snapshot.audioOutputMap.end()) {
+            result = Copy(index->second.audioCapabilities, value, length);
         } else {
             *length = 0;
         }
+
         return result;
     }
 
-    uint32_t Deviceinfo_model_year(char buffer[], uint8_t* length)
+    uint32_t Deviceinfo_audio_ms12_capabilities(const deviceinfo_audio_output_t audioOutput, deviceinfo_audio_ms12_capability_t value[], uint8_t* length)
     {
         ASSERT(length != nullptr);
         uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
+        const Snapshot& snapshot(Current());
 
-        uint16_t modelYear = 0;
-        _lock.Lock();
-        if (_modelYear.IsSet() == true) {
-            modelYear = _modelYear.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceInfoInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceInfoInterface->ModelYear(modelYear));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    _modelYear = modelYear;
-                }
-            }
-        }
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            string year = Core::ToString(modelYear);
-            auto size = year.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH ;
-            } else {
-                strncpy(buffer, year.c_str(), *length);
-            }
-
-            *length = static_cast<uint8_t>(size + 1);
+        AudioOutputMap::const_iterator index = snapshot.audioOutputMap.find(Convert(audioOutput));
+        if (index != snapshot.audioOutputMap.end()) {
+            result = Copy(index->second.ms12Capabilities, value, length);
         } else {
             *length = 0;
         }
+
         return result;
     }
 
-    uint32_t Deviceinfo_system_integrator_name(char buffer[], uint8_t* length)
+    uint32_t Deviceinfo_audio_ms12_audio_profiles(const deviceinfo_audio_output_t audioOutput, deviceinfo_audio_ms12_profile_t value[], uint8_t* length)
     {
         ASSERT(length != nullptr);
         uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
+        const Snapshot& snapshot(Current());
 
-        string integratorName;
-        _lock.Lock();
-        if (_systemIntegraterName.IsSet() == true) {
-            integratorName = _systemIntegraterName.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceInfoInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceInfoInterface->DistributorId(integratorName));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    _systemIntegraterName = integratorName;
-                }
-            }
-        }
-        _lock.Unlock();
-
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            auto size = integratorName.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH;
-            } else {
-                strncpy(buffer, integratorName.c_str(), *length);
-            }
-            *length = static_cast<uint8_t>(size + 1);
+        AudioOutputMap::const_iterator index = snapshot.audioOutputMap.find(Convert(audioOutput));
+        if (index != snapshot.audioOutputMap.end()) {
+            result = Copy(index->second.ms12AudioProfiles, value, length);
         } else {
             *length = 0;
         }
+
         return result;
     }
 
-    uint32_t Deviceinfo_friendly_name(char buffer[], uint8_t* length)
+    uint32_t Deviceinfo_video_outputs(deviceinfo_video_output_t value[], uint8_t* length)
+    {
+        return Copy(Current().videoOutputs, value, length);
+    }
+
+    uint32_t Deviceinfo_output_resolutions(const deviceinfo_video_output_t videoOutput, deviceinfo_output_resolution_t value[], uint8_t* length)
     {
         ASSERT(length != nullptr);
         uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
+        const Snapshot& snapshot(Current());
 
-        string friendlyName;
-        _lock.Lock();
-        if (_friendlyName.IsSet() == true) {
-            friendlyName = _friendlyName.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceInfoInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceInfoInterface->FriendlyName(friendlyName));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    _friendlyName = friendlyName;
-                }
-            }
-        }
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            string year = Core::ToString(friendlyName);
-            auto size = friendlyName.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH;
-            } else {
-                strncpy(buffer, friendlyName.c_str(), *length);
-            }
-            *length = static_cast<uint8_t>(size + 1);
+        VideoOutputMap::const_iterator index = snapshot.videoOutputMap.find(Convert(videoOutput));
+        if (index != snapshot.videoOutputMap.end()) {
+            result = Copy(index->second.resolutions, value, length);
         } else {
             *length = 0;
         }
+
         return result;
     }
 
-    uint32_t Deviceinfo_platform_name(char buffer[], uint8_t* length)
+    uint32_t Deviceinfo_default_output_resolution(const deviceinfo_video_output_t videoOutput, deviceinfo_output_resolution_t* value)
     {
-        ASSERT(length != nullptr);
         uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        string platformName;
-        _lock.Lock();
-        if (_platformName.IsSet() == true) {
-            platformName = _platformName.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceInfoInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceInfoInterface->PlatformName(platformName));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    _platformName = platformName;
-                }
-            }
-        }
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK ) {
-            string year = Core::ToString(platformName) ;
-            auto size = platformName.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH ;
-            } else {
-                strncpy(buffer, platformName.c_str(), *length);
-            }
-            *length = static_cast<uint8_t>(size + 1);
-        } else {
-            *length = 0; 
-        }
-        return result;
-    }
-
-    uint32_t Deviceinfo_architecture(char buffer[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        std::string newValue;
-        _lock.Lock();
-        if (_architecture.IsSet() == true) {
-            newValue = _architecture;
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_identifierInterface != nullptr) {
-                newValue = Core::ToString(_identifierInterface->Architecture());
-                _architecture = newValue;
-                result = deviceinfo_status::DEVICEINFO_OK;
-            }
-        }
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            auto size = newValue.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH ;
-            } else {
-                strncpy(buffer, newValue.c_str(), *length);
-                result = deviceinfo_status::DEVICEINFO_OK;
-            }
-            *length = static_cast<uint8_t>(size + 1);
-        } else {
-            *length = 0;
-        }
-        return result;
-    }
-
-    uint32_t Deviceinfo_chipset(char buffer[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        std::string newValue;
-        _lock.Lock();
-        if (_chipsetName.IsSet() == true) {
-            newValue = _chipsetName.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_identifierInterface != nullptr) {
-                newValue = Core::ToString(_identifierInterface->Chipset());
-                _chipsetName = newValue;
-                result = deviceinfo_status::DEVICEINFO_OK;
-            }
-        }
-
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            auto size = newValue.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH ;
-            } else {
-                strncpy(buffer, newValue.c_str(), *length);
-                result = deviceinfo_status::DEVICEINFO_OK;
-            }
-            *length = static_cast<uint8_t>(size + 1);
-        } else {
-            *length = 0;
-        }
-        return result;
-    }
-
-    uint32_t Deviceinfo_firmware_version(char buffer[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        std::string newValue;
-        _lock.Lock();
-        if (_firmwareVersion.IsSet() == true) {
-            newValue = _firmwareVersion.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_identifierInterface != nullptr) {
-                newValue = Core::ToString(_identifierInterface->FirmwareVersion());
-                _firmwareVersion = newValue;
-                result = deviceinfo_status::DEVICEINFO_OK;
-            }
-        }
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            auto size = newValue.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH ;
-            } else {
-                strncpy(buffer, newValue.c_str(), *length);
-                result = deviceinfo_status::DEVICEINFO_OK;
-            }
-            *length = static_cast<uint8_t>(size + 1);
-        } else {
-            *length = 0;
-        }
-        return result;
-    }
-
-    uint32_t Deviceinfo_id(uint8_t buffer[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        _lock.Lock();
-
-        if (_id.size() > 0) {
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_identifierInterface != nullptr) {
-                uint8_t tempBuffer[255] = {'\0'};
-                uint8_t size = _identifierInterface->Identifier(sizeof (tempBuffer) - 1, tempBuffer);
-                std::copy(tempBuffer, tempBuffer + size, std::back_inserter(_id));
-                _id.shrink_to_fit();
-                result = deviceinfo_status::DEVICEINFO_OK;
-            }
-        }
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            uint8_t size = static_cast<uint8_t>(_id.size());
-            *length = ((size > (*length) - 1) ? (*length) - 1 : size);
-            std::copy_n(_id.begin(), *length, buffer);
-        } else {
-            *length = 0;
-        }
-
-        _lock.Unlock();
-        return result;
-    }
-
-    uint32_t Deviceinfo_id_str(char buffer[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        string id;
-        _lock.Lock();
-        if ( _idStr.IsSet() == true) {
-            id = _idStr;
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_identifierInterface != nullptr) {
-                uint8_t id_buffer[64] = {};
-                id_buffer[0] = _identifierInterface->Identifier(sizeof(id_buffer) - 1, &(id_buffer[1]));
-                id = Core::SystemInfo::Instance().Id(id_buffer, ~0);
-                _idStr = id;
-                result = deviceinfo_status::DEVICEINFO_OK;
-            }
-        }
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            if (id.size() < *length) { 
-                strncpy(buffer, id.c_str(), *length);
-                result = deviceinfo_status::DEVICEINFO_OK;
-            } else {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH;
-            }
-            *length = static_cast<uint8_t>(id.size() + 1);
-
-        } else {
-            *length = 0;
-        }
-
-        return result;
-    }
-
-    uint32_t Deviceinfo_audio_outputs(deviceinfo_audio_output_t value[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        _lock.Lock();
-
-        if (_audioOutputMap.size() > 0) {
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceAudioCapabilitiesInterface != nullptr) {
-                Exchange::IDeviceAudioCapabilities::IAudioOutputIterator* index = nullptr;
-
-                _deviceAudioCapabilitiesInterface->AudioOutputs(index);
-                if (index != nullptr) {
-
-                    Exchange::IDeviceAudioCapabilities::AudioOutput field;
-                    AudioOutputCapability audioOutputCapability;
-                    while (index->Next(field) == true) {
-                        audioOutputCapability.type = Convert(field);
-                        _audioOutputMap.insert(std::pair<Exchange::IDeviceAudioCapabilities::AudioOutput, AudioOutputCapability>(field, audioOutputCapability));
-                    }
-                    index->Release();
-                    result = deviceinfo_status::DEVICEINFO_OK;
-                }
-            }
-        }
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-
-            uint8_t inserted = 0;
-            AudioOutputMap::iterator iter = _audioOutputMap.begin();
-
-            while ((inserted < *length) && iter != _audioOutputMap.end()) {
-                uint8_t loop = 0;
-
-                while ((loop < inserted) && (value[loop] != iter->second.type)) {
-                    loop++;
-                }
-
-                if (loop == inserted) {
-                    value[inserted] = iter->second.type;
-                    inserted++;
-                }
-                iter++;
-            }
-            *length = inserted;
-            result = deviceinfo_status::DEVICEINFO_OK;
-        } else {
-            *length = 0;
-        }
-
-        _lock.Unlock();
-        return result;
-    }
-
-    uint32_t Deviceinfo_audio_capabilities(const deviceinfo_audio_output_t audioOutput, deviceinfo_audio_capability_t value[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        _lock.Lock();
-
-        Exchange::IDeviceAudioCapabilities::AudioOutput audioPort = Convert(audioOutput);
-        AudioOutputMap::iterator index = _audioOutputMap.find(audioPort);
-        if ((index != _audioOutputMap.end()) && (index->second.audioCapabilities.size() > 0)) {
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if ((_deviceAudioCapabilitiesInterface != nullptr) && (index != _audioOutputMap.end())) {
-                 Exchange::IDeviceAudioCapabilities::IAudioCapabilityIterator* capabilities = nullptr;
-
-                _deviceAudioCapabilitiesInterface->AudioCapabilities(audioPort, capabilities);
-                if (capabilities != nullptr) {
-                    Exchange::IDeviceAudioCapabilities::AudioCapability field;
-                    while (capabilities->Next(field) == true) {
-                        deviceinfo_audio_capability_type converted = Convert(field);
-                        index->second.audioCapabilities.push_back(converted);
-                    }
-                    capabilities->Release();
-                    index->second.audioCapabilities.shrink_to_fit();
-                    result = deviceinfo_status::DEVICEINFO_OK;
-                }
-            }
-        }
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-
-            uint8_t inserted = 0;
-            std::vector<deviceinfo_audio_capability_t>::iterator iter = index->second.audioCapabilities.begin();
-
-            while ((inserted < *length) && iter != index->second.audioCapabilities.end()) {
-                uint8_t loop = 0;
-
-                while ((loop < inserted) && (value[loop] != *iter)) {
-                    loop++;
-                }
-
-                if (loop == inserted) {
-                    value[inserted] = *iter;
-                    inserted++;
-                }
-                iter++;
-            }
-            *length = inserted;
-            result = deviceinfo_status::DEVICEINFO_OK;
-        } else {
-            *length = 0;
-        }
-
-        _lock.Unlock();
-        return result;
-    }
-
-    uint32_t Deviceinfo_audio_ms12_capabilities(const deviceinfo_audio_output_t audioOutput, deviceinfo_audio_ms12_capability_t value[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        _lock.Lock();
-
-        Exchange::IDeviceAudioCapabilities::AudioOutput audioPort = Convert(audioOutput);
-        AudioOutputMap::iterator index = _audioOutputMap.find(audioPort);
-        if ((index != _audioOutputMap.end()) && (index->second.ms12Capabilities.size() > 0)) {
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if ((_deviceAudioCapabilitiesInterface != nullptr) && (index != _audioOutputMap.end())) {
-                Exchange::IDeviceAudioCapabilities::IMS12CapabilityIterator* capabilities = nullptr;
-
-                _deviceAudioCapabilitiesInterface->MS12Capabilities(audioPort, capabilities);
-                if (capabilities != nullptr) {
-                    Exchange::IDeviceAudioCapabilities::MS12Capability field;
-                    while (capabilities->Next(field) == true) {
-                        deviceinfo_audio_ms12_capability_type converted = Convert(field);
-                        index->second.ms12Capabilities.push_back(converted);
-                    }
-                    capabilities->Release();
-                    index->second.ms12Capabilities.shrink_to_fit();
-                    result = deviceinfo_status::DEVICEINFO_OK;
-                }
-            }
-        }
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-
-            uint8_t inserted = 0;
-            std::vector<deviceinfo_audio_ms12_capability_t>::iterator iter = index->second.ms12Capabilities.begin();
-
-            while ((inserted < *length) && iter != index->second.ms12Capabilities.end()) {
-                uint8_t loop = 0;
-
-                while ((loop < inserted) && (value[loop] != *iter)) {
-                    loop++;
-                }
-
-                if (loop == inserted) {
-                    value[inserted] = *iter;
-                    inserted++;
-                }
-                iter++;
-            }
-            *length = inserted;
-            result = deviceinfo_status::DEVICEINFO_OK;
-        } else {
-            *length = 0;
-        }
-
-        _lock.Unlock();
-        return result;
-    }
-
-    uint32_t Deviceinfo_audio_ms12_audio_profiles(const deviceinfo_audio_output_t audioOutput, deviceinfo_audio_ms12_profile_t value[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        _lock.Lock();
-
-        Exchange::IDeviceAudioCapabilities::AudioOutput audioPort = Convert(audioOutput);
-        AudioOutputMap::iterator index = _audioOutputMap.find(audioPort);
-        if ((index != _audioOutputMap.end()) && (index->second.ms12AuioProfiles.size() > 0)) {
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if ((_deviceAudioCapabilitiesInterface != nullptr) && (index != _audioOutputMap.end())) {
-                Exchange::IDeviceAudioCapabilities::IMS12ProfileIterator* profiles = nullptr;
-
-                _deviceAudioCapabilitiesInterface->MS12AudioProfiles(audioPort, profiles);
-                if (profiles != nullptr) {
-                    Exchange::IDeviceAudioCapabilities::MS12Profile profile;
-                    while (profiles->Next(profile) == true) {
-                        deviceinfo_audio_ms12_profile_type converted = Convert(profile);
-                        index->second.ms12AuioProfiles.push_back(converted);
-                    }
-                    profiles->Release();
-                    index->second.ms12AuioProfiles.shrink_to_fit();
-                    result = deviceinfo_status::DEVICEINFO_OK;
-                }
-            }
-        }
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-
-            uint8_t inserted = 0;
-            std::vector<deviceinfo_audio_ms12_profile_t>::iterator iter = index->second.ms12AuioProfiles.begin();
-
-            while ((inserted < *length) && iter != index->second.ms12AuioProfiles.end()) {
-                uint8_t loop = 0;
-
-                while ((loop < inserted) && (value[loop] != *iter)) {
-                    loop++;
-                }
-
-                if (loop == inserted) {
-                    value[inserted] = *iter;
-                    inserted++;
-                }
-                iter++;
-            }
-            *length = inserted;
-            result = deviceinfo_status::DEVICEINFO_OK;
-        } else {
-            *length = 0;
-        }
-
-        _lock.Unlock();
-        return result;
-    }
-
-    uint32_t Deviceinfo_video_outputs(deviceinfo_video_output_t value[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        _lock.Lock();
-        if (_videoOutputMap.size()>0) {
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceVideoCapabilitiesInterface != nullptr) {
-                Exchange::IDeviceVideoCapabilities::IVideoOutputIterator* index = nullptr;
-
-                _deviceVideoCapabilitiesInterface->VideoOutputs(index);
-                if (index != nullptr) {
-                    Exchange::IDeviceVideoCapabilities::VideoOutput field;
-                    VideoOutputCapability videoOutputCapability;
-                    while (index->Next(field) == true) {
-                        videoOutputCapability.type = Convert(field);
-                        _videoOutputMap.insert(std::pair<Exchange::IDeviceVideoCapabilities::VideoOutput, VideoOutputCapability>(field, videoOutputCapability));
-                    }
-                    index->Release();
-                    //_videoOutputMap.shrink_to_fit();
-                    result = deviceinfo_status::DEVICEINFO_OK;
-                }
-            }
-        }
-
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-
-            uint8_t inserted = 0;
-            VideoOutputMap::iterator iter = _videoOutputMap.begin();
-
-            while ((inserted < *length) && iter != _videoOutputMap.end()) {
-                uint8_t loop = 0;
-
-                while ((loop < inserted) && (value[loop] != iter->second.type)) {
-                    loop++;
-                }
-
-                if (loop == inserted) {
-                    value[inserted] = iter->second.type;
-                    inserted++;
-                }
-                iter++;
-            }
-            *length = inserted;
-            result = deviceinfo_status::DEVICEINFO_OK;
-        } else {
-            *length = 0;
-        }
-
-        _lock.Unlock();
-        return result;
-    }
-
-    uint32_t Deviceinfo_output_resolutions(const deviceinfo_video_output_t videoOutput, deviceinfo_output_resolution_t value[], uint8_t* length)
-    {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        _lock.Lock();
-
-        Exchange::IDeviceVideoCapabilities::VideoOutput videoPort = Convert(videoOutput);
-        VideoOutputMap::iterator index = _videoOutputMap.find(videoPort);
-        if ((index != _videoOutputMap.end()) && (index->second.resolutions.size() > 0)) {
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if ((_deviceVideoCapabilitiesInterface != nullptr) && (index != _videoOutputMap.end())) {
-                Exchange::IDeviceVideoCapabilities::IScreenResolutionIterator* resolutions = nullptr;
-
-                _deviceVideoCapabilitiesInterface->Resolutions(videoPort, resolutions);
-                if (resolutions != nullptr) {
-                    Exchange::IDeviceVideoCapabilities::ScreenResolution field;
-                    while (resolutions->Next(field) == true) {
-                        deviceinfo_output_resolution_type converted = Convert(field);
-                        index->second.resolutions.push_back(converted);
-                    }
-                    resolutions->Release();
-                    index->second.resolutions.shrink_to_fit();
-                    result = deviceinfo_status::DEVICEINFO_OK;
-                }
-            }
-        }
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-
-            uint8_t inserted = 0;
-            std::vector<deviceinfo_output_resolution_t>::iterator iter = index->second.resolutions.begin();
-
-            while ((inserted < *length) && iter != index->second.resolutions.end()) {
-                uint8_t loop = 0;
-
-                while ((loop < inserted) && (value[loop] != *iter)) {
-                    loop++;
-                }
-
-                if (loop == inserted) {
-                    value[inserted] = *iter;
-                    inserted++;
-                }
-                iter++;
-            }
-            *length = inserted;
-            result = deviceinfo_status::DEVICEINFO_OK;
-        } else {
-            *length = 0;
-        }
-
-        _lock.Unlock();
-        return result;
-    }
+        const Snapshot& snapshot(Current());
 
-    uint32_t Deviceinfo_default_output_resolution(const deviceinfo_video_output_t videoOutput, deviceinfo_output_resolution_t* value)
-    {
-        ASSERT(value != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        _lock.Lock();
-
-        Exchange::IDeviceVideoCapabilities::VideoOutput videoPort = Convert(videoOutput);
-        VideoOutputMap::iterator index = _videoOutputMap.find(videoPort);
-        if ((index != _videoOutputMap.end()) && (index->second.defaultResolution.IsSet() == true)) {
-            *value = index->second.defaultResolution.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if ((_deviceVideoCapabilitiesInterface != nullptr) && (index != _videoOutputMap.end())) {
-                Exchange::IDeviceVideoCapabilities::ScreenResolution resolution;
-
-                _deviceVideoCapabilitiesInterface->DefaultResolution(videoPort, resolution);
-                index->second.defaultResolution = Convert(resolution);
-                *value = index->second.defaultResolution.Value();
-                result = deviceinfo_status::DEVICEINFO_OK;
-            }
+        VideoOutputMap::const_iterator index = snapshot.videoOutputMap.find(Convert(videoOutput));
+        if (index != snapshot.videoOutputMap.end()) {
+            result = Copy(index->second.defaultResolution, value);
         }
 
-        _lock.Unlock();
         return result;
     }
 
     uint32_t Deviceinfo_maximum_output_resolution(const deviceinfo_video_output_t videoOutput, deviceinfo_output_resolution_t* value)
     {
-        ASSERT(value != nullptr);
         uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        _lock.Lock();
-
-        Exchange::IDeviceVideoCapabilities::VideoOutput videoPort = Convert(videoOutput);
-        VideoOutputMap::iterator index = _videoOutputMap.find(videoPort);
-        if ((index != _videoOutputMap.end()) && (index->second.maxScreenResolution.IsSet() == true)) {
-            *value = index->second.maxScreenResolution.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if ((_deviceVideoCapabilitiesInterface != nullptr) && (index != _videoOutputMap.end())) {
-                deviceinfo_output_resolution_type resolutions[32];
-                uint8_t maxLength = sizeof(resolutions) / sizeof(deviceinfo_output_resolution_type);
+        const Snapshot& snapshot(Current());
 
-                result = Deviceinfo_output_resolutions(videoOutput, resolutions, &maxLength);
-
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    if (maxLength == 0) {
-                        result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH;
-                    } else {
-                        uint8_t id = 0;
-                        *value = DEVICEINFO_RESOLUTION_480I;
-
-                        while (id < maxLength) {
-                            if (resolutions[id] > *value) {
-                                *value = resolutions[id];
-                            }
-                            id++;
-                        }
-                        index->second.maxScreenResolution = *value;
-                    }
-                }
-            }
+        VideoOutputMap::const_iterator index = snapshot.videoOutputMap.find(Convert(videoOutput));
+        if (index != snapshot.videoOutputMap.end()) {
+            result = Copy(index->second.maxScreenResolution, value);
         }
 
-        _lock.Unlock();
         return result;
     }
 
     uint32_t Deviceinfo_hdcp(const deviceinfo_video_output_t videoOutput, deviceinfo_hdcp_t* supportsHDCP)
     {
-        ASSERT(supportsHDCP != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_OK;
-        _lock.Lock();
-
-        Exchange::IDeviceVideoCapabilities::VideoOutput videoPort = Convert(videoOutput);
-        VideoOutputMap::iterator index = _videoOutputMap.find(videoPort);
-        if ((index != _videoOutputMap.end()) && (index->second.hdcp.IsSet() == true)) {
-            *supportsHDCP = index->second.hdcp.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if ((_deviceVideoCapabilitiesInterface != nullptr) && (index != _videoOutputMap.end())) {
-                Exchange::IDeviceVideoCapabilities::CopyProtection cp;
-                result = DeviceInfoStatus(_deviceVideoCapabilitiesInterface->Hdcp(videoPort, cp));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    *supportsHDCP = Convert(cp);
-                    index->second.hdcp = *supportsHDCP;
-                }
+        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
+        const Snapshot& snapshot(Current());
 
-                result = deviceinfo_status::DEVICEINFO_OK;
-            }
+        VideoOutputMap::const_iterator index = snapshot.videoOutputMap.find(Convert(videoOutput));
+        if (index != snapshot.videoOutputMap.end()) {
+            result = Copy(index->second.hdcp, supportsHDCP);
         }
 
-        _lock.Unlock();
         return result;
     }
 
     uint32_t Deviceinfo_host_edid(char buffer[], uint8_t* length)
     {
-        ASSERT(length != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        string hostEdid;
-        _lock.Lock();
-        if (_hostEdid.IsSet() == true) {
-            hostEdid = _hostEdid.Value();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-            if (_deviceVideoCapabilitiesInterface != nullptr) {
-
-                result = DeviceInfoStatus(_deviceVideoCapabilitiesInterface->HostEDID(hostEdid));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    _hostEdid = hostEdid;
-                }
-            }
-        }
-
-        _lock.Unlock();
-        if (result == deviceinfo_status::DEVICEINFO_OK) {
-            auto size = hostEdid.size();
-            if (*length <= size) {
-                result = deviceinfo_status::DEVICEINFO_ERROR_INVALID_INPUT_LENGTH ;
-            } else {
-                strncpy(buffer, hostEdid.c_str(), *length);
-            }
-            *length = static_cast<uint8_t>(size + 1);
-        } else {
-            *length = 0;
-        }
-        return result;
+        return Copy(Current().hostEdid, buffer, length);
     }
 
     uint32_t Deviceinfo_hdr(bool* supportsHDR)
     {
-        ASSERT(supportsHDR != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_ERROR_UNAVAILABLE;
-        _lock.Lock();
-        if (isHDRSupportCached() == true) {
-            *supportsHDR = getHDRSupport();
-            result = deviceinfo_status::DEVICEINFO_OK;
-        }
-        else {
-
-            if (_deviceVideoCapabilitiesInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceVideoCapabilitiesInterface->HDR(*supportsHDR));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    setHdrSupport(*supportsHDR);
-                }
-            }
-        }
-        _lock.Unlock();
-        return result;
+        return Copy(Current().hdr, supportsHDR);
     }
 
     uint32_t Deviceinfo_atmos(bool* supportsAtmos)
     {
-        ASSERT(supportsAtmos != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_OK;
-        _lock.Lock();
-        if (isAtmosSupportCached() == true) {
-            *supportsAtmos = getAtmosSupport();
-        }
-        else {
-            if (_deviceVideoCapabilitiesInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceVideoCapabilitiesInterface->Atmos(*supportsAtmos));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    setAtmosSupport(*supportsAtmos);
-                }
-            }
-        }
-
-        _lock.Unlock();
-        return result;
+        return Copy(Current().atmos, supportsAtmos);
     }
 
     uint32_t Deviceinfo_cec(bool* supportsCEC)
     {
-        ASSERT(supportsCEC != nullptr);
-        uint32_t result = deviceinfo_status::DEVICEINFO_OK;
-        _lock.Lock();
-        if (isCecSupportCached() == true) {
-            *supportsCEC = getCecSupport();
-        }
-        else {
-            if (_deviceVideoCapabilitiesInterface != nullptr) {
-                result = DeviceInfoStatus(_deviceVideoCapabilitiesInterface->CEC(*supportsCEC));
-                if (result == deviceinfo_status::DEVICEINFO_OK) {
-                    setCecSupport(*supportsCEC);
-                }
-            }
-        }
-
-        _lock.Unlock();
-        return result;
+        return Copy(Current().cec, supportsCEC);
     }
 
 private:
@@ -1433,24 +842,8 @@ private:
     Exchange::IDeviceAudioCapabilities* _deviceAudioCapabilitiesInterface;
     Exchange::IDeviceVideoCapabilities* _deviceVideoCapabilitiesInterface;
     Exchange::IDeviceInfo* _deviceInfoInterface;
-    Core::OptionalType<std::string> _architecture;
-    Core::OptionalType<std::string> _chipsetName;
-    Core::OptionalType<std::string> _serialNumber;
-    Core::OptionalType<std::string> _sku;
-    Core::OptionalType<std::string> _make;
-    Core::OptionalType<std::string> _deviceType;
-    Core::OptionalType<std::string> _modelName;
-    Core::OptionalType<uint16_t> _modelYear;
-    Core::OptionalType<std::string> _systemIntegraterName;
-    Core::OptionalType<std::string> _friendlyName;
-    Core::OptionalType<std::string> _platformName;
-    Core::OptionalType<std::string> _firmwareVersion;
-    Core::OptionalType<std::string> _idStr;
-    Core::OptionalType<std::string> _hostEdid;
-    VideoOutputMap _videoOutputMap;
-    AudioOutputMap _audioOutputMap;
-    std::vector<uint8_t> _id;
-    uint8_t _hdr_atmos_cec;
+    std::atomic<const Snapshot*> _current;
+    std::list<std::unique_ptr<const Snapshot>> _snapshots;
     static DeviceInfoLink* _singleton;
 };
 
@@ -59,8 +59,224 @@ displayinfo_status_t DisplayInfoStatus(uint32_t status)
 class DisplayInfo : protected RPC::SmartInterfaceType<Exchange::IConnectionProperties> {
 private:
     using BaseClass = RPC::SmartInterfaceType<Exchange::IConnectionProperties>;
-    using DisplayOutputUpdatedCallbacks = std::map<displayinfo_display_output_change_cb, void*>;
-    using OperationalStateChangeCallbacks = std::map<displayinfo_operational_state_change_cb, void*>;
+
+    // Callbacks are called from a thread of their own, on a snapshot of what is
+    // pending, and never with a lock taken that the getters need. So they are free
+    // to query the display, and a slow one does not hold up the RPC notifications
+    // or any other thread. Per subscriber, a display output change arriving while
+    // the previous one is still pending is merged into it (the callback carries no
+    // data, it has to query the latest state anyway). At most QueueLimit operational
+    // state changes are kept, dropping the oldest. Both count as dropped.
+    class Dispatcher : public Core::Thread {
+    private:
+        static constexpr uint8_t QueueLimit = 4;
+
+        struct OutputSubscriber {
+            void* UserData;
+            bool Pending;
+            uint32_t Dropped;
+        };
+        struct OperationalSubscriber {
+            void* UserData;
+            uint8_t Count;
+            bool States[QueueLimit];
+            uint32_t Dropped;
+        };
+
+        using OutputSubscribers = std::map<displayinfo_display_output_change_cb, OutputSubscriber>;
+        using OperationalSubscribers = std::map<displayinfo_operational_state_change_cb, OperationalSubscriber>;
+
+    public:
+        Dispatcher(const Dispatcher&) = delete;
+        Dispatcher& operator=(const Dispatcher&) = delete;
+
+        Dispatcher()
+            : Core::Thread()
+            , _lock()
+            , _deliveryLock()
+            , _signal(false, true)
+            , _outputSubscribers()
+            , _operationalSubscribers()
+            , _outputs()
+            , _operationals()
+        {
+            Thread::Run();
+        }
+        ~Dispatcher() override
+        {
+            Thread::Block();
+            _signal.SetEvent();
+            Thread::Wait(Thread::BLOCKED | Thread::STOPPED, Core::infinite);
+        }
+
+    public:
+        template <typename CALLBACK, typename SUBSCRIBERS>
+        uint32_t Register(SUBSCRIBERS& subscribers, CALLBACK callback, void* userdata)
+        {
+            uint32_t result = displayinfo_status::DISPLAYINFO_ERROR_ALREADY_REGISTERED;
+
+            _lock.Lock();
+
+            if (subscribers.find(callback) == subscribers.end()) {
+                typename SUBSCRIBERS::mapped_type subscriber{};
+                subscriber.UserData = userdata;
+                subscribers.emplace(callback, subscriber);
+                result = displayinfo_status::DISPLAYINFO_OK;
+            }
+
+            _lock.Unlock();
+
+            return (result);
+        }
+        // Once this returns, the callback is not running and will not be called
+        // anymore, unless it is the callback itself unregistering.
+        template <typename CALLBACK, typename SUBSCRIBERS>
+        uint32_t Unregister(SUBSCRIBERS& subscribers, CALLBACK callback)
+        {
+            uint32_t result = displayinfo_status::DISPLAYINFO_ERROR_ALREADY_UNREGISTERED;
+
+            _deliveryLock.Lock();
+            _lock.Lock();
+
+            typename SUBSCRIBERS::iterator index(subscribers.find(callback));
+
+            if (index != subscribers.end()) {
+                subscribers.erase(index);
+                result = displayinfo_status::DISPLAYINFO_OK;
+            }
+
+            _lock.Unlock();
+            _deliveryLock.Unlock();
+
+            return (result);
+        }
+        template <typename CALLBACK, typename SUBSCRIBERS>
+        uint32_t Dropped(SUBSCRIBERS& subscribers, CALLBACK callback, uint32_t& dropped) const
+        {
+            uint32_t result = displayinfo_status::DISPLAYINFO_ERROR_UNKNOWN_KEY;
+
+            _lock.Lock();
+
+            typename SUBSCRIBERS::const_iterator index(subscribers.find(callback));
+
+            if (index != subscribers.end()) {
+                dropped = index->second.Dropped;
+                result = displayinfo_status::DISPLAYINFO_OK;
+            }
+
+            _lock.Unlock();
+
+            return (result);
+        }
+
+        OutputSubscribers& Outputs()
+        {
+            return (_outputSubscribers);
+        }
+        const OutputSubscribers& Outputs() const
+        {
+            return (_outputSubscribers);
+        }
+        OperationalSubscribers& Operationals()
+        {
+            return (_operationalSubscribers);
+        }
+        const OperationalSubscribers& Operationals() const
+        {
+            return (_operationalSubscribers);
+        }
+
+        void OutputChanged()
+        {
+            _lock.Lock();
+
+            for (auto& index : _outputSubscribers) {
+                if (index.second.Pending == true) {
+                    index.second.Dropped++;
+                } else {
+                    index.second.Pending = true;
+                }
+            }
+
+            _signal.SetEvent();
+
+            _lock.Unlock();
+        }
+        void OperationalChanged(const bool upAndRunning)
+        {
+            _lock.Lock();
+
+            for (auto& index : _operationalSubscribers) {
+                OperationalSubscriber& subscriber(index.second);
+
+                if (subscriber.Count == QueueLimit) {
+                    ::memmove(&subscriber.States[0], &subscriber.States[1], (QueueLimit - 1) * sizeof(bool));
+                    subscriber.Count--;
+                    subscriber.Dropped++;
+                    TRACE_L1("Operational state change for a slow subscriber dropped");
+                }
+
+                subscriber.States[subscriber.Count++] = upAndRunning;
+            }
+
+            _signal.SetEvent();
+
+            _lock.Unlock();
+        }
+
+    private:
+        uint32_t Worker() override
+        {
+            _signal.Lock(Core::infinite);
+
+            _deliveryLock.Lock();
+
+            _lock.Lock();
+
+            _signal.ResetEvent();
+
+            for (auto& index : _operationalSubscribers) {
+                for (uint8_t state = 0; state < index.second.Count; state++) {
+                    _operationals.emplace_back(index.first, index.second.UserData, index.second.States[state]);
+                }
+                index.second.Count = 0;
+            }
+
+            for (auto& index : _outputSubscribers) {
+                if (index.second.Pending == true) {
+                    _outputs.emplace_back(index.first, index.second.UserData);
+                    index.second.Pending = false;
+                }
+            }
+
+            _lock.Unlock();
+
+            for (auto& entry : _operationals) {
+                std::get<0>(entry)(std::get<2>(entry), std::get<1>(entry));
+            }
+            for (auto& entry : _outputs) {
+                entry.first(entry.second);
+            }
+
+            _operationals.clear();
+            _outputs.clear();
+
+            _deliveryLock.Unlock();
+
+            return (0);
+        }
+
+    private:
+        mutable Core::CriticalSection _lock;
+        Core::CriticalSection _deliveryLock;
+        Core::Event _signal;
+        OutputSubscribers _outputSubscribers;
+        OperationalSubscribers _operationalSubscribers;
+
+        // Snapshot, only used by the worker.
+        std::vector<std::pair<displayinfo_display_output_change_cb, void*>> _outputs;
+        std::vector<std::tuple<displayinfo_operational_state_change_cb, void*, bool>> _operationals;
+    };
 
     //CONSTRUCTORS
 PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
@@ -70,6 +286,7 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
         , _hdrProperties(nullptr)
         , _graphicsProperties(nullptr)
         , _callsign(callsign)
+        , _dispatcher()
         , _displayUpdatedNotification(this)
     {
         ASSERT(_singleton==nullptr);
@@ -86,13 +303,7 @@ public:
 private:
     void DisplayOutputUpdated(VARIABLE_IS_NOT_USED const Exchange::IConnectionProperties::INotification::Source event)
     {
-        _lock.Lock();
-        
-        for (auto& index : _displayChangeCallbacks) {
-            index.first(index.second);
-        }
-
-        _lock.Unlock();
+        _dispatcher.OutputChanged();
     }
 
     //NOTIFICATIONS
@@ -154,11 +365,9 @@ private:
             }
         }
 
-        for (auto& index : _operationalStateCallbacks) {
-            index.first(upAndRunning, index.second);
-        }
-
         _lock.Unlock();
+
+        _dispatcher.OperationalChanged(upAndRunning);
     }
 
 private:
@@ -169,8 +378,7 @@ private:
     Exchange::IGraphicsProperties* _graphicsProperties;
     std::string _callsign;
 
-    DisplayOutputUpdatedCallbacks _displayChangeCallbacks;
-    OperationalStateChangeCallbacks _operationalStateCallbacks;
+    Dispatcher _dispatcher;
     Core::SinkType<Notification> _displayUpdatedNotification;
     static DisplayInfo* _singleton;
 
@@ -208,78 +416,38 @@ public:
 
     uint32_t RegisterOperationalStateChangedCallback(displayinfo_operational_state_change_cb callback, void* userdata)
     {
-        uint32_t result = displayinfo_status::DISPLAYINFO_ERROR_ALREADY_REGISTERED;
-
         ASSERT(callback != nullptr);
-
-        _lock.Lock();
-
-        if (_operationalStateCallbacks.find(callback) == _operationalStateCallbacks.end()) {
-            _operationalStateCallbacks.emplace(std::piecewise_construct, std::forward_as_tuple(callback), std::forward_as_tuple(userdata));
-            result = displayinfo_status::DISPLAYINFO_OK;
-        }
-
-        _lock.Unlock();
-
-        return (result);
+        return (_dispatcher.Register(_dispatcher.Operationals(), callback, userdata));
     }
 
     uint32_t UnregisterOperationalStateChangedCallback(displayinfo_operational_state_change_cb callback)
     {
-        uint32_t result = displayinfo_status::DISPLAYINFO_ERROR_ALREADY_UNREGISTERED;
-
         ASSERT(callback != nullptr);
+        return (_dispatcher.Unregister(_dispatcher.Operationals(), callback));
+    }
 
-        _lock.Lock();
-
-        OperationalStateChangeCallbacks::iterator index(_operationalStateCallbacks.find(callback));
-
-        if (index != _operationalStateCallbacks.end()) {
-            _operationalStateCallbacks.erase(index);
-            result = displayinfo_status::DISPLAYINFO_OK;
-        }
-
-        _lock.Unlock();
-
-        return (result);
+    uint32_t OperationalStateChangedDropped(displayinfo_operational_state_change_cb callback, uint32_t& dropped) const
+    {
+        ASSERT(callback != nullptr);
+        return (_dispatcher.Dropped(_dispatcher.Operationals(), callback, dropped));
     }
 
     uint32_t RegisterDisplayOutputChangeCallback(displayinfo_display_output_change_cb callback, void* userdata)
     {
-        uint32_t result = displayinfo_status::DISPLAYINFO_ERROR_ALREADY_REGISTERED;
-
         ASSERT(callback != nullptr);
-        
-        _lock.Lock();
-
-        if (_displayChangeCallbacks.find(callback) == _displayChangeCallbacks.end()) {
-            _displayChangeCallbacks.emplace(std::piecewise_construct, std::forward_as_tuple(callback), std::forward_as_tuple(userdata));
-            result = displayinfo_status::DISPLAYINFO_OK;
-        }
-
-        _lock.Unlock();
-
-        return (result);
+        return (_dispatcher.Register(_dispatcher.Outputs(), callback, userdata));
     }
 
     uint32_t UnregisterDolbyAudioModeChangedCallback(displayinfo_display_output_change_cb callback)
     {
-        uint32_t result = displayinfo_status::DISPLAYINFO_ERROR_ALREADY_UNREGISTERED;
-
         ASSERT(callback != nullptr);
-        
-        _lock.Lock();
-
-        DisplayOutputUpdatedCallbacks::iterator index(_displayChangeCallbacks.find(callback));
-
-        if (index != _displayChangeCallbacks.end()) {
-            _displayChangeCallbacks.erase(index);
-            result = displayinfo_status::DISPLAYINFO_OK;
-        }
-
-        _lock.Unlock();
+        return (_dispatcher.Unregister(_dispatcher.Outputs(), callback));
+    }
 
-        return (result);
+    uint32_t DisplayOutputChangeDropped(displayinfo_display_output_change_cb callback, uint32_t& dropped) const
+    {
+        ASSERT(callback != nullptr);
+        return (_dispatcher.Dropped(_dispatcher.Outputs(), callback, dropped));
     }
 
     uint32_t IsAudioPassthrough(bool& outIsEnabled) const
@@ -357,6 +525,162 @@ public:
 
 DisplayInfo* DisplayInfo::_singleton = nullptr;
 
+// The EDID only changes on a hotplug, yet applications tend to parse the same
+// one over and over. The outcome of the last parse is kept, keyed on the block
+// checksums and confirmed on the full content, so a repeated query is a lookup.
+class ParsedEDID {
+public:
+    ParsedEDID() = delete;
+    ParsedEDID(const ParsedEDID&) = delete;
+    ParsedEDID& operator=(const ParsedEDID&) = delete;
+
+    ParsedEDID(const uint8_t buffer[], const uint16_t length)
+        : _raw(buffer, buffer + length)
+        , _key(Key(buffer, length))
+        , _baseResult(displayinfo_status::DISPLAYINFO_ERROR_GENERAL)
+        , _base()
+        , _ceaResult(displayinfo_status::DISPLAYINFO_ERROR_GENERAL)
+        , _cea()
+    {
+        ::memset(&_base, 0, sizeof(_base));
+        ::memset(&_cea, 0, sizeof(_cea));
+
+        Parse(buffer, length);
+    }
+    ~ParsedEDID() = default;
+
+public:
+    static std::shared_ptr<const ParsedEDID> Get(const uint8_t buffer[], const uint16_t length)
+    {
+        static Core::CriticalSection lock;
+        static std::shared_ptr<const ParsedEDID> last;
+
+        std::shared_ptr<const ParsedEDID> result;
+
+        lock.Lock();
+        result = last;
+        lock.Unlock();
+
+        if ((result == nullptr) || (result->IsSame(buffer, length) == false)) {
+            result = std::make_shared<const ParsedEDID>(buffer, length);
+
+            lock.Lock();
+            last = result;
+            lock.Unlock();
+        }
+
+        return (result);
+    }
+
+    uint32_t Base(displayinfo_edid_base_info_t& info) const
+    {
+        if (_baseResult == displayinfo_status::DISPLAYINFO_OK) {
+            info = _base;
+        }
+        return (_baseResult);
+    }
+
+    uint32_t CEA(displayinfo_edid_cea_extension_info_t& info) const
+    {
+        if (_ceaResult == displayinfo_status::DISPLAYINFO_OK) {
+            info = _cea;
+        }
+        return (_ceaResult);
+    }
+
+private:
+    static uint32_t Key(const uint8_t buffer[], const uint16_t length)
+    {
+        const uint16_t blockSize = Plugin::ExtendedDisplayIdentification::Buffer::edid_block_size;
+        uint32_t key = length;
+
+        for (uint16_t checksum = (blockSize - 1); checksum < length; checksum += blockSize) {
+            key = ((key << 5) | (key >> 27)) ^ buffer[checksum];
+        }
+
+        return (key);
+    }
+
+    bool IsSame(const uint8_t buffer[], const uint16_t length) const
+    {
+        return ((_raw.size() == length) && (_key == Key(buffer, length)) && (::memcmp(_raw.data(), buffer, length) == 0));
+    }
+
+    void Parse(const uint8_t buffer[], const uint16_t length)
+    {
+        Plugin::ExtendedDisplayIdentification edid;
+        const uint16_t blockSize = edid.Length();
+
+        ::memcpy(edid.Segment(0), buffer, std::min(length, blockSize));
+
+        if (edid.IsValid() == true) {
+            memcpy(_base.manufacturer_id, edid.Manufacturer().c_str(), sizeof(_base.manufacturer_id));
+            _base.product_code = edid.ProductCode();
+            _base.serial_number = edid.Serial();
+            _base.manufacture_week = edid.Week();
+            _base.manufacture_year = edid.Year();
+            _base.version = edid.Major();
+            _base.revision = edid.Minor();
+            _base.digital = edid.Digital();
+            if (edid.Digital() == true) {
+                _base.bits_per_color = edid.BitsPerColor();
+                _base.video_interface = edid.VideoInterface();
+                _base.display_type = edid.DisplayType();
+            }
+            _base.width_in_centimeters = edid.WidthInCentimeters();
+            _base.height_in_centimeters = edid.HeightInCentimeters();
+            _base.preferred_width_in_pixels = edid.PreferredWidthInPixels();
+            _base.preferred_height_in_pixels = edid.PreferredHeightInPixels();
+            _baseResult = displayinfo_status::DISPLAYINFO_OK;
+
+            // Only take the extensions the base block announces, anything
+            // beyond that is not part of this EDID.
+            uint16_t offset = blockSize;
+
+            for (uint8_t segment = 1; (segment < edid.Segments()) && (offset < length); segment++, offset += blockSize) {
+                ::memcpy(edid.Segment(segment), &(buffer[offset]), std::min(static_cast<uint16_t>(length - offset), blockSize));
+            }
+
+            Plugin::ExtendedDisplayIdentification::Iterator segment = edid.CEASegment();
+
+            if (segment.IsValid() == true) {
+                Plugin::ExtendedDisplayIdentification::CEA cea(segment.Current());
+                std::vector<uint8_t> vics;
+
+                _cea.version = cea.Version();
+                _cea.audio_formats = cea.AudioFormats();
+                _cea.color_spaces = cea.ColorSpaces();
+                _cea.color_formats = cea.ColorFormats();
+                _cea.color_depths[DISPLAYINFO_EDID_COLOR_DEPTH_INDEX_RGB] = cea.RGBColorDepths();
+                _cea.color_depths[DISPLAYINFO_EDID_COLOR_DEPTH_INDEX_YCBCR444] = cea.YCbCr444ColorDepths();
+                _cea.color_depths[DISPLAYINFO_EDID_COLOR_DEPTH_INDEX_YCBCR422] = cea.YCbCr422ColorDepths();
+                _cea.color_depths[DISPLAYINFO_EDID_COLOR_DEPTH_INDEX_YCBCR420] = cea.YCbCr420ColorDepths();
+
+                cea.Timings(vics);
+                ASSERT(vics.size() <= sizeof(_cea.timings));
+
+                _cea.number_of_timings = static_cast<uint8_t>(std::min(vics.size(), sizeof(_cea.timings)));
+
+                if (_cea.number_of_timings != 0) {
+                    ::memcpy(_cea.timings, vics.data(), _cea.number_of_timings);
+                }
+
+                _ceaResult = displayinfo_status::DISPLAYINFO_OK;
+            } else {
+                _ceaResult = displayinfo_status::DISPLAYINFO_ERROR_UNAVAILABLE;
+            }
+        }
+    }
+
+private:
+    const std::vector<uint8_t> _raw;
+    const uint32_t _key;
+    uint32_t _baseResult;
+    displayinfo_edid_base_info_t _base;
+    uint32_t _ceaResult;
+    displayinfo_edid_cea_extension_info_t _cea;
+};
+
 } // namespace Thunder
 
 using namespace Thunder;
@@ -386,6 +710,28 @@ uint32_t displayinfo_unregister_display_output_change_callback(displayinfo_displ
     return DisplayInfo::Instance().UnregisterDolbyAudioModeChangedCallback(callback);
 }
 
+uint32_t displayinfo_display_output_change_dropped(displayinfo_display_output_change_cb callback, uint32_t* dropped)
+{
+    uint32_t errorCode = displayinfo_status::DISPLAYINFO_ERROR_GENERAL;
+
+    if (callback != nullptr && dropped != nullptr) {
+        errorCode = DisplayInfo::Instance().DisplayOutputChangeDropped(callback, *dropped);
+    }
+
+    return errorCode;
+}
+
+uint32_t displayinfo_operational_state_change_dropped(displayinfo_operational_state_change_cb callback, uint32_t* dropped)
+{
+    uint32_t errorCode = displayinfo_status::DISPLAYINFO_ERROR_GENERAL;
+
+    if (callback != nullptr && dropped != nullptr) {
+        errorCode = DisplayInfo::Instance().OperationalStateChangedDropped(callback, *dropped);
+    }
+
+    return errorCode;
+}
+
 void displayinfo_name(char buffer[], const uint8_t length)
 {
     string name = DisplayInfo::Instance().Name();
@@ -555,31 +901,7 @@ uint32_t displayinfo_parse_edid(const uint8_t buffer[], uint16_t length, display
     uint32_t errorCode = displayinfo_status::DISPLAYINFO_ERROR_GENERAL;
 
     if (buffer != nullptr && length != 0 && edid_info != nullptr) {
-        Plugin::ExtendedDisplayIdentification edid;
-        uint32_t len = (length > edid.Length()) ? edid.Length() : length;
-        memcpy((edid.Segment(0)), buffer, len);
-
-        if(edid.IsValid()) {
-            ::memset(edid_info, 0, sizeof(*edid_info));
-            memcpy(edid_info->manufacturer_id, edid.Manufacturer().c_str(), sizeof(edid_info->manufacturer_id));
-            edid_info->product_code = edid.ProductCode();
-            edid_info->serial_number = edid.Serial();
-            edid_info->manufacture_week = edid.Week();
-            edid_info->manufacture_year = edid.Year();
-            edid_info->version = edid.Major();
-            edid_info->revision = edid.Minor();
-            edid_info->digital = edid.Digital();
-            if (edid.Digital() == true) {
-                edid_info->bits_per_color = edid.BitsPerColor();
-                edid_info->video_interface = edid.VideoInterface();
-                edid_info->display_type = edid.DisplayType();
-            }
-            edid_info->width_in_centimeters = edid.WidthInCentimeters();
-            edid_info->height_in_centimeters = edid.HeightInCentimeters();
-            edid_info->preferred_width_in_pixels = edid.PreferredWidthInPixels();
-            edid_info->preferred_height_in_pixels = edid.PreferredHeightInPixels();
-            errorCode = displayinfo_status::DISPLAYINFO_OK;
-        }
+        errorCode = ParsedEDID::Get(buffer, length)->Base(*edid_info);
     }
     return errorCode;
 }
@@ -589,54 +911,7 @@ uint32_t displayinfo_edid_cea_extension_info(const uint8_t buffer[], const uint1
     uint32_t errorCode = displayinfo_status::DISPLAYINFO_ERROR_GENERAL;
 
     if (buffer != nullptr && length != 0 && cea_info != nullptr) {
-        Plugin::ExtendedDisplayIdentification edid;
-        uint32_t max_seg_len = edid.Length();
-        uint32_t segments = (length / max_seg_len);
-
-        if(length % max_seg_len > 0) {
-            segments += 1;
-        }
-
-        uint32_t copied = 0;
-        for(uint32_t seg_iter=0; seg_iter < segments; ++seg_iter) {
-            uint32_t begin = seg_iter * max_seg_len;
-            uint32_t seg_len = ((length - copied) > max_seg_len) ? max_seg_len : (length - copied);
-            memcpy((edid.Segment(seg_iter)), buffer + begin, seg_len);
-            copied += seg_len;
-        }
-
-        ASSERT(copied == length);
-
-        if(edid.IsValid()) {
-            Plugin::ExtendedDisplayIdentification::Iterator segment = edid.CEASegment();
-            if(segment.IsValid() == true) {
-                ::memset(cea_info, 0, sizeof(*cea_info));
-
-                Plugin::ExtendedDisplayIdentification::CEA cae(segment.Current());
-                cea_info->version = cae.Version();
-                cea_info->audio_formats = cae.AudioFormats();
-                cea_info->color_spaces = cae.ColorSpaces();
-                cea_info->color_formats = cae.ColorFormats();
-                cea_info->color_depths[DISPLAYINFO_EDID_COLOR_DEPTH_INDEX_RGB] = cae.RGBColorDepths();
-                cea_info->color_depths[DISPLAYINFO_EDID_COLOR_DEPTH_INDEX_YCBCR444] = cae.YCbCr444ColorDepths();
-                cea_info->color_depths[DISPLAYINFO_EDID_COLOR_DEPTH_INDEX_YCBCR422] = cae.YCbCr422ColorDepths();
-                cea_info->color_depths[DISPLAYINFO_EDID_COLOR_DEPTH_INDEX_YCBCR420] = cae.YCbCr420ColorDepths();
-
-                std::vector<uint8_t> vic_list;
-                cae.Timings(vic_list);
-                ASSERT(vic_list.size() <= sizeof(cea_info->timings));
-
-                for (uint8_t i = 0; i < vic_list.size(); ++i) {
-                    cea_info->timings[i] = vic_list[i];
-                }
-
-                cea_info->number_of_timings = static_cast<uint8_t>(vic_list.size());
-
-                errorCode = displayinfo_status::DISPLAYINFO_OK;
-            } else {
-                errorCode = displayinfo_status::DISPLAYINFO_ERROR_UNAVAILABLE;
-            }
-        }
+        errorCode = ParsedEDID::Get(buffer, length)->CEA(*cea_info);
     }
     return errorCode;
 }
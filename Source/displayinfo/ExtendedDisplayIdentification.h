@@ -40,6 +40,7 @@ namespace Plugin {
             static constexpr uint16_t edid_block_size = 128;
         public:
             Buffer() {
+                ::memset(_data, 0, sizeof(_data));
             }
             Buffer(const Buffer& copy) {
                 ::memcpy(_data, copy._data, sizeof(_data));
@@ -136,6 +137,7 @@ namespace Plugin {
         class CEA {
         public:
             static constexpr uint8_t extension_tag = 0x02;
+            static constexpr uint8_t detailed_timing_descriptor_size = 18;
         public:
             class DataBlockIterator {
             public:
@@ -267,16 +269,40 @@ namespace Plugin {
                 bool _reset;
             };
 
+        public:
+            // One entry per data block in the collection, in the order they
+            // appear. Blocks that do not fit in the collection are dropped.
+            struct DataBlock {
+                DataBlockIterator::blocktype Tag;
+                uint8_t Offset; // of the header byte, within the segment
+                uint8_t Size; // including the header byte
+                uint32_t OUI; // vendor specific blocks only, 0 otherwise
+            };
+
+            using DataBlockList = std::vector<DataBlock>;
+
         public:
             CEA() = delete;
             CEA(const CEA&) = delete;
             CEA& operator= (const CEA&) = delete;
 
+            // All the information is extracted in a single pass over the
+            // segment, the accessors only return what was found.
             CEA(const Buffer& data)
                 : _segment(data)
-                , _colorFormats(GetColorFormats())
+                , _dataBlocks()
+                , _detailedTimings()
+                , _vics()
+                , _colorFormats(DISPLAYINFO_EDID_COLOR_FORMAT_RGB)
+                , _rgbColorDepths(DISPLAYINFO_EDID_COLOR_DEPTH_8_BPC)
+                , _ycbcr444ColorDepths(DISPLAYINFO_EDID_COLOR_DEPTH_UNDEFINED)
+                , _ycbcr420ColorDepths(DISPLAYINFO_EDID_COLOR_DEPTH_UNDEFINED)
+                , _colorSpaces(DISPLAYINFO_EDID_COLOR_SPACE_UNDEFINED)
+                , _audioFormats(0)
             {
                 ASSERT(_segment[0] == extension_tag);
+
+                Parse();
             }
             ~CEA() = default;
 
@@ -293,58 +319,12 @@ namespace Plugin {
 
             displayinfo_edid_color_depth_map_t RGBColorDepths() const
             {
-                displayinfo_edid_color_depth_map_t colorDepthMap = DISPLAYINFO_EDID_COLOR_DEPTH_8_BPC;
-                DataBlockIterator dataBlock = DataBlockIterator(_segment, DetailedTimingDescriptorStart());
-
-                while(dataBlock.Next()) {
-                    if(dataBlock.IsValid() && (dataBlock.BlockTag() == DataBlockIterator::VENDOR_SPECIFIC) && (dataBlock.BlockSize() > 6)) {
-                        if(dataBlock.OUI() == OUI_HDMI_LICENSING) {
-                            if(dataBlock.Current()[6] & (1 << 6)) {
-                                colorDepthMap |= DISPLAYINFO_EDID_COLOR_DEPTH_16_BPC;
-                            }
-                            if(dataBlock.Current()[6] & (1 << 5)) {
-                                colorDepthMap |= DISPLAYINFO_EDID_COLOR_DEPTH_12_BPC;
-                            }
-                            if(dataBlock.Current()[6] & (1 << 4)) {
-                                colorDepthMap |= DISPLAYINFO_EDID_COLOR_DEPTH_10_BPC;
-                            }
-                            break;
-                        }
-                    }
-                }
-
-                return colorDepthMap;
+                return (_rgbColorDepths);
             }
 
             displayinfo_edid_color_depth_map_t YCbCr444ColorDepths() const
             {
-                displayinfo_edid_color_depth_map_t colorDepthMap = DISPLAYINFO_EDID_COLOR_DEPTH_UNDEFINED;
-
-                if (_colorFormats & DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR444) {
-                    colorDepthMap = DISPLAYINFO_EDID_COLOR_DEPTH_8_BPC;
-                    DataBlockIterator dataBlock = DataBlockIterator(_segment, DetailedTimingDescriptorStart());
-
-                    while(dataBlock.Next()) {
-                        if(dataBlock.IsValid() && (dataBlock.BlockTag() == DataBlockIterator::VENDOR_SPECIFIC) && (dataBlock.BlockSize() > 6)) {
-                            if(dataBlock.OUI() == OUI_HDMI_LICENSING) {
-                                if(dataBlock.Current()[6] & (1 << 3)) {
-                                    if(dataBlock.Current()[6] & (1 << 6)) {
-                                        colorDepthMap |= DISPLAYINFO_EDID_COLOR_DEPTH_16_BPC;
-                                    }
-                                    if(dataBlock.Current()[6] & (1 << 5)) {
-                                        colorDepthMap |= DISPLAYINFO_EDID_COLOR_DEPTH_12_BPC;
-                                    }
-                                    if(dataBlock.Current()[6] & (1 << 4)) {
-                                        colorDepthMap |= DISPLAYINFO_EDID_COLOR_DEPTH_10_BPC;
-                                    }
-                                }
-                                break;
-                            }
-                        }
-                    }
-                }
-
-                return colorDepthMap;
+                return (_ycbcr444ColorDepths);
             }
 
             displayinfo_edid_color_depth_map_t YCbCr422ColorDepths() const
@@ -360,235 +340,345 @@ namespace Plugin {
 
             displayinfo_edid_color_depth_map_t YCbCr420ColorDepths() const
             {
-                displayinfo_edid_color_depth_map_t colorDepthMap = DISPLAYINFO_EDID_COLOR_DEPTH_UNDEFINED;
+                return (_ycbcr420ColorDepths);
+            }
 
-                if (_colorFormats & DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR420) {
-                    colorDepthMap = DISPLAYINFO_EDID_COLOR_DEPTH_8_BPC;
-                    DataBlockIterator dataBlock = DataBlockIterator(_segment, DetailedTimingDescriptorStart());
-
-                    while(dataBlock.Next()) {
-                        if(dataBlock.IsValid()) {
-                            if ((dataBlock.BlockTag() == DataBlockIterator::VENDOR_SPECIFIC) && (dataBlock.BlockSize() > 7)) {
-                                if(dataBlock.OUI() == OUI_HDMI_FORUM) {
-                                    if((dataBlock.Current()[7]) & 1) {
-                                        colorDepthMap |= DISPLAYINFO_EDID_COLOR_DEPTH_10_BPC;
-                                        break;
-                                    }
-                                    if((dataBlock.Current()[7]) & 2) {
-                                        colorDepthMap |= DISPLAYINFO_EDID_COLOR_DEPTH_12_BPC;
-                                        break;
-                                    }
-                                    if((dataBlock.Current()[7]) & 4) {
-                                        colorDepthMap |= DISPLAYINFO_EDID_COLOR_DEPTH_16_BPC;
-                                        break;
-                                    }
-                                    break;
-                                }
-                            }
-                        }
-                    }
+            displayinfo_edid_color_space_map_t ColorSpaces() const
+            {
+                return (_colorSpaces);
+            }
+
+            void Timings(std::vector<uint8_t>& vicList) const
+            {
+                vicList.insert(vicList.end(), _vics.begin(), _vics.end());
+            }
+
+            displayinfo_edid_audio_format_map_t AudioFormats() const
+            {
+                return (_audioFormats);
+            }
+
+            const DataBlockList& DataBlocks() const
+            {
+                return (_dataBlocks);
+            }
+
+            // Returns the first data block of the given type (and OUI, for
+            // vendor specific blocks) that is larger than minSize bytes. A
+            // linear scan of the index, a collection holds a few dozen blocks
+            // at most and the parse looks up every tag only once.
+            const DataBlock* Find(const DataBlockIterator::blocktype tag, const uint8_t minSize = 0, const uint32_t oui = 0) const
+            {
+                DataBlockList::const_iterator index(_dataBlocks.cbegin());
+
+                while ((index != _dataBlocks.cend()) && ((index->Tag != tag) || (index->Size <= minSize) || ((oui != 0) && (index->OUI != oui)))) {
+                    index++;
                 }
 
-                return colorDepthMap;
+                return (index != _dataBlocks.cend() ? &(*index) : nullptr);
             }
 
-            displayinfo_edid_color_space_map_t ColorSpaces() const
+            const uint8_t* Block(const DataBlock& block) const
             {
-                displayinfo_edid_color_space_map_t colorSpaceMap = DISPLAYINFO_EDID_COLOR_SPACE_UNDEFINED;
+                return (&_segment[block.Offset]);
+            }
 
-                DataBlockIterator dataBlock = DataBlockIterator(_segment, DetailedTimingDescriptorStart());
-                while(dataBlock.Next()) {
-                    if(dataBlock.IsValid() && (dataBlock.BlockTag() == DataBlockIterator::COLORIMETRY) && (dataBlock.BlockSize() > 3)) {
-                        if(dataBlock.Current()[2]  & (1 << 0)) {
-                            colorSpaceMap |= DISPLAYINFO_EDID_COLOR_SPACE_XVYCC_601;
-                        }
-                        if(dataBlock.Current()[2]  & (1 << 1)) {
-                            colorSpaceMap |= DISPLAYINFO_EDID_COLOR_SPACE_XVYCC_709;
-                        }
-                        if(dataBlock.Current()[2]  & (1 << 2)) {
-                            colorSpaceMap |= DISPLAYINFO_EDID_COLOR_SPACE_SYCC_601;
-                        }
-                        if(dataBlock.Current()[2]  & (1 << 3)) {
-                            colorSpaceMap |= DISPLAYINFO_EDID_COLOR_SPACE_OP_YCC_601;
-                        }
-                        if(dataBlock.Current()[2]  & (1 << 4)) {
-                            colorSpaceMap |= DISPLAYINFO_EDID_COLOR_SPACE_OP_RGB;
-                        }
-                        if(dataBlock.Current()[2]  & (1 << 5)) {
-                            colorSpaceMap |= DISPLAYINFO_EDID_COLOR_SPACE_ITUR_BT_2020_CYCC;
-                        }
-                        if(dataBlock.Current()[2]  & (1 << 6)) {
-                            colorSpaceMap |= DISPLAYINFO_EDID_COLOR_SPACE_ITUR_BT_2020_YCC;
+            // Offsets of the 18 byte detailed timing descriptors in the segment.
+            const std::vector<uint8_t>& DetailedTimingDescriptors() const
+            {
+                return (_detailedTimings);
+            }
+
+        private:
+            uint8_t DetailedTimingDescriptorStart() const
+            {
+                return(_segment[2]);
+            }
+
+            void Parse()
+            {
+                // The last byte of the segment is the checksum.
+                const uint8_t end = std::min(DetailedTimingDescriptorStart(), static_cast<uint8_t>(Buffer::edid_block_size - 1));
+
+                // d < 4 means there is no data block collection (and, for 0, no
+                // detailed timing descriptors either).
+                if (end >= 4) {
+                    uint8_t offset = 4;
+
+                    while (offset < end) {
+                        DataBlock block;
+
+                        block.Size = (_segment[offset] & 0x1F) + 1;
+
+                        if ((offset + block.Size) > end) {
+                            break;
                         }
-                        if(dataBlock.Current()[2]  & (1 << 7)) {
-                            colorSpaceMap |= DISPLAYINFO_EDID_COLOR_SPACE_ITUR_BT_2020_RGB;
+
+                        const uint8_t tag = (_segment[offset] >> 5);
+
+                        if (tag == DataBlockIterator::EXTENDED) {
+                            block.Tag = (block.Size >= 2 ? static_cast<DataBlockIterator::blocktype>(DataBlockIterator::MARKER | _segment[offset + 1]) : DataBlockIterator::INVALID);
+                        } else {
+                            block.Tag = static_cast<DataBlockIterator::blocktype>(tag);
                         }
-                        if(dataBlock.Current()[3]  & (1 << 7)) {
-                            colorSpaceMap |= DISPLAYINFO_EDID_COLOR_SPACE_DCI_P3;
+
+                        block.Offset = offset;
+                        block.OUI = (((block.Tag == DataBlockIterator::VENDOR_SPECIFIC) && (block.Size >= 4)) ?
+                                    ((_segment[offset + 1]) + (_segment[offset + 2] << 8) + (_segment[offset + 3] << 16)) : 0);
+
+                        _dataBlocks.push_back(block);
+
+                        offset += block.Size;
+                    }
+
+                    for (uint8_t dtd = end; (dtd + detailed_timing_descriptor_size) < Buffer::edid_block_size; dtd += detailed_timing_descriptor_size) {
+                        // A zero pixel clock marks the end of the descriptors.
+                        if ((_segment[dtd] == 0) && (_segment[dtd + 1] == 0)) {
+                            break;
                         }
+                        _detailedTimings.push_back(dtd);
+                    }
+                }
+
+                ParseColorFormats();
+                ParseColorDepths();
+                ParseColorSpaces();
+                ParseTimings();
+                ParseAudioFormats();
+            }
+
+            void ParseColorFormats()
+            {
+                if(Version() >= 2) {
+                    if(_segment[3] & (1 << 4)) {
+                        _colorFormats |= DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR444;
+                    }
+                    if(_segment[3] & (1 << 5)) {
+                        _colorFormats |= DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR422;
+                    }
+                }
+
+                for (const DataBlock& block : _dataBlocks) {
+                    if ((block.Tag == DataBlockIterator::YCBCR420_CAPABILITY_MAP) ||
+                        ((block.Tag == DataBlockIterator::VENDOR_SPECIFIC) && (block.Size > 7) && (block.OUI == OUI_HDMI_FORUM) && (Block(block)[7] & 7))) {
+                        _colorFormats |= DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR420;
                         break;
                     }
                 }
-                return colorSpaceMap;
             }
 
-            void Timings(std::vector<uint8_t>& vicList) const
+            void ParseColorDepths()
             {
-                DataBlockIterator dataBlock = DataBlockIterator(_segment, DetailedTimingDescriptorStart());
-                while(dataBlock.Next()) {
-                    if(dataBlock.IsValid() && (dataBlock.BlockTag() == DataBlockIterator::VIDEO)) {
-                        for(uint8_t index = 1; index < dataBlock.BlockSize(); index++) {
-                            const uint8_t vic = dataBlock.Current()[index];
-                            if ((vic >= 128) && (vic <= 192)) {
-                                vicList.push_back(vic & 0x7F);
-                            } else {
-                                vicList.push_back(vic);
-                            }
+                const DataBlock* hdmi = Find(DataBlockIterator::VENDOR_SPECIFIC, 6, OUI_HDMI_LICENSING);
+
+                if (hdmi != nullptr) {
+                    const uint8_t deepColor = Block(*hdmi)[6];
+                    displayinfo_edid_color_depth_map_t depths = 0;
+
+                    if(deepColor & (1 << 6)) {
+                        depths |= DISPLAYINFO_EDID_COLOR_DEPTH_16_BPC;
+                    }
+                    if(deepColor & (1 << 5)) {
+                        depths |= DISPLAYINFO_EDID_COLOR_DEPTH_12_BPC;
+                    }
+                    if(deepColor & (1 << 4)) {
+                        depths |= DISPLAYINFO_EDID_COLOR_DEPTH_10_BPC;
+                    }
+
+                    _rgbColorDepths |= depths;
+
+                    // DC_Y444: the deep color modes also apply to YCbCr 4:4:4
+                    if ((_colorFormats & DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR444) && (deepColor & (1 << 3))) {
+                        _ycbcr444ColorDepths |= depths;
+                    }
+                }
+
+                if (_colorFormats & DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR444) {
+                    _ycbcr444ColorDepths |= DISPLAYINFO_EDID_COLOR_DEPTH_8_BPC;
+                }
+
+                if (_colorFormats & DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR420) {
+                    const DataBlock* forum = Find(DataBlockIterator::VENDOR_SPECIFIC, 7, OUI_HDMI_FORUM);
+
+                    _ycbcr420ColorDepths = DISPLAYINFO_EDID_COLOR_DEPTH_8_BPC;
+
+                    if (forum != nullptr) {
+                        const uint8_t deepColor = Block(*forum)[7];
+
+                        if(deepColor & 1) {
+                            _ycbcr420ColorDepths |= DISPLAYINFO_EDID_COLOR_DEPTH_10_BPC;
+                        } else if(deepColor & 2) {
+                            _ycbcr420ColorDepths |= DISPLAYINFO_EDID_COLOR_DEPTH_12_BPC;
+                        } else if(deepColor & 4) {
+                            _ycbcr420ColorDepths |= DISPLAYINFO_EDID_COLOR_DEPTH_16_BPC;
                         }
-                        break;
                     }
                 }
             }
 
-            displayinfo_edid_audio_format_map_t AudioFormats() const
+            void ParseColorSpaces()
             {
-                displayinfo_edid_audio_format_map_t audioFormatMap = 0;
-
-                DataBlockIterator dataBlock = DataBlockIterator(_segment, DetailedTimingDescriptorStart());
-                while(dataBlock.Next()) {
-                    if(dataBlock.IsValid() && (dataBlock.BlockTag() == DataBlockIterator::AUDIO)) {
-                        for(uint8_t index = 1; index < dataBlock.BlockSize(); index += 3) {
-                            const uint8_t sad = (dataBlock.Current()[index] & 0x78) >> 3;
-                            switch(sad){
-                            case 0x01:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_LPCM;
-                                break;
-                            case 0x02:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_AC3;
-                                break;
-                            case 0x03:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG1;
-                                break;
+                const DataBlock* colorimetry = Find(DataBlockIterator::COLORIMETRY, 3);
+
+                if (colorimetry != nullptr) {
+                    const uint8_t* data = Block(*colorimetry);
+
+                    if(data[2]  & (1 << 0)) {
+                        _colorSpaces |= DISPLAYINFO_EDID_COLOR_SPACE_XVYCC_601;
+                    }
+                    if(data[2]  & (1 << 1)) {
+                        _colorSpaces |= DISPLAYINFO_EDID_COLOR_SPACE_XVYCC_709;
+                    }
+                    if(data[2]  & (1 << 2)) {
+                        _colorSpaces |= DISPLAYINFO_EDID_COLOR_SPACE_SYCC_601;
+                    }
+                    if(data[2]  & (1 << 3)) {
+                        _colorSpaces |= DISPLAYINFO_EDID_COLOR_SPACE_OP_YCC_601;
+                    }
+                    if(data[2]  & (1 << 4)) {
+                        _colorSpaces |= DISPLAYINFO_EDID_COLOR_SPACE_OP_RGB;
+                    }
+                    if(data[2]  & (1 << 5)) {
+                        _colorSpaces |= DISPLAYINFO_EDID_COLOR_SPACE_ITUR_BT_2020_CYCC;
+                    }
+                    if(data[2]  & (1 << 6)) {
+                        _colorSpaces |= DISPLAYINFO_EDID_COLOR_SPACE_ITUR_BT_2020_YCC;
+                    }
+                    if(data[2]  & (1 << 7)) {
+                        _colorSpaces |= DISPLAYINFO_EDID_COLOR_SPACE_ITUR_BT_2020_RGB;
+                    }
+                    if(data[3]  & (1 << 7)) {
+                        _colorSpaces |= DISPLAYINFO_EDID_COLOR_SPACE_DCI_P3;
+                    }
+                }
+            }
+
+            void ParseTimings()
+            {
+                const DataBlock* video = Find(DataBlockIterator::VIDEO);
+
+                if (video != nullptr) {
+                    const uint8_t* data = Block(*video);
+
+                    for(uint8_t index = 1; index < video->Size; index++) {
+                        const uint8_t vic = data[index];
+                        if ((vic >= 128) && (vic <= 192)) {
+                            _vics.push_back(vic & 0x7F);
+                        } else {
+                            _vics.push_back(vic);
+                        }
+                    }
+                }
+            }
+
+            void ParseAudioFormats()
+            {
+                const DataBlock* audio = Find(DataBlockIterator::AUDIO);
+
+                if (audio != nullptr) {
+                    const uint8_t* data = Block(*audio);
+
+                    // Short audio descriptors are 3 bytes, ignore a truncated one.
+                    for(uint8_t index = 1; (index + 2) < audio->Size; index += 3) {
+                        const uint8_t sad = (data[index] & 0x78) >> 3;
+                        switch(sad){
+                        case 0x01:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_LPCM;
+                            break;
+                        case 0x02:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_AC3;
+                            break;
+                        case 0x03:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG1;
+                            break;
+                        case 0x04:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_MP3;
+                            break;
+                        case 0x05:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG2;
+                            break;
+                        case 0x06:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_AAC_LC;
+                            break;
+                        case 0x07:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_DTS;
+                            break;
+                        case 0x08:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_ATRAC;
+                            break;
+                        case 0x09:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_SUPER_AUDIO_CD;
+                            break;
+                        case 0x0A:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_EAC3;
+                            // if MPEG surround implicitly and explicitly supported: assume ATMOS
+                            if((data[index + 2] & 0x01)) {
+                                _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_DOLBY_ATMOS;
+                            }
+                            break;
+                        case 0x0B:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_DTSHD;
+                            break;
+                        case 0x0C:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_DOLBY_TRUEHD;
+                            break;
+                        case 0x0D:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_DST_AUDIO;
+                            break;
+                        case 0x0E:
+                            _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_MS_WMA_PRO;
+                            break;
+                        case 0x0F:
+                            switch((data[index + 2] & 0xF8) >> 3) {
                             case 0x04:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_MP3;
+                                _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG4_HEAAC;
                                 break;
                             case 0x05:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG2;
+                                _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG4_HEAAC_V2;
                                 break;
                             case 0x06:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_AAC_LC;
+                                _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG4_ACC_LC;
                                 break;
                             case 0x07:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_DTS;
+                                _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_DRA;
                                 break;
                             case 0x08:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_ATRAC;
-                                break;
-                            case 0x09:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_SUPER_AUDIO_CD;
+                                _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG4_HEAAC_MPEG_SURROUND;
                                 break;
                             case 0x0A:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_EAC3;
-                                // if MPEG surround implicitly and explicitly supported: assume ATMOS
-                                if((dataBlock.Current()[index + 2] & 0x01)) {
-                                    audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_DOLBY_ATMOS;
-                                }
+                                _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG4_HEAAC_LC_MPEG_SURROUND;
                                 break;
                             case 0x0B:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_DTSHD;
+                                _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEGH_3DAUDIO;
                                 break;
                             case 0x0C:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_DOLBY_TRUEHD;
+                                _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_AC4;
                                 break;
                             case 0x0D:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_DST_AUDIO;
-                                break;
-                            case 0x0E:
-                                audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_MS_WMA_PRO;
+                                _audioFormats |= DISPLAYINFO_EDID_AUDIO_FORMAT_LPCM_3DAUDIO;
                                 break;
-                            case 0x0F:
-                                switch((dataBlock.Current()[index + 2] & 0xF8) >> 3) {
-                                case 0x04:
-                                    audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG4_HEAAC;
-                                    break;
-                                case 0x05:
-                                    audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG4_HEAAC_V2;
-                                    break;
-                                case 0x06:
-                                    audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG4_ACC_LC;
-                                    break;
-                                case 0x07:
-                                    audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_DRA;
-                                    break;
-                                case 0x08:
-                                    audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG4_HEAAC_MPEG_SURROUND;
-                                    break;
-                                case 0x0A:
-                                    audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEG4_HEAAC_LC_MPEG_SURROUND;
-                                    break;
-                                case 0x0B:
-                                    audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_MPEGH_3DAUDIO;
-                                    break;
-                                case 0x0C:
-                                    audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_AC4;
-                                    break;
-                                case 0x0D:
-                                    audioFormatMap |= DISPLAYINFO_EDID_AUDIO_FORMAT_LPCM_3DAUDIO;
-                                    break;
-                                default:
-                                    break;
-                                }
                             default:
                                 break;
                             }
-                        }
-                        break;
-                    }
-                }
-                return audioFormatMap;
-            }
-
-        private:
-            uint8_t DetailedTimingDescriptorStart() const
-            {
-                return(_segment[2]);
-            }
-
-            displayinfo_edid_color_format_map_t GetColorFormats() const
-            {
-                displayinfo_edid_color_format_map_t colorFormatMap = DISPLAYINFO_EDID_COLOR_FORMAT_RGB;
-
-                if(Version() >= 2) {
-                    if(_segment[3] & (1 << 4)) {
-                        colorFormatMap |= DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR444;
-                    }
-                    if(_segment[3] & (1 << 5)) {
-                        colorFormatMap |= DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR422;
-                    }
-                }
-
-                DataBlockIterator dataBlock = DataBlockIterator(_segment, DetailedTimingDescriptorStart());
-                while(dataBlock.Next()) {
-                    if(dataBlock.IsValid()) {
-                        if((dataBlock.BlockTag() == DataBlockIterator::VENDOR_SPECIFIC) && (dataBlock.BlockSize() > 7)) {
-                            if(dataBlock.OUI() == OUI_HDMI_FORUM) {
-                                if((dataBlock.Current()[7]) & 7) {
-                                    colorFormatMap |= DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR420;
-                                    break;
-                                }
-                            }
-                        } else if(dataBlock.BlockTag() == DataBlockIterator::YCBCR420_CAPABILITY_MAP) {
-                            colorFormatMap |= DISPLAYINFO_EDID_COLOR_FORMAT_YCBCR420;
+                            break;
+                        default:
                             break;
                         }
                     }
                 }
-                return colorFormatMap;
             }
 
         private:
             Buffer _segment;
+            DataBlockList _dataBlocks;
+            std::vector<uint8_t> _detailedTimings;
+            std::vector<uint8_t> _vics;
             displayinfo_edid_color_format_map_t _colorFormats;
+            displayinfo_edid_color_depth_map_t _rgbColorDepths;
+            displayinfo_edid_color_depth_map_t _ycbcr444ColorDepths;
+            displayinfo_edid_color_depth_map_t _ycbcr420ColorDepths;
+            displayinfo_edid_color_space_map_t _colorSpaces;
+            displayinfo_edid_audio_format_map_t _audioFormats;
         };
 
     public:
@@ -237,7 +237,11 @@ typedef void (*displayinfo_operational_state_change_cb)(bool is_operational, voi
 
 /**
 * @brief Will be called if there are changes regaring the display output, you need to query
-*        yourself what exacally is changed
+*        yourself what exacally is changed. Changes that come in while the previous one was
+*        not delivered yet are merged into it.
+*
+*        Both callbacks are called from a thread of the library, so it is safe to query
+*        the display from within them.
 *
 * @param userData Pointer passed along when \ref displayinfo_register was issued.
 */
@@ -291,6 +295,28 @@ EXTERNAL uint32_t displayinfo_register_display_output_change_callback( displayin
  **/
 EXTERNAL uint32_t displayinfo_unregister_display_output_change_callback( displayinfo_display_output_change_cb callback);
 
+/**
+ * @brief Number of display output changes not delivered separately to this callback,
+ *        as they were merged into a pending one.
+ *
+ * @param callback Registered callback.
+ * @param dropped Receives the number of merged changes.
+ * @return ERROR_NONE on succes,
+ *         ERROR_UNKNOWN_KEY if callback not registered
+ **/
+EXTERNAL uint32_t displayinfo_display_output_change_dropped(displayinfo_display_output_change_cb callback, uint32_t* dropped);
+
+/**
+ * @brief Number of operational state changes dropped for this callback because it did not
+ *        keep up (a few are queued, the latest one is always delivered).
+ *
+ * @param callback Registered callback.
+ * @param dropped Receives the number of dropped changes.
+ * @return ERROR_NONE on succes,
+ *         ERROR_UNKNOWN_KEY if callback not registered
+ **/
+EXTERNAL uint32_t displayinfo_operational_state_change_dropped(displayinfo_operational_state_change_cb callback, uint32_t* dropped);
+
 /**
  * @brief Returns name of display output.
  *
@@ -21,7 +21,6 @@
 #include <gst/base/gstbytereader.h>
 
 #include "Module.h"
-#include "CapsParser.h"
 #include "open_cdm_adapter.h"
 
 inline bool mappedBuffer(GstBuffer *buffer, bool writable, uint8_t **data, uint32_t *size)
@@ -39,6 +38,163 @@ inline bool mappedBuffer(GstBuffer *buffer, bool writable, uint8_t **data, uint3
     return true;
 }
 
+// Keeps the MediaProperties of the caps last seen by a streaming thread. The caps are only
+// parsed again if a caps event delivered a new GstCaps. A reference on the caps is kept, so
+// the pointer can not be recycled for other caps while it is cached.
+class StreamProperties {
+public:
+    StreamProperties(const StreamProperties&) = delete;
+    StreamProperties& operator= (const StreamProperties&) = delete;
+
+    StreamProperties()
+        : _caps(nullptr)
+        , _properties()
+    {
+        _properties.height = 0;
+        _properties.width = 0;
+        _properties.media_type = MediaType_Unknown;
+    }
+    ~StreamProperties()
+    {
+        if (_caps != nullptr) {
+            gst_caps_unref(_caps);
+        }
+    }
+
+public:
+    const MediaProperties& Get(GstCaps* caps)
+    {
+        if (caps != _caps) {
+            Parse(caps);
+
+            gst_caps_ref(caps);
+            if (_caps != nullptr) {
+                gst_caps_unref(_caps);
+            }
+            _caps = caps;
+        }
+
+        return (_properties);
+    }
+
+private:
+    void Parse(GstCaps* caps)
+    {
+        _properties.height = 0;
+        _properties.width = 0;
+        _properties.media_type = MediaType_Unknown;
+
+        const GstStructure* structure = (gst_caps_is_empty(caps) == FALSE ? gst_caps_get_structure(caps, 0) : nullptr);
+
+        if (structure != nullptr) {
+            // Encrypted caps carry the type of the clear stream, fall back to the caps name otherwise.
+            const gchar* mediaType = gst_structure_get_string(structure, "original-media-type");
+
+            if (mediaType == nullptr) {
+                mediaType = gst_structure_get_name(structure);
+            }
+
+            if (g_str_has_prefix(mediaType, "video") == TRUE) {
+                gint width = 0;
+                gint height = 0;
+
+                _properties.media_type = MediaType_Video;
+
+                if (gst_structure_get_int(structure, "width", &width) == TRUE) {
+                    _properties.width = static_cast<uint16_t>(width);
+                }
+                if (gst_structure_get_int(structure, "height", &height) == TRUE) {
+                    _properties.height = static_cast<uint16_t>(height);
+                }
+            } else if (g_str_has_prefix(mediaType, "audio") == TRUE) {
+                _properties.media_type = MediaType_Audio;
+            } else {
+                TRACE_L1("Found an unknown media type %s", mediaType);
+            }
+        }
+    }
+
+private:
+    GstCaps* _caps;
+    MediaProperties _properties;
+};
+
+static thread_local StreamProperties streamProperties;
+
+// Upper limit of the subsample mapping that fits in a SampleInfo.
+static constexpr uint32_t MaxSubSamples = 0xFF;
+
+// Converts the big endian (clear: 16 bits, encrypted: 32 bits) subsample mapping into a SubSampleInfo table.
+inline bool subSampleTable(const uint8_t* data, const uint32_t size, const uint32_t count, SubSampleInfo table[])
+{
+    GstByteReader reader;
+    bool result = (count <= MaxSubSamples);
+
+    gst_byte_reader_init(&reader, data, size);
+
+    for (uint32_t position = 0; (result == true) && (position < count); position++) {
+        result = ((gst_byte_reader_get_uint16_be(&reader, &table[position].clear_bytes) == TRUE) &&
+                  (gst_byte_reader_get_uint32_be(&reader, &table[position].encrypted_bytes) == TRUE));
+    }
+
+    return (result);
+}
+
+// Fallback for samples the SampleInfo can not describe: decrypt a contiguous copy of the encrypted parts.
+static OpenCDMError gatheredDecrypt(struct OpenCDMSession* session, uint8_t* mappedData, const uint8_t* mappedSubSample, const uint32_t mappedSubSampleSize,
+                                    const uint32_t subSampleCount, const EncryptionScheme encScheme, const EncryptionPattern& pattern,
+                                    const uint8_t* mappedIV, const uint32_t mappedIVSize, const uint8_t* mappedKeyID, const uint32_t mappedKeyIDSize,
+                                    uint32_t initWithLast15)
+{
+    GstByteReader reader;
+    uint16_t inClear = 0;
+    uint32_t inEncrypted = 0;
+    uint32_t totalEncrypted = 0;
+
+    gst_byte_reader_init(&reader, mappedSubSample, mappedSubSampleSize);
+
+    for (unsigned int position = 0; position < subSampleCount; position++) {
+
+        gst_byte_reader_get_uint16_be(&reader, &inClear);
+        gst_byte_reader_get_uint32_be(&reader, &inEncrypted);
+        totalEncrypted += inEncrypted;
+    }
+    gst_byte_reader_set_pos(&reader, 0);
+
+    uint8_t* encryptedData = reinterpret_cast<uint8_t*>(malloc(totalEncrypted));
+    uint8_t* encryptedDataIter = encryptedData;
+
+    uint32_t index = 0;
+    for (unsigned int position = 0; position < subSampleCount; position++) {
+
+        gst_byte_reader_get_uint16_be(&reader, &inClear);
+        gst_byte_reader_get_uint32_be(&reader, &inEncrypted);
+
+        memcpy(encryptedDataIter, mappedData + index + inClear, inEncrypted);
+        index += inClear + inEncrypted;
+        encryptedDataIter += inEncrypted;
+    }
+    gst_byte_reader_set_pos(&reader, 0);
+
+    OpenCDMError result = opencdm_session_decrypt(session, encryptedData, totalEncrypted, encScheme, pattern, mappedIV, mappedIVSize, mappedKeyID, mappedKeyIDSize, initWithLast15);
+
+    // Re-build sub-sample data.
+    index = 0;
+    unsigned total = 0;
+    for (uint32_t position = 0; position < subSampleCount; position++) {
+        gst_byte_reader_get_uint16_be(&reader, &inClear);
+        gst_byte_reader_get_uint32_be(&reader, &inEncrypted);
+
+        memcpy(mappedData + total + inClear, encryptedData + index, inEncrypted);
+        index += inEncrypted;
+        total += inClear + inEncrypted;
+    }
+
+    free(encryptedData);
+
+    return (result);
+}
+
 OpenCDMError opencdm_gstreamer_session_decrypt(struct OpenCDMSession* session, GstBuffer* buffer, GstBuffer* subSampleBuffer, const uint32_t subSampleCount,
                                                GstBuffer* IV, GstBuffer* keyID, uint32_t initWithLast15)
 {
@@ -109,49 +265,34 @@ OpenCDMError opencdm_gstreamer_session_decrypt(struct OpenCDMSession* session, G
             }
             uint8_t *mappedSubSample = reinterpret_cast<uint8_t* >(sampleMap.data);
             uint32_t mappedSubSampleSize = static_cast<uint32_t >(sampleMap.size);
-            GstByteReader* reader = gst_byte_reader_new(mappedSubSample, mappedSubSampleSize);
-            uint16_t inClear = 0;
-            uint32_t inEncrypted = 0;
-            uint32_t totalEncrypted = 0;
-            for (unsigned int position = 0; position < subSampleCount; position++) {
-
-                gst_byte_reader_get_uint16_be(reader, &inClear);
-                gst_byte_reader_get_uint32_be(reader, &inEncrypted);
-                totalEncrypted += inEncrypted;
-            }
-            gst_byte_reader_set_pos(reader, 0);
-
-            uint8_t* encryptedData = reinterpret_cast<uint8_t*>(malloc(totalEncrypted));
-            uint8_t* encryptedDataIter = encryptedData;
-
-            uint32_t index = 0;
-            for (unsigned int position = 0; position < subSampleCount; position++) {
 
-                gst_byte_reader_get_uint16_be(reader, &inClear);
-                gst_byte_reader_get_uint32_be(reader, &inEncrypted);
-
-                memcpy(encryptedDataIter, mappedData + index + inClear, inEncrypted);
-                index += inClear + inEncrypted;
-                encryptedDataIter += inEncrypted;
-            }
-            gst_byte_reader_set_pos(reader, 0);
+            if ((subSampleCount > MaxSubSamples) || (initWithLast15 != 0)) {
+                // The SampleInfo can not describe this sample, gather the encrypted parts.
+                result = gatheredDecrypt(session, mappedData, mappedSubSample, mappedSubSampleSize, subSampleCount, encScheme, pattern,
+                                         mappedIV, mappedIVSize, mappedKeyID, mappedKeyIDSize, initWithLast15);
+            } else {
+                SubSampleInfo subSamples[MaxSubSamples];
 
-
-            result = opencdm_session_decrypt(session, encryptedData, totalEncrypted, encScheme, pattern, mappedIV, mappedIVSize, mappedKeyID, mappedKeyIDSize, initWithLast15);
-            // Re-build sub-sample data.
-            index = 0;
-            unsigned total = 0;
-            for (uint32_t position = 0; position < subSampleCount; position++) {
-                gst_byte_reader_get_uint16_be(reader, &inClear);
-                gst_byte_reader_get_uint32_be(reader, &inEncrypted);
-
-                memcpy(mappedData + total + inClear, encryptedData + index, inEncrypted);
-                index += inEncrypted;
-                total += inClear + inEncrypted;
+                if (subSampleTable(mappedSubSample, mappedSubSampleSize, subSampleCount, subSamples) == false) {
+                    TRACE_L1(_T("Invalid subsample table."));
+                    result = ERROR_INVALID_DECRYPT_BUFFER;
+                } else {
+                    // Decrypt in place, the clear parts are skipped using the subsample mapping.
+                    SampleInfo sampleInfo;
+                    sampleInfo.subSample = subSamples;
+                    sampleInfo.subSampleCount = static_cast<uint8_t>(subSampleCount);
+                    sampleInfo.scheme = encScheme;
+                    sampleInfo.pattern.clear_blocks = pattern.clear_blocks;
+                    sampleInfo.pattern.encrypted_blocks = pattern.encrypted_blocks;
+                    sampleInfo.iv = mappedIV;
+                    sampleInfo.ivLength = static_cast<uint8_t>(mappedIVSize);
+                    sampleInfo.keyId = mappedKeyID;
+                    sampleInfo.keyIdLength = static_cast<uint8_t>(mappedKeyIDSize);
+
+                    result = opencdm_session_decrypt_v2(session, mappedData, mappedDataSize, &sampleInfo, nullptr);
+                }
             }
 
-            gst_byte_reader_free(reader);
-            free(encryptedData);
             gst_buffer_unmap(subSampleBuffer, &sampleMap);
         } else {
             result = opencdm_session_decrypt(session, mappedData, mappedDataSize, encScheme, pattern, mappedIV, mappedIVSize, mappedKeyID, mappedKeyIDSize, initWithLast15);
@@ -211,7 +352,6 @@ OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* ses
                     result = ERROR_INVALID_DECRYPT_BUFFER;
                     goto exit;
                 }
-                ASSERT(mappedSubSampleSize==subSampleCount);
             }
 
             //Get IV
@@ -259,51 +399,21 @@ OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* ses
             gst_structure_get_uint(protectionMeta->info, "skip_byte_block", &pattern.clear_blocks);
 
             //Create a SubSampleInfo Array with mapping
-            SubSampleInfo * subSampleInfoPtr = nullptr;
+            SubSampleInfo subSampleInfo[MaxSubSamples];
+            SubSampleInfo* subSampleInfoPtr = nullptr;
             if (subSample != nullptr) {
-                GstByteReader* reader = gst_byte_reader_new(mappedSubSample, mappedSubSampleSize);
-                subSampleInfoPtr = reinterpret_cast<SubSampleInfo*>(malloc(subSampleCount * sizeof(SubSampleInfo)));
-                for (unsigned int position = 0; position < subSampleCount; position++) {
-
-                    gst_byte_reader_get_uint16_be(reader, &subSampleInfoPtr[position].clear_bytes);
-                    gst_byte_reader_get_uint32_be(reader, &subSampleInfoPtr[position].encrypted_bytes);
+                if (subSampleTable(mappedSubSample, mappedSubSampleSize, subSampleCount, subSampleInfo) == false) {
+                    TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Invalid subsample mapping.");
+                    result = ERROR_INVALID_DECRYPT_BUFFER;
+                    goto exit;
                 }
-                gst_byte_reader_set_pos(reader, 0);
-                gst_byte_reader_free(reader);
+                subSampleInfoPtr = subSampleInfo;
             }
 
             //Get Stream Properties from GstCaps
-            MediaProperties *spPtr = nullptr;
-            MediaProperties streamProperties;
+            const MediaProperties* spPtr = nullptr;
             if(caps != nullptr){
-                gchar *capsStr = gst_caps_to_string (caps);
-                if (capsStr != nullptr) {
-                    Thunder::Plugin::CapsParser capsParser;
-                    capsParser.Parse(reinterpret_cast<const uint8_t*>(capsStr), strlen(capsStr));
-                    streamProperties.height = capsParser.GetHeight();
-                    streamProperties.width = capsParser.GetWidth();
-                    switch (capsParser.GetMediaType()) {
-                        case CDMi::MediaType::Video:
-                            streamProperties.media_type = MediaType_Video;
-                        break;
-
-                        case CDMi::MediaType::Audio:
-                            streamProperties.media_type = MediaType_Audio;
-                        break;
-
-                        case CDMi::MediaType::Data:
-                            streamProperties.media_type = MediaType_Data;
-                        break;
-
-                        default:
-                            streamProperties.media_type = MediaType_Unknown;
-                        break;
-                    }
-                    spPtr = &streamProperties;
-                    g_free(capsStr);
-                } else {
-                    TRACE_L1("Could not convert caps to string");
-                }
+                spPtr = &streamProperties.Get(caps);
             }
 
             SampleInfo sampleInfo;
@@ -322,11 +432,6 @@ OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* ses
                                                 mappedDataSize,
                                                 &sampleInfo,
                                                 spPtr);
-
-            //Clean up
-            if(subSampleInfoPtr != nullptr) {
-               free(subSampleInfoPtr);
-           }
         } else {
             TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Missing Protection Metadata.");
             result = ERROR_INVALID_DECRYPT_BUFFER;
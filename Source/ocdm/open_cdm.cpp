@@ -745,42 +745,45 @@ bool OpenCDMAccessor::WaitForKey(const uint8_t keyLength, const uint8_t keyId[],
         std::string& sessionId, OpenCDMSystem* system) const
     {
         bool result = false;
-        uint64_t timeOut(Core::Time::Now().Add(waitTime).Ticks());
+        const uint64_t hash(KeyHash(keyLength, keyId));
+        Exchange::KeyId key(keyId, keyLength);
 
-        do {
-            _adminLock.Lock();
+        _adminLock.Lock();
 
-            KeyMap::const_iterator session(_sessionKeys.begin());
+        std::pair<KeyIndex::const_iterator, KeyIndex::const_iterator> range(_keys.equal_range(hash));
 
-            for  (; session != _sessionKeys.end(); ++session) {
-                if (!system || session->second->BelongsTo(system) == true) {
-                    if(session->second->Status(keyLength, keyId) == status) {
-                        result = true;
-                        break;
-                    }
-                }
+        for (; range.first != range.second; ++(range.first)) {
+            const KeyEntry& entry(range.first->second);
+
+            if ((entry.Key == key) && (entry.Key.Status() == status) && ((system == nullptr) || (entry.Session->BelongsTo(system) == true))) {
+                sessionId = entry.Session->SessionId();
+                result = true;
+                break;
             }
+        }
 
-            if (result == false) {
-                Exchange::KeyId paramKey(keyId, keyLength);
-                _interested++;
+        if ((result == false) && (waitTime > 0)) {
+            Waiter waiter(key, status, system);
+            WaiterIndex::iterator index(_waiters.emplace(hash, &waiter));
 
-                _adminLock.Unlock();
+            _adminLock.Unlock();
 
-                TRACE_L1("Waiting for KeyId: %s", paramKey.ToString().c_str());
+            TRACE_L1("Waiting for KeyId: %s", key.ToString().c_str());
 
-                uint64_t now(Core::Time::Now().Ticks());
+            // KeyUpdate() signals the waiters of this key only.
+            waiter.Signal.Lock(waitTime);
 
-                if (now < timeOut) {
-                    _signal.Lock(static_cast<uint32_t>((timeOut - now) / Core::Time::TicksPerMillisecond));
-                }
+            _adminLock.Lock();
 
-                Core::InterlockedDecrement(_interested);
-            } else {
-                sessionId = session->first;
-                _adminLock.Unlock();
+            _waiters.erase(index);
+
+            if (waiter.SessionId.empty() == false) {
+                sessionId = waiter.SessionId;
+                result = true;
             }
-        } while ((result == false) && (timeOut > Core::Time::Now().Ticks()));
+        }
+
+        _adminLock.Unlock();
 
         return (result);
     }
@@ -818,8 +821,10 @@ bool OpenCDMAccessor::WaitForKey(const uint8_t keyLength, const uint8_t keyId[],
 
         _adminLock.Unlock();
     }
-    void OpenCDMAccessor::RemoveSession(const string& sessionId)
+    void OpenCDMAccessor::RemoveSession(OpenCDMSession* session)
     {
+        const string& sessionId = session->SessionId();
+
         _adminLock.Lock();
 
         KeyMap::iterator index(_sessionKeys.find(sessionId));
@@ -831,6 +836,81 @@ bool OpenCDMAccessor::WaitForKey(const uint8_t keyLength, const uint8_t keyId[],
                 sessionId.c_str());
         }
 
+        KeyIndex::iterator key(_keys.begin());
+
+        while (key != _keys.end()) {
+            if (key->second.Session == session) {
+                key = _keys.erase(key);
+            } else {
+                ++key;
+            }
+        }
+
+        _adminLock.Unlock();
+    }
+
+    Exchange::ISession::KeyStatus OpenCDMAccessor::Status(const OpenCDMSession* session, const uint8_t keyLength, const uint8_t keyId[]) const
+    {
+        Exchange::ISession::KeyStatus result(Exchange::ISession::StatusPending);
+
+        _adminLock.Lock();
+
+        KeyIndex::const_iterator index(Find(KeyHash(keyLength, keyId), Exchange::KeyId(keyId, keyLength), session));
+
+        if (index != _keys.cend()) {
+            result = index->second.Key.Status();
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    bool OpenCDMAccessor::HasKeyId(const OpenCDMSession* session, const uint8_t keyLength, const uint8_t keyId[]) const
+    {
+        _adminLock.Lock();
+
+        bool result = (Find(KeyHash(keyLength, keyId), Exchange::KeyId(keyId, keyLength), session) != _keys.cend());
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    void OpenCDMAccessor::KeyUpdate(const OpenCDMSession* session, const uint8_t keyLength, const uint8_t keyId[], const Exchange::ISession::KeyStatus status)
+    {
+        const uint64_t hash(KeyHash(keyLength, keyId));
+        Exchange::KeyId key(keyId, keyLength);
+
+        key.Status(status);
+
+        _adminLock.Lock();
+
+        std::pair<KeyIndex::iterator, KeyIndex::iterator> entries(_keys.equal_range(hash));
+
+        while ((entries.first != entries.second) && ((entries.first->second.Session != session) || (!(entries.first->second.Key == key)))) {
+            ++(entries.first);
+        }
+
+        if (entries.first == entries.second) {
+            _keys.emplace(hash, KeyEntry(key, session));
+        } else {
+            entries.first->second.Key.Status(status);
+        }
+
+        // Wake up the threads that are waiting for this key to reach this status.
+        std::pair<WaiterIndex::iterator, WaiterIndex::iterator> range(_waiters.equal_range(hash));
+
+        for (; range.first != range.second; ++(range.first)) {
+            Waiter& waiter(*(range.first->second));
+
+            if ((waiter.SessionId.empty() == true) && (waiter.Status == status) && (waiter.Key == key) &&
+                ((waiter.System == nullptr) || (session->BelongsTo(waiter.System) == true))) {
+                waiter.SessionId = session->SessionId();
+                waiter.Signal.SetEvent();
+            }
+        }
+
         _adminLock.Unlock();
     }
 
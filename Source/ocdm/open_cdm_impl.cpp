@@ -113,7 +113,7 @@ OpenCDMSession::~OpenCDMSession()
 {
     SessionPvt.Destruct(this, _pvtData);
 
-    OpenCDMAccessor::Instance()->RemoveSession(_sessionId);
+    OpenCDMAccessor::Instance()->RemoveSession(this);
 
     if (_session != nullptr) {
         _session->Revoke(&_sink);
@@ -26,6 +26,7 @@
 #include "open_cdm.h"
 
 #include <atomic>
+#include <unordered_map>
 
 using namespace Thunder;
 
@@ -50,6 +51,38 @@ struct OpenCDMAccessor : public Exchange::IAccessorOCDM {
 private:
     typedef std::map<string, OpenCDMSession*> KeyMap;
 
+    struct KeyEntry {
+        KeyEntry(const Exchange::KeyId& key, const OpenCDMSession* session)
+            : Key(key)
+            , Session(session)
+        {
+        }
+
+        Exchange::KeyId Key;
+        const OpenCDMSession* Session;
+    };
+
+    struct Waiter {
+        Waiter(const Exchange::KeyId& key, const Exchange::ISession::KeyStatus status, OpenCDMSystem* system)
+            : Key(key)
+            , Status(status)
+            , System(system)
+            , SessionId()
+            , Signal(false, true)
+        {
+        }
+
+        const Exchange::KeyId Key;
+        const Exchange::ISession::KeyStatus Status;
+        OpenCDMSystem* const System;
+        string SessionId;
+        Core::Event Signal;
+    };
+
+    // The key statuses of all sessions and the threads waiting for a key, indexed on the key id.
+    typedef std::unordered_multimap<uint64_t, KeyEntry> KeyIndex;
+    typedef std::unordered_multimap<uint64_t, Waiter*> WaiterIndex;
+
 protected:
     OpenCDMAccessor(const TCHAR domainName[])
         : _refCount(1)
@@ -58,9 +91,9 @@ protected:
         , _client()
         , _remote(nullptr)
         , _adminLock()
-        , _signal(false, true)
-        , _interested(0)
         , _sessionKeys()
+        , _keys()
+        , _waiters()
     {
         ASSERT(domainName != nullptr);
         _domain = domainName;
@@ -99,7 +132,7 @@ protected:
     }
 
 public:
-    OpenCDMAccessor() : _signal(false, true) { ASSERT(false); }
+    OpenCDMAccessor() { ASSERT(false); }
     OpenCDMAccessor(const OpenCDMAccessor&) = delete;
     OpenCDMAccessor& operator=(const OpenCDMAccessor&) = delete;
 
@@ -247,24 +280,12 @@ public:
 
     OpenCDMSession* Session(const std::string& sessionId);
 
-    void AddSession(OpenCDMSession* sessionId);
-    void RemoveSession(const string& sessionId);
-    void KeyUpdate()
-    {
-        _adminLock.Lock();
-
-        if (_interested != 0) {
-            // We need to notify the "other side", they are expecting an update
-            _signal.SetEvent();
+    void AddSession(OpenCDMSession* session);
+    void RemoveSession(OpenCDMSession* session);
 
-            while (_interested != 0) {
-                ::SleepMs(0);
-            }
-
-            _signal.ResetEvent();
-        }
-        _adminLock.Unlock();
-    }
+    Exchange::ISession::KeyStatus Status(const OpenCDMSession* session, const uint8_t keyLength, const uint8_t keyId[]) const;
+    bool HasKeyId(const OpenCDMSession* session, const uint8_t keyLength, const uint8_t keyId[]) const;
+    void KeyUpdate(const OpenCDMSession* session, const uint8_t keyLength, const uint8_t keyId[], const Exchange::ISession::KeyStatus status);
 
     uint64_t GetDrmSystemTime(const std::string& keySystem) const override
     {
@@ -478,6 +499,31 @@ public:
 
     void SystemBeingDestructed(OpenCDMSystem* system);
 
+private:
+    // Exchange::KeyId also matches the first 8 bytes of a key id in swapped (GUID) byte
+    // order, so only the last 8 bytes are used to index a key.
+    static uint64_t KeyHash(const uint8_t keyLength, const uint8_t keyId[])
+    {
+        uint64_t result = 0;
+
+        for (uint8_t index = 8; index < 16; index++) {
+            result = (result << 8) | (index < keyLength ? keyId[index] : 0);
+        }
+
+        return (result);
+    }
+
+    KeyIndex::const_iterator Find(const uint64_t hash, const Exchange::KeyId& key, const OpenCDMSession* session) const
+    {
+        std::pair<KeyIndex::const_iterator, KeyIndex::const_iterator> range(_keys.equal_range(hash));
+
+        while ((range.first != range.second) && ((range.first->second.Session != session) || (!(range.first->second.Key == key)))) {
+            ++(range.first);
+        }
+
+        return (range.first != range.second ? range.first : _keys.cend());
+    }
+
 private:
     mutable uint32_t _refCount;
     string _domain;
@@ -485,15 +531,13 @@ private:
     mutable Core::ProxyType<RPC::CommunicatorClient> _client;
     mutable Exchange::IAccessorOCDM* _remote;
     mutable Core::CriticalSection _adminLock;
-    mutable Core::Event _signal;
-    mutable volatile uint32_t _interested;
     KeyMap _sessionKeys;
+    KeyIndex _keys;
+    mutable WaiterIndex _waiters;
 };
 
 struct OpenCDMSession {
 private:
-    using KeyStatusesMap = std::list<Exchange::KeyId>;
-
     class Sink : public Exchange::ISession::ICallback {
     //private:
     public:
@@ -551,6 +595,7 @@ private:
     public:
         DataExchange(const string& bufferName)
             : Exchange::DataExchange(bufferName)
+            , _lock()
             , _busy(false)
         {
 
@@ -574,15 +619,13 @@ private:
         {
             int ret = 0;
 
-            // This works, because we know that the Audio and the Video streams are
-            // fed from
-            // the same process, so they will use the same critial section and thus
-            // will
-            // not interfere with each-other. If Audio and video will be located into
-            // two
-            // different processes, start using the administartion space to share a
-            // lock.
-            _systemLock.Lock();
+            // The shared buffer is owned by this session only, so it is sufficient to
+            // serialize the users of this buffer (e.g. the Audio and the Video stream
+            // of the same session, fed from the same process). Other sessions have
+            // their own buffer and can decrypt in parallel. If Audio and video will
+            // be located into two different processes, start using the administration
+            // space to share a lock.
+            _lock.Lock();
 
             _busy = true;
 
@@ -641,12 +684,13 @@ private:
 
             _busy = false;
 
-            _systemLock.Unlock();
+            _lock.Unlock();
 
             return (ret);
         }
 
     private:
+        Core::CriticalSection _lock;
         bool _busy;
     };
 
@@ -666,6 +710,7 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
         OpenCDMSessionCallbacks* callbacks,
         void* userData)
         : _sessionId()
+        , _decryptLock()
         , _decryptSession(nullptr)
         , _session(nullptr)
         , _sessionExt(nullptr)
@@ -674,7 +719,6 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
         , _URL()
         , _callback(callbacks)
         , _userData(userData)
-        , _keyStatuses()
         , _error()
         , _errorCode(~0)
         , _sysError(Exchange::OCDM_RESULT::OCDM_SUCCESS)
@@ -743,19 +787,11 @@ public:
     }
     inline Exchange::ISession::KeyStatus Status(const uint8_t keyIDLength, const uint8_t keyId[]) const
     {
-        Exchange::KeyId key(keyId, keyIDLength);
-
-        KeyStatusesMap::const_iterator index = std::find(_keyStatuses.begin(), _keyStatuses.end(), key);
-
-        return index != _keyStatuses.end() ? index->Status() : Exchange::ISession::StatusPending;
+        return (OpenCDMAccessor::Instance()->Status(this, keyIDLength, keyId));
     }
     inline bool HasKeyId(const uint8_t keyIDLength, const uint8_t keyID[]) const
     {
-        Exchange::KeyId key(keyID, keyIDLength);
-
-        KeyStatusesMap::const_iterator index = std::find(_keyStatuses.begin(), _keyStatuses.end(), key);
-
-        return (index != _keyStatuses.end());
+        return (OpenCDMAccessor::Instance()->HasKeyId(this, keyIDLength, keyID));
     }
     inline void Close()
     {
@@ -799,9 +835,13 @@ public:
     {
         uint32_t result = OpenCDMError::ERROR_INVALID_DECRYPT_BUFFER;
 
-        // lazy create decryptbuffer
+        // lazy create decryptbuffer, the first decrypting thread creates it, others wait for it.
         if(_decryptSession == nullptr) {
-            DecryptSession(_session);
+            _decryptLock.Lock();
+            if(_decryptSession == nullptr) {
+                DecryptSession(_session);
+            }
+            _decryptLock.Unlock();
         }
 
         // prevent unnecesary double atomic access
@@ -884,7 +924,7 @@ public:
         return (_sysError);
     }
 
-    bool BelongsTo(OpenCDMSystem* system) { return system == _system; }
+    bool BelongsTo(const OpenCDMSystem* system) const { return system == _system; }
 
 protected:
     void Session(Exchange::ISession* session)
@@ -927,8 +967,16 @@ protected:
                 _decryptSession = new DataExchange(bufferid); 
             }
             else if ( result == 1 ) {
-                while( _decryptSession == nullptr ) {
-                    SleepMs(0);
+                // Creation is serialized by the _decryptLock, so the buffer was not
+                // created through this session object. Attach to the one the server
+                // has, if it can not tell which, the next Decrypt() asks again.
+                ASSERT (_decryptSession == nullptr);
+                bufferid = _session->BufferId();
+
+                if (bufferid.empty() == false) {
+                    _decryptSession = new DataExchange(bufferid);
+                } else {
+                    TRACE_L1("DecryptSession already exists on the server side, but it is not known by name!");
                 }
             }
             else {
@@ -963,17 +1011,7 @@ protected:
     // Event fired on key status update
     void OnKeyStatusUpdate(const uint8_t keyID[], const uint8_t keyIDLength, const Exchange::ISession::KeyStatus status)
     {   
-        Exchange::KeyId key(keyID, keyIDLength);
-
-        KeyStatusesMap::iterator index = std::find(_keyStatuses.begin(), _keyStatuses.end(), key);
-
-        if (index == _keyStatuses.end()) {
-            key.Status(status);
-            _keyStatuses.emplace_back(key);
-        }
-        else {
-            index->Status(status);
-        }
+        OpenCDMAccessor::Instance()->KeyUpdate(this, keyIDLength, keyID, status);
 
         if ((_callback != nullptr) && (_callback->key_update_callback != nullptr) && (status != Exchange::ISession::StatusPending)) {
             _callback->key_update_callback(this, _userData, keyID, keyIDLength);
@@ -989,6 +1027,7 @@ protected:
 
 private:
     std::string _sessionId;
+    Core::CriticalSection _decryptLock;
     std::atomic<DataExchange*> _decryptSession;
     Exchange::ISession* _session;
     Exchange::ISessionExt* _sessionExt;
@@ -997,7 +1036,6 @@ private:
     std::string _URL;
     OpenCDMSessionCallbacks* _callback;
     void* _userData; 
-    KeyStatusesMap _keyStatuses;
     std::string _error;
     uint32_t _errorCode;
     Exchange::OCDM_RESULT _sysError;
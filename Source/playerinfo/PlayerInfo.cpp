@@ -56,18 +56,173 @@ playerinfo_status_t PlayerInfoStatus(uint32_t status)
     return playerInfoStatus;
 }
 
+static playerinfo_videocodec_t VideoCodec(const Exchange::IPlayerProperties::VideoCodec codec)
+{
+    playerinfo_videocodec_t result;
+
+    switch (codec) {
+    case Exchange::IPlayerProperties::VideoCodec::VIDEO_UNDEFINED:
+        result = PLAYERINFO_VIDEO_UNDEFINED;
+        break;
+    case Exchange::IPlayerProperties::VideoCodec::VIDEO_H263:
+        result = PLAYERINFO_VIDEO_H263;
+        break;
+    case Exchange::IPlayerProperties::VideoCodec::VIDEO_H264:
+        result = PLAYERINFO_VIDEO_H264;
+        break;
+    case Exchange::IPlayerProperties::VideoCodec::VIDEO_H265:
+        result = PLAYERINFO_VIDEO_H265;
+        break;
+    case Exchange::IPlayerProperties::VideoCodec::VIDEO_H265_10:
+        result = PLAYERINFO_VIDEO_H265_10;
+        break;
+    case Exchange::IPlayerProperties::VideoCodec::VIDEO_MPEG:
+        result = PLAYERINFO_VIDEO_MPEG;
+        break;
+    case Exchange::IPlayerProperties::VideoCodec::VIDEO_VP8:
+        result = PLAYERINFO_VIDEO_VP8;
+        break;
+    case Exchange::IPlayerProperties::VideoCodec::VIDEO_VP9:
+        result = PLAYERINFO_VIDEO_VP9;
+        break;
+    case Exchange::IPlayerProperties::VideoCodec::VIDEO_VP10:
+        result = PLAYERINFO_VIDEO_VP10;
+        break;
+    default:
+        TRACE_L1(_T("New video codec in the interface, not handled in client library!"));
+        ASSERT(false && "Invalid enum");
+        result = PLAYERINFO_VIDEO_UNDEFINED;
+        break;
+    }
+
+    return (result);
+}
+
+static playerinfo_audiocodec_t AudioCodec(const Exchange::IPlayerProperties::AudioCodec codec)
+{
+    playerinfo_audiocodec_t result;
+
+    switch (codec) {
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_UNDEFINED:
+        result = PLAYERINFO_AUDIO_UNDEFINED;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_AAC:
+        result = PLAYERINFO_AUDIO_AAC;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_AC3:
+        result = PLAYERINFO_AUDIO_AC3;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_AC3_PLUS:
+        result = PLAYERINFO_AUDIO_AC3_PLUS;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_DTS:
+        result = PLAYERINFO_AUDIO_DTS;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_MPEG1:
+        result = PLAYERINFO_AUDIO_MPEG1;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_MPEG2:
+        result = PLAYERINFO_AUDIO_MPEG2;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_MPEG3:
+        result = PLAYERINFO_AUDIO_MPEG3;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_MPEG4:
+        result = PLAYERINFO_AUDIO_MPEG4;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_OPUS:
+        result = PLAYERINFO_AUDIO_OPUS;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_VORBIS_OGG:
+        result = PLAYERINFO_AUDIO_VORBIS_OGG;
+        break;
+    case Exchange::IPlayerProperties::AudioCodec::AUDIO_WAV:
+        result = PLAYERINFO_AUDIO_WAV;
+        break;
+    default:
+        TRACE_L1(_T("New audio codec in the interface, not handled in client library!"));
+        ASSERT(false && "Invalid enum");
+        result = PLAYERINFO_AUDIO_UNDEFINED;
+        break;
+    }
+
+    return (result);
+}
+
+static uint32_t Resolution(const Exchange::IPlayerProperties::PlaybackResolution value, playerinfo_playback_resolution_t& result)
+{
+    uint32_t status = playerinfo_status::PLAYERINFO_OK;
+
+    switch (value) {
+    case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_UNKNOWN:
+        result = PLAYERINFO_RESOLUTION_UNKNOWN;
+        break;
+    case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_480I:
+        result = PLAYERINFO_RESOLUTION_480I;
+        break;
+    case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_480P:
+        result = PLAYERINFO_RESOLUTION_480P;
+        break;
+    case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_576I:
+        result = PLAYERINFO_RESOLUTION_576I;
+        break;
+    case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_576P:
+        result = PLAYERINFO_RESOLUTION_576P;
+        break;
+    case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_720P:
+        result = PLAYERINFO_RESOLUTION_720P;
+        break;
+    case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_1080I:
+        result = PLAYERINFO_RESOLUTION_1080I;
+        break;
+    case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_1080P:
+        result = PLAYERINFO_RESOLUTION_1080P;
+        break;
+    case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_2160P30:
+        result = PLAYERINFO_RESOLUTION_2160P30;
+        break;
+    case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_2160P60:
+        result = PLAYERINFO_RESOLUTION_2160P60;
+        break;
+    default:
+        TRACE_GLOBAL(Trace::Warning, ("New resolution in the interface, not handled in client library!"));
+        result = PLAYERINFO_RESOLUTION_UNKNOWN;
+        status = playerinfo_status::PLAYERINFO_ERROR_UNKNOWN_KEY;
+        break;
+    }
+
+    return (status);
+}
+
 class PlayerInfo : protected RPC::SmartInterfaceType<Exchange::IPlayerProperties> {
 private:
     using BaseClass = RPC::SmartInterfaceType<Exchange::IPlayerProperties>;
     using DolbyModeAudioUpdateCallbacks = std::map<playerinfo_dolby_audio_updated_cb, void*>;
     using OperationalStateChangeCallbacks = std::map<playerinfo_operational_state_change_cb, void*>;
+    using ResolutionUpdateCallbacks = std::map<playerinfo_playback_resolution_updated_cb, void*>;
+
+    // The codec lists are kept as a bitmask indexed by the playerinfo_*codec_t value,
+    // the top bit marks the mask as fetched. The interface only reports them once per
+    // connection, so they are refetched after a reconnect, or (audio) after the Dolby
+    // output reported a change, and not for every query.
+    static constexpr uint32_t CodecsFetched = 0x80000000;
+
+    // IPlayerProperties has no resolution event, the monitor samples the resolution on
+    // behalf of all registered callbacks and only runs while there are any.
+    static constexpr uint32_t ResolutionInterval = 500; // ms
 
     //CONSTRUCTORS
     PlayerInfo(const string& callsign)
         : BaseClass()
+        , _playerInterface(nullptr)
         , _dolbyInterface(nullptr)
         , _callsign(callsign)
+        , _videoCodecs(0)
+        , _audioCodecs(0)
+        , _resolution(Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_UNKNOWN)
+        , _resolutionKnown(false)
         , _dolbyNotification(this)
+        , _resolutionMonitor(*this)
     {
         ASSERT(_singleton==nullptr);
         _singleton=this;
@@ -85,6 +240,9 @@ private:
     {
         _lock.Lock();
 
+        // A different output mode may change what the audio path accepts.
+        _audioCodecs.store(0, std::memory_order_relaxed);
+
         for (auto& index : _dolbyCallbacks) {
             index.first(index.second);
         }
@@ -120,6 +278,13 @@ private:
             }
         }
 
+        _videoCodecs.store(0, std::memory_order_relaxed);
+        _audioCodecs.store(0, std::memory_order_relaxed);
+
+        if ((_playerInterface != nullptr) && (_resolutionCallbacks.empty() == false)) {
+            _resolutionMonitor.Run();
+        }
+
         for (auto& index : _operationalStateCallbacks) {
             index.first(upAndRunning, index.second);
         }
@@ -151,22 +316,187 @@ private:
         PlayerInfo& _parent;
     };
 
+    class ResolutionMonitor : public Core::Thread {
+    public:
+        ResolutionMonitor() = delete;
+        ResolutionMonitor(const ResolutionMonitor&) = delete;
+        ResolutionMonitor& operator=(const ResolutionMonitor&) = delete;
+
+        explicit ResolutionMonitor(PlayerInfo& parent)
+            : Core::Thread()
+            , _parent(parent)
+        {
+        }
+        ~ResolutionMonitor() override
+        {
+            Thread::Stop();
+            Thread::Wait(Thread::BLOCKED | Thread::STOPPED, Core::infinite);
+        }
+
+        uint32_t Worker() override
+        {
+            return (_parent.ResolutionCheck());
+        }
+
+    private:
+        PlayerInfo& _parent;
+    };
+
+    uint32_t ResolutionCheck()
+    {
+        uint32_t delay = Core::infinite;
+        Exchange::IPlayerProperties* player = nullptr;
+
+        _lock.Lock();
+
+        if ((_playerInterface == nullptr) || (_resolutionCallbacks.empty() == true)) {
+            _resolutionMonitor.Block();
+        } else {
+            // Sample without holding the lock, the getters should not wait for this call.
+            player = _playerInterface;
+            player->AddRef();
+        }
+
+        _lock.Unlock();
+
+        if (player != nullptr) {
+            Exchange::IPlayerProperties::PlaybackResolution value;
+
+            if (player->Resolution(value) == Core::ERROR_NONE) {
+                ResolutionUpdateCallbacks callbacks;
+
+                _lock.Lock();
+
+                if ((_resolutionKnown == true) && (value != _resolution)) {
+                    callbacks = _resolutionCallbacks;
+                }
+
+                _resolution = value;
+                _resolutionKnown = true;
+
+                _lock.Unlock();
+
+                playerinfo_playback_resolution_t resolution;
+
+                if ((callbacks.empty() == false) && (Resolution(value, resolution) == playerinfo_status::PLAYERINFO_OK)) {
+                    for (auto& index : callbacks) {
+                        index.first(resolution, index.second);
+                    }
+                }
+            }
+
+            player->Release();
+
+            delay = ResolutionInterval;
+        }
+
+        return (delay);
+    }
+
+    uint32_t VideoCodecMask() const
+    {
+        uint32_t mask = _videoCodecs.load(std::memory_order_acquire);
+
+        if ((mask & CodecsFetched) == 0) {
+            Exchange::IPlayerProperties::IVideoCodecIterator* videoCodecs = nullptr;
+
+            _lock.Lock();
+
+            if ((_playerInterface != nullptr) && (PlayerInfoStatus(_playerInterface->VideoCodecs(videoCodecs)) == playerinfo_status::PLAYERINFO_OK) && (videoCodecs != nullptr)) {
+                Exchange::IPlayerProperties::VideoCodec codec;
+
+                mask = CodecsFetched;
+
+                while (videoCodecs->Next(codec) == true) {
+                    mask |= (1u << VideoCodec(codec));
+                }
+                videoCodecs->Release();
+
+                _videoCodecs.store(mask, std::memory_order_release);
+            }
+
+            _lock.Unlock();
+        }
+
+        return (mask & (~CodecsFetched));
+    }
+
+    uint32_t AudioCodecMask() const
+    {
+        uint32_t mask = _audioCodecs.load(std::memory_order_acquire);
+
+        if ((mask & CodecsFetched) == 0) {
+            Exchange::IPlayerProperties::IAudioCodecIterator* audioCodecs = nullptr;
+
+            _lock.Lock();
+
+            if ((_playerInterface != nullptr) && (PlayerInfoStatus(_playerInterface->AudioCodecs(audioCodecs)) == playerinfo_status::PLAYERINFO_OK) && (audioCodecs != nullptr)) {
+                Exchange::IPlayerProperties::AudioCodec codec;
+
+                mask = CodecsFetched;
+
+                while (audioCodecs->Next(codec) == true) {
+                    mask |= (1u << AudioCodec(codec));
+                }
+                audioCodecs->Release();
+
+                _audioCodecs.store(mask, std::memory_order_release);
+            }
+
+            _lock.Unlock();
+        }
+
+        return (mask & (~CodecsFetched));
+    }
+
+    template <typename CODEC>
+    static int8_t Codecs(uint32_t mask, CODEC array[], const uint8_t length)
+    {
+        int8_t value = 0;
+        uint8_t numberOfCodecs = 0;
+
+        for (uint32_t bits = mask; bits != 0; bits &= (bits - 1)) {
+            ++numberOfCodecs;
+        }
+
+        if (numberOfCodecs < length) {
+            for (uint8_t codec = 0; mask != 0; ++codec, mask >>= 1) {
+                if ((mask & 1) != 0) {
+                    array[value++] = static_cast<CODEC>(codec);
+                }
+            }
+        } else {
+            value = -numberOfCodecs;
+        }
+
+        return (value);
+    }
+
 private:
     //MEMBERS
     mutable Core::CriticalSection _lock;
     Exchange::IPlayerProperties* _playerInterface;
     Exchange::Dolby::IOutput* _dolbyInterface;
     std::string _callsign;
+    mutable std::atomic<uint32_t> _videoCodecs;
+    mutable std::atomic<uint32_t> _audioCodecs;
+    Exchange::IPlayerProperties::PlaybackResolution _resolution;
+    bool _resolutionKnown;
 
     DolbyModeAudioUpdateCallbacks _dolbyCallbacks;
     OperationalStateChangeCallbacks _operationalStateCallbacks;
+    ResolutionUpdateCallbacks _resolutionCallbacks;
     Core::SinkType<Notification> _dolbyNotification;
+    ResolutionMonitor _resolutionMonitor;
     static PlayerInfo* _singleton;
 
 public:
     //OBJECT MANAGEMENT
     ~PlayerInfo()
     {
+        _resolutionMonitor.Stop();
+        _resolutionMonitor.Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+
         BaseClass::Close(Core::infinite);
         ASSERT(_singleton!=nullptr);
         _singleton = nullptr;
@@ -271,160 +601,81 @@ public:
         return (result);
     }
 
-    uint32_t IsAudioEquivalenceEnabled(bool& outIsEnabled) const
-    {
-        Core::SafeSyncType<Core::CriticalSection> lock(_lock);
-        return (_playerInterface != nullptr ? PlayerInfoStatus(_playerInterface->IsAudioEquivalenceEnabled(outIsEnabled)) : static_cast<uint32_t>(playerinfo_status::PLAYERINFO_ERROR_UNAVAILABLE));
-    }
-
-    uint32_t PlaybackResolution(Exchange::IPlayerProperties::PlaybackResolution& outResolution) const
+    uint32_t RegisterPlaybackResolutionChangedCallback(playerinfo_playback_resolution_updated_cb callback, void* userdata)
     {
-        Core::SafeSyncType<Core::CriticalSection> lock(_lock);
-        return (_playerInterface != nullptr ? PlayerInfoStatus(_playerInterface->Resolution(outResolution)) : static_cast<uint32_t>(playerinfo_status::PLAYERINFO_ERROR_UNAVAILABLE));
-    }
+        uint32_t result = playerinfo_status::PLAYERINFO_ERROR_ALREADY_REGISTERED;
 
-    int8_t VideoCodecs(playerinfo_videocodec_t array[], const uint8_t length) const
-    {
-        Exchange::IPlayerProperties::IVideoCodecIterator* videoCodecs;
-        int8_t value = 0;
+        ASSERT(callback != nullptr);
 
         _lock.Lock();
 
-        if (_playerInterface != nullptr) {
-            if (PlayerInfoStatus(_playerInterface->VideoCodecs(videoCodecs)) == playerinfo_status::PLAYERINFO_OK && videoCodecs != nullptr) {
+        if (_resolutionCallbacks.find(callback) == _resolutionCallbacks.end()) {
+            if (_resolutionCallbacks.empty() == true) {
+                // Changes are reported relative to what the monitor saw first.
+                _resolutionKnown = false;
+            }
 
-                Exchange::IPlayerProperties::VideoCodec codec;
+            _resolutionCallbacks.emplace(std::piecewise_construct, std::forward_as_tuple(callback), std::forward_as_tuple(userdata));
+            result = playerinfo_status::PLAYERINFO_OK;
 
-                uint8_t numberOfCodecs = 0;
-                const uint8_t newArraySize = 50;
-                playerinfo_videocodec_t newArray[newArraySize];
-
-                while (videoCodecs->Next(codec) && numberOfCodecs < newArraySize) {
-                    switch (codec) {
-                    case Exchange::IPlayerProperties::VideoCodec::VIDEO_UNDEFINED:
-                        newArray[numberOfCodecs] = PLAYERINFO_VIDEO_UNDEFINED;
-                        break;
-                    case Exchange::IPlayerProperties::VideoCodec::VIDEO_H263:
-                        newArray[numberOfCodecs] = PLAYERINFO_VIDEO_H263;
-                        break;
-                    case Exchange::IPlayerProperties::VideoCodec::VIDEO_H264:
-                        newArray[numberOfCodecs] = PLAYERINFO_VIDEO_H264;
-                        break;
-                    case Exchange::IPlayerProperties::VideoCodec::VIDEO_H265:
-                        newArray[numberOfCodecs] = PLAYERINFO_VIDEO_H265;
-                        break;
-                    case Exchange::IPlayerProperties::VideoCodec::VIDEO_H265_10:
-                        newArray[numberOfCodecs] = PLAYERINFO_VIDEO_H265_10;
-                        break;
-                    case Exchange::IPlayerProperties::VideoCodec::VIDEO_MPEG:
-                        newArray[numberOfCodecs] = PLAYERINFO_VIDEO_MPEG;
-                        break;
-                    case Exchange::IPlayerProperties::VideoCodec::VIDEO_VP8:
-                        newArray[numberOfCodecs] = PLAYERINFO_VIDEO_VP8;
-                        break;
-                    case Exchange::IPlayerProperties::VideoCodec::VIDEO_VP9:
-                        newArray[numberOfCodecs] = PLAYERINFO_VIDEO_VP9;
-                        break;
-                    case Exchange::IPlayerProperties::VideoCodec::VIDEO_VP10:
-                        newArray[numberOfCodecs] = PLAYERINFO_VIDEO_VP10;
-                        break;
-                    default:
-                        TRACE_L1(_T("New video codec in the interface, not handled in client library!"));
-                        ASSERT(false && "Invalid enum");
-                        newArray[numberOfCodecs] = PLAYERINFO_VIDEO_UNDEFINED;
-                        break;
-                    }
-                    ++numberOfCodecs;
-                }
-                if (numberOfCodecs < length) {
-                    value = numberOfCodecs;
-                    std::copy(newArray, newArray + numberOfCodecs, array);
-                } else {
-                    value = -numberOfCodecs;
-                }
-                videoCodecs->Release();
+            if (_playerInterface != nullptr) {
+                _resolutionMonitor.Run();
             }
         }
 
         _lock.Unlock();
 
-        return (value);
+        return (result);
     }
-    int8_t AudioCodecs(playerinfo_audiocodec_t array[], const uint8_t length) const
+
+    uint32_t UnregisterPlaybackResolutionChangedCallback(playerinfo_playback_resolution_updated_cb callback)
     {
-        Exchange::IPlayerProperties::IAudioCodecIterator* audioCodecs;
-        int8_t value = 0;
+        uint32_t result = playerinfo_status::PLAYERINFO_ERROR_ALREADY_UNREGISTERED;
 
-        _lock.Lock();
+        ASSERT(callback != nullptr);
 
-        if (_playerInterface != nullptr) {
-            if (_playerInterface->AudioCodecs(audioCodecs) == playerinfo_status::PLAYERINFO_OK && audioCodecs != nullptr) {
+        _lock.Lock();
 
-                Exchange::IPlayerProperties::AudioCodec codec;
+        ResolutionUpdateCallbacks::iterator index(_resolutionCallbacks.find(callback));
 
-                uint8_t numberOfCodecs = 0;
-                const uint8_t newArraySize = 50;
-                playerinfo_audiocodec_t newArray[newArraySize];
-
-                while (audioCodecs->Next(codec) && numberOfCodecs < newArraySize) {
-                    switch (codec) {
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_UNDEFINED:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_UNDEFINED;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_AAC:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_AAC;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_AC3:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_AC3;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_AC3_PLUS:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_AC3_PLUS;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_DTS:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_DTS;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_MPEG1:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_MPEG1;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_MPEG2:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_MPEG2;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_MPEG3:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_MPEG3;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_MPEG4:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_MPEG4;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_OPUS:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_OPUS;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_VORBIS_OGG:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_VORBIS_OGG;
-                        break;
-                    case Exchange::IPlayerProperties::AudioCodec::AUDIO_WAV:
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_WAV;
-                        break;
-                    default:
-                        TRACE_L1(_T("New audio codec in the interface, not handled in client library!"));
-                        ASSERT(false && "Invalid enum");
-                        newArray[numberOfCodecs] = PLAYERINFO_AUDIO_UNDEFINED;
-                        break;
-                    }
-                    ++numberOfCodecs;
-                }
-                if (numberOfCodecs < length) {
-                    value = numberOfCodecs;
-                    std::copy(newArray, newArray + numberOfCodecs, array);
-                } else {
-                    value = -numberOfCodecs;
-                }
-                audioCodecs->Release();
-            }
+        if (index != _resolutionCallbacks.end()) {
+            _resolutionCallbacks.erase(index);
+            result = playerinfo_status::PLAYERINFO_OK;
         }
 
         _lock.Unlock();
 
-        return (value);
+        return (result);
+    }
+
+    uint32_t IsAudioEquivalenceEnabled(bool& outIsEnabled) const
+    {
+        Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+        return (_playerInterface != nullptr ? PlayerInfoStatus(_playerInterface->IsAudioEquivalenceEnabled(outIsEnabled)) : static_cast<uint32_t>(playerinfo_status::PLAYERINFO_ERROR_UNAVAILABLE));
+    }
+
+    uint32_t PlaybackResolution(Exchange::IPlayerProperties::PlaybackResolution& outResolution) const
+    {
+        Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+        return (_playerInterface != nullptr ? PlayerInfoStatus(_playerInterface->Resolution(outResolution)) : static_cast<uint32_t>(playerinfo_status::PLAYERINFO_ERROR_UNAVAILABLE));
+    }
+
+    int8_t VideoCodecs(playerinfo_videocodec_t array[], const uint8_t length) const
+    {
+        return (Codecs(VideoCodecMask(), array, length));
+    }
+    int8_t AudioCodecs(playerinfo_audiocodec_t array[], const uint8_t length) const
+    {
+        return (Codecs(AudioCodecMask(), array, length));
+    }
+
+    bool IsVideoCodecSupported(const playerinfo_videocodec_t codec) const
+    {
+        return ((static_cast<uint32_t>(codec) < 31) && ((VideoCodecMask() & (1u << codec)) != 0));
+    }
+    bool IsAudioCodecSupported(const playerinfo_audiocodec_t codec) const
+    {
+        return ((static_cast<uint32_t>(codec) < 31) && ((AudioCodecMask() & (1u << codec)) != 0));
     }
 
     bool IsAtmosMetadataSupported() const
@@ -501,6 +752,16 @@ uint32_t playerinfo_unregister_dolby_sound_mode_updated_callback(playerinfo_dolb
     return PlayerInfo::Instance().UnregisterDolbyAudioModeChangedCallback(callback);
 }
 
+uint32_t playerinfo_register_playback_resolution_updated_callback(playerinfo_playback_resolution_updated_cb callback, void* userdata)
+{
+    return PlayerInfo::Instance().RegisterPlaybackResolutionChangedCallback(callback, userdata);
+}
+
+uint32_t playerinfo_unregister_playback_resolution_updated_callback(playerinfo_playback_resolution_updated_cb callback)
+{
+    return PlayerInfo::Instance().UnregisterPlaybackResolutionChangedCallback(callback);
+}
+
 void playerinfo_name(char buffer[], const uint8_t length)
 {
     strncpy(buffer, PlayerInfo::Instance().Name().c_str(), length);
@@ -508,51 +769,18 @@ void playerinfo_name(char buffer[], const uint8_t length)
 
 uint32_t playerinfo_playback_resolution(playerinfo_playback_resolution_t* resolution)
 {
+    uint32_t result = playerinfo_status::PLAYERINFO_ERROR_UNAVAILABLE;
+
     if (resolution != nullptr) {
         Exchange::IPlayerProperties::PlaybackResolution value = Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_UNKNOWN;
         *resolution = PLAYERINFO_RESOLUTION_UNKNOWN;
 
         if (PlayerInfo::Instance().PlaybackResolution(value) == playerinfo_status::PLAYERINFO_OK) {
-            switch (value) {
-            case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_UNKNOWN:
-                *resolution = PLAYERINFO_RESOLUTION_UNKNOWN;
-                break;
-            case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_480I:
-                *resolution = PLAYERINFO_RESOLUTION_480I;
-                break;
-            case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_480P:
-                *resolution = PLAYERINFO_RESOLUTION_480P;
-                break;
-            case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_576I:
-                *resolution = PLAYERINFO_RESOLUTION_576I;
-                break;
-            case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_576P:
-                *resolution = PLAYERINFO_RESOLUTION_576P;
-                break;
-            case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_720P:
-                *resolution = PLAYERINFO_RESOLUTION_720P;
-                break;
-            case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_1080I:
-                *resolution = PLAYERINFO_RESOLUTION_1080I;
-                break;
-            case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_1080P:
-                *resolution = PLAYERINFO_RESOLUTION_1080P;
-                break;
-            case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_2160P30:
-                *resolution = PLAYERINFO_RESOLUTION_2160P30;
-                break;
-            case Exchange::IPlayerProperties::PlaybackResolution::RESOLUTION_2160P60:
-                *resolution = PLAYERINFO_RESOLUTION_2160P60;
-                break;
-            default:
-                TRACE_GLOBAL(Trace::Warning, ("New resolution in the interface, not handled in client library!"));
-                *resolution = PLAYERINFO_RESOLUTION_UNKNOWN;
-                return playerinfo_status::PLAYERINFO_ERROR_UNKNOWN_KEY;
-            }
-            return playerinfo_status::PLAYERINFO_OK;
+            result = Resolution(value, *resolution);
         }
     }
-    return playerinfo_status::PLAYERINFO_ERROR_UNAVAILABLE;
+
+    return (result);
 }
 
 uint32_t playerinfo_is_audio_equivalence_enabled(bool* is_enabled)
@@ -570,6 +798,16 @@ int8_t playerinfo_audio_codecs(playerinfo_audiocodec_t array[], const uint8_t le
     return PlayerInfo::Instance().AudioCodecs(array, length);
 }
 
+bool playerinfo_is_video_codec_supported(const playerinfo_videocodec_t codec)
+{
+    return PlayerInfo::Instance().IsVideoCodecSupported(codec);
+}
+
+bool playerinfo_is_audio_codec_supported(const playerinfo_audiocodec_t codec)
+{
+    return PlayerInfo::Instance().IsAudioCodecSupported(codec);
+}
+
 bool playerinfo_is_dolby_atmos_supported()
 {
     return PlayerInfo::Instance().IsAtmosMetadataSupported();
@@ -127,6 +127,14 @@ typedef void (*playerinfo_operational_state_change_cb)(bool is_operational, void
 */
 typedef void (*playerinfo_dolby_audio_updated_cb)(void* userdata);
 
+/**
+* @brief Will be called if the video playback resolution changed.
+*
+* @param resolution The new playback resolution
+* @param userData Pointer passed along when @ref playerinfo_register_playback_resolution_updated_callback was issued.
+*/
+typedef void (*playerinfo_playback_resolution_updated_cb)(playerinfo_playback_resolution_t resolution, void* userdata);
+
 /**
  * @brief Get a @ref playerinfo_type instance that matches the PlayerInfo implementation
  * 
@@ -185,6 +193,26 @@ EXTERNAL uint32_t playerinfo_register_dolby_sound_mode_updated_callback(playerin
  *         PLAYERINFO_ERROR_UNAVAILABLE if: instance or is NULL */
 EXTERNAL uint32_t playerinfo_unregister_dolby_sound_mode_updated_callback(playerinfo_dolby_audio_updated_cb callback);
 
+/**
+ * @brief Register for the updates of the video playback resolution, so it does not
+ *        need to be polled. Changes are reported relative to the resolution at the
+ *        time of the first registration, query it once with @ref playerinfo_playback_resolution.
+ * 
+ * @param callback Function to be called on update
+ * @param userdata Data passed to callback funcion
+ * @return  PLAYERINFO_OK on succes, 
+ *          PLAYERINFO_ERROR_ALREADY_REGISTERED if callback already registered
+ */
+EXTERNAL uint32_t playerinfo_register_playback_resolution_updated_callback(playerinfo_playback_resolution_updated_cb callback, void* userdata);
+
+/**
+ * @brief Unregister from the updates of the video playback resolution
+ * 
+ * @param callback Callback function unregister
+ * @return PLAYERINFO_OK on succes, 
+ *         PLAYERINFO_ERROR_ALREADY_UNREGISTERED if callback not registered */
+EXTERNAL uint32_t playerinfo_unregister_playback_resolution_updated_callback(playerinfo_playback_resolution_updated_cb callback);
+
 /**
  * @brief Get the instance name (callsign)
  * 
@@ -242,6 +270,27 @@ EXTERNAL int8_t playerinfo_audio_codecs(playerinfo_audiocodec_t array[], const u
  */
 EXTERNAL int8_t playerinfo_video_codecs(playerinfo_videocodec_t array[], const uint8_t length);
 
+/**
+ * @brief Checks if the player supports an audio codec. The codec list is fetched once
+ *        and cached, it is refreshed after the connection is re-established or the
+ *        Dolby output mode changed.
+ * 
+ * @param codec The codec to check
+ * @return true if the player supports @ref codec,
+ *         false otherwise or on an invalid connection
+ */
+EXTERNAL bool playerinfo_is_audio_codec_supported(const playerinfo_audiocodec_t codec);
+
+/**
+ * @brief Checks if the player supports a video codec. The codec list is fetched once
+ *        and cached, it is refreshed after the connection is re-established.
+ * 
+ * @param codec The codec to check
+ * @return true if the player supports @ref codec,
+ *         false otherwise or on an invalid connection
+ */
+EXTERNAL bool playerinfo_is_video_codec_supported(const playerinfo_videocodec_t codec);
+
 /**
  * @brief Atmos capabilities of Sink
  * 
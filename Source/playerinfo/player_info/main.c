@@ -57,6 +57,7 @@ void show_menu(void)
            "\tR : Check playback resolution.\n"
            "\tA : Check audio codecs.\n"
            "\tV : Check video codecs.\n"
+           "\tH : Check H.264 and AAC support.\n"
            "\tM : Is Atmos metadata supported.\n"
            "\tB : Get Dolby soundmode .\n"
            "\tE : Enable Atmos output.\n"
@@ -72,6 +73,11 @@ void on_dolby_event(VARIABLE_IS_NOT_USED void* data)
     Trace("Dolby event triggered");
 }
 
+void on_resolution_event(playerinfo_playback_resolution_t resolution, VARIABLE_IS_NOT_USED void* data)
+{
+    Trace("Playback resolution changed to %d", resolution);
+}
+
 void on_operational_state_change(bool is_operational, VARIABLE_IS_NOT_USED void* data)
 {
     Trace("Operational state of the instance %s operational", is_operational ? "is" : "not");
@@ -101,6 +107,9 @@ int main(void)
             if (playerinfo_register_dolby_sound_mode_updated_callback(on_dolby_event, NULL) == 0) {
                 Trace("Registered for an dolby sound mode update.");
             }
+            if (playerinfo_register_playback_resolution_updated_callback(on_resolution_event, NULL) == 0) {
+                Trace("Registered for a playback resolution update.");
+            }
             break;
         }
 
@@ -108,6 +117,9 @@ int main(void)
             if (playerinfo_unregister_dolby_sound_mode_updated_callback(on_dolby_event) == 0) {
                 Trace("Unregistered from an dolby sound mode update.");
             }
+            if (playerinfo_unregister_playback_resolution_updated_callback(on_resolution_event) == 0) {
+                Trace("Unregistered from a playback resolution update.");
+            }
             break;
         }
 
@@ -282,6 +294,12 @@ int main(void)
             break;
         }
 
+        case 'H': {
+            Trace("H.264 %s supported", playerinfo_is_video_codec_supported(PLAYERINFO_VIDEO_H264) ? "is" : "not");
+            Trace("AAC %s supported", playerinfo_is_audio_codec_supported(PLAYERINFO_AUDIO_AAC) ? "is" : "not");
+            break;
+        }
+
         case 'M': {
             bool is_supported = false;
             is_supported = playerinfo_is_dolby_atmos_supported();
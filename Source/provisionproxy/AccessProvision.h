@@ -64,6 +64,31 @@ int GetDeviceId(unsigned short MaxIdLength, char Id[]);
 
 int GetDRMId(const char label[], const unsigned short MaxIdLength, char Id[]);
 
+/*
+ * provisioningproxy_prefetch - function to request and cache the DRM ids for a set of labels up front,
+ *                              all over the one (kept open) link to the provisioning
+ *
+ * Parameters
+ *  labels - Names of the DRM ids to request
+ *  count  - Number of entries in labels
+ *
+ * Return value
+ *  Number of labels cached, 0 if caching is disabled (see provisioningproxy_cache_lifetime)
+ *
+ */
+unsigned short provisioningproxy_prefetch(const char* const labels[], const unsigned short count);
+
+/*
+ * provisioningproxy_cache_lifetime - function to set how long cleared DRM ids are cached. The
+ *                                    cache is kept in locked memory and wiped on expiry. The
+ *                                    default is taken from PROVISION_CACHE_LIFETIME, or 0.
+ *
+ * Parameters
+ *  lifetime - in milliseconds, 0 disables the cache and wipes what is cached
+ *
+ */
+void provisioningproxy_cache_lifetime(const unsigned int lifetime);
+
 void provisioningproxy_dispose();
 }
 
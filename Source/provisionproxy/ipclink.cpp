@@ -31,6 +31,12 @@
 #include "IPCProvision.h"
 MODULE_NAME_ARCHIVE_DECLARATION
 
+#include "../common/EndPointLink.h"
+
+#ifndef __WINDOWS__
+#include <sys/mman.h>
+#endif
+
 using namespace Thunder;
 
 static string GetEndPoint()
@@ -44,6 +50,398 @@ static string GetEndPoint()
 #endif
 }
 
+namespace {
+
+    // Page aligned memory that is locked in RAM, so a cleared DRM id is never
+    // swapped out (nor ends up in a core dump), and is wiped before it is freed.
+    class LockedBuffer {
+    public:
+        LockedBuffer() = delete;
+        LockedBuffer(const LockedBuffer&) = delete;
+        LockedBuffer& operator=(const LockedBuffer&) = delete;
+
+        explicit LockedBuffer(const uint32_t size)
+            : _data(nullptr)
+            , _size(0)
+            , _length(0)
+        {
+            const uint32_t pageSize = Core::SystemInfo::Instance().GetPageSize();
+            const uint32_t allocation = (((size + pageSize - 1) / pageSize) * pageSize);
+
+#ifdef __WINDOWS__
+            void* data = ::VirtualAlloc(nullptr, allocation, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+
+            if ((data != nullptr) && (::VirtualLock(data, allocation) == FALSE)) {
+                ::VirtualFree(data, 0, MEM_RELEASE);
+                data = nullptr;
+            }
+#else
+            void* data = ::mmap(nullptr, allocation, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (data == MAP_FAILED) {
+                data = nullptr;
+            } else if (::mlock(data, allocation) != 0) {
+                ::munmap(data, allocation);
+                data = nullptr;
+            } else {
+#ifdef MADV_DONTDUMP
+                ::madvise(data, allocation, MADV_DONTDUMP);
+#endif
+            }
+#endif
+
+            if (data != nullptr) {
+                _data = static_cast<char*>(data);
+                _size = allocation;
+            } else {
+                TRACE_L1(_T("Could not lock %d bytes of memory for the provisioning cache"), allocation);
+            }
+        }
+        ~LockedBuffer()
+        {
+            if (_data != nullptr) {
+                Wipe(_data, _size);
+
+#ifdef __WINDOWS__
+                ::VirtualUnlock(_data, _size);
+                ::VirtualFree(_data, 0, MEM_RELEASE);
+#else
+                ::munlock(_data, _size);
+                ::munmap(_data, _size);
+#endif
+            }
+        }
+
+    public:
+        static void Wipe(void* data, uint32_t length)
+        {
+            // Through a volatile pointer, so the compiler can not drop it as a dead store.
+            volatile char* index = static_cast<volatile char*>(data);
+
+            while (length-- != 0) {
+                *index++ = 0;
+            }
+        }
+
+        bool IsValid() const
+        {
+            return (_data != nullptr);
+        }
+        char* Data()
+        {
+            return (_data);
+        }
+        const char* Data() const
+        {
+            return (_data);
+        }
+        uint32_t Size() const
+        {
+            return (_size);
+        }
+        uint32_t Length() const
+        {
+            return (_length);
+        }
+        void Length(const uint32_t length)
+        {
+            ASSERT(length <= _size);
+            _length = length;
+        }
+
+    private:
+        char* _data;
+        uint32_t _size;
+        uint32_t _length;
+    };
+
+    // Process wide link to the provisioning endpoint, kept open between
+    // requests. Optionally, cleared DRM ids are kept in locked memory for a
+    // configurable lifetime, so a DRM stack asking for the same label again
+    // does not need another round trip and decryption. Expired blobs are
+    // wiped on the next request.
+    class Link {
+    private:
+        static constexpr uint16_t MaxBlobSize = (10 * 1024);
+        static constexpr uint8_t MaxCachedBlobs = 16;
+
+        struct Entry {
+            std::unique_ptr<LockedBuffer> Blob;
+            uint64_t Expires;
+        };
+
+        using Cache = std::unordered_map<string, Entry>;
+
+    protected:
+        Link()
+            : _adminLock()
+            , _link(GetEndPoint(), _T("Provisioning"))
+            , _deviceId()
+            , _lifetime(0)
+            , _cache()
+        {
+            TCHAR* lifetime = ::getenv(_T("PROVISION_CACHE_LIFETIME"));
+
+            if (lifetime != nullptr) {
+                _lifetime = (static_cast<uint64_t>(::atoi(lifetime)) * Core::Time::TicksPerMillisecond);
+            }
+        }
+
+    public:
+        Link(const Link&) = delete;
+        Link& operator=(const Link&) = delete;
+
+        ~Link()
+        {
+            _link.Close();
+
+            _adminLock.Lock();
+            _cache.clear();
+            _adminLock.Unlock();
+        }
+
+        static Link& Instance()
+        {
+            return (Core::SingletonType<Link>::Instance());
+        }
+
+    public:
+        // The device id does not change, it is only fetched once. Returns what
+        // the Provisioning returned, available tells if it could be asked at all.
+        uint32_t DeviceId(string& deviceId, bool& available)
+        {
+            uint32_t result = Core::ERROR_NONE;
+
+            available = true;
+
+            _adminLock.Lock();
+            deviceId = _deviceId;
+            _adminLock.Unlock();
+
+            if (deviceId.empty() == true) {
+                Exchange::IProvisioning* remote = _link.Interface();
+
+                if (remote == nullptr) {
+                    available = false;
+                    result = Core::ERROR_UNAVAILABLE;
+                } else {
+                    result = remote->DeviceId(deviceId);
+                    remote->Release();
+                }
+
+                if ((result == Core::ERROR_NONE) && (deviceId.empty() == false)) {
+                    _adminLock.Lock();
+                    _deviceId = deviceId;
+                    _adminLock.Unlock();
+                }
+            }
+
+            return (result);
+        }
+
+        // Same return value as ClearBlob: the length of the cleared id, or its
+        // negated length if it does not fit in maxLength.
+        int DRMId(const string& label, const uint16_t maxLength, char outId[])
+        {
+            int result = Cached(label, maxLength, outId);
+
+            if (result == 0) {
+                Exchange::IProvisioning* remote = _link.Interface();
+
+                if (remote != nullptr) {
+                    result = Fetch(remote, label, maxLength, outId);
+                    remote->Release();
+                }
+            }
+
+            return (result != 0 ? result : -1);
+        }
+
+        // Requests all labels back to back over the one open channel, so they
+        // are cached before the DRM stack asks for them. A COM-RPC call blocks
+        // until its reply is in, so they are not in flight at the same time.
+        // Returns the number cached.
+        uint16_t Prefetch(const char* const labels[], const uint16_t count)
+        {
+            uint16_t result = 0;
+            Exchange::IProvisioning* remote = _link.Interface();
+
+            if (remote != nullptr) {
+                for (uint16_t index = 0; (index < count) && (Enabled() == true); index++) {
+                    if ((labels[index] != nullptr) && ((Cached(labels[index], 0, nullptr) > 0) || (Fetch(remote, labels[index], 0, nullptr) > 0))) {
+                        result++;
+                    }
+                }
+
+                remote->Release();
+            }
+
+            return (result);
+        }
+
+        void Lifetime(const uint32_t lifetimeMs)
+        {
+            _adminLock.Lock();
+
+            _lifetime = (static_cast<uint64_t>(lifetimeMs) * Core::Time::TicksPerMillisecond);
+
+            if (_lifetime == 0) {
+                _cache.clear();
+            }
+
+            _adminLock.Unlock();
+        }
+
+    private:
+        bool Enabled() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
+            return (_lifetime != 0);
+        }
+
+        // Fetches and clears the blob for label. With caching enabled, the id is
+        // cleared into locked memory and kept, and copied out from there.
+        // Returns 0 if nothing was cleared.
+        int Fetch(Exchange::IProvisioning* remote, const string& label, const uint16_t maxLength, char outId[])
+        {
+            int result = 0;
+            std::unique_ptr<uint8_t[]> buffer(new uint8_t[MaxBlobSize]);
+            uint16_t size = MaxBlobSize;
+
+            uint32_t error = remote->DRMId(label, size, buffer.get());
+
+            if (error == Core::ERROR_NONE) {
+                // This is a huge encrypted blob, convert it to an uencrypted required info
+                const char* blob = reinterpret_cast<const char*>(buffer.get());
+                bool decrypted = false;
+
+                if (Enabled() == true) {
+                    std::unique_ptr<LockedBuffer> cleared(new LockedBuffer(size));
+
+                    int length = (cleared->IsValid() == true ? ClearBlob(size, blob, static_cast<unsigned short>(std::min(cleared->Size(), static_cast<uint32_t>(0xFFFF))), cleared->Data()) : 0);
+
+                    if ((length < 0) && (static_cast<uint32_t>(-length) > cleared->Size())) {
+                        cleared.reset(new LockedBuffer(-length));
+                        length = (cleared->IsValid() == true ? ClearBlob(size, blob, static_cast<unsigned short>(std::min(cleared->Size(), static_cast<uint32_t>(0xFFFF))), cleared->Data()) : 0);
+                    }
+
+                    if (length > 0) {
+                        cleared->Length(length);
+                        result = Copy(*cleared, maxLength, outId);
+                        Store(label, cleared);
+                        decrypted = true;
+                    }
+                }
+
+                // Cleared and copied out above already, Store() may have moved the buffer since.
+                if ((decrypted == false) && (outId != nullptr)) {
+                    result = ClearBlob(size, blob, maxLength, outId);
+                }
+
+                if (result > 0) {
+                    TRACE_L1(_T("Received Provision Info for '%s' with length [%d]."), label.c_str(), result);
+                } else if (result < 0) {
+                    TRACE_L1(_T("Provisioning for %s too big. Length: %d - %d."), label.c_str(), -result, maxLength);
+                }
+            } else {
+                TRACE_L1(_T("Failed to extract %s provisioning. Error code %d."), label.c_str(), error);
+            }
+
+            LockedBuffer::Wipe(buffer.get(), MaxBlobSize);
+
+            return (result);
+        }
+
+        // Copies a cleared id out, or with a null outId, only reports it is there.
+        static int Copy(const LockedBuffer& cleared, const uint16_t maxLength, char outId[])
+        {
+            int result = static_cast<int>(cleared.Length());
+
+            if (outId != nullptr) {
+                if (cleared.Length() <= maxLength) {
+                    ::memcpy(outId, cleared.Data(), cleared.Length());
+                } else {
+                    result = -result;
+                }
+            }
+
+            return (result);
+        }
+
+        void Expire(const uint64_t now)
+        {
+            Cache::iterator index(_cache.begin());
+
+            while (index != _cache.end()) {
+                if (index->second.Expires <= now) {
+                    index = _cache.erase(index);
+                } else {
+                    ++index;
+                }
+            }
+        }
+
+        int Cached(const string& label, const uint16_t maxLength, char outId[])
+        {
+            int result = 0;
+
+            _adminLock.Lock();
+
+            if (_lifetime != 0) {
+                Expire(Core::Time::Now().Ticks());
+
+                Cache::const_iterator index(_cache.find(label));
+
+                if (index != _cache.end()) {
+                    result = Copy(*(index->second.Blob), maxLength, outId);
+                }
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+        void Store(const string& label, std::unique_ptr<LockedBuffer>& blob)
+        {
+            _adminLock.Lock();
+
+            if (_lifetime != 0) {
+                const uint64_t now = Core::Time::Now().Ticks();
+
+                Expire(now);
+
+                if ((_cache.size() >= MaxCachedBlobs) && (_cache.find(label) == _cache.end())) {
+                    // Make room: drop the entry that would have expired first.
+                    Cache::iterator oldest(_cache.begin());
+
+                    for (Cache::iterator index(_cache.begin()); index != _cache.end(); ++index) {
+                        if (index->second.Expires < oldest->second.Expires) {
+                            oldest = index;
+                        }
+                    }
+
+                    _cache.erase(oldest);
+                }
+
+                Entry& entry(_cache[label]);
+                entry.Blob = std::move(blob);
+                entry.Expires = (now + _lifetime);
+            }
+
+            _adminLock.Unlock();
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        Client::EndPointLink<Exchange::IProvisioning> _link;
+        string _deviceId;
+        uint64_t _lifetime;
+        Cache _cache;
+    };
+
+}
+
 extern "C" {
 /*
  * GetDeviceId - function to obtain the unique Device ID
@@ -61,36 +459,26 @@ extern "C" {
  */
 int GetDeviceId(unsigned short MaxIdLength, char Id[])
 {
-    auto engine = Core::ProxyType<RPC::InvokeServerType<1, 0, 4>>::Create();
-    auto client = Core::ProxyType<RPC::CommunicatorClient>::Create(Core::NodeId(GetEndPoint().c_str()), Core::ProxyType<Core::IIPCServer>(engine));
-
+    string deviceId;
+    bool available = false;
     int result = -1;
 
-    if ((client.IsValid() == true) && (client->IsOpen() == false)) {
-        Exchange::IProvisioning* provisioningInterface = client->Open<Exchange::IProvisioning>("Provisioning");
-        if (provisioningInterface != nullptr) {
-            string deviceId;
-            uint32_t error = provisioningInterface->DeviceId(deviceId);
-            if (error == Core::ERROR_NONE) {
-                TRACE_L1(_T("Received deviceId '%s'."), deviceId.c_str());
-                result = static_cast<int>(deviceId.size());
-                if (result <= MaxIdLength) {
-                    std::copy(deviceId.begin(), deviceId.end(), Id);
-                } else {
-                    TRACE_L1(_T("Received deviceId is too long [%d]."), result);
-                    result = -result;
-                }
-
-            } else {
-                result = error;
-                result = -result;
-            }
+    uint32_t error = Link::Instance().DeviceId(deviceId, available);
 
-            provisioningInterface->Release();
+    if (available == false) {
+        TRACE_L1(_T("Could not reach the Provisioning @ %s."), GetEndPoint().c_str());
+    } else if (error == Core::ERROR_NONE) {
+        TRACE_L1(_T("Received deviceId '%s'."), deviceId.c_str());
+        result = static_cast<int>(deviceId.size());
+        if (result <= MaxIdLength) {
+            std::copy(deviceId.begin(), deviceId.end(), Id);
+        } else {
+            TRACE_L1(_T("Received deviceId is too long [%d]."), result);
+            result = -result;
         }
-        client.Release();
     } else {
-        TRACE_L1(_T("Could not open link. error=%d"), result);
+        result = error;
+        result = -result;
     }
 
     return result;
@@ -114,41 +502,35 @@ int GetDeviceId(unsigned short MaxIdLength, char Id[])
 
 int GetDRMId(const char label[], const unsigned short maxIdLength, char outId[])
 {
-    auto engine = Core::ProxyType<RPC::InvokeServerType<1, 0, 4>>::Create();
-    auto client = Core::ProxyType<RPC::CommunicatorClient>::Create(Core::NodeId(GetEndPoint().c_str()), Core::ProxyType<Core::IIPCServer>(engine));
-
-    int result = -1;
-
-    if ((client.IsValid() == true) && (client->IsOpen() == false)) {
-        Exchange::IProvisioning* provisioningInterface = client->Open<Exchange::IProvisioning>("Provisioning");
-        if (provisioningInterface != nullptr) {
-            uint8_t buffer[10 * 1024]; //should fit ;)
-            uint16_t size = sizeof(buffer);
-
-            uint32_t error = provisioningInterface->DRMId(label, size, buffer);
-
-            if (error == Core::ERROR_NONE) {
-
-                // This is a huge encrypted blob, convert it to an uencrypted required info
-                result = ClearBlob(size, reinterpret_cast<const char*>(buffer) , maxIdLength, outId);
-                if (result > 0) {
-                    TRACE_L1(_T("Received Provision Info for '%s' with length [%d]."), label, result);
-                } else {
-                    TRACE_L1(_T("Provisioning for %s too big. Length: %d - %d."), label, -result, maxIdLength);
-                }
-
-            } else {
-                TRACE_L1(_T("Failed to extract %s provisioning. Error code %d."), label, error);
-            }
+    return (Link::Instance().DRMId((label != nullptr ? label : _T("playready")), maxIdLength, outId));
+}
 
-            provisioningInterface->Release();
-        }
-        client.Release();
-    } else {
-        TRACE_L1(_T("Could not open link. error=%d"), result);
-    }
+/*
+ * provisioningproxy_prefetch - function to request and cache the DRM ids for a set of labels up front
+ *
+ * Parameters
+ *  labels - Names of the DRM ids to request
+ *  count  - Number of entries in labels
+ *
+ * Return value
+ *  Number of labels cached, 0 if caching is disabled (see provisioningproxy_cache_lifetime)
+ *
+ */
+unsigned short provisioningproxy_prefetch(const char* const labels[], const unsigned short count)
+{
+    return (labels != nullptr ? Link::Instance().Prefetch(labels, count) : 0);
+}
 
-    return result;
+/*
+ * provisioningproxy_cache_lifetime - function to set how long cleared DRM ids are cached
+ *
+ * Parameters
+ *  lifetime - in milliseconds, 0 disables the cache and wipes what is cached
+ *
+ */
+void provisioningproxy_cache_lifetime(const unsigned int lifetime)
+{
+    Link::Instance().Lifetime(lifetime);
 }
 
 void provisioningproxy_dispose()
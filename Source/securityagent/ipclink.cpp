@@ -20,6 +20,8 @@
 #include "IPCSecurityToken.h"
 #include "securityagent.h"
 
+#include "../common/EndPointLink.h"
+
 using namespace Thunder;
 
 static string GetEndPoint()
@@ -35,6 +37,169 @@ static string GetEndPoint()
         : value);
 }
 
+namespace {
+
+    // Process wide link to the token endpoint of the SecurityAgent, kept open
+    // between requests. Optionally, tokens are cached on the payload they were
+    // created for, for a configurable lifetime.
+    class Link {
+    private:
+        static constexpr uint8_t MaxCachedTokens = 32;
+
+        struct Entry {
+            string Token;
+            uint64_t Expires;
+        };
+
+        using Cache = std::unordered_map<string, Entry>;
+
+    protected:
+        Link()
+            : _adminLock()
+            , _link(GetEndPoint(), _T("SecurityAgent"))
+            , _lifetime(0)
+            , _cache()
+        {
+        }
+
+    public:
+        Link(const Link&) = delete;
+        Link& operator=(const Link&) = delete;
+
+        ~Link() = default;
+
+        static Link& Instance()
+        {
+            return (Core::SingletonType<Link>::Instance());
+        }
+
+    public:
+        // Returns what the SecurityAgent returned, available tells if it
+        // could be asked at all.
+        uint32_t Token(const uint16_t length, const uint8_t buffer[], string& token, bool& available)
+        {
+            const string payload(reinterpret_cast<const char*>(buffer), length);
+            uint32_t result = Core::ERROR_NONE;
+
+            available = true;
+
+            if (Cached(payload, token) == false) {
+                PluginHost::IAuthenticate* remote = _link.Interface();
+
+                if (remote == nullptr) {
+                    available = false;
+                    result = Core::ERROR_UNAVAILABLE;
+                } else {
+                    result = remote->CreateToken(length, buffer, token);
+
+                    remote->Release();
+
+                    if (result == Core::ERROR_NONE) {
+                        Store(payload, token);
+                    }
+                }
+            }
+
+            return (result);
+        }
+
+        void Lifetime(const uint32_t lifetimeMs)
+        {
+            _adminLock.Lock();
+
+            _lifetime = (static_cast<uint64_t>(lifetimeMs) * Core::Time::TicksPerMillisecond);
+
+            if (_lifetime == 0) {
+                _cache.clear();
+            }
+
+            _adminLock.Unlock();
+        }
+
+        void Invalidate(const uint16_t length, const uint8_t buffer[])
+        {
+            _adminLock.Lock();
+
+            if (buffer == nullptr) {
+                _cache.clear();
+            } else {
+                _cache.erase(string(reinterpret_cast<const char*>(buffer), length));
+            }
+
+            _adminLock.Unlock();
+        }
+
+    private:
+        bool Cached(const string& payload, string& token)
+        {
+            bool result = false;
+
+            _adminLock.Lock();
+
+            if (_lifetime != 0) {
+                Cache::iterator index(_cache.find(payload));
+
+                if (index != _cache.end()) {
+                    if (index->second.Expires > Core::Time::Now().Ticks()) {
+                        token = index->second.Token;
+                        result = true;
+                    } else {
+                        _cache.erase(index);
+                    }
+                }
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+        void Store(const string& payload, const string& token)
+        {
+            _adminLock.Lock();
+
+            if (_lifetime != 0) {
+                const uint64_t now = Core::Time::Now().Ticks();
+
+                if (_cache.size() >= MaxCachedTokens) {
+                    // Make room: drop whatever expired, or else the entry that
+                    // would have expired first.
+                    Cache::iterator oldest(_cache.begin());
+                    Cache::iterator index(_cache.begin());
+
+                    while (index != _cache.end()) {
+                        if (index->second.Expires <= now) {
+                            index = _cache.erase(index);
+                        } else {
+                            if (index->second.Expires < oldest->second.Expires) {
+                                oldest = index;
+                            }
+                            ++index;
+                        }
+                    }
+
+                    if (_cache.size() >= MaxCachedTokens) {
+                        _cache.erase(oldest);
+                    }
+                }
+
+                Entry& entry(_cache[payload]);
+                entry.Token = token;
+                entry.Expires = (now + _lifetime);
+            }
+
+            _adminLock.Unlock();
+        }
+
+    private:
+        Core::CriticalSection _adminLock;
+        Client::EndPointLink<PluginHost::IAuthenticate> _link;
+        uint64_t _lifetime;
+        Cache _cache;
+    };
+
+}
+
 extern "C" {
 
 /*
@@ -53,43 +218,41 @@ extern "C" {
  */
 int GetToken(unsigned short maxLength, unsigned short inLength, unsigned char buffer[])
 {
-    auto engine = Core::ProxyType<RPC::InvokeServerType<1, 0, 4>>::Create();
-    auto client = Core::ProxyType<RPC::CommunicatorClient>::Create(Core::NodeId(GetEndPoint().c_str()), Core::ProxyType<Core::IIPCServer>(engine));
-
+    std::string token;
+    bool available = false;
     int result = -1;
 
-    if ((client.IsValid() == true) && (client->IsOpen() == false)) {
-        PluginHost::IAuthenticate* securityAgentInterface = client->Open<PluginHost::IAuthenticate>("SecurityAgent");
-        
-        if (securityAgentInterface != nullptr) {
-            std::string token;
-            uint32_t error = securityAgentInterface->CreateToken(inLength, buffer, token);
+    uint32_t error = Link::Instance().Token(inLength, buffer, token, available);
 
-            if (error == Core::ERROR_NONE) {
-                result = static_cast<uint32_t>(token.length());
+    if (available == false) {
+        TRACE_L1(_T("Could not reach the SecurityAgent @ %s."), GetEndPoint().c_str());
+    } else if (error == Core::ERROR_NONE) {
+        result = static_cast<uint32_t>(token.length());
 
-                if (result <= maxLength) {
-                    std::copy(std::begin(token), std::end(token), buffer);
-                } else {
-                    TRACE_L1(_T("Received token is too long [%d]."), result);
-                    result = -result;
-                }
-            } else {
-                result = error;
-                result = -result;
-            }
-
-            securityAgentInterface->Release();
+        if (result <= maxLength) {
+            std::copy(std::begin(token), std::end(token), buffer);
+        } else {
+            TRACE_L1(_T("Received token is too long [%d]."), result);
+            result = -result;
         }
-
-        client.Release();
     } else {
-        TRACE_L1(_T("Could not open link. error=%d"), result);
+        result = error;
+        result = -result;
     }
 
     return (result);
 }
 
+void securityagent_token_lifetime(unsigned int lifetime)
+{
+    Link::Instance().Lifetime(lifetime);
+}
+
+void securityagent_invalidate_token(unsigned short inLength, const unsigned char buffer[])
+{
+    Link::Instance().Invalidate(inLength, buffer);
+}
+
 void securityagent_dispose() {
     Core::Singleton::Dispose();
 }
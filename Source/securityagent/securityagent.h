@@ -57,6 +57,24 @@ extern "C" {
 	 */
 	int EXTERNAL GetToken(unsigned short maxLength, unsigned short inLength, unsigned char buffer[]);
 
+	/*
+	 * securityagent_token_lifetime - enable caching of the tokens obtained through GetToken
+	 *
+	 * Parameters
+	 *  lifetime    - time in ms a token is handed out again for the same payload, without
+	 *                consulting the SecurityAgent. 0 (the default) disables and clears the cache.
+	 */
+	void EXTERNAL securityagent_token_lifetime(unsigned int lifetime);
+
+	/*
+	 * securityagent_invalidate_token - drop a cached token
+	 *
+	 * Parameters
+	 *  inLength    - holds the length of the payload the token was created for.
+	 *  buffer      - the payload the token was created for, NULL drops all cached tokens.
+	 */
+	void EXTERNAL securityagent_invalidate_token(unsigned short inLength, const unsigned char buffer[]);
+
 	/**
 	 * @brief Close the cached open connection if it exists.
 	 *
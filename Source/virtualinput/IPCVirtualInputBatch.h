@@ -0,0 +1,64 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+using namespace Thunder;
+
+namespace IPC {
+
+namespace VirtualInput {
+
+    // Extension of the IVirtualInput protocol. A listener that sets INPUT_BATCH in the
+    // Mode of its NameMessage response accepts EventMessage: up to MaxEvents key, mouse
+    // and touch events in one frame. The frame is acknowledged on receipt, the listener
+    // runs its callbacks afterwards, so the sender does not wait for the application.
+    // Listeners not announcing INPUT_BATCH only get the single event messages.
+    enum { INPUT_BATCH = 0x80 };
+    enum { MaxEvents = 32 };
+
+    enum eventtype : uint8_t {
+        EVENT_KEY = 0,
+        EVENT_MOUSE = 1,
+        EVENT_TOUCH = 2
+    };
+
+    struct Event {
+        uint8_t Type; // eventtype
+        uint8_t Action; // keyactiontype, mouseactiontype or touchactiontype
+        uint16_t Index; // Mouse button or touch index
+        uint32_t Code; // Key code
+        int32_t X; // Mouse horizontal or touch x
+        int32_t Y; // Mouse vertical or touch y
+    };
+
+    struct Events {
+        // Sequence number of Entries[0]; every event takes one, so the next frame
+        // starts at Sequence + Count. A gap means the sender dropped events.
+        uint32_t Sequence;
+        uint8_t Count;
+        Event Entries[MaxEvents];
+    };
+
+    typedef Core::IPCMessageType<16, Events, Core::IPC::Void> EventMessage;
+}
+
+} // namespace IPC::VirtualInput
@@ -19,11 +19,167 @@
 
 #include "Module.h"
 #include <plugins/IVirtualInput.h>
+#include "IPCVirtualInputBatch.h"
 #include "virtualinput.h"
 
 namespace Thunder {
 namespace VirtualInput{
 
+    namespace Batch = ::IPC::VirtualInput;
+
+    // The IPC thread only queues the events and acknowledges the message, the
+    // callbacks run on this thread. So the sender is no longer held up by the
+    // application, only by the queue running full, which pushes back on the
+    // sender just like a slow callback used to.
+    class Dispatcher : public Core::Thread {
+    private:
+        static constexpr uint16_t QueueSize = 256;
+
+    public:
+        Dispatcher() = delete;
+        Dispatcher(const Dispatcher&) = delete;
+        Dispatcher& operator=(const Dispatcher&) = delete;
+
+        Dispatcher(FNKeyEvent keyCallback, FNMouseEvent mouseCallback, FNTouchEvent touchCallback)
+            : Core::Thread()
+            , _keyCallback(keyCallback)
+            , _mouseCallback(mouseCallback)
+            , _touchCallback(touchCallback)
+            , _lock()
+            , _filled(false, true)
+            , _space(true, true)
+            , _head(0)
+            , _count(0)
+            , _expected(0)
+            , _synchronized(false)
+            , _lost(0)
+        {
+            Thread::Run();
+        }
+        ~Dispatcher() override
+        {
+            Thread::Block();
+            _filled.SetEvent();
+            Thread::Wait(Thread::BLOCKED | Thread::STOPPED, Core::infinite);
+        }
+
+    public:
+        // Only to be called from the IPC thread.
+        void Push(const uint8_t count, const Batch::Event events[])
+        {
+            uint8_t index = 0;
+
+            while (index < count) {
+                _lock.Lock();
+
+                while ((_count < QueueSize) && (index < count)) {
+                    _queue[(_head + _count) % QueueSize] = events[index++];
+                    _count++;
+                }
+
+                if (_count == QueueSize) {
+                    _space.ResetEvent();
+                }
+
+                _filled.SetEvent();
+
+                _lock.Unlock();
+
+                if (index < count) {
+                    _space.Lock(Core::infinite);
+                }
+            }
+        }
+        // Only to be called from the IPC thread.
+        void Sequence(const uint32_t sequence, const uint8_t count)
+        {
+            if ((_synchronized == true) && (sequence != _expected)) {
+                const uint32_t gap = (sequence - _expected);
+
+                // A sequence running backwards means the sender restarted, not a loss.
+                if (gap < 0x80000000) {
+                    TRACE_L1("Lost %u input events", gap);
+                    _lost += gap;
+                }
+            }
+
+            _synchronized = true;
+            _expected = sequence + count;
+        }
+        uint32_t Lost() const
+        {
+            return (_lost.load(std::memory_order_relaxed));
+        }
+
+    private:
+        uint32_t Worker() override
+        {
+            Batch::Event events[Batch::MaxEvents];
+            uint8_t count = 0;
+
+            _filled.Lock(Core::infinite);
+
+            _lock.Lock();
+
+            while ((_count > 0) && (count < Batch::MaxEvents)) {
+                events[count++] = _queue[_head];
+                _head = (_head + 1) % QueueSize;
+                _count--;
+            }
+
+            if (_count == 0) {
+                _filled.ResetEvent();
+            }
+
+            _space.SetEvent();
+
+            _lock.Unlock();
+
+            for (uint8_t index = 0; index < count; index++) {
+                Deliver(events[index]);
+            }
+
+            return (0);
+        }
+        void Deliver(const Batch::Event& event) const
+        {
+            switch (event.Type) {
+            case Batch::EVENT_KEY:
+                if (_keyCallback != nullptr) {
+                    _keyCallback(static_cast<keyactiontype>(event.Action), event.Code);
+                }
+                break;
+            case Batch::EVENT_MOUSE:
+                if (_mouseCallback != nullptr) {
+                    _mouseCallback(static_cast<mouseactiontype>(event.Action), event.Index, static_cast<short>(event.X), static_cast<short>(event.Y));
+                }
+                break;
+            case Batch::EVENT_TOUCH:
+                if (_touchCallback != nullptr) {
+                    _touchCallback(static_cast<touchactiontype>(event.Action), event.Index, static_cast<unsigned short>(event.X), static_cast<unsigned short>(event.Y));
+                }
+                break;
+            default:
+                TRACE_L1("Unknown input event type %d", event.Type);
+                break;
+            }
+        }
+
+    private:
+        FNKeyEvent _keyCallback;
+        FNMouseEvent _mouseCallback;
+        FNTouchEvent _touchCallback;
+        Core::CriticalSection _lock;
+        Core::Event _filled;
+        Core::Event _space;
+        Batch::Event _queue[QueueSize];
+        uint16_t _head;
+        uint16_t _count;
+        uint32_t _expected;
+        bool _synchronized;
+        std::atomic<uint32_t> _lost;
+    };
+
     class KeyEventHandler : public Core::IIPCServer {
     private:
         KeyEventHandler() = delete;
@@ -31,8 +187,8 @@ namespace VirtualInput{
         KeyEventHandler& operator=(const KeyEventHandler&) = delete;
 
     public:
-        KeyEventHandler(FNKeyEvent callback)
-            : _callback(callback)
+        KeyEventHandler(Dispatcher& dispatcher)
+            : _dispatcher(dispatcher)
         {
         }
         virtual ~KeyEventHandler()
@@ -43,13 +199,19 @@ namespace VirtualInput{
         virtual void Procedure(Core::IPCChannel& source, Core::ProxyType<Core::IIPC>& data)
         {
             Core::ProxyType<IVirtualInput::KeyMessage> message(data);
-            ASSERT((_callback != nullptr) && (message.IsValid() == true));
-            _callback(static_cast<keyactiontype>(message->Parameters().Action), message->Parameters().Code);
+            ASSERT(message.IsValid() == true);
+
+            Batch::Event event{};
+            event.Type = Batch::EVENT_KEY;
+            event.Action = static_cast<uint8_t>(message->Parameters().Action);
+            event.Code = message->Parameters().Code;
+
             source.ReportResponse(data);
+            _dispatcher.Push(1, &event);
         }
 
     private:
-        FNKeyEvent _callback;
+        Dispatcher& _dispatcher;
     };
 
     class MouseEventHandler : public Core::IIPCServer {
@@ -59,8 +221,8 @@ namespace VirtualInput{
         MouseEventHandler& operator=(const MouseEventHandler&) = delete;
 
     public:
-        MouseEventHandler(FNMouseEvent callback)
-            : _callback(callback)
+        MouseEventHandler(Dispatcher& dispatcher)
+            : _dispatcher(dispatcher)
         {
         }
         virtual ~MouseEventHandler()
@@ -71,13 +233,21 @@ namespace VirtualInput{
         virtual void Procedure(Core::IPCChannel& source, Core::ProxyType<Core::IIPC>& data)
         {
             Core::ProxyType<IVirtualInput::MouseMessage> message(data);
-            ASSERT((_callback != nullptr) && (message.IsValid() == true));
-            _callback(static_cast<mouseactiontype>(message->Parameters().Action), message->Parameters().Button, message->Parameters().Horizontal, message->Parameters().Vertical);
+            ASSERT(message.IsValid() == true);
+
+            Batch::Event event{};
+            event.Type = Batch::EVENT_MOUSE;
+            event.Action = static_cast<uint8_t>(message->Parameters().Action);
+            event.Index = message->Parameters().Button;
+            event.X = message->Parameters().Horizontal;
+            event.Y = message->Parameters().Vertical;
+
             source.ReportResponse(data);
+            _dispatcher.Push(1, &event);
         }
 
     private:
-        FNMouseEvent _callback;
+        Dispatcher& _dispatcher;
     };
 
     class TouchEventHandler : public Core::IIPCServer {
@@ -87,8 +257,8 @@ namespace VirtualInput{
         TouchEventHandler& operator=(const TouchEventHandler&) = delete;
 
     public:
-        TouchEventHandler(FNTouchEvent callback)
-            : _callback(callback)
+        TouchEventHandler(Dispatcher& dispatcher)
+            : _dispatcher(dispatcher)
         {
         }
         virtual ~TouchEventHandler()
@@ -99,13 +269,57 @@ namespace VirtualInput{
         virtual void Procedure(Core::IPCChannel& source, Core::ProxyType<Core::IIPC>& data)
         {
             Core::ProxyType<IVirtualInput::TouchMessage> message(data);
-            ASSERT((_callback != nullptr) && (message.IsValid() == true));
-            _callback(static_cast<touchactiontype>(message->Parameters().Action), message->Parameters().Index, message->Parameters().X, message->Parameters().Y);
+            ASSERT(message.IsValid() == true);
+
+            Batch::Event event{};
+            event.Type = Batch::EVENT_TOUCH;
+            event.Action = static_cast<uint8_t>(message->Parameters().Action);
+            event.Index = message->Parameters().Index;
+            event.X = message->Parameters().X;
+            event.Y = message->Parameters().Y;
+
+            source.ReportResponse(data);
+            _dispatcher.Push(1, &event);
+        }
+
+    private:
+        Dispatcher& _dispatcher;
+    };
+
+    class BatchEventHandler : public Core::IIPCServer {
+    private:
+        BatchEventHandler() = delete;
+        BatchEventHandler(const BatchEventHandler&) = delete;
+        BatchEventHandler& operator=(const BatchEventHandler&) = delete;
+
+    public:
+        BatchEventHandler(Dispatcher& dispatcher)
+            : _dispatcher(dispatcher)
+        {
+        }
+        virtual ~BatchEventHandler()
+        {
+        }
+
+    private:
+        virtual void Procedure(Core::IPCChannel& source, Core::ProxyType<Core::IIPC>& data)
+        {
+            Core::ProxyType<Batch::EventMessage> message(data);
+            ASSERT(message.IsValid() == true);
+
+            const Batch::Events& events(message->Parameters());
+            const uint8_t count = std::min(events.Count, static_cast<uint8_t>(Batch::MaxEvents));
+
+            _dispatcher.Sequence(events.Sequence, count);
+
+            // The message stays ours until we return, so the events can be queued
+            // straight from it after the sender got its acknowledgement.
             source.ReportResponse(data);
+            _dispatcher.Push(count, events.Entries);
         }
 
     private:
-        FNTouchEvent _callback;
+        Dispatcher& _dispatcher;
     };
 
     class Controller {
@@ -149,10 +363,12 @@ namespace VirtualInput{
 
     public:
         Controller(const string& name, const Core::NodeId& source, FNKeyEvent keyCallback = nullptr, FNMouseEvent mouseCallback = nullptr, FNTouchEvent touchCallback = nullptr)
-            : _channel(source, 32)
-            , _keyCallback((keyCallback != nullptr) ? (Core::ProxyType<Core::IIPCServer>(Core::ProxyType<KeyEventHandler>::Create(keyCallback))) : (Core::ProxyType<Core::IIPCServer>()))
-            , _mouseCallback((mouseCallback != nullptr) ? (Core::ProxyType<Core::IIPCServer>(Core::ProxyType<MouseEventHandler>::Create(mouseCallback))) : (Core::ProxyType<Core::IIPCServer>()))
-            , _touchCallback((touchCallback != nullptr) ? (Core::ProxyType<Core::IIPCServer>(Core::ProxyType<TouchEventHandler>::Create(touchCallback))) : (Core::ProxyType<Core::IIPCServer>()))
+            : _dispatcher(keyCallback, mouseCallback, touchCallback)
+            , _channel(source, 1024)
+            , _keyCallback((keyCallback != nullptr) ? (Core::ProxyType<Core::IIPCServer>(Core::ProxyType<KeyEventHandler>::Create(_dispatcher))) : (Core::ProxyType<Core::IIPCServer>()))
+            , _mouseCallback((mouseCallback != nullptr) ? (Core::ProxyType<Core::IIPCServer>(Core::ProxyType<MouseEventHandler>::Create(_dispatcher))) : (Core::ProxyType<Core::IIPCServer>()))
+            , _touchCallback((touchCallback != nullptr) ? (Core::ProxyType<Core::IIPCServer>(Core::ProxyType<TouchEventHandler>::Create(_dispatcher))) : (Core::ProxyType<Core::IIPCServer>()))
+            , _batchCallback(Core::ProxyType<Core::IIPCServer>(Core::ProxyType<BatchEventHandler>::Create(_dispatcher)))
         {
             if (_keyCallback.IsValid() ==  true) {
                 _channel.CreateFactory<IVirtualInput::KeyMessage>(1);
@@ -169,6 +385,9 @@ namespace VirtualInput{
                 _channel.Register(IVirtualInput::TouchMessage::Id(), _touchCallback);
             }
 
+            _channel.CreateFactory<Batch::EventMessage>(1);
+            _channel.Register(Batch::EventMessage::Id(), _batchCallback);
+
             _channel.CreateFactory<IVirtualInput::NameMessage>(1);
             _channel.Register(IVirtualInput::NameMessage::Id(), Core::ProxyType<Core::IIPCServer>(Core::ProxyType<NameEventHandler>::Create(name, Mode())));
 
@@ -196,6 +415,10 @@ namespace VirtualInput{
                 _touchCallback.Release();
             }
 
+            _channel.Unregister(Batch::EventMessage::Id());
+            _channel.DestroyFactory<Batch::EventMessage>();
+            _batchCallback.Release();
+
             _channel.Unregister(IVirtualInput::NameMessage::Id());
             _channel.DestroyFactory<IVirtualInput::NameMessage>();
         }
@@ -204,13 +427,20 @@ namespace VirtualInput{
         {
             return (_keyCallback.IsValid()   ? IVirtualInput::INPUT_KEY   : 0) |
                    (_mouseCallback.IsValid() ? IVirtualInput::INPUT_MOUSE : 0) |
-                   (_touchCallback.IsValid() ? IVirtualInput::INPUT_TOUCH : 0) ;
+                   (_touchCallback.IsValid() ? IVirtualInput::INPUT_TOUCH : 0) |
+                   Batch::INPUT_BATCH;
+        }
+        uint32_t Lost() const
+        {
+            return (_dispatcher.Lost());
         }
     private:
+        Dispatcher _dispatcher;
         Core::IPCChannelClientType<Core::Void, false, true> _channel;
         Core::ProxyType<Core::IIPCServer> _keyCallback;
         Core::ProxyType<Core::IIPCServer> _mouseCallback;
         Core::ProxyType<Core::IIPCServer> _touchCallback;
+        Core::ProxyType<Core::IIPCServer> _batchCallback;
     };
 }
 }
@@ -236,6 +466,11 @@ void virtualinput_close(void* handle)
     delete reinterpret_cast<VirtualInput::Controller*>(handle);
 }
 
+unsigned int virtualinput_lost_events(void* handle)
+{
+    return (reinterpret_cast<VirtualInput::Controller*>(handle)->Lost());
+}
+
 void virtualinput_dispose() {
     Core::Singleton::Dispose();
 }
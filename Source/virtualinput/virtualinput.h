@@ -80,6 +80,15 @@ typedef void (*FNTouchEvent)(enum touchactiontype type, unsigned short index,  u
 EXTERNAL void* virtualinput_open(const char listenerName[], const char connector[], FNKeyEvent keyCallback, FNMouseEvent mouseCallback, FNTouchEvent touchCallback);
 EXTERNAL void  virtualinput_close(void* handle);
 
+/**
+ * @brief Number of input events the sender reported as sent, but that never
+ *        arrived here (e.g. dropped by the input plugin under load).
+ *
+ * @param handle Handle returned by virtualinput_open.
+ * @return Events lost since the handle was opened.
+ */
+EXTERNAL unsigned int virtualinput_lost_events(void* handle);
+
 /**
  * @brief Close the cached open connection if it exists.
  *
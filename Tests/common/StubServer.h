@@ -0,0 +1,127 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <core/core.h>
+#include <com/com.h>
+
+#include <iostream>
+
+// Set by the build, from where the Thunder it is built against is installed.
+#ifndef PROXYSTUB_PATH
+#error "PROXYSTUB_PATH should point to the installed Thunder proxy stubs"
+#endif
+
+namespace Thunder {
+namespace Tests {
+
+    // Base for a stub implementation of INTERFACE. It lives as long as the
+    // StubServer that serves it, so a release from the other side never
+    // destructs it.
+    template <typename INTERFACE>
+    class Stub : public INTERFACE {
+    public:
+        Stub(const Stub<INTERFACE>&) = delete;
+        Stub<INTERFACE>& operator=(const Stub<INTERFACE>&) = delete;
+
+        Stub()
+            : _refCount(0)
+        {
+        }
+        ~Stub() override = default;
+
+    public:
+        uint32_t AddRef() const override
+        {
+            Core::InterlockedIncrement(_refCount);
+            return (Core::ERROR_NONE);
+        }
+        uint32_t Release() const override
+        {
+            Core::InterlockedDecrement(_refCount);
+            return (Core::ERROR_NONE);
+        }
+
+    private:
+        mutable uint32_t _refCount;
+    };
+
+    // Serves an IMPLEMENTATION over COM-RPC on the given node, in place of the
+    // plugin a client library talks to, and counts the links opened to it.
+    template <typename IMPLEMENTATION>
+    class StubServer : public RPC::Communicator {
+    public:
+        StubServer() = delete;
+        StubServer(const StubServer<IMPLEMENTATION>&) = delete;
+        StubServer<IMPLEMENTATION>& operator=(const StubServer<IMPLEMENTATION>&) = delete;
+
+        StubServer(const Core::NodeId& node, const string& proxyStubPath)
+            : RPC::Communicator(node, proxyStubPath, Core::ProxyType<Core::IIPCServer>(Core::ProxyType<RPC::InvokeServerType<1, 0, 4>>::Create()))
+            , _implementation()
+            , _acquired(0)
+        {
+            Open(Core::infinite);
+        }
+        ~StubServer() override
+        {
+            Close(Core::infinite);
+        }
+
+    public:
+        const IMPLEMENTATION& Implementation() const
+        {
+            return (_implementation);
+        }
+        uint32_t Acquired() const
+        {
+            return (_acquired);
+        }
+
+    private:
+        void* Acquire(const string&, const uint32_t interfaceId, const uint32_t) override
+        {
+            void* result = _implementation.QueryInterface(interfaceId);
+
+            if (result != nullptr) {
+                Core::InterlockedIncrement(_acquired);
+            }
+
+            return (result);
+        }
+
+    private:
+        IMPLEMENTATION _implementation;
+        uint32_t _acquired;
+    };
+
+    // The proxy stubs the build was configured with, or the ones given on the command line.
+    inline string ProxyStubPath(const int argc, const char* argv[])
+    {
+        return (argc > 1 ? argv[1] : PROXYSTUB_PATH);
+    }
+
+    inline bool Check(const TCHAR label[], const bool condition)
+    {
+        std::cout << (condition == true ? "[PASS] " : "[FAIL] ") << label << std::endl;
+        return (condition);
+    }
+
+}
+}
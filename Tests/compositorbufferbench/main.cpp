@@ -0,0 +1,453 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MODULE_NAME
+#define MODULE_NAME CompositorBufferBench
+#endif
+
+#include <compositorbuffer/CompositorBufferType.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+
+using namespace std;
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+// Frame exchange between a compositor and a client process over a CompositorBuffer. The
+// eventfd path (both sides on the ResourceMonitor) is compared with the futex handshake
+// (both sides waiting on a thread of their own). The async run draws on a compositor thread,
+// every slot handed to Request(slot) must be the one that gets rendered. The last run lets
+// the client die while it holds a slot, the compositor must still get that slot.
+namespace {
+
+    constexpr TCHAR Connector[] = _T("/tmp/compositorbufferbench");
+    constexpr uint32_t BufferId = 1;
+    constexpr uint32_t WaitTime = 2000;
+    constexpr uint32_t Width = 1280;
+    constexpr uint32_t Height = 720;
+    constexpr uint32_t Format = 0x34325241; // DRM_FORMAT_ARGB8888
+    constexpr uint8_t Depth = 2;
+
+    using Clock = std::chrono::steady_clock;
+
+    class Composer : public Compositor::CompositorBuffer {
+    public:
+        Composer() = delete;
+        Composer(Composer&&) = delete;
+        Composer(const Composer&) = delete;
+        Composer& operator=(Composer&&) = delete;
+        Composer& operator=(const Composer&) = delete;
+
+        Composer(const uint8_t depth, const bool async)
+            : Compositor::CompositorBuffer(Width, Height, Format, 0, Exchange::ICompositionBuffer::TYPE_RAW, depth)
+            , _async(async)
+            , _lock()
+            , _signal()
+            , _queue()
+            , _pending(0)
+            , _running(true)
+            , _misses(0)
+            , _drawer()
+        {
+            for (uint8_t slot = 0; slot < depth; slot++) {
+                int fd = ::memfd_create(_T("CompositorBufferBench"), MFD_CLOEXEC);
+
+                if (fd != -1) {
+                    Compositor::CompositorBuffer::Add(slot, fd, Width * 4, 0);
+                    ::close(fd);
+                }
+            }
+
+            if (_async == true) {
+                _drawer = std::thread([this]() { Draw(); });
+            }
+        }
+        ~Composer() override
+        {
+            if (_drawer.joinable() == true) {
+                {
+                    std::lock_guard<std::mutex> guard(_lock);
+                    _running = false;
+                }
+
+                _signal.notify_one();
+                _drawer.join();
+            }
+        }
+
+    public:
+        void Request(const uint8_t slot) override
+        {
+            if (_async == false) {
+                if (Rendered(slot) == false) {
+                    _misses++;
+                }
+            } else {
+                std::lock_guard<std::mutex> guard(_lock);
+
+                // The client may ring again before we got to it, draw each frame once.
+                if ((_pending & (1 << slot)) == 0) {
+                    _pending |= (1 << slot);
+                    _queue.push_back(slot);
+                    _signal.notify_one();
+                }
+            }
+        }
+        uint32_t Misses() const
+        {
+            return (_misses);
+        }
+
+    private:
+        // Like a real compositor, draw on a thread of our own. The client keeps submitting
+        // meanwhile, so the selected slot moves on while an older one is still being drawn.
+        void Draw()
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+
+            while (_running == true) {
+                if (_queue.empty() == true) {
+                    _signal.wait(guard);
+                } else {
+                    const uint8_t slot = _queue.front();
+                    _queue.pop_front();
+
+                    guard.unlock();
+
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+                    const bool rendered = Rendered(slot);
+
+                    guard.lock();
+
+                    _pending &= ~(1 << slot);
+
+                    if (rendered == false) {
+                        _misses++;
+                    }
+                }
+            }
+        }
+
+    private:
+        const bool _async;
+        std::mutex _lock;
+        std::condition_variable _signal;
+        std::deque<uint8_t> _queue;
+        uint8_t _pending;
+        bool _running;
+        std::atomic<uint32_t> _misses;
+        std::thread _drawer;
+    };
+
+    class Renderer : public Compositor::ClientBuffer {
+    public:
+        Renderer() = delete;
+        Renderer(Renderer&&) = delete;
+        Renderer(const Renderer&) = delete;
+        Renderer& operator=(Renderer&&) = delete;
+        Renderer& operator=(const Renderer&) = delete;
+
+        Renderer(Core::PrivilegedRequest::Container& descriptors, const bool futex)
+            : Compositor::ClientBuffer()
+            , _futex(futex)
+            , _rendered(false, true)
+            , _frames(0)
+        {
+            Compositor::ClientBuffer::Load(descriptors);
+        }
+        ~Renderer() override = default;
+
+    public:
+        void Rendered() override
+        {
+            _frames++;
+            _rendered.SetEvent();
+        }
+        void Published() override
+        {
+        }
+        uint32_t Frames() const
+        {
+            return (_frames);
+        }
+        // Hand the next free slot to the compositor, waits if they are all in use.
+        bool Render()
+        {
+            Exchange::ICompositionBuffer::IIterator* planes;
+
+            // Without the ResourceMonitor, slots only come back while we are in Wait().
+            while (((planes = AcquireNext(_futex == true ? 0 : WaitTime)) == nullptr) && (_futex == true) && (Wait(WaitTime) == Core::ERROR_NONE)) {
+            }
+
+            if (planes != nullptr) {
+                Relinquish();
+            }
+
+            return ((planes != nullptr) && (RequestRender() == true));
+        }
+        bool Completed(const uint32_t frames)
+        {
+            bool result = true;
+
+            while ((_frames < frames) && (result == true)) {
+                result = ((_futex == true ? Wait(WaitTime) : _rendered.Lock(WaitTime)) == Core::ERROR_NONE);
+            }
+
+            return (result);
+        }
+
+    private:
+        const bool _futex;
+        Core::Event _rendered;
+        std::atomic<uint32_t> _frames;
+    };
+
+    class Dispatcher : public Core::PrivilegedRequest {
+    public:
+        Dispatcher(Dispatcher&&) = delete;
+        Dispatcher(const Dispatcher&) = delete;
+        Dispatcher& operator=(Dispatcher&&) = delete;
+        Dispatcher& operator=(const Dispatcher&) = delete;
+
+        Dispatcher()
+            : _buffer(nullptr)
+        {
+        }
+        ~Dispatcher() override = default;
+
+        void Add(Compositor::CompositorBuffer& buffer)
+        {
+            _buffer = &buffer;
+        }
+        uint8_t Service(const uint32_t id, const uint8_t maxSize, int container[]) override
+        {
+            return (((id == BufferId) && (_buffer != nullptr)) ? _buffer->Descriptors(maxSize, container) : 0);
+        }
+
+    private:
+        Compositor::CompositorBuffer* _buffer;
+    };
+
+    void Report(const TCHAR label[], vector<uint64_t>& samples)
+    {
+        if (samples.empty() == false) {
+            uint64_t total = 0;
+
+            std::sort(samples.begin(), samples.end());
+
+            for (const uint64_t sample : samples) {
+                total += sample;
+            }
+
+            cout << label << ": " << samples.size() << " frames, round trip in us"
+                 << fixed << setprecision(1)
+                 << " avg " << (static_cast<double>(total) / samples.size() / 1000)
+                 << " p50 " << (static_cast<double>(samples[samples.size() / 2]) / 1000)
+                 << " p99 " << (static_cast<double>(samples[(samples.size() * 99) / 100]) / 1000)
+                 << " max " << (static_cast<double>(samples.back()) / 1000) << endl;
+        }
+    }
+
+    void Report(const TCHAR label[], const uint32_t frames, const uint32_t rendered, const uint64_t duration)
+    {
+        cout << label << ": " << frames << " frames in " << (duration / 1000000) << " ms, "
+             << (duration != 0 ? ((static_cast<uint64_t>(frames) * 1000000000) / duration) : 0) << " frames/s, "
+             << rendered << " rendered" << endl;
+    }
+
+    uint64_t Elapsed(const Clock::time_point& start)
+    {
+        return (std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    // Client side, runs in the child process.
+    bool Render(const string& mode, const uint32_t frames, const string& connector)
+    {
+        bool passed = false;
+        const bool futex = (mode == _T("futex"));
+        Dispatcher bridge;
+        Core::PrivilegedRequest::Container descriptors;
+
+        if (bridge.Request(WaitTime, connector, BufferId, descriptors) != Core::ERROR_NONE) {
+            cout << "The client did not get the buffer" << endl;
+        } else {
+            Core::ProxyType<Renderer> client(Core::ProxyType<Renderer>::Create(descriptors, futex));
+
+            if (mode == _T("crash")) {
+                if (client->AcquireNext(WaitTime) != nullptr) {
+                    // Gone, while holding the lock of the slot.
+                    ::_exit(0);
+                }
+            } else {
+                if (futex == false) {
+                    Core::ResourceMonitor::Instance().Register(*client);
+                }
+
+                // Latency: one frame in flight, wait for it to be rendered.
+                vector<uint64_t> samples;
+                samples.reserve(frames);
+
+                while (samples.size() < frames) {
+                    const uint32_t expected = client->Frames() + 1;
+                    const Clock::time_point start = Clock::now();
+
+                    if ((client->Render() == false) || (client->Completed(expected) == false)) {
+                        break;
+                    }
+
+                    samples.push_back(Elapsed(start));
+                }
+
+                passed = (samples.size() == frames);
+                Report(_T("latency   "), samples);
+
+                // Throughput: keep the swapchain filled, the compositor only renders the latest frame.
+                const uint32_t rendered = client->Frames();
+                const Clock::time_point start = Clock::now();
+                uint32_t submitted = 0;
+
+                while ((submitted < frames) && (client->Render() == true)) {
+                    submitted++;
+                }
+
+                passed &= (submitted == frames);
+                Report(_T("throughput"), submitted, (client->Frames() - rendered), Elapsed(start));
+
+                if (futex == false) {
+                    Core::ResourceMonitor::Instance().Unregister(*client);
+                }
+            }
+
+            client.Release();
+        }
+
+        return (passed);
+    }
+
+    pid_t Spawn(const string& mode, const uint32_t frames, const string& connector)
+    {
+        const string count = Core::NumberType<uint32_t>(frames).Text();
+
+        cout.flush();
+
+        pid_t result = ::fork();
+
+        if (result == 0) {
+            // Start over in a clean process, this one carries the threads of the compositor side.
+            ::execl("/proc/self/exe", "compositorbufferbench", "-client", mode.c_str(), count.c_str(), connector.c_str(), nullptr);
+            ::_exit(127);
+        }
+
+        return (result);
+    }
+
+    // Compositor side, runs in the parent process.
+    bool Compose(const string& mode, const uint32_t frames)
+    {
+        bool passed = false;
+        const bool futex = (mode == _T("futex"));
+        const string connector = string(Connector) + '.' + mode;
+        Core::ProxyType<Composer> server(Core::ProxyType<Composer>::Create(Depth, (mode == _T("async"))));
+        Dispatcher bridge;
+
+        cout << "[" << mode << "]" << endl;
+
+        bridge.Add(*server);
+        bridge.Open(connector);
+
+        if (futex == false) {
+            Core::ResourceMonitor::Instance().Register(*server);
+        }
+
+        const pid_t child = Spawn(mode, frames, connector);
+
+        if (child == -1) {
+            cout << "Could not start the client" << endl;
+        } else {
+            int status = 0;
+
+            if (futex == true) {
+                while (::waitpid(child, &status, WNOHANG) == 0) {
+                    server->Wait(100);
+                }
+            } else {
+                ::waitpid(child, &status, 0);
+            }
+
+            passed = ((WIFEXITED(status) == true) && (WEXITSTATUS(status) == 0));
+
+            if (server->Misses() != 0) {
+                cout << server->Misses() << " requested slots could not be rendered" << endl;
+                passed = false;
+            }
+
+            if ((passed == true) && (mode == _T("crash"))) {
+                // The client claimed and locked slot 0 before it died.
+                passed = (server->Acquire(WaitTime) != nullptr);
+
+                if (passed == true) {
+                    server->Relinquish();
+                }
+
+                cout << "Lock held by the crashed client " << (passed == true ? "recovered" : "NOT recovered") << endl;
+            }
+        }
+
+        if (futex == false) {
+            Core::ResourceMonitor::Instance().Unregister(*server);
+        }
+
+        server.Release();
+
+        return (passed);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    bool passed;
+
+    if ((argc == 5) && (::strcmp(argv[1], "-client") == 0)) {
+        passed = Render(argv[2], ::atoi(argv[3]), argv[4]);
+    } else {
+        const uint32_t frames = (argc > 1 ? ::atoi(argv[1]) : 10000);
+
+        cout << "compositorbufferbench [frames]" << endl;
+
+        passed = Compose(_T("eventfd"), frames);
+        passed &= Compose(_T("futex"), frames);
+        passed &= Compose(_T("async"), frames);
+        passed &= Compose(_T("crash"), frames);
+    }
+
+    Core::Singleton::Dispose();
+
+    return (passed == true ? 0 : 1);
+}
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# Generates the seed corpus for displayinfofuzz: spec conformant EDID 1.3/1.4
+# base blocks with CEA-861 extensions, plus a few deliberately broken ones.
+
+import os
+import struct
+
+
+def checksum(block):
+    block[127] = (256 - (sum(block[:127]) & 0xFF)) & 0xFF
+    return block
+
+
+def dtd(clock_khz, hactive, hblank, vactive, vblank, hfp, hsync, vfp, vsync, hmm, vmm):
+    d = bytearray(18)
+    struct.pack_into('<H', d, 0, clock_khz // 10)
+    d[2] = hactive & 0xFF
+    d[3] = hblank & 0xFF
+    d[4] = ((hactive >> 4) & 0xF0) | ((hblank >> 8) & 0x0F)
+    d[5] = vactive & 0xFF
+    d[6] = vblank & 0xFF
+    d[7] = ((vactive >> 4) & 0xF0) | ((vblank >> 8) & 0x0F)
+    d[8] = hfp & 0xFF
+    d[9] = hsync & 0xFF
+    d[10] = ((vfp & 0x0F) << 4) | (vsync & 0x0F)
+    d[11] = ((hfp >> 2) & 0xC0) | ((hsync >> 4) & 0x30) | ((vfp >> 2) & 0x0C) | ((vsync >> 4) & 0x03)
+    d[12] = hmm & 0xFF
+    d[13] = vmm & 0xFF
+    d[14] = ((hmm >> 4) & 0xF0) | ((vmm >> 8) & 0x0F)
+    d[17] = 0x1E
+    return d
+
+
+def descriptor(tag, text=b''):
+    d = bytearray(18)
+    d[3] = tag
+    if tag in (0xFC, 0xFF, 0xFE):
+        payload = (text + b'\n').ljust(13, b' ')[:13]
+        d[5:18] = payload
+    elif tag == 0xFD:
+        d[5:10] = bytes([24, 75, 15, 135, 60])
+    return d
+
+
+def base(name, extensions, digital=0xA5, version=4):
+    b = bytearray(128)
+    b[0:8] = b'\x00\xff\xff\xff\xff\xff\xff\x00'
+    b[8:10] = b'\x4c\x2d'
+    struct.pack_into('<H', b, 10, 0x0C39)
+    struct.pack_into('<I', b, 12, 0x01000E00)
+    b[16], b[17] = 12, 30
+    b[18], b[19] = 1, version
+    b[20] = digital
+    b[21], b[22] = 160, 90
+    b[23] = 120
+    b[24] = 0x2A
+    b[25:35] = bytes([0xEE, 0x91, 0xA3, 0x54, 0x4C, 0x99, 0x26, 0x0F, 0x50, 0x54])
+    b[35:38] = bytes([0xBD, 0xEF, 0x80])
+    std = [(0x71, 0x4F), (0x81, 0xC0), (0x81, 0x00), (0x81, 0x80),
+           (0x95, 0x00), (0xA9, 0xC0), (0xB3, 0x00), (0x01, 0x01)]
+    for i, (x, y) in enumerate(std):
+        b[38 + 2 * i], b[39 + 2 * i] = x, y
+    b[54:72] = dtd(148500, 1920, 280, 1080, 45, 88, 44, 4, 5, 1600, 900)
+    b[72:90] = descriptor(0xFD)
+    b[90:108] = descriptor(0xFC, name)
+    b[108:126] = descriptor(0xFF, b'H4ZN900000')
+    b[126] = extensions
+    return checksum(b)
+
+
+def block(tag, payload):
+    assert len(payload) < 32
+    return bytes([(tag << 5) | len(payload)]) + bytes(payload)
+
+
+def extended(tag, payload):
+    return block(7, [tag] + list(payload))
+
+
+def cea(blocks, dtds, flags=0xF0):
+    e = bytearray(128)
+    e[0], e[1] = 0x02, 0x03
+    collection = b''.join(blocks)
+    d = 4 + len(collection)
+    assert d + 18 * len(dtds) <= 127
+    e[2] = d
+    e[3] = flags | len(dtds)
+    e[4:d] = collection
+    for i, t in enumerate(dtds):
+        e[d + 18 * i: d + 18 * (i + 1)] = t
+    return checksum(e)
+
+
+VIDEO_HD = block(2, [0x90, 0x04, 0x03, 0x05, 0x01, 0x13, 0x14, 0x1F, 0x20, 0x22])
+VIDEO_UHD = block(2, [0x90, 0x04, 0x03, 0x10, 0x1F, 0x5F, 0x60, 0x61, 0x65, 0x66, 0x76, 0x77])
+AUDIO = block(1, [0x09, 0x07, 0x07, 0x15, 0x07, 0x50, 0x3D, 0x1F, 0xC0, 0x57, 0x06, 0x00, 0x5F, 0x7E, 0x01])
+SPEAKERS = block(4, [0x01, 0x00, 0x00])
+HDMI_VSDB = block(3, [0x03, 0x0C, 0x00, 0x10, 0x00, 0xB8, 0x3C, 0x20, 0x00, 0x60, 0x01, 0x02, 0x03])
+HF_VSDB = block(3, [0xD8, 0x5D, 0xC4, 0x01, 0x78, 0x80, 0x07])
+COLORIMETRY = extended(0x05, [0xC3, 0x01])
+HDR_STATIC = extended(0x06, [0x07, 0x01])
+VIDEO_CAPABILITY = extended(0x00, [0x4F])
+YCBCR420_VIDEO = extended(0x0E, [0x5F, 0x60, 0x61])
+YCBCR420_CAPABILITY = extended(0x0F, [0x0F])
+
+DTD_720P = dtd(74250, 1280, 370, 720, 30, 110, 40, 5, 5, 1600, 900)
+DTD_480P = dtd(27000, 720, 138, 480, 45, 16, 62, 9, 6, 1600, 900)
+DTD_576P = dtd(27000, 720, 144, 576, 49, 12, 64, 5, 5, 1600, 900)
+
+
+def seeds():
+    yield 'dvi_base_only', base(b'DVI 1080p', 0, digital=0x80, version=3)
+    yield 'hdmi_1080p', base(b'HDMI 1080p', 1) + cea(
+        [VIDEO_HD, AUDIO, SPEAKERS, HDMI_VSDB], [DTD_720P, DTD_480P, DTD_576P])
+    yield 'hdmi_uhd_hdr', base(b'HDMI UHD', 1) + cea(
+        [VIDEO_UHD, AUDIO, SPEAKERS, HDMI_VSDB, HF_VSDB, COLORIMETRY, HDR_STATIC,
+         VIDEO_CAPABILITY, YCBCR420_VIDEO, YCBCR420_CAPABILITY], [DTD_720P])
+    yield 'hdmi_two_extensions', base(b'HDMI 2 EXT', 2) + cea(
+        [VIDEO_HD, HDMI_VSDB], [DTD_720P]) + cea([AUDIO, COLORIMETRY], [DTD_480P])
+    yield 'cea_no_data_blocks', base(b'CEA EMPTY', 1) + cea([], [DTD_720P, DTD_480P])
+
+    # Malformed: the parser must reject or bound these, not read past them.
+    truncated = base(b'TRUNCATED', 1) + cea([VIDEO_HD, AUDIO, HDMI_VSDB], [DTD_720P])
+    yield 'truncated_extension', truncated[:128 + 40]
+    yield 'missing_extension', base(b'MISSING', 3) + cea([VIDEO_HD], [DTD_720P])
+
+    overrun = bytearray(cea([VIDEO_HD, AUDIO], [DTD_720P]))
+    overrun[4] = (1 << 5) | 31
+    yield 'block_overruns_collection', base(b'OVERRUN', 1) + checksum(overrun)
+
+    dtd_offset = bytearray(cea([VIDEO_HD], []))
+    dtd_offset[2] = 0xFF
+    yield 'dtd_offset_past_block', base(b'DTD OFFSET', 1) + checksum(dtd_offset)
+
+    short_sad = bytearray(cea([block(1, [0x09, 0x07, 0x07, 0x15])], [DTD_720P]))
+    yield 'short_audio_descriptor', base(b'SHORT SAD', 1) + bytes(short_sad)
+
+    empty_extended = bytearray(cea([block(7, [])], []))
+    yield 'empty_extended_tag', base(b'EMPTY EXT', 1) + bytes(empty_extended)
+
+    bad = bytearray(base(b'BAD CHECKSUM', 1) + cea([VIDEO_HD, AUDIO], [DTD_720P]))
+    bad[127] ^= 0x55
+    yield 'bad_checksum', bytes(bad)
+
+
+if __name__ == '__main__':
+    here = os.path.dirname(os.path.abspath(__file__))
+    for name, data in seeds():
+        with open(os.path.join(here, name + '.bin'), 'wb') as f:
+            f.write(data)
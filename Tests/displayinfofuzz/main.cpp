@@ -0,0 +1,153 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <displayinfo.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+namespace {
+
+    struct Result {
+        uint32_t baseStatus;
+        uint32_t ceaStatus;
+        displayinfo_edid_base_info_t base;
+        displayinfo_edid_cea_extension_info_t cea;
+    };
+
+    void Parse(const uint8_t data[], const uint16_t length, Result& result)
+    {
+        memset(&result, 0, sizeof(result));
+
+        result.baseStatus = displayinfo_parse_edid(data, length, &result.base);
+        result.ceaStatus = displayinfo_edid_cea_extension_info(data, length, &result.cea);
+    }
+
+    // Field by field, the padding of the structs is not part of the result.
+    bool IsSame(const displayinfo_edid_base_info_t& lhs, const displayinfo_edid_base_info_t& rhs)
+    {
+        return ((lhs.version == rhs.version) && (lhs.revision == rhs.revision)
+            && (memcmp(lhs.manufacturer_id, rhs.manufacturer_id, sizeof(lhs.manufacturer_id)) == 0)
+            && (lhs.product_code == rhs.product_code) && (lhs.serial_number == rhs.serial_number)
+            && (lhs.manufacture_week == rhs.manufacture_week) && (lhs.manufacture_year == rhs.manufacture_year)
+            && (lhs.digital == rhs.digital) && (lhs.bits_per_color == rhs.bits_per_color)
+            && (lhs.video_interface == rhs.video_interface) && (lhs.display_type == rhs.display_type)
+            && (lhs.width_in_centimeters == rhs.width_in_centimeters) && (lhs.height_in_centimeters == rhs.height_in_centimeters)
+            && (lhs.preferred_width_in_pixels == rhs.preferred_width_in_pixels) && (lhs.preferred_height_in_pixels == rhs.preferred_height_in_pixels));
+    }
+
+    bool IsSame(const displayinfo_edid_cea_extension_info_t& lhs, const displayinfo_edid_cea_extension_info_t& rhs)
+    {
+        return ((lhs.version == rhs.version) && (lhs.audio_formats == rhs.audio_formats)
+            && (lhs.color_spaces == rhs.color_spaces) && (lhs.color_formats == rhs.color_formats)
+            && (memcmp(lhs.color_depths, rhs.color_depths, sizeof(lhs.color_depths)) == 0)
+            && (lhs.number_of_timings == rhs.number_of_timings)
+            && (memcmp(lhs.timings, rhs.timings, lhs.number_of_timings * sizeof(lhs.timings[0])) == 0));
+    }
+
+    bool IsSame(const Result& lhs, const Result& rhs)
+    {
+        return ((lhs.baseStatus == rhs.baseStatus) && (lhs.ceaStatus == rhs.ceaStatus)
+            && ((lhs.baseStatus != DISPLAYINFO_OK) || (IsSame(lhs.base, rhs.base) == true))
+            && ((lhs.ceaStatus != DISPLAYINFO_OK) || (IsSame(lhs.cea, rhs.cea) == true)));
+    }
+
+    // A parse served from the cache must be indistinguishable from a fresh one.
+    void Verify(const Result& lhs, const Result& rhs, const char step[])
+    {
+        if (IsSame(lhs, rhs) == false) {
+            fprintf(stderr, "Parse cache mismatch (%s): base %u/%u, cea %u/%u\n", step, lhs.baseStatus, rhs.baseStatus, lhs.ceaStatus, rhs.ceaStatus);
+            abort();
+        }
+    }
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    // The C API takes 16 bit lengths, anything bigger than 256 blocks is not an EDID anyway.
+    const uint16_t length = static_cast<uint16_t>(size > 0xFFFF ? 0xFFFF : size);
+
+    // The copy keeps the input alive for the parse cache and lets us hit it twice:
+    // once as a miss and once as a hit, which must yield the same result.
+    std::vector<uint8_t> buffer(data, data + length);
+    Result miss;
+    Result hit;
+
+    Parse(buffer.data(), length, miss);
+    Parse(buffer.data(), length, hit);
+
+    Verify(miss, hit, "hit");
+
+    if (length > 0) {
+        // Same checksums, different content: must not be served from the cache.
+        Result changed;
+
+        buffer[0] ^= 0xFF;
+        Parse(buffer.data(), length, changed);
+        Parse(buffer.data(), length, hit);
+
+        Verify(changed, hit, "changed hit");
+
+        // And back, which must not get the result of the changed content either.
+        buffer[0] ^= 0xFF;
+        Parse(buffer.data(), length, hit);
+
+        Verify(miss, hit, "restored");
+    }
+
+    return (0);
+}
+
+#ifdef FUZZ_STANDALONE_DRIVER
+
+int main(int argc, const char* argv[])
+{
+    int result = 0;
+
+    for (int index = 1; index < argc; index++) {
+        FILE* file = fopen(argv[index], "rb");
+
+        if (file == nullptr) {
+            fprintf(stderr, "Could not open %s\n", argv[index]);
+            result = 1;
+        } else {
+            std::vector<uint8_t> data;
+            uint8_t chunk[512];
+            size_t loaded;
+
+            while ((loaded = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+                data.insert(data.end(), chunk, chunk + loaded);
+            }
+
+            fclose(file);
+
+            LLVMFuzzerTestOneInput(data.data(), data.size());
+            printf("%s: %zu bytes, OK\n", argv[index], data.size());
+        }
+    }
+
+    return (result);
+}
+
+#endif
@@ -0,0 +1,247 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Module.h"
+#include "ModeSet.h"
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <gbm.h>
+#include <drm/drm_fourcc.h>
+
+#include <iostream>
+#include <set>
+
+#include <poll.h>
+
+using namespace std;
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+// Renders frames into a gbm surface and flips them on the display of the ModeSet backend,
+// dispatching the flip events from this loop. Without a display, the virtual KMS driver
+// will do: modprobe vkms
+namespace {
+
+    constexpr uint32_t WaitTime = 1000;
+
+    class Flips : public ModeSet::ICallback {
+    public:
+        Flips(const Flips&) = delete;
+        Flips& operator=(const Flips&) = delete;
+
+        Flips()
+            : _count(0)
+        {
+        }
+        ~Flips() override = default;
+
+    public:
+        void PageFlip(unsigned int, unsigned int, unsigned int) override
+        {
+            _count++;
+        }
+        void VBlank(unsigned int, unsigned int, unsigned int) override
+        {
+        }
+        uint32_t Count() const
+        {
+            return (_count);
+        }
+
+    private:
+        std::atomic<uint32_t> _count;
+    };
+
+    // Only one flip can be pending, have the previous one completed first.
+    bool Completed(ModeSet& modeSet)
+    {
+        bool result = true;
+
+        while ((modeSet.IsFlipPending() == true) && (result == true)) {
+            struct pollfd descriptor = { modeSet.Descriptor(), POLLIN, 0 };
+
+            if ((result = (::poll(&descriptor, 1, WaitTime) > 0)) == true) {
+                modeSet.Dispatch();
+            }
+        }
+
+        return (result);
+    }
+
+    EGLConfig Configuration(EGLDisplay display)
+    {
+        const EGLint attributes[] = {
+            EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+            EGL_NONE
+        };
+
+        EGLConfig result = nullptr;
+        EGLConfig configs[64];
+        EGLint count = 0;
+
+        if (eglChooseConfig(display, attributes, configs, (sizeof(configs) / sizeof(EGLConfig)), &count) == EGL_TRUE) {
+            // The visual has to match the format of the gbm surface.
+            for (EGLint index = 0; (index < count) && (result == nullptr); index++) {
+                EGLint id = 0;
+
+                if ((eglGetConfigAttrib(display, configs[index], EGL_NATIVE_VISUAL_ID, &id) == EGL_TRUE) && (static_cast<uint32_t>(id) == ModeSet::SupportedBufferType())) {
+                    result = configs[index];
+                }
+            }
+        }
+
+        return (result);
+    }
+
+    // A video like buffer on top of the render target, on an overlay plane if the display takes it.
+    // The virtual KMS driver only has overlay planes with: modprobe vkms enable_overlay=1
+    bool Overlay(ModeSet& modeSet, struct gbm_surface* surface, EGLDisplay display, EGLSurface window, const uint32_t format, const TCHAR name[])
+    {
+        bool result = true;
+        struct gbm_bo* bo = gbm_bo_create(const_cast<struct gbm_device*>(modeSet.UnderlyingHandle()), 256, 256, format, GBM_BO_USE_SCANOUT);
+
+        if (bo == nullptr) {
+            cout << name << ": not supported by the gbm device" << endl;
+        } else {
+            ModeSet::Layer layer = { modeSet.AddBufferToOutput(bo), format, 256, 256, 64, 64, 512, 512, 0 };
+
+            if (layer.id == static_cast<uint32_t>(~0)) {
+                cout << name << ": no framebuffer" << endl;
+            } else {
+                const uint8_t placed = modeSet.Assign(&layer, 1);
+
+                if (placed == 0) {
+                    cout << name << ": GL composition" << endl;
+                } else {
+                    cout << name << ": plane " << layer.plane << endl;
+                }
+
+                // With the layer for a few frames, then without it, so the plane is disabled again.
+                for (uint8_t frame = 0; (frame < 4) && (result == true); frame++) {
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    eglSwapBuffers(display, window);
+
+                    const uint32_t id = modeSet.AddSurfaceToOutput(surface);
+
+                    result = (id != static_cast<uint32_t>(~0)) && (Completed(modeSet) == true) && (modeSet.ScanOutRenderTarget(surface, id, &layer, (frame < 3 ? 1 : 0)) == true);
+                }
+
+                result = result && (Completed(modeSet) == true);
+            }
+
+            gbm_bo_destroy(bo);
+        }
+
+        return (result);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const uint32_t frames = (argc > 1 ? ::atoi(argv[1]) : 600);
+    bool passed = false;
+
+    cout << "modesettest [frames]" << endl;
+
+    {
+        ModeSet modeSet;
+
+        if (modeSet.Descriptor() == -1) {
+            cout << "No display to flip on, try: modprobe vkms" << endl;
+        } else {
+            Flips flips;
+            struct gbm_surface* surface = modeSet.CreateRenderTarget(modeSet.Width(), modeSet.Height());
+            EGLDisplay display = eglGetDisplay(reinterpret_cast<EGLNativeDisplayType>(const_cast<struct gbm_device*>(modeSet.UnderlyingHandle())));
+            EGLConfig config = nullptr;
+
+            modeSet.Callback(&flips);
+
+            if ((surface == nullptr) || (eglInitialize(display, nullptr, nullptr) != EGL_TRUE) || (eglBindAPI(EGL_OPENGL_ES_API) != EGL_TRUE) || ((config = Configuration(display)) == nullptr)) {
+                cout << "No EGL on the gbm device" << endl;
+            } else {
+                const EGLint contextAttributes[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+                EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+                EGLSurface window = eglCreateWindowSurface(display, config, reinterpret_cast<EGLNativeWindowType>(surface), nullptr);
+
+                if ((context != EGL_NO_CONTEXT) && (window != EGL_NO_SURFACE) && (eglMakeCurrent(display, window, window, context) == EGL_TRUE)) {
+                    std::set<uint32_t> framebuffers;
+                    const uint64_t start = Core::Time::Now().Ticks();
+                    uint32_t frame = 0;
+
+                    cout << "Display " << modeSet.Width() << "x" << modeSet.Height() << endl;
+
+                    while (frame < frames) {
+                        glClearColor(static_cast<float>(frame % 60) / 60.0f, 0.0f, 0.5f, 1.0f);
+                        glClear(GL_COLOR_BUFFER_BIT);
+                        eglSwapBuffers(display, window);
+
+                        const uint32_t id = modeSet.AddSurfaceToOutput(surface);
+
+                        if ((id == static_cast<uint32_t>(~0)) || (Completed(modeSet) == false) || (modeSet.ScanOutRenderTarget(surface, id) == false)) {
+                            break;
+                        }
+
+                        framebuffers.insert(id);
+                        frame++;
+                    }
+
+                    Completed(modeSet);
+
+                    const uint64_t duration = Core::Time::Now().Ticks() - start;
+
+                    cout << frame << " frames, " << flips.Count() << " flips in " << (duration / 1000) << " ms, "
+                         << (duration != 0 ? ((static_cast<uint64_t>(flips.Count()) * 1000000) / duration) : 0) << " flips/s" << endl;
+                    cout << framebuffers.size() << " framebuffers added for " << frame << " frames" << endl;
+
+                    // The surface cycles through a handful of buffers, each gets a framebuffer once.
+                    passed = (flips.Count() == frames) && (framebuffers.size() <= 4);
+
+                    if (modeSet.IsAtomic() == true) {
+                        passed &= Overlay(modeSet, surface, display, window, DRM_FORMAT_ARGB8888, _T("ARGB8888"));
+                        passed &= Overlay(modeSet, surface, display, window, DRM_FORMAT_NV12, _T("NV12"));
+                        passed &= Overlay(modeSet, surface, display, window, DRM_FORMAT_P010, _T("P010"));
+                    }
+
+                    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+                }
+
+                if (window != EGL_NO_SURFACE) {
+                    eglDestroySurface(display, window);
+                }
+                if (context != EGL_NO_CONTEXT) {
+                    eglDestroyContext(display, context);
+                }
+            }
+
+            eglTerminate(display);
+
+            modeSet.Callback(nullptr);
+            modeSet.DestroyRenderTarget(surface);
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (passed == true ? 0 : 1);
+}
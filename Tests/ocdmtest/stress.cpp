@@ -0,0 +1,604 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2021 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME OpenCDMStressTest
+#endif
+
+#include <ocdm/open_cdm.h>
+
+#include <core/core.h>
+#include <com/com.h>
+#include <interfaces/IOCDM.h>
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <thread>
+#include <vector>
+
+// Set by the build, from where the Thunder it is built against is installed.
+#ifndef PROXYSTUB_PATH
+#error "PROXYSTUB_PATH should point to the installed Thunder proxy stubs"
+#endif
+
+using namespace std;
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+// Hammers the key status and session administration of the OCDM client library
+// against an in-process mock of the OCDM server and reports the CPU time the
+// waiting threads consumed. Up front, it checks a session attaches to a decrypt
+// buffer the server already has.
+namespace {
+
+    constexpr TCHAR Connector[] = _T("/tmp/ocdmstresstest");
+    constexpr TCHAR KeySystem[] = _T("org.thunder.stress");
+    constexpr TCHAR ProxyStubPath[] = _T(PROXYSTUB_PATH);
+    constexpr TCHAR ExistingBuffer[] = _T("/tmp/ocdmstresstest.buffer");
+    constexpr uint32_t ExistingBufferSize = (64 * 1024);
+    constexpr uint8_t KeyLength = 16;
+    constexpr uint8_t KeysPerSession = 8;
+
+    uint64_t ThreadCPUTime()
+    {
+        struct rusage usage;
+
+        ::getrusage(RUSAGE_THREAD, &usage);
+
+        return ((static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000) + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+    }
+
+    void KeyId(const uint8_t session, const uint8_t key, uint8_t keyId[KeyLength])
+    {
+        ::memset(keyId, 0xA5, KeyLength);
+        keyId[14] = session;
+        keyId[15] = key;
+    }
+
+    class MockSession : public Exchange::ISession {
+    public:
+        MockSession() = delete;
+        MockSession(const MockSession&) = delete;
+        MockSession& operator=(const MockSession&) = delete;
+
+        // With existing set, the decrypt buffer is there before the client asks
+        // for it, as if it was created through another session object.
+        MockSession(const uint8_t index, Exchange::ISession::ICallback* callback, const bool existing)
+            : _refCount(1)
+            , _index(index)
+            , _lock()
+            , _callback(callback)
+            , _buffer(existing == true ? new Exchange::DataExchange(ExistingBuffer, ExistingBufferSize) : nullptr)
+            , _serving(_buffer != nullptr)
+            , _server()
+        {
+            _callback->AddRef();
+
+            if (_buffer != nullptr) {
+                // Hand every sample straight back, as decrypted.
+                _server = std::thread([this]() {
+                    while (_serving == true) {
+                        if (_buffer->RequestConsume(100) == Core::ERROR_NONE) {
+                            _buffer->Consumed();
+                        }
+                    }
+                });
+            }
+        }
+        ~MockSession() override
+        {
+            Revoke(nullptr);
+
+            if (_buffer != nullptr) {
+                _serving = false;
+                _server.join();
+                delete _buffer;
+            }
+        }
+
+    public:
+        uint32_t AddRef() const override
+        {
+            Core::InterlockedIncrement(_refCount);
+            return (Core::ERROR_NONE);
+        }
+        uint32_t Release() const override
+        {
+            if (Core::InterlockedDecrement(_refCount) == 0) {
+                delete this;
+                return (Core::ERROR_DESTRUCTION_SUCCEEDED);
+            }
+            return (Core::ERROR_NONE);
+        }
+
+        BEGIN_INTERFACE_MAP(MockSession)
+        INTERFACE_ENTRY(Exchange::ISession)
+        END_INTERFACE_MAP
+
+        uint8_t Index() const
+        {
+            return (_index);
+        }
+        void Announce(const uint8_t key, const Exchange::ISession::KeyStatus status)
+        {
+            uint8_t keyId[KeyLength];
+
+            KeyId(_index, key, keyId);
+
+            _lock.Lock();
+            if (_callback != nullptr) {
+                _callback->OnKeyStatusUpdate(keyId, KeyLength, status);
+            }
+            _lock.Unlock();
+        }
+
+        Exchange::OCDM_RESULT Load() override
+        {
+            return (Exchange::OCDM_SUCCESS);
+        }
+        void Update(const uint8_t*, const uint16_t) override
+        {
+        }
+        Exchange::OCDM_RESULT Remove() override
+        {
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT Metricdata(uint32_t& bufferSize, uint8_t[]) const override
+        {
+            bufferSize = 0;
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::ISession::KeyStatus Status() const override
+        {
+            return (Exchange::ISession::Usable);
+        }
+        Exchange::ISession::KeyStatus Status(const uint8_t[], const uint8_t) const override
+        {
+            return (Exchange::ISession::Usable);
+        }
+        std::string BufferId() const override
+        {
+            return (_buffer != nullptr ? _buffer->Name() : std::string());
+        }
+        std::string SessionId() const override
+        {
+            return (std::string(_T("stress-")) + Core::NumberType<uint8_t>(_index).Text());
+        }
+        std::string Metadata() const override
+        {
+            return (std::string());
+        }
+        void Close() override
+        {
+        }
+        void ResetOutputProtection() override
+        {
+        }
+        void SetParameter(const std::string&, const std::string&) override
+        {
+        }
+        void Revoke(Exchange::ISession::ICallback*) override
+        {
+            _lock.Lock();
+            if (_callback != nullptr) {
+                _callback->Release();
+                _callback = nullptr;
+            }
+            _lock.Unlock();
+        }
+        uint32_t CreateSessionBuffer(string&) override
+        {
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+
+            if (_buffer != nullptr) {
+                // Already exists on the server side.
+                result = 1;
+            } else {
+                // Widen the window in which decrypting threads race for the lazy buffer creation.
+                SleepMs(1);
+            }
+
+            return (result);
+        }
+
+    private:
+        mutable uint32_t _refCount;
+        const uint8_t _index;
+        Core::CriticalSection _lock;
+        Exchange::ISession::ICallback* _callback;
+        Exchange::DataExchange* _buffer;
+        std::atomic<bool> _serving;
+        std::thread _server;
+    };
+
+    class MockAccessor : public Exchange::IAccessorOCDM {
+    public:
+        MockAccessor(const MockAccessor&) = delete;
+        MockAccessor& operator=(const MockAccessor&) = delete;
+
+        MockAccessor()
+            : _refCount(1)
+            , _lock()
+            , _sessions()
+            , _created(0)
+            , _existing(false)
+        {
+        }
+        ~MockAccessor() override = default;
+
+    public:
+        uint32_t AddRef() const override
+        {
+            Core::InterlockedIncrement(_refCount);
+            return (Core::ERROR_NONE);
+        }
+        uint32_t Release() const override
+        {
+            if (Core::InterlockedDecrement(_refCount) == 0) {
+                delete this;
+                return (Core::ERROR_DESTRUCTION_SUCCEEDED);
+            }
+            return (Core::ERROR_NONE);
+        }
+
+        BEGIN_INTERFACE_MAP(MockAccessor)
+        INTERFACE_ENTRY(Exchange::IAccessorOCDM)
+        END_INTERFACE_MAP
+
+        // Push a status for every key of every living session.
+        void Announce(const Exchange::ISession::KeyStatus status)
+        {
+            std::list<MockSession*> sessions;
+
+            _lock.Lock();
+            for (MockSession* session : _sessions) {
+                session->AddRef();
+                sessions.push_back(session);
+            }
+            _lock.Unlock();
+
+            for (MockSession* session : sessions) {
+                for (uint8_t key = 0; key < KeysPerSession; key++) {
+                    session->Announce(key, status);
+                }
+                session->Release();
+            }
+        }
+        void Clear()
+        {
+            _lock.Lock();
+            for (MockSession* session : _sessions) {
+                session->Release();
+            }
+            _sessions.clear();
+            _lock.Unlock();
+        }
+        uint32_t Created() const
+        {
+            return (_created);
+        }
+        // Sessions created from now on come with a decrypt buffer that already exists.
+        void Existing(const bool existing)
+        {
+            _existing = existing;
+        }
+
+        bool IsTypeSupported(const std::string&, const std::string&) const override
+        {
+            return (true);
+        }
+        Exchange::OCDM_RESULT Metadata(const string&, string& metadata) const override
+        {
+            metadata.clear();
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT Metricdata(const string&, uint32_t& length, uint8_t[]) const override
+        {
+            length = 0;
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT CreateSession(const string&, const int32_t, const std::string&, const uint8_t*, const uint16_t,
+            const uint8_t*, const uint16_t, Exchange::ISession::ICallback* callback, std::string& sessionId,
+            Exchange::ISession*& session) override
+        {
+            MockSession* created = new MockSession(static_cast<uint8_t>(Core::InterlockedIncrement(_created)), callback, _existing);
+
+            sessionId = created->SessionId();
+
+            created->AddRef();
+            session = created;
+
+            _lock.Lock();
+            _sessions.push_back(created);
+            if (_sessions.size() > 32) {
+                // Let go of the oldest sessions, keeps the amount of keys to announce bounded.
+                _sessions.front()->Release();
+                _sessions.pop_front();
+            }
+            _lock.Unlock();
+
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT SetServerCertificate(const string&, const uint8_t*, const uint16_t) override
+        {
+            return (Exchange::OCDM_SUCCESS);
+        }
+        uint64_t GetDrmSystemTime(const std::string&) const override
+        {
+            return (0);
+        }
+        std::string GetVersionExt(const std::string&) const override
+        {
+            return (std::string());
+        }
+        uint32_t GetLdlSessionLimit(const std::string&) const override
+        {
+            return (0);
+        }
+        bool IsSecureStopEnabled(const std::string&) override
+        {
+            return (false);
+        }
+        Exchange::OCDM_RESULT EnableSecureStop(const std::string&, bool) override
+        {
+            return (Exchange::OCDM_SUCCESS);
+        }
+        uint32_t ResetSecureStops(const std::string&) override
+        {
+            return (0);
+        }
+        Exchange::OCDM_RESULT GetSecureStopIds(const std::string&, uint8_t[], uint16_t, uint32_t& count) override
+        {
+            count = 0;
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT GetSecureStop(const std::string&, const uint8_t[], uint16_t, uint8_t[], uint16_t& rawSize) override
+        {
+            rawSize = 0;
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT CommitSecureStop(const std::string&, const uint8_t[], uint16_t, const uint8_t[], uint16_t) override
+        {
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT DeleteKeyStore(const std::string&) override
+        {
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT DeleteSecureStore(const std::string&) override
+        {
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT GetKeyStoreHash(const std::string&, uint8_t[], uint16_t) override
+        {
+            return (Exchange::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT GetSecureStoreHash(const std::string&, uint8_t[], uint16_t) override
+        {
+            return (Exchange::OCDM_SUCCESS);
+        }
+
+    private:
+        mutable uint32_t _refCount;
+        Core::CriticalSection _lock;
+        std::list<MockSession*> _sessions;
+        uint32_t _created;
+        std::atomic<bool> _existing;
+    };
+
+    class MockServer : public RPC::Communicator {
+    public:
+        MockServer() = delete;
+        MockServer(const MockServer&) = delete;
+        MockServer& operator=(const MockServer&) = delete;
+
+        MockServer(const Core::NodeId& node, const string& proxyStubPath, MockAccessor* accessor)
+            : RPC::Communicator(node, proxyStubPath, Core::ProxyType<Core::IIPCServer>(Core::ProxyType<RPC::InvokeServerType<4, 0, 8>>::Create()))
+            , _accessor(accessor)
+        {
+            Open(Core::infinite);
+        }
+        ~MockServer() override
+        {
+            Close(Core::infinite);
+        }
+
+    private:
+        void* Acquire(const string&, const uint32_t interfaceId, const uint32_t) override
+        {
+            void* result = nullptr;
+
+            if (interfaceId == Exchange::IAccessorOCDM::ID) {
+                _accessor->AddRef();
+                result = static_cast<Exchange::IAccessorOCDM*>(_accessor);
+            }
+
+            return (result);
+        }
+
+    private:
+        MockAccessor* _accessor;
+    };
+
+    struct Statistics {
+        Statistics()
+            : Found(0)
+            , Missed(0)
+            , WaitTime(0)
+            , CPUTime(0)
+        {
+        }
+
+        std::atomic<uint32_t> Found;
+        std::atomic<uint32_t> Missed;
+        std::atomic<uint64_t> WaitTime;
+        std::atomic<uint64_t> CPUTime;
+    };
+}
+
+int main(int argc, const char* argv[])
+{
+    cout << "[waiters] [churners] [seconds] [proxystub path]" << endl;
+
+    const uint32_t waiters = (argc > 1 ? atoi(argv[1]) : 8);
+    const uint32_t churners = (argc > 2 ? atoi(argv[2]) : 4);
+    const uint32_t seconds = (argc > 3 ? atoi(argv[3]) : 5);
+    const string proxyStubPath = (argc > 4 ? argv[4] : ProxyStubPath);
+
+    Core::SystemInfo::SetEnvironment(_T("OPEN_CDM_SERVER"), Connector);
+
+    MockAccessor* accessor = new MockAccessor();
+    int result = 0;
+
+    {
+        MockServer server(Core::NodeId(Connector), proxyStubPath, accessor);
+
+        struct OpenCDMSystem* system = opencdm_create_system(KeySystem);
+
+        if (system == nullptr) {
+            cout << "ocdm system could not be created" << endl;
+            result = -1;
+        } else {
+            // The server already has the decrypt buffer of the session, the client
+            // should attach to it rather than give up on decrypting.
+            struct OpenCDMSession* existing = nullptr;
+
+            accessor->Existing(true);
+
+            if (opencdm_construct_session(system, Temporary, "cenc", nullptr, 0, nullptr, 0, nullptr, nullptr, &existing) == ERROR_NONE) {
+                uint8_t sample[64] = {};
+                EncryptionPattern pattern = { 0, 0 };
+
+                const OpenCDMError decrypted = opencdm_session_decrypt(existing, sample, sizeof(sample), AesCtr_Cenc, pattern, nullptr, 0, nullptr, 0);
+                const bool attached = ((decrypted != ERROR_INVALID_DECRYPT_BUFFER) && (string(opencdm_session_buffer_id(existing)) == ExistingBuffer));
+
+                cout << "existing buffer:    " << (attached == true ? "attached" : "NOT attached") << endl;
+
+                if (attached == false) {
+                    result = -1;
+                }
+
+                opencdm_destruct_session(existing);
+            } else {
+                cout << "session with an existing buffer could not be created" << endl;
+                result = -1;
+            }
+
+            accessor->Existing(false);
+
+            std::atomic<bool> running(true);
+            std::atomic<uint32_t> sessions(0);
+            Statistics statistics;
+            std::vector<std::thread> threads;
+
+            // Key rotation: flip all keys of all sessions between usable and expired.
+            threads.emplace_back([&]() {
+                bool usable = true;
+                while (running == true) {
+                    accessor->Announce(usable == true ? Exchange::ISession::Usable : Exchange::ISession::Expired);
+                    usable = !usable;
+                }
+            });
+
+            // Session churn: create a session, race the lazy decrypt buffer creation and destroy it again.
+            for (uint32_t index = 0; index < churners; index++) {
+                threads.emplace_back([&]() {
+                    while (running == true) {
+                        struct OpenCDMSession* session = nullptr;
+
+                        if (opencdm_construct_session(system, Temporary, "cenc", nullptr, 0, nullptr, 0, nullptr, nullptr, &session) == ERROR_NONE) {
+                            uint8_t sample[64] = {};
+                            EncryptionPattern pattern = { 0, 0 };
+
+                            std::thread decrypter([&]() {
+                                opencdm_session_decrypt(session, sample, sizeof(sample), AesCtr_Cenc, pattern, nullptr, 0, nullptr, 0);
+                            });
+                            opencdm_session_decrypt(session, sample, sizeof(sample), AesCtr_Cenc, pattern, nullptr, 0, nullptr, 0);
+                            decrypter.join();
+
+                            opencdm_destruct_session(session);
+                            sessions++;
+                        }
+                    }
+                });
+            }
+
+            // Waiters: wait for a random key of a recent session to become usable.
+            for (uint32_t index = 0; index < waiters; index++) {
+                threads.emplace_back([&]() {
+                    while (running == true) {
+                        uint8_t keyId[KeyLength];
+                        const uint32_t created = accessor->Created();
+                        const uint8_t session = static_cast<uint8_t>(created - (Core::Time::Now().Ticks() % 16));
+
+                        KeyId(session, static_cast<uint8_t>(Core::Time::Now().Ticks() % KeysPerSession), keyId);
+
+                        const uint64_t start = Core::Time::Now().Ticks();
+                        const uint64_t cpu = ThreadCPUTime();
+
+                        struct OpenCDMSession* found = opencdm_get_system_session(system, keyId, KeyLength, 100);
+
+                        statistics.CPUTime += ThreadCPUTime() - cpu;
+                        statistics.WaitTime += Core::Time::Now().Ticks() - start;
+
+                        if (found != nullptr) {
+                            statistics.Found++;
+                            opencdm_destruct_session(found);
+                        } else {
+                            statistics.Missed++;
+                        }
+                    }
+                });
+            }
+
+            SleepS(seconds);
+            running = false;
+
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+
+            const uint32_t lookups = statistics.Found + statistics.Missed;
+
+            cout << "sessions created:   " << sessions << endl;
+            cout << "key lookups:        " << lookups << " (found: " << statistics.Found << ", timed out: " << statistics.Missed << ")" << endl;
+            cout << "wall time waiting:  " << (statistics.WaitTime / Core::Time::TicksPerMillisecond) << " ms" << endl;
+            cout << "CPU time waiting:   " << (statistics.CPUTime / 1000) << " ms" << endl;
+            if (lookups > 0) {
+                cout << "CPU time per wait:  " << (statistics.CPUTime / lookups) << " us" << endl;
+            }
+
+            opencdm_destruct_system(system);
+        }
+
+        opencdm_dispose();
+
+        accessor->Clear();
+    }
+
+    accessor->Release();
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
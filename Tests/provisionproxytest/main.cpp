@@ -0,0 +1,186 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+#ifndef MODULE_NAME
+#define MODULE_NAME ProvisionProxyTest
+#endif
+
+#include <AccessProvision.h>
+
+#include <core/core.h>
+#include <com/com.h>
+#include <interfaces/IProvisioning.h>
+
+#include "../common/StubServer.h"
+
+using namespace std;
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+// Exercises the persistent link, the prefetch and the DRM id cache of the
+// ProvisionProxy client library against an in-process stub of the
+// provisioning endpoint:
+//   provisionproxytest [proxystub path]
+namespace {
+
+    constexpr TCHAR Connector[] = _T("/tmp/provisionproxytest");
+    constexpr TCHAR DeviceIdentifier[] = _T("0123456789ABCDEF");
+    constexpr uint16_t MaxIdLength = 1024;
+
+    class Provisioning : public Tests::Stub<Exchange::IProvisioning> {
+    public:
+        Provisioning(const Provisioning&) = delete;
+        Provisioning& operator=(const Provisioning&) = delete;
+
+        Provisioning()
+            : _deviceIds(0)
+            , _drmIds(0)
+        {
+        }
+        ~Provisioning() override = default;
+
+    public:
+        BEGIN_INTERFACE_MAP(Provisioning)
+        INTERFACE_ENTRY(Exchange::IProvisioning)
+        END_INTERFACE_MAP
+
+        void Register(Exchange::IProvisioning::INotification*) override
+        {
+        }
+        void Unregister(Exchange::IProvisioning::INotification*) override
+        {
+        }
+        uint32_t DeviceId(string& id) const override
+        {
+            Core::InterlockedIncrement(_deviceIds);
+            id = DeviceIdentifier;
+            return (Core::ERROR_NONE);
+        }
+        uint32_t DRMId(const string& label, uint16_t& length, uint8_t buffer[]) const override
+        {
+            uint32_t result = Core::ERROR_UNKNOWN_KEY;
+
+            Core::InterlockedIncrement(_drmIds);
+
+            if ((label.empty() == false) && (label.length() <= length)) {
+                ::memcpy(buffer, label.c_str(), label.length());
+                length = static_cast<uint16_t>(label.length());
+                result = Core::ERROR_NONE;
+            }
+
+            return (result);
+        }
+
+        uint32_t DeviceIds() const
+        {
+            return (_deviceIds);
+        }
+        uint32_t DRMIds() const
+        {
+            return (_drmIds);
+        }
+
+    private:
+        mutable uint32_t _deviceIds;
+        mutable uint32_t _drmIds;
+    };
+
+    using Server = Tests::StubServer<Provisioning>;
+
+    int DeviceId()
+    {
+        char buffer[MaxIdLength];
+
+        return (GetDeviceId(sizeof(buffer), buffer));
+    }
+
+    int DRMId(const char label[])
+    {
+        char buffer[MaxIdLength];
+
+        return (GetDRMId(label, sizeof(buffer), buffer));
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const string proxyStubPath = Tests::ProxyStubPath(argc, argv);
+    const char* const labels[] = { _T("playready"), _T("widevine"), _T("netflix") };
+    bool passed = true;
+
+    Core::SystemInfo::SetEnvironment(_T("PROVISION_PATH"), Connector);
+
+    {
+        Server server(Core::NodeId(Connector), proxyStubPath);
+        const Provisioning& provisioning(server.Implementation());
+
+        bool received = true;
+
+        for (uint8_t index = 0; index < 10; index++) {
+            received &= (DeviceId() == static_cast<int>(sizeof(DeviceIdentifier) - 1));
+        }
+
+        passed &= Tests::Check(_T("the device id is fetched once"), (received == true) && (provisioning.DeviceIds() == 1));
+
+        for (uint8_t index = 0; index < 10; index++) {
+            DRMId(labels[0]);
+        }
+
+        passed &= Tests::Check(_T("DRM ids are requested over a single link"), (server.Acquired() == 1) && (provisioning.DRMIds() == 10));
+
+        passed &= Tests::Check(_T("nothing is prefetched without a cache"), (provisioningproxy_prefetch(labels, 3) == 0) && (provisioning.DRMIds() == 10));
+
+        provisioningproxy_cache_lifetime(200);
+
+        const unsigned short prefetched = provisioningproxy_prefetch(labels, 3);
+
+        passed &= Tests::Check(_T("labels are prefetched over the same link"), (server.Acquired() == 1) && (provisioning.DRMIds() == 13));
+
+        // The stub hands out the labels as blobs, whether those clear
+        // depends on the libprovision the test is built against.
+        if (prefetched == 3) {
+            DRMId(labels[0]);
+            DRMId(labels[1]);
+
+            passed &= Tests::Check(_T("cached DRM ids are reused"), (provisioning.DRMIds() == 13));
+
+            SleepMs(250);
+            DRMId(labels[0]);
+
+            passed &= Tests::Check(_T("an expired DRM id is requested again"), (provisioning.DRMIds() == 14));
+        } else {
+            cout << "[SKIP] the stub blobs do not clear, the cache is not exercised" << endl;
+        }
+
+        provisioningproxy_cache_lifetime(0);
+    }
+
+    passed &= Tests::Check(_T("no DRM id without a Provisioning"), (DRMId(labels[0]) < 0));
+
+    {
+        Server server(Core::NodeId(Connector), proxyStubPath);
+
+        DRMId(labels[0]);
+
+        passed &= Tests::Check(_T("the link is re-established"), (server.Acquired() == 1) && (server.Implementation().DRMIds() == 1));
+    }
+
+    provisioningproxy_dispose();
+
+    return (passed == true ? 0 : 1);
+}
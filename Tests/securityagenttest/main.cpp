@@ -0,0 +1,155 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MODULE_NAME
+#define MODULE_NAME SecurityAgentTest
+#endif
+
+#include <securityagent.h>
+
+#include <core/core.h>
+#include <com/com.h>
+#include <plugins/plugins.h>
+
+#include "../common/StubServer.h"
+
+using namespace std;
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+// Exercises the persistent link and the token cache of the SecurityAgent
+// client library against an in-process stub of the SecurityAgent token
+// endpoint:
+//   securityagenttest [proxystub path]
+namespace {
+
+    constexpr TCHAR Connector[] = _T("/tmp/securityagenttest");
+    constexpr TCHAR Rejected[] = _T("http://localhost/rejected");
+    constexpr uint16_t MaxTokenLength = 2048;
+
+    class Authenticate : public Tests::Stub<PluginHost::IAuthenticate> {
+    public:
+        Authenticate(const Authenticate&) = delete;
+        Authenticate& operator=(const Authenticate&) = delete;
+
+        Authenticate()
+            : _created(0)
+        {
+        }
+        ~Authenticate() override = default;
+
+    public:
+        BEGIN_INTERFACE_MAP(Authenticate)
+        INTERFACE_ENTRY(PluginHost::IAuthenticate)
+        END_INTERFACE_MAP
+
+        uint32_t CreateToken(const uint16_t length, const uint8_t buffer[], string& token) override
+        {
+            const string payload(reinterpret_cast<const char*>(buffer), length);
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+
+            if (payload != Rejected) {
+                Core::InterlockedIncrement(_created);
+                token = _T("token-") + Core::NumberType<uint32_t>(_created).Text() + _T("-") + payload;
+                result = Core::ERROR_NONE;
+            }
+
+            return (result);
+        }
+        PluginHost::ISecurity* Officer(const string&) override
+        {
+            return (nullptr);
+        }
+
+        uint32_t Created() const
+        {
+            return (_created);
+        }
+
+    private:
+        uint32_t _created;
+    };
+
+    using Server = Tests::StubServer<Authenticate>;
+
+    int Token(const string& payload)
+    {
+        uint8_t buffer[MaxTokenLength];
+
+        ::memcpy(buffer, payload.c_str(), payload.length());
+
+        return (GetToken(sizeof(buffer), static_cast<uint16_t>(payload.length()), buffer));
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const string proxyStubPath = Tests::ProxyStubPath(argc, argv);
+    bool passed = true;
+
+    Core::SystemInfo::SetEnvironment(_T("SECURITYAGENT_PATH"), Connector);
+
+    {
+        Server server(Core::NodeId(Connector), proxyStubPath);
+
+        for (uint8_t index = 0; index < 10; index++) {
+            Token(_T("http://localhost/one"));
+        }
+
+        passed &= Tests::Check(_T("tokens are created on a single link"), (server.Acquired() == 1) && (server.Implementation().Created() == 10));
+
+        passed &= Tests::Check(_T("an error of the SecurityAgent is passed on"), (Token(Rejected) == -static_cast<int>(Core::ERROR_UNAVAILABLE)));
+
+        securityagent_token_lifetime(200);
+
+        for (uint8_t index = 0; index < 10; index++) {
+            Token(_T("http://localhost/one"));
+        }
+        Token(_T("http://localhost/two"));
+
+        passed &= Tests::Check(_T("cached tokens are reused per payload"), (server.Implementation().Created() == 12));
+
+        const string payload(_T("http://localhost/one"));
+        securityagent_invalidate_token(static_cast<uint16_t>(payload.length()), reinterpret_cast<const uint8_t*>(payload.c_str()));
+        Token(payload);
+
+        passed &= Tests::Check(_T("an invalidated token is recreated"), (server.Implementation().Created() == 13));
+
+        SleepMs(250);
+        Token(payload);
+
+        passed &= Tests::Check(_T("an expired token is recreated"), (server.Implementation().Created() == 14));
+
+        securityagent_token_lifetime(0);
+    }
+
+    passed &= Tests::Check(_T("no token without a SecurityAgent"), (Token(_T("http://localhost/three")) == -1));
+
+    {
+        Server server(Core::NodeId(Connector), proxyStubPath);
+
+        passed &= Tests::Check(_T("the link is re-established"), (Token(_T("http://localhost/one")) > 0) && (server.Acquired() == 1));
+    }
+
+    securityagent_dispose();
+
+    Core::Singleton::Dispose();
+
+    return (passed == true ? 0 : 1);
+}
@@ -0,0 +1,213 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MODULE_NAME
+#define MODULE_NAME VirtualInputBench
+#endif
+
+#include <virtualinput.h>
+
+#include <core/core.h>
+#include <plugins/IVirtualInput.h>
+#include <IPCVirtualInputBatch.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+// Measures the key event throughput of the VirtualInput client library against an
+// in-process stub of the input plugin: one message per event versus batched frames.
+namespace {
+
+    constexpr TCHAR Connector[] = _T("/tmp/virtualinputbench");
+    constexpr uint32_t WaitTime = 2000;
+
+    using Server = Core::IPCChannelServerType<Core::Void, true>;
+    using Client = Server::Client;
+
+    std::atomic<uint32_t> _received(0);
+    std::atomic<uint32_t> _lastCode(0);
+    std::atomic<bool> _ordered(true);
+    uint32_t _callbackDelay = 0;
+
+    void KeyEvent(enum keyactiontype, unsigned int code)
+    {
+        if (code != (_lastCode + 1)) {
+            _ordered = false;
+        }
+        _lastCode = code;
+
+        if (_callbackDelay != 0) {
+            ::usleep(_callbackDelay);
+        }
+
+        _received++;
+    }
+
+    Core::ProxyType<Client> Listener(Server& server)
+    {
+        Core::ProxyType<Client> result;
+        uint32_t waited = 0;
+
+        while ((result.IsValid() == false) && (waited < WaitTime)) {
+            auto index(server.Clients());
+
+            if (index.Next() == true) {
+                result = index.Client();
+            } else {
+                SleepMs(10);
+                waited += 10;
+            }
+        }
+
+        return (result);
+    }
+
+    bool Drained(const uint32_t events)
+    {
+        uint32_t waited = 0;
+
+        while ((_received < events) && (waited < (10 * WaitTime))) {
+            SleepMs(1);
+            waited++;
+        }
+
+        return (_received == events);
+    }
+
+    void Reset()
+    {
+        _received = 0;
+        _lastCode = 0;
+        _ordered = true;
+    }
+
+    uint64_t Single(Client& client, const uint32_t events)
+    {
+        Core::ProxyType<IVirtualInput::KeyMessage> message(Core::ProxyType<IVirtualInput::KeyMessage>::Create());
+        const uint64_t start = Core::Time::Now().Ticks();
+
+        for (uint32_t code = 1; code <= events; code++) {
+            message->Parameters().Action = static_cast<decltype(message->Parameters().Action)>(KEY_PRESSED);
+            message->Parameters().Code = code;
+
+            client.Invoke(Core::ProxyType<Core::IIPC>(message), WaitTime);
+        }
+
+        Drained(events);
+
+        return (Core::Time::Now().Ticks() - start);
+    }
+
+    uint64_t Batched(Client& client, const uint32_t events)
+    {
+        Core::ProxyType<IPC::VirtualInput::EventMessage> message(Core::ProxyType<IPC::VirtualInput::EventMessage>::Create());
+        const uint64_t start = Core::Time::Now().Ticks();
+        uint32_t code = 1;
+
+        while (code <= events) {
+            IPC::VirtualInput::Events& frame(message->Parameters());
+
+            frame.Sequence = code;
+            frame.Count = 0;
+
+            while ((frame.Count < IPC::VirtualInput::MaxEvents) && (code <= events)) {
+                IPC::VirtualInput::Event& entry(frame.Entries[frame.Count++]);
+
+                entry = IPC::VirtualInput::Event();
+                entry.Type = IPC::VirtualInput::EVENT_KEY;
+                entry.Action = KEY_PRESSED;
+                entry.Code = code++;
+            }
+
+            client.Invoke(Core::ProxyType<Core::IIPC>(message), WaitTime);
+        }
+
+        Drained(events);
+
+        return (Core::Time::Now().Ticks() - start);
+    }
+
+    void Report(const TCHAR label[], const uint32_t events, const uint64_t duration)
+    {
+        cout << label << ": " << events << " events in " << (duration / 1000) << " ms, "
+             << (duration != 0 ? ((static_cast<uint64_t>(events) * 1000000) / duration) : 0) << " events/s"
+             << (_ordered == true ? "" : " [OUT OF ORDER]") << endl;
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const uint32_t events = (argc > 1 ? ::atoi(argv[1]) : 100000);
+    _callbackDelay = (argc > 2 ? ::atoi(argv[2]) : 0);
+
+    cout << "virtualinputbench [events] [callback delay in us]" << endl;
+
+    bool passed = false;
+
+    {
+        Server server(Core::NodeId(Connector), 1024);
+
+        server.Open(Core::infinite);
+
+        void* handle = virtualinput_open("virtualinputbench", Connector, KeyEvent, nullptr, nullptr);
+        Core::ProxyType<Client> client(Listener(server));
+
+        if (client.IsValid() == false) {
+            cout << "The listener did not connect" << endl;
+        } else {
+            Core::ProxyType<IVirtualInput::NameMessage> name(Core::ProxyType<IVirtualInput::NameMessage>::Create());
+
+            if (client->Invoke(Core::ProxyType<Core::IIPC>(name), WaitTime) != Core::ERROR_NONE) {
+                cout << "The listener did not report its name" << endl;
+            } else {
+                const bool batching = ((name->Response().Mode & IPC::VirtualInput::INPUT_BATCH) != 0);
+
+                cout << "Listener '" << name->Response().Name << "', batching " << (batching == true ? "supported" : "not supported") << endl;
+
+                Reset();
+                Report(_T("single "), events, Single(*client, events));
+                passed = (_received == events) && (_ordered == true);
+
+                if (batching == true) {
+                    Reset();
+                    Report(_T("batched"), events, Batched(*client, events));
+                    passed &= (_received == events) && (_ordered == true);
+                }
+
+                cout << "Lost events: " << virtualinput_lost_events(handle) << endl;
+                passed &= (virtualinput_lost_events(handle) == 0);
+            }
+        }
+
+        client.Release();
+
+        virtualinput_close(handle);
+
+        server.Close(Core::infinite);
+    }
+
+    virtualinput_dispose();
+
+    Core::Singleton::Dispose();
+
+    return (passed == true ? 0 : 1);
+}
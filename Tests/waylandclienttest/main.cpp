@@ -0,0 +1,237 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MODULE_NAME
+#define MODULE_NAME WaylandClientTest
+#endif
+
+#include <core/core.h>
+#include <compositor/Client.h>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+
+using namespace std;
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+// Renders on a couple of surfaces, each from a thread of its own, while the main thread
+// takes the notifications of the Wayland event thread. No surface should wait for another,
+// or for the input. Runs against the headless backend of weston:
+//   weston --backend=headless-backend.so --socket=wayland-test &
+//   XDG_RUNTIME_DIR=... WAYLAND_DISPLAY=wayland-test waylandclienttest
+// With the pixman renderer of weston, have Mesa render in software: LIBGL_ALWAYS_SOFTWARE=1
+namespace {
+
+    constexpr uint32_t Width = 640;
+    constexpr uint32_t Height = 360;
+    constexpr int WaitTime = 100;
+
+    class Renderer {
+    public:
+        Renderer() = delete;
+        Renderer(const Renderer&) = delete;
+        Renderer& operator=(const Renderer&) = delete;
+
+        Renderer(EGLDisplay display, EGLConfig config, Compositor::IDisplay::ISurface* surface)
+            : _display(display)
+            , _config(config)
+            , _surface(surface)
+            , _frames(0)
+            , _slowest(0)
+            , _duration(0)
+            , _done(false)
+        {
+        }
+        ~Renderer() = default;
+
+    public:
+        void Run(const uint32_t frames)
+        {
+            const EGLint attributes[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+            EGLContext context = eglCreateContext(_display, _config, EGL_NO_CONTEXT, attributes);
+            EGLSurface window = eglCreateWindowSurface(_display, _config, _surface->Native(), nullptr);
+
+            if ((context != EGL_NO_CONTEXT) && (window != EGL_NO_SURFACE) && (eglMakeCurrent(_display, window, window, context) == EGL_TRUE)) {
+                const uint64_t start = Core::Time::Now().Ticks();
+                uint64_t previous = start;
+
+                while (_frames < frames) {
+                    glClearColor(static_cast<float>(_frames % 60) / 60.0f, 0.0f, 0.5f, 1.0f);
+                    glClear(GL_COLOR_BUFFER_BIT);
+
+                    if (eglSwapBuffers(_display, window) != EGL_TRUE) {
+                        break;
+                    }
+
+                    const uint64_t now = Core::Time::Now().Ticks();
+
+                    _slowest = std::max(_slowest, now - previous);
+                    previous = now;
+                    _frames++;
+                }
+
+                _duration = previous - start;
+
+                eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            }
+
+            if (window != EGL_NO_SURFACE) {
+                eglDestroySurface(_display, window);
+            }
+            if (context != EGL_NO_CONTEXT) {
+                eglDestroyContext(_display, context);
+            }
+
+            eglReleaseThread();
+
+            _done = true;
+        }
+        bool IsDone() const
+        {
+            return (_done);
+        }
+        uint32_t Frames() const
+        {
+            return (_frames);
+        }
+        void Report() const
+        {
+            cout << _surface->Name() << ": " << _frames << " frames in " << (_duration / 1000) << " ms, "
+                 << (_duration != 0 ? ((static_cast<uint64_t>(_frames) * 1000000) / _duration) : 0) << " frames/s, "
+                 << "slowest frame " << (_slowest / 1000) << " ms" << endl;
+        }
+
+    private:
+        EGLDisplay _display;
+        EGLConfig _config;
+        Compositor::IDisplay::ISurface* _surface;
+        uint32_t _frames;
+        uint64_t _slowest;
+        uint64_t _duration;
+        std::atomic<bool> _done;
+    };
+
+    EGLConfig Configuration(EGLDisplay display)
+    {
+        const EGLint attributes[] = {
+            EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+            EGL_NONE
+        };
+
+        EGLConfig result = nullptr;
+        EGLint count = 0;
+
+        if ((eglChooseConfig(display, attributes, &result, 1, &count) != EGL_TRUE) || (count == 0)) {
+            result = nullptr;
+        }
+
+        return (result);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const uint32_t frames = (argc > 1 ? ::atoi(argv[1]) : 300);
+    const uint32_t count = (argc > 2 ? ::atoi(argv[2]) : 2);
+    bool passed = false;
+
+    cout << "waylandclienttest [frames] [surfaces]" << endl;
+
+    Compositor::IDisplay* display = Compositor::IDisplay::Instance(_T("WaylandClientTest"));
+
+    if (display == nullptr) {
+        cout << "No Wayland display" << endl;
+    } else {
+        EGLDisplay egl = eglGetDisplay(display->Native());
+        EGLConfig config = nullptr;
+
+        if ((eglInitialize(egl, nullptr, nullptr) != EGL_TRUE) || (eglBindAPI(EGL_OPENGL_ES_API) != EGL_TRUE) || ((config = Configuration(egl)) == nullptr)) {
+            cout << "No EGL on the Wayland display" << endl;
+        } else {
+            vector<Compositor::IDisplay::ISurface*> surfaces;
+            vector<Renderer*> renderers;
+            vector<std::thread> threads;
+
+            for (uint32_t index = 0; index < count; index++) {
+                Compositor::IDisplay::ISurface* surface = display->Create(_T("WaylandClientTest-") + Core::NumberType<uint32_t>(index).Text(), Width, Height);
+
+                if (surface != nullptr) {
+                    surfaces.push_back(surface);
+                    renderers.push_back(new Renderer(egl, config, surface));
+                }
+            }
+
+            for (Renderer* renderer : renderers) {
+                threads.emplace_back(&Renderer::Run, renderer, frames);
+            }
+
+            // The events are dispatched on the event thread, this only takes the notifications.
+            uint32_t notifications = 0;
+            bool running = true;
+
+            while ((running == true) && (std::any_of(renderers.begin(), renderers.end(), [](const Renderer* renderer) { return (renderer->IsDone() == false); }) == true)) {
+                struct pollfd descriptor = { display->FileDescriptor(), POLLIN, 0 };
+
+                if (::poll(&descriptor, 1, WaitTime) > 0) {
+                    running = (display->Process(descriptor.revents) == 0);
+                    notifications++;
+                }
+            }
+
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+
+            passed = (renderers.empty() == false) && (running == true);
+
+            for (Renderer* renderer : renderers) {
+                renderer->Report();
+                passed &= (renderer->Frames() == frames);
+                delete renderer;
+            }
+
+            cout << notifications << " notifications from the event thread" << endl;
+
+            for (Compositor::IDisplay::ISurface* surface : surfaces) {
+                surface->Release();
+            }
+        }
+
+        eglTerminate(egl);
+
+        display->Release();
+    }
+
+    Core::Singleton::Dispose();
+
+    return (passed == true ? 0 : 1);
+}
@@ -0,0 +1,343 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MODULE_NAME
+#define MODULE_NAME WaylandDmabufTest
+#endif
+
+#include <core/core.h>
+#include <compositor/Client.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/udmabuf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+using namespace std;
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+// Presents dma-bufs on a surface without any GPU in the loop: the buffers come from udmabuf
+// (memfd pages exported as a dma-buf), the compositor reads them with pixman. Runs against
+// the headless backend of weston:
+//   modprobe udmabuf
+//   weston --backend=headless-backend.so --renderer=pixman --socket=wayland-test &
+//   XDG_RUNTIME_DIR=... WAYLAND_DISPLAY=wayland-test waylanddmabuftest
+namespace {
+
+    constexpr uint32_t Width = 640;
+    constexpr uint32_t Height = 360;
+    constexpr uint32_t WaitTime = 1000;
+    constexpr uint8_t Depth = 3;
+
+    constexpr uint32_t FormatXRGB8888 = 0x34325258; // DRM_FORMAT_XRGB8888
+    constexpr uint32_t FormatNV12 = 0x3231564E; // DRM_FORMAT_NV12
+    constexpr uint64_t ModifierLinear = 0; // DRM_FORMAT_MOD_LINEAR
+
+    class Buffer {
+    public:
+        Buffer() = delete;
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        Buffer(const uint32_t format)
+            : _memfd(-1)
+            , _dmabuf(-1)
+            , _size(0)
+            , _data(nullptr)
+            , _count(0)
+            , _planes()
+        {
+            const long page = ::sysconf(_SC_PAGESIZE);
+
+            if (format == FormatNV12) {
+                _count = 2;
+                _planes[0] = { -1, 0, Width };
+                _planes[1] = { -1, Width * Height, Width };
+                _size = (Width * Height * 3) / 2;
+            } else {
+                _count = 1;
+                _planes[0] = { -1, 0, Width * 4 };
+                _size = Width * Height * 4;
+            }
+
+            _size = ((_size + page - 1) / page) * page;
+
+            int device = ::open("/dev/udmabuf", O_RDWR | O_CLOEXEC);
+
+            if (device != -1) {
+                _memfd = ::memfd_create(_T("WaylandDmabufTest"), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+                // udmabuf only takes memfds that can not shrink.
+                if ((_memfd != -1) && (::ftruncate(_memfd, _size) == 0) && (::fcntl(_memfd, F_ADD_SEALS, F_SEAL_SHRINK) == 0)) {
+                    struct udmabuf_create create = { static_cast<uint32_t>(_memfd), UDMABUF_FLAGS_CLOEXEC, 0, _size };
+
+                    _dmabuf = ::ioctl(device, UDMABUF_CREATE, &create);
+
+                    void* data = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _memfd, 0);
+
+                    _data = (data != MAP_FAILED ? static_cast<uint8_t*>(data) : nullptr);
+                }
+
+                ::close(device);
+            }
+
+            for (uint8_t plane = 0; plane < _count; plane++) {
+                _planes[plane].fd = _dmabuf;
+            }
+        }
+        ~Buffer()
+        {
+            if (_data != nullptr) {
+                ::munmap(_data, _size);
+            }
+            if (_dmabuf != -1) {
+                ::close(_dmabuf);
+            }
+            if (_memfd != -1) {
+                ::close(_memfd);
+            }
+        }
+
+    public:
+        bool IsValid() const
+        {
+            return ((_dmabuf != -1) && (_data != nullptr));
+        }
+        uint8_t Count() const
+        {
+            return (_count);
+        }
+        const Compositor::IDisplay::Plane* Planes() const
+        {
+            return (_planes);
+        }
+        int Descriptor() const
+        {
+            return (_dmabuf);
+        }
+        // A plain level per frame, enough for the compositor to have something to read.
+        void Fill(const uint32_t frame)
+        {
+            ::memset(_data, static_cast<int>((frame * 4) & 0xFF), _size);
+        }
+
+    private:
+        int _memfd;
+        int _dmabuf;
+        uint64_t _size;
+        uint8_t* _data;
+        uint8_t _count;
+        Compositor::IDisplay::Plane _planes[2];
+    };
+
+    class Releases : public Compositor::IDisplay::IBufferCallback {
+    public:
+        Releases(const Releases&) = delete;
+        Releases& operator=(const Releases&) = delete;
+
+        Releases()
+            : _lock()
+            , _signal()
+            , _free()
+            , _count(0)
+        {
+        }
+        ~Releases() override = default;
+
+    public:
+        void Released(const uint32_t id) override
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+
+            _free.insert(id);
+            _count++;
+            _signal.notify_one();
+        }
+        void Add(const uint32_t id)
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+
+            _free.insert(id);
+        }
+        // The next buffer the compositor is done with, ~0 if none comes back in time.
+        uint32_t Next()
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+
+            uint32_t result = ~0;
+
+            if (_signal.wait_for(lock, std::chrono::milliseconds(WaitTime), [this]() { return (_free.empty() == false); }) == true) {
+                result = *_free.begin();
+                _free.erase(_free.begin());
+            }
+
+            return (result);
+        }
+        void Clear()
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+
+            _free.clear();
+        }
+        uint32_t Count() const
+        {
+            return (_count);
+        }
+
+    private:
+        std::mutex _lock;
+        std::condition_variable _signal;
+        std::set<uint32_t> _free;
+        std::atomic<uint32_t> _count;
+    };
+
+    bool Present(Compositor::IDisplay::ISurface* surface, Releases& releases, const uint32_t format, const TCHAR name[], const uint32_t frames, const bool required)
+    {
+        bool result = false;
+        vector<Buffer*> buffers;
+        vector<uint32_t> ids;
+
+        for (uint8_t index = 0; index < Depth; index++) {
+            buffers.push_back(new Buffer(format));
+        }
+
+        if (buffers[0]->IsValid() == false) {
+            cout << name << ": no udmabuf, try: modprobe udmabuf" << endl;
+        } else {
+            for (Buffer* buffer : buffers) {
+                ids.push_back(surface->Import(Width, Height, format, ModifierLinear, buffer->Count(), buffer->Planes()));
+            }
+
+            if (ids[0] == static_cast<uint32_t>(~0)) {
+                cout << name << ": not imported by the compositor" << endl;
+                result = (required == false);
+            } else {
+                // The same dma-buf, handed over with another descriptor, is in the pool already.
+                Compositor::IDisplay::Plane planes[2];
+                const int descriptor = ::dup(buffers[0]->Descriptor());
+
+                for (uint8_t plane = 0; plane < buffers[0]->Count(); plane++) {
+                    planes[plane] = buffers[0]->Planes()[plane];
+                    planes[plane].fd = descriptor;
+                }
+
+                const bool reused = (surface->Import(Width, Height, format, ModifierLinear, buffers[0]->Count(), planes) == ids[0]);
+
+                ::close(descriptor);
+
+                for (const uint32_t id : ids) {
+                    releases.Add(id);
+                }
+
+                const uint32_t released = releases.Count();
+                const uint64_t start = Core::Time::Now().Ticks();
+                bool held = true;
+                uint32_t frame = 0;
+
+                while (frame < frames) {
+                    const uint32_t id = releases.Next();
+
+                    if (id == static_cast<uint32_t>(~0)) {
+                        break;
+                    }
+
+                    buffers[std::find(ids.begin(), ids.end(), id) - ids.begin()]->Fill(frame);
+
+                    if (surface->Present(id) == false) {
+                        break;
+                    }
+
+                    // Until the compositor lets go of it, the buffer can not be presented again.
+                    held &= (surface->Present(id) == false);
+                    frame++;
+                }
+
+                const uint64_t duration = Core::Time::Now().Ticks() - start;
+
+                cout << name << ": " << frame << " frames in " << (duration / 1000) << " ms, "
+                     << (duration != 0 ? ((static_cast<uint64_t>(frame) * 1000000) / duration) : 0) << " frames/s, "
+                     << (releases.Count() - released) << " releases, " << ids.size() << " buffers, pool "
+                     << (reused == true ? "reused" : "NOT reused") << endl;
+
+                result = (frame == frames) && (reused == true) && (held == true) && (std::find(ids.begin(), ids.end(), static_cast<uint32_t>(~0)) == ids.end());
+
+                for (const uint32_t id : ids) {
+                    surface->Forget(id);
+                }
+
+                releases.Clear();
+            }
+        }
+
+        for (Buffer* buffer : buffers) {
+            delete buffer;
+        }
+
+        return (result);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const uint32_t frames = (argc > 1 ? ::atoi(argv[1]) : 300);
+    bool passed = false;
+
+    cout << "waylanddmabuftest [frames]" << endl;
+
+    Compositor::IDisplay* display = Compositor::IDisplay::Instance(_T("WaylandDmabufTest"));
+
+    if (display == nullptr) {
+        cout << "No Wayland display" << endl;
+    } else {
+        Compositor::IDisplay::ISurface* surface = display->Create(_T("WaylandDmabufTest"), Width, Height);
+
+        if (surface == nullptr) {
+            cout << "No surface on the Wayland display" << endl;
+        } else {
+            Releases releases;
+
+            surface->BufferCallback(&releases);
+
+            passed = Present(surface, releases, FormatXRGB8888, _T("XRGB8888"), frames, true);
+
+            // Not every compositor reads multi-planar YUV, only fail if it took the buffers.
+            passed &= Present(surface, releases, FormatNV12, _T("NV12"), frames, false);
+
+            surface->BufferCallback(nullptr);
+            surface->Release();
+        }
+
+        display->Release();
+    }
+
+    Core::Singleton::Dispose();
+
+    return (passed == true ? 0 : 1);
+}